@@ -0,0 +1,3 @@
+
+#include "libxml/parser.h"
+
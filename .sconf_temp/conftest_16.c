@@ -0,0 +1,3 @@
+
+#include "miniupnpc.h"
+
@@ -0,0 +1,8 @@
+
+#include <stdlib.h>
+#include <stdio.h>
+int main() {
+    printf("%d", (int)sizeof(ip_mreqn));
+    return 0;
+}
+    
\ No newline at end of file
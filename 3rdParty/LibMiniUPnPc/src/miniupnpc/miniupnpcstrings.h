@@ -0,0 +1,8 @@
+
+#ifndef __MINIUPNPCSTRINGS_H__
+#define __MINIUPNPCSTRINGS_H__
+
+#define OS_STRING "posix"
+#define MINIUPNPC_VERSION_STRING "1.9"
+
+#endif
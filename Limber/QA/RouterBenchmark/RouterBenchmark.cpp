@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include "Swiften/Elements/Message.h"
+#include "Limber/Server/ServerStanzaRouter.h"
+#include "Limber/Server/ServerSession.h"
+
+using namespace Swift;
+
+namespace {
+	class BenchmarkServerSession : public ServerSession {
+		public:
+			BenchmarkServerSession(const JID& jid, int priority) : jid(jid), priority(priority), received(0) {}
+
+			virtual const JID& getJID() const { return jid; }
+			virtual int getPriority() const { return priority; }
+
+			virtual void sendStanza(boost::shared_ptr<Stanza>) {
+				++received;
+			}
+
+			JID jid;
+			int priority;
+			size_t received;
+	};
+
+	double elapsedMicroseconds(const boost::posix_time::ptime& start) {
+		return static_cast<double>((boost::posix_time::microsec_clock::universal_time() - start).total_microseconds());
+	}
+}
+
+/**
+ * Routes stanzas between 100k sessions (50k users with 2 resources each),
+ * addressed to both bare and full JIDs.
+ *
+ * Usage: RouterBenchmark [number of stanzas]
+ */
+int main(int argc, char* argv[]) {
+	const size_t users = 50000;
+	const size_t resourcesPerUser = 2;
+	const size_t stanzas = argc > 1 ? boost::lexical_cast<size_t>(argv[1]) : 20000;
+
+	std::vector<BenchmarkServerSession*> sessions;
+	ServerStanzaRouter router;
+	boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+	for (size_t i = 0; i < users; ++i) {
+		for (size_t j = 0; j < resourcesPerUser; ++j) {
+			JID jid("user" + boost::lexical_cast<std::string>(i), "example.com", "resource" + boost::lexical_cast<std::string>(j));
+			sessions.push_back(new BenchmarkServerSession(jid, static_cast<int>(j)));
+			router.addClientSession(sessions.back());
+		}
+	}
+	double time = elapsedMicroseconds(start);
+	std::cout << "Added " << sessions.size() << " sessions: " << std::fixed << std::setprecision(2) << time / sessions.size() << " us/session" << std::endl;
+
+	std::vector<boost::shared_ptr<Message> > messages;
+	std::srand(0);
+	for (size_t i = 0; i < stanzas; ++i) {
+		const BenchmarkServerSession* session = sessions[static_cast<size_t>(std::rand()) % sessions.size()];
+		boost::shared_ptr<Message> message = boost::make_shared<Message>();
+		message->setTo(i % 2 == 0 ? session->getJID() : session->getJID().toBare());
+		messages.push_back(message);
+	}
+
+	size_t routed = 0;
+	start = boost::posix_time::microsec_clock::universal_time();
+	for (size_t i = 0; i < messages.size(); ++i) {
+		if (router.routeStanza(messages[i])) {
+			++routed;
+		}
+	}
+	time = elapsedMicroseconds(start);
+	std::cout << "Routed " << routed << " stanzas: " << std::fixed << std::setprecision(2) << time / messages.size() << " us/stanza" << std::endl;
+
+	start = boost::posix_time::microsec_clock::universal_time();
+	for (size_t i = 0; i < sessions.size(); ++i) {
+		router.removeClientSession(sessions[i]);
+		delete sessions[i];
+	}
+	time = elapsedMicroseconds(start);
+	std::cout << "Removed " << sessions.size() << " sessions: " << std::fixed << std::setprecision(2) << time / sessions.size() << " us/session" << std::endl;
+	return 0;
+}
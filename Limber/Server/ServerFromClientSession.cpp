@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,7 +20,11 @@
 #include "Swiften/Elements/AuthSuccess.h"
 #include "Swiften/Elements/AuthFailure.h"
 #include "Swiften/Elements/AuthRequest.h"
+#include "Swiften/Elements/StartTLSRequest.h"
+#include "Swiften/Elements/StartTLSFailure.h"
+#include "Swiften/Elements/TLSProceed.h"
 #include "Swiften/SASL/PLAINMessage.h"
+#include "Swiften/TLS/TLSContextFactory.h"
 
 namespace Swift {
 
@@ -36,7 +40,21 @@ ServerFromClientSession::ServerFromClientSession(
 			userRegistry_(userRegistry),
 			authenticated_(false),
 			initialized(false),
-			allowSASLEXTERNAL(false) {
+			allowSASLEXTERNAL(false),
+			tlsContextFactory_(NULL),
+			directTLS_(false) {
+}
+
+void ServerFromClientSession::handleSessionStarted() {
+	if (directTLS_) {
+		TLSContext* context = tlsContextFactory_ ? tlsContextFactory_->createServerTLSContext() : NULL;
+		if (context) {
+			addServerTLSEncryption(context);
+		}
+		else {
+			finishSession(TLSError);
+		}
+	}
 }
 
 
@@ -45,7 +63,19 @@ void ServerFromClientSession::handleElement(boost::shared_ptr<ToplevelElement> e
 		onElementReceived(element);
 	}
 	else {
-		if (AuthRequest* authRequest = dynamic_cast<AuthRequest*>(element.get())) {
+		if (dynamic_cast<StartTLSRequest*>(element.get())) {
+			TLSContext* context = (tlsContextFactory_ && !isTLSEncrypted() && !authenticated_) ? tlsContextFactory_->createServerTLSContext() : NULL;
+			if (context) {
+				getXMPPLayer()->writeElement(boost::make_shared<TLSProceed>());
+				addServerTLSEncryption(context);
+				getXMPPLayer()->resetParser();
+			}
+			else {
+				getXMPPLayer()->writeElement(boost::make_shared<StartTLSFailure>());
+				finishSession(TLSError);
+			}
+		}
+		else if (AuthRequest* authRequest = dynamic_cast<AuthRequest*>(element.get())) {
 			if (authRequest->getMechanism() == "PLAIN" || (allowSASLEXTERNAL && authRequest->getMechanism() == "EXTERNAL")) {
 				if (authRequest->getMechanism() == "EXTERNAL") {
 						getXMPPLayer()->writeElement(boost::make_shared<AuthSuccess>());
@@ -95,6 +125,9 @@ void ServerFromClientSession::handleStreamStart(const ProtocolHeader& incomingHe
 
 	boost::shared_ptr<StreamFeatures> features(new StreamFeatures());
 	if (!authenticated_) {
+		if (tlsContextFactory_ && !isTLSEncrypted()) {
+			features->setHasStartTLS();
+		}
 		features->addAuthenticationMechanism("PLAIN");
 		if (allowSASLEXTERNAL) {
 			features->addAuthenticationMechanism("EXTERNAL");
@@ -109,6 +142,9 @@ void ServerFromClientSession::handleStreamStart(const ProtocolHeader& incomingHe
 
 void ServerFromClientSession::setInitialized() {
 	initialized = true;
+	// From here on, most stanzas are only routed, so don't parse their
+	// payloads unless they are needed.
+	getXMPPLayer()->setRawForwarding(true);
 	onSessionStarted();
 }
 
@@ -116,4 +152,12 @@ void ServerFromClientSession::setAllowSASLEXTERNAL() {
 	allowSASLEXTERNAL = true;
 }
 
+void ServerFromClientSession::setTLSContextFactory(TLSContextFactory* factory) {
+	tlsContextFactory_ = factory;
+}
+
+void ServerFromClientSession::setDirectTLS() {
+	directTLS_ = true;
+}
+
 }
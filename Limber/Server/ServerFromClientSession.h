@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -28,6 +28,7 @@ namespace Swift {
 	class ConnectionLayer;
 	class Connection;
 	class XMLParserFactory;
+	class TLSContextFactory;
 
 	class ServerFromClientSession : public Session {
 		public:
@@ -42,7 +43,19 @@ namespace Swift {
 			boost::signal<void ()> onSessionStarted;
 			void setAllowSASLEXTERNAL();
 
+			/**
+			 * Offers STARTTLS, using server contexts from the given factory.
+			 */
+			void setTLSContextFactory(TLSContextFactory* factory);
+
+			/**
+			 * Starts TLS as soon as the session starts, instead of offering
+			 * STARTTLS (direct TLS). Requires a TLS context factory.
+			 */
+			void setDirectTLS();
+
 		private:
+			void handleSessionStarted();
 			void handleElement(boost::shared_ptr<ToplevelElement>);
 			void handleStreamStart(const ProtocolHeader& header);
 
@@ -57,6 +70,8 @@ namespace Swift {
 			bool authenticated_;
 			bool initialized;
 			bool allowSASLEXTERNAL;
+			TLSContextFactory* tlsContextFactory_;
+			bool directTLS_;
 			std::string user_;
 	};
 }
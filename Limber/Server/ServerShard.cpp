@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include "Limber/Server/ServerShard.h"
+
+#include <utility>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <Swiften/Elements/IQ.h>
+#include <Swiften/Elements/Presence.h>
+#include <Swiften/Elements/RosterPayload.h>
+#include <Swiften/Elements/VCard.h>
+#include <Swiften/Network/Connection.h>
+
+#include "Limber/Server/ServerFromClientSession.h"
+#include "Limber/Server/ServerSession.h"
+#include "Limber/Server/ShardedStanzaRouter.h"
+
+namespace Swift {
+
+/**
+ * The routing table entry of a bound session.
+ *
+ * The router calls this from the thread of the sending session, so
+ * stanzas are handed off to the event loop of the owning shard, and the
+ * priority is kept in an atomic.
+ */
+class ServerShard::RoutedSession : public ServerSession, public boost::enable_shared_from_this<RoutedSession> {
+	public:
+		RoutedSession(boost::shared_ptr<ServerFromClientSession> session, EventLoop* eventLoop) : session_(session), jid_(session->getRemoteJID()), priority_(-1), eventLoop_(eventLoop) {
+		}
+
+		virtual const JID& getJID() const {
+			return jid_;
+		}
+
+		virtual int getPriority() const {
+			return priority_.load(boost::memory_order_relaxed);
+		}
+
+		void setPriority(int priority) {
+			priority_.store(priority, boost::memory_order_relaxed);
+		}
+
+		virtual void sendStanza(boost::shared_ptr<Stanza> stanza) {
+			eventLoop_->postEvent(boost::bind(&RoutedSession::deliverStanza, shared_from_this(), stanza));
+		}
+
+	private:
+		void deliverStanza(boost::shared_ptr<Stanza> stanza) {
+			if (boost::shared_ptr<ServerFromClientSession> session = session_.lock()) {
+				session->sendElement(stanza);
+			}
+		}
+
+	private:
+		boost::weak_ptr<ServerFromClientSession> session_;
+		JID jid_;
+		boost::atomic<int> priority_;
+		EventLoop* eventLoop_;
+};
+
+ServerShard::ServerShard(UserRegistry* userRegistry, ShardedStanzaRouter* router, TLSContextFactory* tlsContextFactory) : userRegistry_(userRegistry), router_(router), tlsContextFactory_(tlsContextFactory), eventLoop_(SimpleEventLoop::LockFreeQueue) {
+}
+
+ServerShard::~ServerShard() {
+	for (SessionMap::const_iterator i = sessions_.begin(); i != sessions_.end(); ++i) {
+		if (i->second) {
+			router_->removeClientSession(i->second.get());
+		}
+	}
+}
+
+void ServerShard::run() {
+	eventLoop_.run();
+}
+
+void ServerShard::stop() {
+	eventLoop_.stop();
+}
+
+void ServerShard::addConnection(boost::shared_ptr<Connection> connection, bool directTLS) {
+	boost::shared_ptr<ServerFromClientSession> session(new ServerFromClientSession(idGenerator_.generateID(), connection, &payloadParserFactories_, &payloadSerializers_, &xmlParserFactory_, userRegistry_));
+	if (tlsContextFactory_) {
+		session->setTLSContextFactory(tlsContextFactory_);
+		if (directTLS) {
+			session->setDirectTLS();
+		}
+	}
+	sessions_.insert(std::make_pair(session, boost::shared_ptr<RoutedSession>()));
+	session->onSessionStarted.connect(boost::bind(&ServerShard::handleSessionStarted, this, session));
+	session->onElementReceived.connect(boost::bind(&ServerShard::handleElementReceived, this, _1, session));
+	session->onSessionFinished.connect(boost::bind(&ServerShard::handleSessionFinished, this, session));
+	session->startSession();
+	connection->listen();
+}
+
+void ServerShard::handleSessionStarted(boost::shared_ptr<ServerFromClientSession> session) {
+	boost::shared_ptr<RoutedSession> routedSession = boost::make_shared<RoutedSession>(session, &eventLoop_);
+	sessions_[session] = routedSession;
+	router_->addClientSession(routedSession.get());
+}
+
+void ServerShard::handleSessionFinished(boost::shared_ptr<ServerFromClientSession> session) {
+	SessionMap::iterator i = sessions_.find(session);
+	if (i == sessions_.end()) {
+		return;
+	}
+	if (i->second) {
+		router_->removeClientSession(i->second.get());
+	}
+	sessions_.erase(i);
+}
+
+void ServerShard::handleElementReceived(boost::shared_ptr<ToplevelElement> element, boost::shared_ptr<ServerFromClientSession> session) {
+	boost::shared_ptr<Stanza> stanza(boost::dynamic_pointer_cast<Stanza>(element));
+	if (!stanza) {
+		return;
+	}
+	stanza->setFrom(session->getRemoteJID());
+	if (!stanza->getTo().isValid()) {
+		stanza->setTo(JID(session->getLocalJID()));
+	}
+	if (!stanza->getTo().isValid() || stanza->getTo() == session->getLocalJID() || stanza->getTo() == session->getRemoteJID().toBare()) {
+		if (boost::shared_ptr<Presence> presence = boost::dynamic_pointer_cast<Presence>(stanza)) {
+			SessionMap::const_iterator i = sessions_.find(session);
+			if (i != sessions_.end() && i->second) {
+				if (presence->getType() == Presence::Available) {
+					i->second->setPriority(presence->getPriority());
+				}
+				else if (presence->getType() == Presence::Unavailable) {
+					i->second->setPriority(-1);
+				}
+			}
+		}
+		else if (boost::shared_ptr<IQ> iq = boost::dynamic_pointer_cast<IQ>(stanza)) {
+			if (iq->getPayload<RosterPayload>()) {
+				session->sendElement(IQ::createResult(iq->getFrom(), iq->getID(), boost::make_shared<RosterPayload>()));
+			}
+			if (iq->getPayload<VCard>()) {
+				if (iq->getType() == IQ::Get) {
+					boost::shared_ptr<VCard> vcard(new VCard());
+					vcard->setNickname(iq->getFrom().getNode());
+					session->sendElement(IQ::createResult(iq->getFrom(), iq->getID(), vcard));
+				}
+				else {
+					session->sendElement(IQ::createError(iq->getFrom(), iq->getID(), ErrorPayload::Forbidden, ErrorPayload::Cancel));
+				}
+			}
+			else {
+				session->sendElement(IQ::createError(iq->getFrom(), iq->getID(), ErrorPayload::FeatureNotImplemented, ErrorPayload::Cancel));
+			}
+		}
+	}
+	else if (!router_->routeStanza(stanza)) {
+		boost::shared_ptr<IQ> iq = boost::dynamic_pointer_cast<IQ>(stanza);
+		if (iq && (iq->getType() == IQ::Get || iq->getType() == IQ::Set)) {
+			session->sendElement(IQ::createError(iq->getFrom(), iq->getID(), ErrorPayload::ServiceUnavailable, ErrorPayload::Cancel));
+		}
+	}
+}
+
+}
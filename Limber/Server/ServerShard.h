@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <Swiften/Base/IDGenerator.h>
+#include <Swiften/EventLoop/SimpleEventLoop.h>
+#include <Swiften/Network/BoostIOServiceThread.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+
+namespace Swift {
+	class Connection;
+	class ServerFromClientSession;
+	class ShardedStanzaRouter;
+	class TLSContextFactory;
+	class ToplevelElement;
+	class UserRegistry;
+
+	/**
+	 * A set of client sessions that is served by a single thread.
+	 *
+	 * Every shard has its own event loop, I/O service, parsers and
+	 * serializers, so sessions of different shards never share state.
+	 * Stanzas for sessions of other shards are routed through a
+	 * ShardedStanzaRouter, and are posted to the (lock-free) event queue of
+	 * the shard owning the target session.
+	 */
+	class ServerShard : public boost::noncopyable {
+		public:
+			/**
+			 * If a TLS context factory is given, sessions offer STARTTLS
+			 * with its server contexts. The factory is shared by all shards.
+			 */
+			ServerShard(UserRegistry* userRegistry, ShardedStanzaRouter* router, TLSContextFactory* tlsContextFactory = NULL);
+			~ServerShard();
+
+			boost::shared_ptr<boost::asio::io_service> getIOService() const {
+				return ioServiceThread_.getIOService();
+			}
+
+			EventLoop* getEventLoop() {
+				return &eventLoop_;
+			}
+
+			/**
+			 * Runs the event loop of the shard in the calling thread, until
+			 * stop() is called.
+			 */
+			void run();
+			void stop();
+
+			/**
+			 * Starts a session on a connection that was created with the
+			 * I/O service and event loop of this shard.
+			 *
+			 * This should be called from the event loop of the shard.
+			 * With directTLS, the session starts with a TLS handshake
+			 * instead of offering STARTTLS.
+			 */
+			void addConnection(boost::shared_ptr<Connection> connection, bool directTLS = false);
+
+		private:
+			class RoutedSession;
+
+			void handleSessionStarted(boost::shared_ptr<ServerFromClientSession> session);
+			void handleSessionFinished(boost::shared_ptr<ServerFromClientSession> session);
+			void handleElementReceived(boost::shared_ptr<ToplevelElement> element, boost::shared_ptr<ServerFromClientSession> session);
+
+		private:
+			typedef boost::unordered_map<boost::shared_ptr<ServerFromClientSession>, boost::shared_ptr<RoutedSession> > SessionMap;
+
+			UserRegistry* userRegistry_;
+			ShardedStanzaRouter* router_;
+			TLSContextFactory* tlsContextFactory_;
+			SimpleEventLoop eventLoop_;
+			BoostIOServiceThread ioServiceThread_;
+			IDGenerator idGenerator_;
+			PlatformXMLParserFactory xmlParserFactory_;
+			FullPayloadParserFactoryCollection payloadParserFactories_;
+			FullPayloadSerializerCollection payloadSerializers_;
+			SessionMap sessions_;
+	};
+}
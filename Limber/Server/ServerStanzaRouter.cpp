@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,12 +14,6 @@
 namespace Swift {
 
 namespace {
-	struct PriorityLessThan {
-		bool operator()(const ServerSession* s1, const ServerSession* s2) const {
-			return s1->getPriority() < s2->getPriority();
-		}
-	};
-
 	struct HasJID {
 		HasJID(const JID& jid) : jid(jid) {}
 		bool operator()(const ServerSession* session) const {
@@ -36,39 +30,51 @@ bool ServerStanzaRouter::routeStanza(boost::shared_ptr<Stanza> stanza) {
 	JID to = stanza->getTo();
 	assert(to.isValid());
 
+	SessionMap::const_iterator resources = clientSessions_.find(to.toBare().toString());
+	if (resources == clientSessions_.end()) {
+		return false;
+	}
+	const std::vector<ServerSession*>& sessions = resources->second;
+
 	// For a full JID, first try to route to a session with the full JID
 	if (!to.isBare()) {
-		std::vector<ServerSession*>::const_iterator i = std::find_if(clientSessions_.begin(), clientSessions_.end(), HasJID(to));
-		if (i != clientSessions_.end()) {
+		std::vector<ServerSession*>::const_iterator i = std::find_if(sessions.begin(), sessions.end(), HasJID(to));
+		if (i != sessions.end()) {
 			(*i)->sendStanza(stanza);
 			return true;
 		}
 	}
 
-	// Look for candidate sessions
-	to = to.toBare();
-	std::vector<ServerSession*> candidateSessions;
-	for (std::vector<ServerSession*>::const_iterator i = clientSessions_.begin(); i != clientSessions_.end(); ++i) {
-		if ((*i)->getJID().equals(to, JID::WithoutResource) && (*i)->getPriority() >= 0) {
-			candidateSessions.push_back(*i);
+	// Find the session with the highest non-negative priority.
+	// Priorities change with presence, so they are not cached.
+	ServerSession* bestSession = NULL;
+	int bestPriority = -1;
+	for (std::vector<ServerSession*>::const_iterator i = sessions.begin(); i != sessions.end(); ++i) {
+		int priority = (*i)->getPriority();
+		if (priority > bestPriority) {
+			bestSession = *i;
+			bestPriority = priority;
 		}
 	}
-	if (candidateSessions.empty()) {
+	if (!bestSession) {
 		return false;
 	}
-
-	// Find the session with the highest priority
-	std::vector<ServerSession*>::const_iterator i = std::max_element(clientSessions_.begin(), clientSessions_.end(), PriorityLessThan());
-	(*i)->sendStanza(stanza);
+	bestSession->sendStanza(stanza);
 	return true;
 }
 
 void ServerStanzaRouter::addClientSession(ServerSession* clientSession) {
-	clientSessions_.push_back(clientSession);
+	clientSessions_[clientSession->getJID().toBare().toString()].push_back(clientSession);
 }
 
 void ServerStanzaRouter::removeClientSession(ServerSession* clientSession) {
-	erase(clientSessions_, clientSession);
+	SessionMap::iterator resources = clientSessions_.find(clientSession->getJID().toBare().toString());
+	if (resources != clientSessions_.end()) {
+		erase(resources->second, clientSession);
+		if (resources->second.empty()) {
+			clientSessions_.erase(resources);
+		}
+	}
 }
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,7 +7,9 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
-#include <map>
+#include <boost/unordered_map.hpp>
+#include <string>
+#include <vector>
 
 #include <Swiften/JID/JID.h>
 #include <Swiften/Elements/Stanza.h>
@@ -21,10 +23,18 @@ namespace Swift {
 
 			bool routeStanza(boost::shared_ptr<Stanza>);
 
+			/**
+			 * Adds a session to the routing table.
+			 *
+			 * The JID of the session should not change while it is in the
+			 * routing table. Its priority is looked up when routing.
+			 */
 			void addClientSession(ServerSession*);
 			void removeClientSession(ServerSession*);
 
 		private:
-			std::vector<ServerSession*> clientSessions_;
+			// Sessions are indexed by bare JID, in the order they were added
+			typedef boost::unordered_map<std::string, std::vector<ServerSession*> > SessionMap;
+			SessionMap clientSessions_;
 	};
 }
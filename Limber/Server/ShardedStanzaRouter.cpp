@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include "Limber/Server/ShardedStanzaRouter.h"
+
+#include <boost/thread/locks.hpp>
+
+namespace Swift {
+
+ShardedStanzaRouter::ShardedStanzaRouter() {
+}
+
+bool ShardedStanzaRouter::routeStanza(boost::shared_ptr<Stanza> stanza) {
+	boost::lock_guard<boost::mutex> lock(mutex_);
+	return router_.routeStanza(stanza);
+}
+
+void ShardedStanzaRouter::addClientSession(ServerSession* session) {
+	boost::lock_guard<boost::mutex> lock(mutex_);
+	router_.addClientSession(session);
+}
+
+void ShardedStanzaRouter::removeClientSession(ServerSession* session) {
+	boost::lock_guard<boost::mutex> lock(mutex_);
+	router_.removeClientSession(session);
+}
+
+}
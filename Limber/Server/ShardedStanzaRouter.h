@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <Swiften/Elements/Stanza.h>
+
+#include "Limber/Server/ServerStanzaRouter.h"
+
+namespace Swift {
+	class ServerSession;
+
+	/**
+	 * A ServerStanzaRouter that can be shared by sessions running in
+	 * different threads.
+	 *
+	 * The routing table is protected by a mutex, so sessions should not
+	 * do any work in ServerSession::sendStanza() apart from handing off
+	 * the stanza to the thread that owns them.
+	 */
+	class ShardedStanzaRouter : public boost::noncopyable {
+		public:
+			ShardedStanzaRouter();
+
+			bool routeStanza(boost::shared_ptr<Stanza>);
+
+			void addClientSession(ServerSession*);
+			void removeClientSession(ServerSession*);
+
+		private:
+			boost::mutex mutex_;
+			ServerStanzaRouter router_;
+	};
+}
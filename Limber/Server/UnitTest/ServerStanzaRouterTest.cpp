@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -22,6 +22,8 @@ class ServerStanzaRouterTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST(testRouteStanza_BareJIDWithMultipleSessions);
 		CPPUNIT_TEST(testRouteStanza_BareJIDWithOnlyNegativePriorities);
 		CPPUNIT_TEST(testRouteStanza_BareJIDWithChangingPresence);
+		CPPUNIT_TEST(testRouteStanza_BareJIDWithOtherUserSessions);
+		CPPUNIT_TEST(testRouteStanza_AfterRemoveClientSession);
 		CPPUNIT_TEST_SUITE_END();
 
 	public:
@@ -123,6 +125,38 @@ class ServerStanzaRouterTest : public CppUnit::TestFixture {
 			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session2.sentStanzas.size()));
 		}
 
+		void testRouteStanza_BareJIDWithOtherUserSessions() {
+			ServerStanzaRouter testling;
+			MockServerSession session1(JID("foo@bar.com/Baz"), 1);
+			testling.addClientSession(&session1);
+			MockServerSession session2(JID("other@bar.com/Baz"), 8);
+			testling.addClientSession(&session2);
+
+			bool result = testling.routeStanza(createMessageTo("foo@bar.com"));
+
+			CPPUNIT_ASSERT(result);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session1.sentStanzas.size()));
+			CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(session2.sentStanzas.size()));
+		}
+
+		void testRouteStanza_AfterRemoveClientSession() {
+			ServerStanzaRouter testling;
+			MockServerSession session1(JID("foo@bar.com/Baz"), 8);
+			testling.addClientSession(&session1);
+			MockServerSession session2(JID("foo@bar.com/Bar"), 5);
+			testling.addClientSession(&session2);
+
+			testling.removeClientSession(&session1);
+			bool result1 = testling.routeStanza(createMessageTo("foo@bar.com/Baz"));
+			testling.removeClientSession(&session2);
+			bool result2 = testling.routeStanza(createMessageTo("foo@bar.com"));
+
+			CPPUNIT_ASSERT(result1);
+			CPPUNIT_ASSERT(!result2);
+			CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(session1.sentStanzas.size()));
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session2.sentStanzas.size()));
+		}
+
 	private:
 		boost::shared_ptr<Message> createMessageTo(const std::string& recipient) {
 			boost::shared_ptr<Message> message(new Message());
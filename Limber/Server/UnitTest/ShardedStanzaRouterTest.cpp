@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+#include <boost/thread.hpp>
+
+#include "Swiften/Base/sleep.h"
+#include "Swiften/Elements/Message.h"
+#include "Swiften/Network/DummyConnection.h"
+#include "Limber/Server/ServerSession.h"
+#include "Limber/Server/ServerShard.h"
+#include "Limber/Server/ShardedStanzaRouter.h"
+#include "Limber/Server/SimpleUserRegistry.h"
+
+using namespace Swift;
+
+class ShardedStanzaRouterTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(ShardedStanzaRouterTest);
+		CPPUNIT_TEST(testRouteStanza_FromSeveralThreads);
+		CPPUNIT_TEST(testRouteStanza_ToSessionOnOtherShard);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void testRouteStanza_FromSeveralThreads() {
+			ShardedStanzaRouter testling;
+			CountingServerSession session1(JID("foo@bar.com/Bla"));
+			testling.addClientSession(&session1);
+			CountingServerSession session2(JID("foo@bar.com/Baz"));
+			testling.addClientSession(&session2);
+
+			// Sessions come and go while the others are being routed to
+			boost::thread_group senders;
+			for (int i = 0; i < 4; ++i) {
+				senders.create_thread(boost::bind(&ShardedStanzaRouterTest::routeStanzas, this, &testling, i % 2 ? "foo@bar.com/Bla" : "foo@bar.com/Baz"));
+			}
+			for (int i = 0; i < 1000; ++i) {
+				CountingServerSession session3(JID("foo@bar.com/Other"));
+				testling.addClientSession(&session3);
+				testling.removeClientSession(&session3);
+			}
+			senders.join_all();
+
+			CPPUNIT_ASSERT_EQUAL(2000, session1.sentStanzas.load());
+			CPPUNIT_ASSERT_EQUAL(2000, session2.sentStanzas.load());
+		}
+
+		void testRouteStanza_ToSessionOnOtherShard() {
+			SimpleUserRegistry userRegistry;
+			userRegistry.addUser(JID("alice@localhost"), "secret");
+			userRegistry.addUser(JID("bob@localhost"), "secret");
+			ShardedStanzaRouter router;
+			ServerShard* shard1 = new ServerShard(&userRegistry, &router);
+			ServerShard* shard2 = new ServerShard(&userRegistry, &router);
+			boost::thread thread1(boost::bind(&ServerShard::run, shard1));
+			boost::thread thread2(boost::bind(&ServerShard::run, shard2));
+
+			boost::shared_ptr<Client> alice = boost::make_shared<Client>(shard1);
+			boost::shared_ptr<Client> bob = boost::make_shared<Client>(shard2);
+			alice->startSession("AGFsaWNlAHNlY3JldA==");
+			bob->startSession("AGJvYgBzZWNyZXQ=");
+			bool sessionsStarted = alice->waitFor("id=\"session\"") && bob->waitFor("id=\"session\"");
+
+			alice->send("<message to='bob@localhost/phone' type='chat'><body>Hi Bob</body></message>");
+			bool delivered = bob->waitFor(">Hi Bob</body>");
+			std::string bobOutput = bob->getOutput();
+
+			shard1->stop();
+			shard2->stop();
+			thread1.join();
+			thread2.join();
+			alice.reset();
+			bob.reset();
+			delete shard1;
+			delete shard2;
+
+			CPPUNIT_ASSERT(sessionsStarted);
+			CPPUNIT_ASSERT(delivered);
+			CPPUNIT_ASSERT(bobOutput.find("from=\"alice@localhost/phone\"") != std::string::npos);
+		}
+
+	private:
+		void routeStanzas(ShardedStanzaRouter* router, const std::string& recipient) {
+			for (int i = 0; i < 1000; ++i) {
+				boost::shared_ptr<Message> message(new Message());
+				message->setTo(JID(recipient));
+				router->routeStanza(message);
+			}
+		}
+
+		class CountingServerSession : public ServerSession {
+			public:
+				CountingServerSession(const JID& jid) : jid(jid), sentStanzas(0) {}
+
+				virtual const JID& getJID() const { return jid; }
+				virtual int getPriority() const { return 0; }
+
+				virtual void sendStanza(boost::shared_ptr<Stanza>) {
+					++sentStanzas;
+				}
+
+				JID jid;
+				boost::atomic<int> sentStanzas;
+		};
+
+		/**
+		 * A client connected to a shard, which is fed raw XML from the
+		 * test thread.
+		 */
+		class Client {
+			public:
+				Client(ServerShard* shard) : connection(boost::make_shared<ClientConnection>(shard->getEventLoop())) {
+					connection->onDataSent.connect(boost::bind(&Client::handleDataSent, this, _1));
+					shard->getEventLoop()->postEvent(boost::bind(&ServerShard::addConnection, shard, connection, false));
+				}
+
+				~Client() {
+					connection->onDataSent.disconnect_all_slots();
+				}
+
+				void startSession(const std::string& plainMessage) {
+					send("<?xml version='1.0'?><stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams' to='localhost' version='1.0'>");
+					send("<auth xmlns='urn:ietf:params:xml:ns:xmpp-sasl' mechanism='PLAIN'>" + plainMessage + "</auth>");
+					send("<?xml version='1.0'?><stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams' to='localhost' version='1.0'>");
+					send("<iq type='set' id='bind'><bind xmlns='urn:ietf:params:xml:ns:xmpp-bind'><resource>phone</resource></bind></iq>");
+					send("<iq type='set' id='session'><session xmlns='urn:ietf:params:xml:ns:xmpp-session'/></iq>");
+				}
+
+				void send(const std::string& data) {
+					connection->receive(createSafeByteArray(data));
+				}
+
+				bool waitFor(const std::string& data) {
+					for (int i = 0; i < 1000; ++i) {
+						if (getOutput().find(data) != std::string::npos) {
+							return true;
+						}
+						Swift::sleep(10);
+					}
+					return false;
+				}
+
+				std::string getOutput() {
+					boost::lock_guard<boost::mutex> lock(outputMutex);
+					return output;
+				}
+
+			private:
+				class ClientConnection : public DummyConnection {
+					public:
+						ClientConnection(EventLoop* eventLoop) : DummyConnection(eventLoop) {}
+
+						void listen() {
+						}
+				};
+
+				// Called from the thread of the shard
+				void handleDataSent(const SafeByteArray& data) {
+					boost::lock_guard<boost::mutex> lock(outputMutex);
+					output += safeByteArrayToString(data);
+				}
+
+			private:
+				boost::shared_ptr<ClientConnection> connection;
+				boost::mutex outputMutex;
+				std::string output;
+		};
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ShardedStanzaRouterTest);
@@ -1,104 +1,210 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
+#include <cstring>
+#include <iostream>
 #include <string>
+#include <vector>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/placeholders.hpp>
 #include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
-#include "Swiften/Elements/IQ.h"
-#include "Swiften/Elements/RosterPayload.h"
-#include "Swiften/Elements/VCard.h"
-#include "Swiften/Base/IDGenerator.h"
+#include "Swiften/Base/foreach.h"
 #include "Swiften/EventLoop/EventLoop.h"
-#include "Swiften/EventLoop/SimpleEventLoop.h"
-#include "Swiften/EventLoop/EventOwner.h"
-#include "Swiften/Elements/Stanza.h"
-#include "Swiften/Network/ConnectionServer.h"
 #include "Swiften/Network/BoostConnection.h"
 #include "Swiften/Network/BoostIOServiceThread.h"
-#include "Swiften/Network/BoostConnectionServer.h"
+#include "Swiften/TLS/PKCS12Certificate.h"
+#include "Swiften/TLS/PlatformTLSFactories.h"
+#include "Swiften/TLS/TLSContextFactory.h"
 #include "Limber/Server/SimpleUserRegistry.h"
-#include "Limber/Server/ServerFromClientSession.h"
-#include "Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h"
-#include "Swiften/Parser/PlatformXMLParserFactory.h"
-#include "Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h"
+#include "Limber/Server/ServerShard.h"
+#include "Limber/Server/ShardedStanzaRouter.h"
 
 using namespace Swift;
 
+/**
+ * Accepts client connections, and hands them out to the shards in turn.
+ *
+ * The first shard runs in the thread calling run(); all other shards
+ * get a thread of their own. If a TLS context factory is given, clients
+ * are offered STARTTLS on port 5222, and direct TLS on port 5223.
+ */
 class Server {
 	public:
-		Server(UserRegistry* userRegistry, EventLoop* eventLoop) : userRegistry_(userRegistry) {
-			serverFromClientConnectionServer_ = BoostConnectionServer::create(5222, boostIOServiceThread_.getIOService(), eventLoop);
-			serverFromClientConnectionServer_->onNewConnection.connect(boost::bind(&Server::handleNewConnection, this, _1));
-			serverFromClientConnectionServer_->start();
+		Server(UserRegistry* userRegistry, size_t threads, TLSContextFactory* tlsContextFactory) : acceptorThread_(new BoostIOServiceThread()), stopping_(false), acceptorsClosed_(false), nextShard_(0) {
+			acceptor_.reset(new boost::asio::ip::tcp::acceptor(*acceptorThread_->getIOService(), boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), 5222)));
+			if (tlsContextFactory) {
+				directTLSAcceptor_.reset(new boost::asio::ip::tcp::acceptor(*acceptorThread_->getIOService(), boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), 5223)));
+			}
+			for (size_t i = 0; i < threads; ++i) {
+				shards_.push_back(new ServerShard(userRegistry, &router_, tlsContextFactory));
+			}
+			for (size_t i = 1; i < shards_.size(); ++i) {
+				shardThreads_.push_back(new boost::thread(boost::bind(&ServerShard::run, shards_[i])));
+			}
+			acceptorThread_->getIOService()->post(boost::bind(&Server::startAccepting, this));
+		}
+
+		~Server() {
+			// The acceptors are only used from the acceptor thread, so they
+			// are closed there. The acceptor thread is stopped before the
+			// shards, because its pending accepts hold connections of the
+			// shards.
+			acceptorThread_->getIOService()->post(boost::bind(&Server::closeAcceptors, this));
+			{
+				boost::unique_lock<boost::mutex> lock(acceptorsClosedMutex_);
+				while (!acceptorsClosed_) {
+					acceptorsClosedCondition_.wait(lock);
+				}
+			}
+			acceptorThread_.reset();
+
+			foreach (ServerShard* shard, shards_) {
+				shard->stop();
+			}
+			foreach (boost::thread* thread, shardThreads_) {
+				thread->join();
+				delete thread;
+			}
+			foreach (ServerShard* shard, shards_) {
+				delete shard;
+			}
+		}
+
+		void run() {
+			shards_[0]->run();
 		}
 
 	private:
-		void handleNewConnection(boost::shared_ptr<Connection> c) {
-			boost::shared_ptr<ServerFromClientSession> session(new ServerFromClientSession(idGenerator_.generateID(), c, &payloadParserFactories_, &payloadSerializers_, &xmlParserFactory, userRegistry_));
-			serverFromClientSessions_.push_back(session);
-			session->onElementReceived.connect(boost::bind(&Server::handleElementReceived, this, _1, session));
-			session->onSessionFinished.connect(boost::bind(&Server::handleSessionFinished, this, session));
-			session->startSession();
+		// Called from the acceptor thread
+		void startAccepting() {
+			acceptNextConnection(acceptor_.get(), false);
+			if (directTLSAcceptor_) {
+				acceptNextConnection(directTLSAcceptor_.get(), true);
+			}
 		}
 
-		void handleSessionFinished(boost::shared_ptr<ServerFromClientSession> session) {
-			serverFromClientSessions_.erase(std::remove(serverFromClientSessions_.begin(), serverFromClientSessions_.end(), session), serverFromClientSessions_.end());
+		void acceptNextConnection(boost::asio::ip::tcp::acceptor* acceptor, bool directTLS) {
+			ServerShard* shard = shards_[nextShard_];
+			nextShard_ = (nextShard_ + 1) % shards_.size();
+			BoostConnection::ref connection = BoostConnection::create(shard->getIOService(), shard->getEventLoop());
+			acceptor->async_accept(connection->getSocket(), boost::bind(&Server::handleAccept, this, acceptor, directTLS, connection, shard, boost::asio::placeholders::error));
 		}
 
-		void handleElementReceived(boost::shared_ptr<ToplevelElement> element, boost::shared_ptr<ServerFromClientSession> session) {
-			boost::shared_ptr<Stanza> stanza(boost::dynamic_pointer_cast<Stanza>(element));
-			if (!stanza) {
+		void handleAccept(boost::asio::ip::tcp::acceptor* acceptor, bool directTLS, BoostConnection::ref connection, ServerShard* shard, const boost::system::error_code& error) {
+			if (stopping_ || error == boost::asio::error::operation_aborted) {
 				return;
 			}
-			stanza->setFrom(session->getRemoteJID());
-			if (!stanza->getTo().isValid()) {
-				stanza->setTo(JID(session->getLocalJID()));
-			}
-			if (!stanza->getTo().isValid() || stanza->getTo() == session->getLocalJID() || stanza->getTo() == session->getRemoteJID().toBare()) {
-				if (boost::shared_ptr<IQ> iq = boost::dynamic_pointer_cast<IQ>(stanza)) {
-					if (iq->getPayload<RosterPayload>()) {
-						session->sendElement(IQ::createResult(iq->getFrom(), iq->getID(), boost::make_shared<RosterPayload>()));
-					}
-					if (iq->getPayload<VCard>()) {
-						if (iq->getType() == IQ::Get) {
-							boost::shared_ptr<VCard> vcard(new VCard());
-							vcard->setNickname(iq->getFrom().getNode());
-							session->sendElement(IQ::createResult(iq->getFrom(), iq->getID(), vcard));
-						}
-						else {
-							session->sendElement(IQ::createError(iq->getFrom(), iq->getID(), ErrorPayload::Forbidden, ErrorPayload::Cancel));
-						}
-					}
-					else {
-						session->sendElement(IQ::createError(iq->getFrom(), iq->getID(), ErrorPayload::FeatureNotImplemented, ErrorPayload::Cancel));
-					}
-				}
+			if (!error) {
+				shard->getEventLoop()->postEvent(boost::bind(&ServerShard::addConnection, shard, connection, directTLS));
 			}
+			acceptNextConnection(acceptor, directTLS);
+		}
+
+		// Called from the acceptor thread
+		void closeAcceptors() {
+			stopping_ = true;
+			acceptor_.reset();
+			directTLSAcceptor_.reset();
+			boost::lock_guard<boost::mutex> lock(acceptorsClosedMutex_);
+			acceptorsClosed_ = true;
+			acceptorsClosedCondition_.notify_one();
 		}
 
 	private:
-		IDGenerator idGenerator_;
-		PlatformXMLParserFactory xmlParserFactory;
-		UserRegistry* userRegistry_;
-		BoostIOServiceThread boostIOServiceThread_;
-		boost::shared_ptr<BoostConnectionServer> serverFromClientConnectionServer_;
-		std::vector< boost::shared_ptr<ServerFromClientSession> > serverFromClientSessions_;
-		FullPayloadParserFactoryCollection payloadParserFactories_;
-		FullPayloadSerializerCollection payloadSerializers_;
+		ShardedStanzaRouter router_;
+		std::vector<ServerShard*> shards_;
+		std::vector<boost::thread*> shardThreads_;
+		boost::scoped_ptr<BoostIOServiceThread> acceptorThread_;
+		boost::scoped_ptr<boost::asio::ip::tcp::acceptor> acceptor_;
+		boost::scoped_ptr<boost::asio::ip::tcp::acceptor> directTLSAcceptor_;
+		bool stopping_;
+		boost::mutex acceptorsClosedMutex_;
+		boost::condition_variable acceptorsClosedCondition_;
+		bool acceptorsClosed_;
+		size_t nextShard_;
 };
 
-int main() {
-	SimpleEventLoop eventLoop;
+static void printUsage(const char* program) {
+	std::cerr << "Usage: " << program << " [--threads N] [--certificate FILE.p12 [--password PASSWORD]]" << std::endl;
+}
+
+static bool getOptionValue(int argc, char* argv[], int& i, const char* option, std::string& value) {
+	size_t length = std::strlen(option);
+	if (std::strcmp(argv[i], option) == 0 && i + 1 < argc) {
+		value = argv[++i];
+		return true;
+	}
+	if (std::strncmp(argv[i], option, length) == 0 && argv[i][length] == '=') {
+		value = argv[i] + length + 1;
+		return true;
+	}
+	return false;
+}
+
+int main(int argc, char* argv[]) {
+	size_t threads = 1;
+	std::string certificateFile;
+	std::string certificatePassword;
+	for (int i = 1; i < argc; ++i) {
+		std::string value;
+		if (getOptionValue(argc, argv, i, "--threads", value)) {
+			try {
+				threads = boost::lexical_cast<size_t>(value);
+			}
+			catch (const boost::bad_lexical_cast&) {
+				threads = 0;
+			}
+			if (threads == 0) {
+				printUsage(argv[0]);
+				return 1;
+			}
+		}
+		else if (getOptionValue(argc, argv, i, "--certificate", value)) {
+			certificateFile = value;
+		}
+		else if (getOptionValue(argc, argv, i, "--password", value)) {
+			certificatePassword = value;
+		}
+		else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	PlatformTLSFactories tlsFactories;
+	TLSContextFactory* tlsContextFactory = NULL;
+	if (!certificateFile.empty()) {
+		tlsContextFactory = tlsFactories.getTLSContextFactory();
+		if (!tlsContextFactory->setServerCertificate(boost::make_shared<PKCS12Certificate>(certificateFile, createSafeByteArray(certificatePassword)))) {
+			std::cerr << "Unable to use certificate " << certificateFile << std::endl;
+			return 1;
+		}
+	}
+
 	SimpleUserRegistry userRegistry;
 	userRegistry.addUser(JID("remko@localhost"), "remko");
 	userRegistry.addUser(JID("kevin@localhost"), "kevin");
 	userRegistry.addUser(JID("remko@limber.swift.im"), "remko");
 	userRegistry.addUser(JID("kevin@limber.swift.im"), "kevin");
-	Server server(&userRegistry, &eventLoop);
-	eventLoop.run();
+	try {
+		Server server(&userRegistry, threads, tlsContextFactory);
+		server.run();
+	}
+	catch (const boost::system::system_error& e) {
+		std::cerr << "Unable to start server: " << e.what() << std::endl;
+		return 1;
+	}
 	return 0;
 }
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2014 Isode Limited.
+ * Copyright (c) 2014-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -56,6 +56,10 @@ ContactsMap HistoryController::getContacts(const JID& selfJID, HistoryMessage::T
 	return localHistory_->getContacts(selfJID, type, keyword);
 }
 
+std::vector<HistoryMessage> HistoryController::searchMessages(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword, size_t firstResult, size_t maxResults) const {
+	return localHistory_->searchMessages(selfJID, type, keyword, firstResult, maxResults);
+}
+
 boost::posix_time::ptime HistoryController::getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) {
 	return localHistory_->getLastTimeStampFromMUC(selfJID, mucJID);
 }
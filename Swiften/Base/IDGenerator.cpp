@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2011 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,13 +10,21 @@
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace Swift {
 
+namespace {
+	// The generator is shared by all instances, so it is only seeded once
+	boost::mutex generatorMutex;
+}
+
 IDGenerator::IDGenerator() {
 }
 
 std::string IDGenerator::generateID() {
+	boost::lock_guard<boost::mutex> lock(generatorMutex);
 	static boost::uuids::random_generator generator;
 	return boost::lexical_cast<std::string>(generator());
 }
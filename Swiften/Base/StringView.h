@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <boost/functional/hash.hpp>
+
+namespace Swift {
+	/**
+	 * A non-owning reference to a sequence of characters.
+	 *
+	 * The referenced data is not copied, so a view is only valid as long as
+	 * the data it was created from.
+	 */
+	class StringView {
+		public:
+			StringView() : data_(NULL), size_(0) {
+			}
+
+			StringView(const char* data, size_t size) : data_(data), size_(size) {
+			}
+
+			StringView(const char* data) : data_(data), size_(std::strlen(data)) {
+			}
+
+			StringView(const std::string& s) : data_(s.data()), size_(s.size()) {
+			}
+
+			const char* data() const {
+				return data_;
+			}
+
+			size_t size() const {
+				return size_;
+			}
+
+			bool empty() const {
+				return size_ == 0;
+			}
+
+			const char* begin() const {
+				return data_;
+			}
+
+			const char* end() const {
+				return data_ + size_;
+			}
+
+			std::string toString() const {
+				return std::string(data_, size_);
+			}
+
+			bool operator==(const StringView& other) const {
+				return size_ == other.size_ && (size_ == 0 || std::memcmp(data_, other.data_, size_) == 0);
+			}
+
+			bool operator!=(const StringView& other) const {
+				return !(*this == other);
+			}
+
+		private:
+			const char* data_;
+			size_t size_;
+	};
+
+	inline std::size_t hash_value(const StringView& s) {
+		return boost::hash_range(s.begin(), s.end());
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <typeinfo>
+#include <boost/functional/hash.hpp>
+
+namespace Swift {
+	/**
+	 * A copyable, hashable handle to a std::type_info, usable as a key in
+	 * (unordered) associative containers.
+	 *
+	 * Equality uses type_info comparison, and the hash is computed from the
+	 * type name, so the same type compares equal even when its type_info
+	 * object is duplicated across shared libraries.
+	 */
+	class TypeIndex {
+		public:
+			TypeIndex(const std::type_info& info) : info_(&info) {
+			}
+
+			const std::type_info& getTypeInfo() const {
+				return *info_;
+			}
+
+			bool operator==(const TypeIndex& other) const {
+				return *info_ == *other.info_;
+			}
+
+			bool operator!=(const TypeIndex& other) const {
+				return !(*this == other);
+			}
+
+			bool operator<(const TypeIndex& other) const {
+				return info_->before(*other.info_);
+			}
+
+		private:
+			const std::type_info* info_;
+	};
+
+	inline std::size_t hash_value(const TypeIndex& index) {
+		const char* name = index.getTypeInfo().name();
+		return boost::hash_range(name, name + std::strlen(name));
+	}
+}
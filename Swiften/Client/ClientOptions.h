@@ -63,7 +63,11 @@ namespace Swift {
 		bool allowPLAINWithoutTLS;
 
 		/**
-		 * Use XEP-196 stream resumption when available.
+		 * Use XEP-0198 stream resumption when available. If the
+		 * connection breaks, the client reconnects and resumes the
+		 * stream without emitting onDisconnected, and stanzas that
+		 * the server did not ack are sent again.
+		 * Not used with BOSH, or when forgetPassword is set.
 		 *
 		 * Default: false
 		 */
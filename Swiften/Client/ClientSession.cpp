@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,6 +14,7 @@
 
 #include <Swiften/Base/Platform.h>
 #include <Swiften/Base/Log.h>
+#include <Swiften/Base/foreach.h>
 #include <Swiften/Elements/ProtocolHeader.h>
 #include <Swiften/Elements/StreamFeatures.h>
 #include <Swiften/Elements/StreamError.h>
@@ -31,6 +32,8 @@
 #include <Swiften/Elements/EnableStreamManagement.h>
 #include <Swiften/Elements/StreamManagementEnabled.h>
 #include <Swiften/Elements/StreamManagementFailed.h>
+#include <Swiften/Elements/StreamResume.h>
+#include <Swiften/Elements/StreamResumed.h>
 #include <Swiften/Elements/StartSession.h>
 #include <Swiften/Elements/StanzaAck.h>
 #include <Swiften/Elements/StanzaAckRequest.h>
@@ -68,6 +71,8 @@ ClientSession::ClientSession(
 			useStreamCompression(true),
 			useTLS(UseTLSWhenAvailable),
 			useAcks(true),
+			useStreamResumption(false),
+			resumed(false),
 			needSessionStart(false),
 			needResourceBind(false),
 			needAcking(false),
@@ -101,11 +106,27 @@ void ClientSession::sendStreamHeader() {
 	stream->writeHeader(header);
 }
 
+void ClientSession::resume(boost::shared_ptr<ClientSession> session) {
+	assert(state == Initial);
+	assert(session->isResumable());
+	previousSession = session;
+	localJID = session->localJID;
+}
+
 void ClientSession::sendStanza(boost::shared_ptr<Stanza> stanza) {
-	stream->writeElement(stanza);
-	if (stanzaAckRequester_) {
+	if (previousSession) {
+		// Queue the stanza with the ones that will be resent after resuming
+		previousSession->sendStanza(stanza);
+	}
+	else if (state == ResumingSession || isResumable()) {
 		stanzaAckRequester_->handleStanzaSent(stanza);
 	}
+	else {
+		stream->writeElement(stanza);
+		if (stanzaAckRequester_) {
+			stanzaAckRequester_->handleStanzaSent(stanza);
+		}
+	}
 }
 
 void ClientSession::handleStreamStart(const ProtocolHeader&) {
@@ -253,6 +274,19 @@ void ClientSession::handleElement(boost::shared_ptr<ToplevelElement> element) {
 				finishSession(Error::NoSupportedAuthMechanismsError);
 			}
 		}
+		else if (previousSession) {
+			if (streamFeatures->hasStreamManagement()) {
+				state = ResumingSession;
+				stream->setWhitespacePingEnabled(true);
+				boost::shared_ptr<StreamResume> resume = boost::make_shared<StreamResume>();
+				resume->setResumeID(previousSession->resumeID);
+				resume->setHandledStanzasCount(previousSession->stanzaAckResponder_->getHandledStanzasCount());
+				stream->writeElement(resume);
+			}
+			else {
+				finishSession(boost::shared_ptr<Swift::Error>());
+			}
+		}
 		else {
 			// Start the session
 			rosterVersioningSupported = streamFeatures->hasRosterVersioning();
@@ -279,7 +313,10 @@ void ClientSession::handleElement(boost::shared_ptr<ToplevelElement> element) {
 	else if (boost::dynamic_pointer_cast<CompressFailure>(element)) {
 		finishSession(Error::CompressionFailedError);
 	}
-	else if (boost::dynamic_pointer_cast<StreamManagementEnabled>(element)) {
+	else if (boost::shared_ptr<StreamManagementEnabled> enabled = boost::dynamic_pointer_cast<StreamManagementEnabled>(element)) {
+		if (useStreamResumption && enabled->getResumeSupported()) {
+			resumeID = enabled->getResumeID();
+		}
 		stanzaAckRequester_ = boost::make_shared<StanzaAckRequester>();
 		stanzaAckRequester_->onRequestAck.connect(boost::bind(&ClientSession::requestAck, shared_from_this()));
 		stanzaAckRequester_->onStanzaAcked.connect(boost::bind(&ClientSession::handleStanzaAcked, shared_from_this(), _1));
@@ -289,8 +326,18 @@ void ClientSession::handleElement(boost::shared_ptr<ToplevelElement> element) {
 		continueSessionInitialization();
 	}
 	else if (boost::dynamic_pointer_cast<StreamManagementFailed>(element)) {
-		needAcking = false;
-		continueSessionInitialization();
+		if (state == ResumingSession) {
+			// The server no longer has the stream
+			finishSession(boost::shared_ptr<Swift::Error>());
+		}
+		else {
+			needAcking = false;
+			continueSessionInitialization();
+		}
+	}
+	else if (boost::shared_ptr<StreamResumed> streamResumed = boost::dynamic_pointer_cast<StreamResumed>(element)) {
+		CHECK_STATE_OR_RETURN(ResumingSession);
+		handleStreamResumed(streamResumed);
 	}
 	else if (AuthChallenge* challenge = dynamic_cast<AuthChallenge*>(element.get())) {
 		CHECK_STATE_OR_RETURN(Authenticating);
@@ -345,7 +392,9 @@ void ClientSession::continueSessionInitialization() {
 	}
 	else if (needAcking) {
 		state = EnablingSessionManagement;
-		stream->writeElement(boost::make_shared<EnableStreamManagement>());
+		boost::shared_ptr<EnableStreamManagement> enable = boost::make_shared<EnableStreamManagement>();
+		enable->setResume(useStreamResumption);
+		stream->writeElement(enable);
 	}
 	else if (needSessionStart) {
 		state = StartingSession;
@@ -411,14 +460,25 @@ void ClientSession::handleStreamClosed(boost::shared_ptr<Swift::Error> streamErr
 	State previousState = state;
 	state = Finished;
 
+	// Only a stream that broke after it was set up can be resumed. The
+	// ack state is kept for the session that resumes it.
+	if (previousState != Initialized || !streamError) {
+		resumeID.clear();
+	}
+	previousSession.reset();
+
 	if (stanzaAckRequester_) {
 		stanzaAckRequester_->onRequestAck.disconnect(boost::bind(&ClientSession::requestAck, shared_from_this()));
 		stanzaAckRequester_->onStanzaAcked.disconnect(boost::bind(&ClientSession::handleStanzaAcked, shared_from_this(), _1));
-		stanzaAckRequester_.reset();
+		if (!isResumable()) {
+			stanzaAckRequester_.reset();
+		}
 	}
 	if (stanzaAckResponder_) {
 		stanzaAckResponder_->onAck.disconnect(boost::bind(&ClientSession::ack, shared_from_this(), _1));
-		stanzaAckResponder_.reset();
+		if (!isResumable()) {
+			stanzaAckResponder_.reset();
+		}
 	}
 	stream->setWhitespacePingEnabled(false);
 	stream->onStreamStartReceived.disconnect(boost::bind(&ClientSession::handleStreamStart, shared_from_this(), _1));
@@ -462,6 +522,32 @@ void ClientSession::finishSession(boost::shared_ptr<Swift::Error> error) {
 	stream->close();
 }
 
+void ClientSession::handleStreamResumed(boost::shared_ptr<StreamResumed> streamResumed) {
+	stanzaAckRequester_ = previousSession->stanzaAckRequester_;
+	stanzaAckRequester_->onRequestAck.connect(boost::bind(&ClientSession::requestAck, shared_from_this()));
+	stanzaAckRequester_->onStanzaAcked.connect(boost::bind(&ClientSession::handleStanzaAcked, shared_from_this(), _1));
+	stanzaAckResponder_ = previousSession->stanzaAckResponder_;
+	stanzaAckResponder_->onAck.connect(boost::bind(&ClientSession::ack, shared_from_this(), _1));
+	rosterVersioningSupported = previousSession->rosterVersioningSupported;
+	resumeID = previousSession->resumeID;
+	previousSession.reset();
+	resumed = true;
+
+	if (streamResumed->getHandledStanzasCount()) {
+		stanzaAckRequester_->handleAckReceived(*streamResumed->getHandledStanzasCount());
+	}
+
+	// Resend what the server didn't get before the connection broke
+	state = Initialized;
+	foreach (boost::shared_ptr<Stanza> stanza, stanzaAckRequester_->getUnackedStanzas()) {
+		stream->writeElement(stanza);
+	}
+	if (!stanzaAckRequester_->getUnackedStanzas().empty()) {
+		requestAck();
+	}
+	onInitialized();
+}
+
 void ClientSession::requestAck() {
 	stream->writeElement(boost::make_shared<StanzaAckRequest>());
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -24,6 +24,7 @@ namespace Swift {
 	class CertificateTrustChecker;
 	class IDNConverter;
 	class CryptoProvider;
+	class StreamResumed;
 
 	class SWIFTEN_API ClientSession : public boost::enable_shared_from_this<ClientSession> {
 		public:
@@ -37,6 +38,7 @@ namespace Swift {
 				WaitingForCredentials,
 				Authenticating,
 				EnablingSessionManagement,
+				ResumingSession,
 				BindingResource,
 				StartingSession,
 				Initialized,
@@ -92,6 +94,51 @@ namespace Swift {
 				useAcks = b;
 			}
 
+			/**
+			 * Sets whether the server should be asked to allow resuming the
+			 * stream (XEP-0198) if the connection breaks.
+			 */
+			void setUseStreamResumption(bool b) {
+				useStreamResumption = b;
+			}
+
+			/**
+			 * Resumes the stream of the given session after authenticating,
+			 * instead of binding a new resource. Stanzas that were not acked
+			 * by the server are sent again once the stream is resumed, and
+			 * stanzas sent while resuming are queued until then.
+			 *
+			 * The session is finished without an error if the server
+			 * does not allow resuming.
+			 *
+			 * Must be called before start().
+			 */
+			void resume(boost::shared_ptr<ClientSession> session);
+
+			/**
+			 * Returns whether the session is finished, but its stream can be
+			 * resumed by another session.
+			 */
+			bool isResumable() const {
+				return state == Finished && !resumeID.empty();
+			}
+
+			/**
+			 * Returns whether the session resumed the stream of a previous
+			 * session.
+			 */
+			bool isResumed() const {
+				return resumed;
+			}
+
+			/**
+			 * Returns whether stanzas can be sent. This is also the case while
+			 * the stream is being resumed, or can still be resumed.
+			 */
+			bool canSendStanzas() const {
+				return state == Initialized || state == ResumingSession || previousSession || isResumable();
+			}
+
 
 			bool getStreamManagementEnabled() const {
 				// Explicitly convert to bool. In C++11, it would be cleaner to
@@ -160,6 +207,7 @@ namespace Swift {
 			void requestAck();
 			void handleStanzaAcked(boost::shared_ptr<Stanza> stanza);
 			void ack(unsigned int handledStanzasCount);
+			void handleStreamResumed(boost::shared_ptr<StreamResumed>);
 			void continueAfterTLSEncrypted();
 			void checkTrustOrFinish(const std::vector<Certificate::ref>& certificateChain, boost::shared_ptr<CertificateVerificationError> error);
 
@@ -173,6 +221,8 @@ namespace Swift {
 			bool useStreamCompression;
 			UseTLS useTLS;
 			bool useAcks;
+			bool useStreamResumption;
+			bool resumed;
 			bool needSessionStart;
 			bool needResourceBind;
 			bool needAcking;
@@ -180,6 +230,8 @@ namespace Swift {
 			ClientAuthenticator* authenticator;
 			boost::shared_ptr<StanzaAckRequester> stanzaAckRequester_;
 			boost::shared_ptr<StanzaAckResponder> stanzaAckResponder_;
+			std::string resumeID;
+			boost::shared_ptr<ClientSession> previousSession;
 			boost::shared_ptr<Swift::Error> error_;
 			CertificateTrustChecker* certificateTrustChecker;
 	};
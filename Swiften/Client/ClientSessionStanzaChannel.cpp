@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,7 +12,7 @@
 namespace Swift {
 
 void ClientSessionStanzaChannel::setSession(boost::shared_ptr<ClientSession> session) {
-	assert(!this->session);
+	assert(!this->session || this->session->isResumable());
 	this->session = session;
 	session->onInitialized.connect(boost::bind(&ClientSessionStanzaChannel::handleSessionInitialized, this));
 	session->onFinished.connect(boost::bind(&ClientSessionStanzaChannel::handleSessionFinished, this, _1));
@@ -49,9 +49,18 @@ void ClientSessionStanzaChannel::handleSessionFinished(boost::shared_ptr<Error>)
 	session->onStanzaReceived.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanza, this, _1));
 	session->onStanzaAcked.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaAcked, this, _1));
 	session->onInitialized.disconnect(boost::bind(&ClientSessionStanzaChannel::handleSessionInitialized, this));
-	session.reset();
 
-	onAvailableChanged(false);
+	// Stay available while the stream can still be resumed
+	if (!session->isResumable()) {
+		resetSession();
+	}
+}
+
+void ClientSessionStanzaChannel::resetSession() {
+	if (session) {
+		session.reset();
+		onAvailableChanged(false);
+	}
 }
 
 void ClientSessionStanzaChannel::handleStanza(boost::shared_ptr<Stanza> stanza) {
@@ -95,7 +104,9 @@ void ClientSessionStanzaChannel::handleStanzaAcked(boost::shared_ptr<Stanza> sta
 
 
 void ClientSessionStanzaChannel::handleSessionInitialized() {
-	onAvailableChanged(true);
+	if (!session->isResumed()) {
+		onAvailableChanged(true);
+	}
 }
 
 }
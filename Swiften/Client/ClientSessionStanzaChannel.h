@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,8 +21,17 @@ namespace Swift {
 	 */
 	class ClientSessionStanzaChannel : public StanzaChannel {
 		public:
+			/**
+			 * Sets the session to send stanzas over. This can replace a
+			 * session that is resumable.
+			 */
 			void setSession(boost::shared_ptr<ClientSession> session);
 
+			/**
+			 * Drops a resumable session that will not be resumed.
+			 */
+			void resetSession();
+
 			void sendIQ(boost::shared_ptr<IQ> iq);
 			void sendMessage(boost::shared_ptr<Message> message);
 			void sendPresence(boost::shared_ptr<Presence> presence);
@@ -30,7 +39,7 @@ namespace Swift {
 			virtual std::vector<Certificate::ref> getPeerCertificateChain() const;
 
 			bool isAvailable() const {
-				return session && session->getState() == ClientSession::Initialized;
+				return session && session->canSendStanzas();
 			}
 
 		private:
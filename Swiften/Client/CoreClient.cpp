@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -57,10 +57,15 @@ void CoreClient::connect(const ClientOptions& o) {
 	SWIFT_LOG(debug) << "Connecting ";
 
 	forceReset();
+	resetSuspendedSession();
 	disconnectRequested_ = false;
 
 	options = o;
+	connectToServer();
+}
 
+void CoreClient::connectToServer() {
+	const ClientOptions& o = options;
 
 	// Determine connection types to use
 	assert(proxyConnectionFactories.empty());
@@ -143,7 +148,6 @@ void CoreClient::connect(const ClientOptions& o) {
 		sessionStream_->onDataWritten.connect(boost::bind(&CoreClient::handleDataWritten, this, _1));
 		bindSessionToStream();
 	}
-
 }
 
 void CoreClient::bindSessionToStream() {
@@ -163,6 +167,11 @@ void CoreClient::bindSessionToStream() {
 			break;
 	}
 	session_->setUseAcks(options.useAcks);
+	session_->setUseStreamResumption(options.useStreamResumption && !options.forgetPassword && options.boshURL.isEmpty());
+	if (suspendedSession_) {
+		session_->resume(suspendedSession_);
+		suspendedSession_.reset();
+	}
 	stanzaChannel_->setSession(session_);
 	session_->onFinished.connect(boost::bind(&CoreClient::handleSessionFinished, this, _1));
 	session_->onNeedCredentials.connect(boost::bind(&CoreClient::handleNeedCredentials, this));
@@ -175,6 +184,7 @@ void CoreClient::bindSessionToStream() {
 void CoreClient::handleConnectorFinished(boost::shared_ptr<Connection> connection, boost::shared_ptr<Error> error) {
 	resetConnector();
 	if (!connection) {
+		resetSuspendedSession();
 		if (options.forgetPassword) {
 			purgePassword();
 		}
@@ -193,6 +203,7 @@ void CoreClient::handleConnectorFinished(boost::shared_ptr<Connection> connectio
 		if (certificate_ && !certificate_->isNull()) {
 			sessionStream_->setTLSCertificate(certificate_);
 		}
+		sessionStream_->setTLSServerName(jid_.getDomain());
 		sessionStream_->onDataRead.connect(boost::bind(&CoreClient::handleDataRead, this, _1));
 		sessionStream_->onDataWritten.connect(boost::bind(&CoreClient::handleDataWritten, this, _1));
 
@@ -220,8 +231,23 @@ void CoreClient::handleSessionFinished(boost::shared_ptr<Error> error) {
 	if (options.forgetPassword) {
 		purgePassword();
 	}
+	if (!error && interruptionError_ && !session_->isResumed() && !disconnectRequested_) {
+		// Resuming failed, so report why the stream was interrupted
+		error = interruptionError_;
+	}
+	interruptionError_.reset();
 	resetSession();
 
+	if (session_->isResumable() && !disconnectRequested_) {
+		// Reconnect, and resume the stream without telling the user
+		SWIFT_LOG(debug) << "Session interrupted, resuming" << std::endl;
+		suspendedSession_ = session_;
+		interruptionError_ = error;
+		connectToServer();
+		return;
+	}
+	stanzaChannel_->resetSession();
+
 	boost::optional<ClientError> actualError;
 	if (error) {
 		ClientError clientError;
@@ -448,6 +474,14 @@ void CoreClient::resetSession() {
 	connection_.reset();
 }
 
+void CoreClient::resetSuspendedSession() {
+	interruptionError_.reset();
+	if (suspendedSession_) {
+		suspendedSession_.reset();
+		stanzaChannel_->resetSession();
+	}
+}
+
 void CoreClient::forceReset() {
 	if (connector_) {
 		SWIFT_LOG(warning) << "Client not disconnected properly: Connector still active" << std::endl;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2012 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -206,6 +206,7 @@ namespace Swift {
 			virtual void handleConnected() {}
 
 		private:
+			void connectToServer();
 			void handleConnectorFinished(boost::shared_ptr<Connection>, boost::shared_ptr<Error> error);
 			void handleStanzaChannelAvailableChanged(bool available);
 			void handleSessionFinished(boost::shared_ptr<Error>);
@@ -220,6 +221,7 @@ namespace Swift {
 
 			void resetConnector();
 			void resetSession();
+			void resetSuspendedSession();
 			void forceReset();
 
 		private:
@@ -234,6 +236,8 @@ namespace Swift {
 			boost::shared_ptr<Connection> connection_;
 			boost::shared_ptr<SessionStream> sessionStream_;
 			boost::shared_ptr<ClientSession> session_;
+			boost::shared_ptr<ClientSession> suspendedSession_;
+			boost::shared_ptr<Error> interruptionError_;
 			CertificateWithKey::ref certificate_;
 			bool disconnectRequested_;
 			CertificateTrustChecker* certificateTrustChecker;
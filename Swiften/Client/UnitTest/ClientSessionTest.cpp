@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -28,7 +28,10 @@
 #include <Swiften/Elements/StreamManagementEnabled.h>
 #include <Swiften/Elements/StreamManagementFailed.h>
 #include <Swiften/Elements/StanzaAck.h>
+#include <Swiften/Elements/StanzaAckRequest.h>
 #include <Swiften/Elements/EnableStreamManagement.h>
+#include <Swiften/Elements/StreamResume.h>
+#include <Swiften/Elements/StreamResumed.h>
 #include <Swiften/Elements/IQ.h>
 #include <Swiften/Elements/ResourceBind.h>
 #include <Swiften/TLS/SimpleCertificate.h>
@@ -57,6 +60,10 @@ class ClientSessionTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST(testStreamManagement_Failed);
 		CPPUNIT_TEST(testUnexpectedChallenge);
 		CPPUNIT_TEST(testFinishAcksStanzas);
+		CPPUNIT_TEST(testStreamResumption_Enable);
+		CPPUNIT_TEST(testStreamResumption_NotResumableAfterFinish);
+		CPPUNIT_TEST(testStreamResumption_Resume);
+		CPPUNIT_TEST(testStreamResumption_ResumeFailed);
 		/*
 		CPPUNIT_TEST(testResourceBind);
 		CPPUNIT_TEST(testResourceBind_ChangeResource);
@@ -343,6 +350,98 @@ class ClientSessionTest : public CppUnit::TestFixture {
 			server->receiveAck(3);
 		}
 
+		void testStreamResumption_Enable() {
+			boost::shared_ptr<ClientSession> session(createSession());
+			initializeResumableSession(session);
+
+			CPPUNIT_ASSERT_EQUAL(ClientSession::Initialized, session->getState());
+			CPPUNIT_ASSERT(!session->isResumable());
+
+			server->breakConnection();
+
+			CPPUNIT_ASSERT(sessionFinishedReceived);
+			CPPUNIT_ASSERT(session->isResumable());
+			CPPUNIT_ASSERT(session->canSendStanzas());
+		}
+
+		void testStreamResumption_NotResumableAfterFinish() {
+			boost::shared_ptr<ClientSession> session(createSession());
+			initializeResumableSession(session);
+
+			session->finish();
+
+			CPPUNIT_ASSERT_EQUAL(ClientSession::Finished, session->getState());
+			CPPUNIT_ASSERT(!session->isResumable());
+			CPPUNIT_ASSERT(!session->canSendStanzas());
+		}
+
+		void testStreamResumption_Resume() {
+			boost::shared_ptr<ClientSession> session(createSession());
+			initializeResumableSession(session);
+			server->sendMessage();
+			session->sendStanza(createMessage("m1"));
+			session->sendStanza(createMessage("m2"));
+			server->breakConnection();
+			session->sendStanza(createMessage("m3"));
+
+			server = boost::make_shared<MockSessionStream>();
+			boost::shared_ptr<ClientSession> resumingSession(createSession());
+			resumingSession->resume(session);
+			resumingSession->start();
+			server->receiveStreamStart();
+			server->sendStreamStart();
+			server->sendStreamFeaturesWithPLAINAuthentication();
+			resumingSession->sendCredentials(createSafeByteArray("mypass"));
+			server->receiveAuthRequest("PLAIN");
+			server->sendAuthSuccess();
+			server->receiveStreamStart();
+			server->sendStreamStart();
+			server->sendStreamFeaturesWithBindAndStreamManagement();
+			server->receiveStreamResume("session-1", 1);
+			resumingSession->sendStanza(createMessage("m4"));
+			CPPUNIT_ASSERT(server->receivedEvents.empty());
+			server->sendStreamResumed(1);
+
+			CPPUNIT_ASSERT_EQUAL(ClientSession::Initialized, resumingSession->getState());
+			CPPUNIT_ASSERT(resumingSession->isResumed());
+			CPPUNIT_ASSERT(resumingSession->getStreamManagementEnabled());
+			CPPUNIT_ASSERT_EQUAL(JID("foo@bar.com/bla"), resumingSession->getLocalJID());
+			server->receiveMessage("m2");
+			server->receiveMessage("m3");
+			server->receiveMessage("m4");
+			server->receiveAckRequest();
+			CPPUNIT_ASSERT(server->receivedEvents.empty());
+		}
+
+		void testStreamResumption_ResumeFailed() {
+			boost::shared_ptr<ClientSession> session(createSession());
+			initializeResumableSession(session);
+			server->breakConnection();
+
+			server = boost::make_shared<MockSessionStream>();
+			boost::shared_ptr<ClientSession> resumingSession(createSession());
+			resumingSession->resume(session);
+			resumingSession->start();
+			server->receiveStreamStart();
+			server->sendStreamStart();
+			server->sendStreamFeaturesWithPLAINAuthentication();
+			resumingSession->sendCredentials(createSafeByteArray("mypass"));
+			server->receiveAuthRequest("PLAIN");
+			server->sendAuthSuccess();
+			server->receiveStreamStart();
+			server->sendStreamStart();
+			server->sendStreamFeaturesWithBindAndStreamManagement();
+			server->receiveStreamResume("session-1", 0);
+			sessionFinishedReceived = false;
+			server->sendStreamManagementFailed();
+
+			CPPUNIT_ASSERT_EQUAL(ClientSession::Finished, resumingSession->getState());
+			CPPUNIT_ASSERT(sessionFinishedReceived);
+			CPPUNIT_ASSERT(!sessionFinishedError);
+			CPPUNIT_ASSERT(!resumingSession->isResumed());
+			CPPUNIT_ASSERT(!resumingSession->isResumable());
+		}
+
 	private:
 		boost::shared_ptr<ClientSession> createSession() {
 			boost::shared_ptr<ClientSession> session = ClientSession::create(JID("me@foo.com"), server, idnConverter.get(), crypto.get());
@@ -369,6 +468,30 @@ class ClientSessionTest : public CppUnit::TestFixture {
 			server->sendStreamManagementEnabled();
 		}
 
+		void initializeResumableSession(boost::shared_ptr<ClientSession> session) {
+			session->setUseStreamResumption(true);
+			session->start();
+			server->receiveStreamStart();
+			server->sendStreamStart();
+			server->sendStreamFeaturesWithPLAINAuthentication();
+			session->sendCredentials(createSafeByteArray("mypass"));
+			server->receiveAuthRequest("PLAIN");
+			server->sendAuthSuccess();
+			server->receiveStreamStart();
+			server->sendStreamStart();
+			server->sendStreamFeaturesWithBindAndStreamManagement();
+			server->receiveBind();
+			server->sendBindResult();
+			server->receiveStreamManagementEnable(true);
+			server->sendStreamManagementEnabled("session-1");
+		}
+
+		static boost::shared_ptr<Message> createMessage(const std::string& id) {
+			boost::shared_ptr<Message> message = boost::make_shared<Message>();
+			message->setID(id);
+			return message;
+		}
+
 		void handleSessionFinished(boost::shared_ptr<Error> error) {
 			sessionFinishedReceived = true;
 			sessionFinishedError = error;
@@ -546,6 +669,20 @@ class ClientSessionTest : public CppUnit::TestFixture {
 					onElementReceived(boost::make_shared<StreamManagementEnabled>());
 				}
 
+				void sendStreamManagementEnabled(const std::string& resumeID) {
+					boost::shared_ptr<StreamManagementEnabled> enabled = boost::make_shared<StreamManagementEnabled>();
+					enabled->setResumeSupported();
+					enabled->setResumeID(resumeID);
+					onElementReceived(enabled);
+				}
+
+				void sendStreamResumed(unsigned int handledStanzasCount) {
+					boost::shared_ptr<StreamResumed> resumed = boost::make_shared<StreamResumed>();
+					resumed->setResumeID("session-1");
+					resumed->setHandledStanzasCount(handledStanzasCount);
+					onElementReceived(resumed);
+				}
+
 				void sendStreamManagementFailed() {
 					onElementReceived(boost::make_shared<StreamManagementFailed>());
 				}
@@ -588,6 +725,34 @@ class ClientSessionTest : public CppUnit::TestFixture {
 					CPPUNIT_ASSERT(boost::dynamic_pointer_cast<EnableStreamManagement>(event.element));
 				}
 
+				void receiveStreamManagementEnable(bool resume) {
+					Event event = popEvent();
+					boost::shared_ptr<EnableStreamManagement> enable = boost::dynamic_pointer_cast<EnableStreamManagement>(event.element);
+					CPPUNIT_ASSERT(enable);
+					CPPUNIT_ASSERT_EQUAL(resume, enable->getResume());
+				}
+
+				void receiveStreamResume(const std::string& resumeID, unsigned int handledStanzasCount) {
+					Event event = popEvent();
+					boost::shared_ptr<StreamResume> resume = boost::dynamic_pointer_cast<StreamResume>(event.element);
+					CPPUNIT_ASSERT(resume);
+					CPPUNIT_ASSERT_EQUAL(resumeID, resume->getResumeID());
+					CPPUNIT_ASSERT(resume->getHandledStanzasCount());
+					CPPUNIT_ASSERT_EQUAL(handledStanzasCount, *resume->getHandledStanzasCount());
+				}
+
+				void receiveMessage(const std::string& id) {
+					Event event = popEvent();
+					boost::shared_ptr<Message> message = boost::dynamic_pointer_cast<Message>(event.element);
+					CPPUNIT_ASSERT(message);
+					CPPUNIT_ASSERT_EQUAL(id, message->getID());
+				}
+
+				void receiveAckRequest() {
+					Event event = popEvent();
+					CPPUNIT_ASSERT(boost::dynamic_pointer_cast<StanzaAckRequest>(event.element));
+				}
+
 				void receiveBind() {
 					Event event = popEvent();
 					CPPUNIT_ASSERT(event.element);
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Client/ClientError.h>
+#include <Swiften/Client/ClientOptions.h>
+#include <Swiften/Client/StanzaChannel.h>
+#include <Swiften/Client/CoreClient.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+#include <Swiften/Elements/Message.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
+#include <Swiften/IDN/IDNConverter.h>
+#include <Swiften/IDN/PlatformIDNConverter.h>
+#include <Swiften/Network/Connection.h>
+#include <Swiften/Network/ConnectionFactory.h>
+#include <Swiften/Network/DummyTimerFactory.h>
+#include <Swiften/Network/HostAddress.h>
+#include <Swiften/Network/HostAddressPort.h>
+#include <Swiften/Network/NetworkFactories.h>
+#include <Swiften/Network/NullProxyProvider.h>
+#include <Swiften/Network/StaticDomainNameResolver.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+
+using namespace Swift;
+
+class CoreClientTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(CoreClientTest);
+		CPPUNIT_TEST(testConnect);
+		CPPUNIT_TEST(testResume);
+		CPPUNIT_TEST(testResume_Refused);
+		CPPUNIT_TEST(testResume_ConnectError);
+		CPPUNIT_TEST(testResume_Disconnect);
+		CPPUNIT_TEST(testConnectionError_WithoutResumption);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void setUp() {
+			eventLoop = new DummyEventLoop();
+			networkFactories = new TestNetworkFactories(eventLoop);
+			networkFactories->resolver.addAddress("xmpp.foo.com", HostAddress("1.2.3.4"));
+			client = new CoreClient(JID("alice@foo.com/phone"), createSafeByteArray("secret"), networkFactories);
+			client->onConnected.connect(boost::bind(&CoreClientTest::handleConnected, this));
+			client->onDisconnected.connect(boost::bind(&CoreClientTest::handleDisconnected, this, _1));
+			client->getStanzaChannel()->onAvailableChanged.connect(boost::bind(&CoreClientTest::handleAvailableChanged, this, _1));
+			connected = 0;
+			options.useTLS = ClientOptions::NeverUseTLS;
+			options.allowPLAINWithoutTLS = true;
+			options.useStreamResumption = true;
+			options.manualHostname = "xmpp.foo.com";
+			options.manualPort = 5222;
+		}
+
+		void tearDown() {
+			if (client->isActive()) {
+				client->disconnect();
+				eventLoop->processEvents();
+			}
+			delete client;
+			eventLoop->processEvents();
+			delete networkFactories;
+			delete eventLoop;
+		}
+
+		void testConnect() {
+			connectAndStartSession();
+
+			CPPUNIT_ASSERT(client->isAvailable());
+			CPPUNIT_ASSERT_EQUAL(1, connected);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(availableChanges.size()));
+			CPPUNIT_ASSERT(availableChanges[0]);
+			CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(disconnectErrors.size()));
+			CPPUNIT_ASSERT(getConnection(0)->hasWritten("resume=\"true\""));
+		}
+
+		void testResume() {
+			connectAndStartSession();
+
+			getConnection(0)->breakConnection();
+			eventLoop->processEvents();
+			client->sendMessage(createMessage("Are you there?"));
+			CPPUNIT_ASSERT(client->isAvailable());
+			completeConnect(1);
+			authenticate(1);
+			getConnection(1)->receive("<resumed xmlns='urn:xmpp:sm:2' previd='resume-1' h='0'/>");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT(getConnection(1)->hasWritten("previd=\"resume-1\""));
+			CPPUNIT_ASSERT(getConnection(1)->hasWritten("Are you there?"));
+			CPPUNIT_ASSERT(client->isAvailable());
+			CPPUNIT_ASSERT_EQUAL(1, connected);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(availableChanges.size()));
+			CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(disconnectErrors.size()));
+		}
+
+		void testResume_Refused() {
+			connectAndStartSession();
+
+			getConnection(0)->breakConnection();
+			eventLoop->processEvents();
+			completeConnect(1);
+			authenticate(1);
+			getConnection(1)->receive("<failed xmlns='urn:xmpp:sm:2'/>");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT(!client->isAvailable());
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(availableChanges.size()));
+			CPPUNIT_ASSERT(!availableChanges[1]);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(disconnectErrors.size()));
+			CPPUNIT_ASSERT(disconnectErrors[0]);
+			CPPUNIT_ASSERT_EQUAL(ClientError::ConnectionReadError, disconnectErrors[0]->getType());
+		}
+
+		void testResume_ConnectError() {
+			connectAndStartSession();
+
+			networkFactories->connectionFactory.connects = false;
+			getConnection(0)->breakConnection();
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT(!client->isAvailable());
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(availableChanges.size()));
+			CPPUNIT_ASSERT(!availableChanges[1]);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(disconnectErrors.size()));
+			CPPUNIT_ASSERT(disconnectErrors[0]);
+			CPPUNIT_ASSERT_EQUAL(ClientError::ConnectionError, disconnectErrors[0]->getType());
+		}
+
+		void testResume_Disconnect() {
+			connectAndStartSession();
+
+			getConnection(0)->breakConnection();
+			eventLoop->processEvents();
+			client->disconnect();
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT(!client->isAvailable());
+			CPPUNIT_ASSERT(!client->isActive());
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(availableChanges.size()));
+			CPPUNIT_ASSERT(!availableChanges[1]);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(disconnectErrors.size()));
+			CPPUNIT_ASSERT(!disconnectErrors[0]);
+		}
+
+		void testConnectionError_WithoutResumption() {
+			options.useStreamResumption = false;
+			connectAndStartSession();
+
+			getConnection(0)->breakConnection();
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(networkFactories->connectionFactory.connections.size()));
+			CPPUNIT_ASSERT(!client->isAvailable());
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(availableChanges.size()));
+			CPPUNIT_ASSERT(!availableChanges[1]);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(disconnectErrors.size()));
+			CPPUNIT_ASSERT(disconnectErrors[0]);
+			CPPUNIT_ASSERT_EQUAL(ClientError::ConnectionReadError, disconnectErrors[0]->getType());
+		}
+
+	private:
+		void connectAndStartSession() {
+			client->connect(options);
+			completeConnect(0);
+			authenticate(0);
+			getConnection(0)->receive("<iq type='result' id='session-bind'><bind xmlns='urn:ietf:params:xml:ns:xmpp-bind'><jid>alice@foo.com/phone</jid></bind></iq>");
+			eventLoop->processEvents();
+			if (options.useStreamResumption) {
+				getConnection(0)->receive("<enabled xmlns='urn:xmpp:sm:2' id='resume-1' resume='true'/>");
+			}
+			else {
+				getConnection(0)->receive("<enabled xmlns='urn:xmpp:sm:2'/>");
+			}
+			eventLoop->processEvents();
+		}
+
+		void completeConnect(size_t index) {
+			eventLoop->processEvents();
+			getConnection(index)->onConnectFinished(false);
+			eventLoop->processEvents();
+		}
+
+		void authenticate(size_t index) {
+			boost::shared_ptr<MockConnection> connection = getConnection(index);
+			connection->receive(getStreamHeader());
+			connection->receive("<stream:features><mechanisms xmlns='urn:ietf:params:xml:ns:xmpp-sasl'><mechanism>PLAIN</mechanism></mechanisms></stream:features>");
+			eventLoop->processEvents();
+			connection->receive("<success xmlns='urn:ietf:params:xml:ns:xmpp-sasl'/>");
+			eventLoop->processEvents();
+			connection->receive(getStreamHeader());
+			connection->receive("<stream:features><bind xmlns='urn:ietf:params:xml:ns:xmpp-bind'/><sm xmlns='urn:xmpp:sm:2'/></stream:features>");
+			eventLoop->processEvents();
+		}
+
+		std::string getStreamHeader() const {
+			return "<?xml version='1.0'?><stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams' from='foo.com' id='stream' version='1.0'>";
+		}
+
+		boost::shared_ptr<Message> createMessage(const std::string& body) {
+			boost::shared_ptr<Message> message = boost::make_shared<Message>();
+			message->setTo(JID("bob@foo.com/phone"));
+			message->setBody(body);
+			return message;
+		}
+
+		void handleConnected() {
+			++connected;
+		}
+
+		void handleDisconnected(const boost::optional<ClientError>& error) {
+			disconnectErrors.push_back(error);
+		}
+
+		void handleAvailableChanged(bool available) {
+			availableChanges.push_back(available);
+		}
+
+		struct MockConnection : public Connection, public EventOwner, public boost::enable_shared_from_this<MockConnection> {
+			public:
+				MockConnection(bool connects, EventLoop* eventLoop) : connects(connects), eventLoop(eventLoop), disconnected(false) {
+				}
+
+				void listen() { assert(false); }
+
+				// Successful connects are finished by the test
+				void connect(const HostAddressPort&) {
+					if (!connects) {
+						eventLoop->postEvent(boost::bind(boost::ref(onConnectFinished), true), shared_from_this());
+					}
+				}
+
+				HostAddressPort getLocalAddress() const { return HostAddressPort(); }
+
+				void disconnect() {
+					if (!disconnected) {
+						disconnected = true;
+						eventLoop->postEvent(boost::bind(boost::ref(onDisconnected), boost::optional<Connection::Error>()), shared_from_this());
+					}
+				}
+
+				void write(const SafeByteArray& data) {
+					append(dataWritten, data);
+				}
+
+				void receive(const std::string& data) {
+					onDataRead(boost::make_shared<SafeByteArray>(createSafeByteArray(data)));
+				}
+
+				void breakConnection() {
+					disconnected = true;
+					onDisconnected(Connection::ReadError);
+				}
+
+				bool hasWritten(const std::string& data) const {
+					return safeByteArrayToString(dataWritten).find(data) != std::string::npos;
+				}
+
+				bool connects;
+				EventLoop* eventLoop;
+				bool disconnected;
+				SafeByteArray dataWritten;
+		};
+
+		struct MockConnectionFactory : public ConnectionFactory {
+			MockConnectionFactory(EventLoop* eventLoop) : eventLoop(eventLoop), connects(true) {
+			}
+
+			boost::shared_ptr<Connection> createConnection() {
+				boost::shared_ptr<MockConnection> connection = boost::make_shared<MockConnection>(connects, eventLoop);
+				connections.push_back(connection);
+				return connection;
+			}
+
+			EventLoop* eventLoop;
+			bool connects;
+			std::vector< boost::shared_ptr<MockConnection> > connections;
+		};
+
+		class TestNetworkFactories : public NetworkFactories {
+			public:
+				TestNetworkFactories(EventLoop* eventLoop) : eventLoop(eventLoop), connectionFactory(eventLoop), resolver(eventLoop), idnConverter(PlatformIDNConverter::create()), cryptoProvider(PlatformCryptoProvider::create()) {
+				}
+
+				~TestNetworkFactories() {
+					delete cryptoProvider;
+					delete idnConverter;
+				}
+
+				virtual TimerFactory* getTimerFactory() const { return const_cast<DummyTimerFactory*>(&timerFactory); }
+				virtual ConnectionFactory* getConnectionFactory() const { return const_cast<MockConnectionFactory*>(&connectionFactory); }
+				virtual DomainNameResolver* getDomainNameResolver() const { return const_cast<StaticDomainNameResolver*>(&resolver); }
+				virtual ConnectionServerFactory* getConnectionServerFactory() const { return NULL; }
+				virtual NATTraverser* getNATTraverser() const { return NULL; }
+				virtual NetworkEnvironment* getNetworkEnvironment() const { return NULL; }
+				virtual XMLParserFactory* getXMLParserFactory() const { return const_cast<PlatformXMLParserFactory*>(&xmlParserFactory); }
+				virtual TLSContextFactory* getTLSContextFactory() const { return NULL; }
+				virtual ProxyProvider* getProxyProvider() const { return const_cast<NullProxyProvider*>(&proxyProvider); }
+				virtual EventLoop* getEventLoop() const { return eventLoop; }
+				virtual IDNConverter* getIDNConverter() const { return idnConverter; }
+				virtual CryptoProvider* getCryptoProvider() const { return cryptoProvider; }
+
+				EventLoop* eventLoop;
+				DummyTimerFactory timerFactory;
+				MockConnectionFactory connectionFactory;
+				StaticDomainNameResolver resolver;
+				PlatformXMLParserFactory xmlParserFactory;
+				NullProxyProvider proxyProvider;
+				IDNConverter* idnConverter;
+				CryptoProvider* cryptoProvider;
+		};
+
+		boost::shared_ptr<MockConnection> getConnection(size_t index) {
+			CPPUNIT_ASSERT(index < networkFactories->connectionFactory.connections.size());
+			return networkFactories->connectionFactory.connections[index];
+		}
+
+	private:
+		DummyEventLoop* eventLoop;
+		TestNetworkFactories* networkFactories;
+		CoreClient* client;
+		ClientOptions options;
+		int connected;
+		std::vector<bool> availableChanges;
+		std::vector< boost::optional<ClientError> > disconnectErrors;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CoreClientTest);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013 Isode Limited.
+ * Copyright (c) 2013-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,3 +12,16 @@ using namespace Swift;
 
 CryptoProvider::~CryptoProvider() {
 }
+
+Hash* CryptoProvider::createHash(const std::string& algorithm) {
+	if (algorithm == "sha-1") {
+		return createSHA1();
+	}
+	else if (algorithm == "sha-256") {
+		return createSHA256();
+	}
+	else if (algorithm == "md5") {
+		return createMD5();
+	}
+	return NULL;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013 Isode Limited.
+ * Copyright (c) 2013-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,6 +11,8 @@
 #include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/Crypto/Hash.h>
 
+#include <string>
+
 namespace Swift {
 	class Hash;
 
@@ -20,10 +22,19 @@ namespace Swift {
 
 			virtual Hash* createSHA1() = 0;
 			virtual Hash* createMD5() = 0;
+			virtual Hash* createSHA256() = 0;
 			virtual ByteArray getHMACSHA1(const SafeByteArray& key, const ByteArray& data) = 0;
 			virtual ByteArray getHMACSHA1(const ByteArray& key, const ByteArray& data) = 0;
 			virtual bool isMD5AllowedForCrypto() const = 0;
 
+			/**
+			 * Creates a hash for the algorithm with the given name, as used in
+			 * hash elements (XEP-0300), e.g. "sha-1" or "sha-256".
+			 *
+			 * Returns NULL if the algorithm isn't supported.
+			 */
+			Hash* createHash(const std::string& algorithm);
+
 			// Convenience
 			template<typename T> ByteArray getSHA1Hash(const T& data) {
 				return boost::shared_ptr<Hash>(createSHA1())->update(data).getHash();
@@ -32,5 +43,9 @@ namespace Swift {
 			template<typename T> ByteArray getMD5Hash(const T& data) {
 				return boost::shared_ptr<Hash>(createMD5())->update(data).getHash();
 			}
+
+			template<typename T> ByteArray getSHA256Hash(const T& data) {
+				return boost::shared_ptr<Hash>(createSHA256())->update(data).getHash();
+			}
 	};
 }
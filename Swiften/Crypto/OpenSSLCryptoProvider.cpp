@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013 Isode Limited.
+ * Copyright (c) 2013-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -103,6 +103,47 @@ namespace {
 	};
 
 
+	class SHA256Hash : public Hash {
+		public:
+			SHA256Hash() : finalized(false) {
+				if (!SHA256_Init(&context)) {
+					assert(false);
+				}
+			}
+
+			~SHA256Hash() {
+			}
+
+			virtual Hash& update(const ByteArray& data) SWIFTEN_OVERRIDE {
+				return updateInternal(data);
+			}
+
+			virtual Hash& update(const SafeByteArray& data) SWIFTEN_OVERRIDE {
+				return updateInternal(data);
+			}
+
+			virtual std::vector<unsigned char> getHash() SWIFTEN_OVERRIDE {
+				assert(!finalized);
+				std::vector<unsigned char> result(SHA256_DIGEST_LENGTH);
+				SHA256_Final(vecptr(result), &context);
+				return result;
+			}
+
+		private:
+			template<typename ContainerType>
+			Hash& updateInternal(const ContainerType& data) {
+				assert(!finalized);
+				if (!SHA256_Update(&context, vecptr(data), data.size())) {
+					assert(false);
+				}
+				return *this;
+			}
+
+		private:
+			SHA256_CTX context;
+			bool finalized;
+	};
+
 	template<typename T>
 	ByteArray getHMACSHA1Internal(const T& key, const ByteArray& data) {
 		unsigned int len = SHA_DIGEST_LENGTH;
@@ -126,6 +167,10 @@ Hash* OpenSSLCryptoProvider::createMD5() {
 	return new MD5Hash();
 }
 
+Hash* OpenSSLCryptoProvider::createSHA256() {
+	return new SHA256Hash();
+}
+
 ByteArray OpenSSLCryptoProvider::getHMACSHA1(const SafeByteArray& key, const ByteArray& data) {
 	return getHMACSHA1Internal(key, data);
 }
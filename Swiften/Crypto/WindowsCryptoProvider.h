@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013  Isode Limited.
+ * Copyright (c) 2013-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -19,6 +19,7 @@ namespace Swift {
 
 			virtual Hash* createSHA1() SWIFTEN_OVERRIDE;
 			virtual Hash* createMD5() SWIFTEN_OVERRIDE;
+			virtual Hash* createSHA256() SWIFTEN_OVERRIDE;
 			virtual ByteArray getHMACSHA1(const SafeByteArray& key, const ByteArray& data) SWIFTEN_OVERRIDE;
 			virtual ByteArray getHMACSHA1(const ByteArray& key, const ByteArray& data) SWIFTEN_OVERRIDE;
 			virtual bool isMD5AllowedForCrypto() const SWIFTEN_OVERRIDE;
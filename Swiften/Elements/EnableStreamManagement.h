@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,6 +12,20 @@
 namespace Swift {
 	class EnableStreamManagement : public ToplevelElement {
 		public:
-			EnableStreamManagement() {}
+			EnableStreamManagement() : resume(false) {}
+
+			/**
+			 * Asks the server to allow resuming the stream later on.
+			 */
+			void setResume(bool b) {
+				resume = b;
+			}
+
+			bool getResume() const {
+				return resume;
+			}
+
+		private:
+			bool resume;
 	};
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,19 +8,96 @@
 #include <Swiften/Elements/Delay.h>
 
 #include <typeinfo>
+#include <boost/smart_ptr/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <Swiften/Base/foreach.h>
 
+namespace {
+	// Few stanzas have raw payloads, so they share a pool of mutexes
+	// instead of having one each.
+	const size_t rawPayloadsMutexCount = 41;
+	boost::mutex rawPayloadsMutexes[rawPayloadsMutexCount];
+
+	boost::mutex& getRawPayloadsMutex(const void* stanza) {
+		return rawPayloadsMutexes[reinterpret_cast<size_t>(stanza) % rawPayloadsMutexCount];
+	}
+}
+
 namespace Swift {
 
-Stanza::Stanza() {
+Stanza::Stanza() : hasRawPayloads_(false) {
 }
 	
 Stanza::~Stanza() {
 	payloads_.clear();
 }
 
+Stanza::Stanza(const Stanza& other) : ToplevelElement(other), id_(other.id_), from_(other.from_), to_(other.to_), hasRawPayloads_(false) {
+	copyPayloads(other);
+}
+
+Stanza& Stanza::operator=(const Stanza& other) {
+	if (this != &other) {
+		ToplevelElement::operator=(other);
+		id_ = other.id_;
+		from_ = other.from_;
+		to_ = other.to_;
+		copyPayloads(other);
+	}
+	return *this;
+}
+
+void Stanza::copyPayloads(const Stanza& other) {
+	if (other.hasRawPayloads_.load(boost::memory_order_acquire)) {
+		boost::mutex::scoped_lock lock(getRawPayloadsMutex(&other));
+		payloads_ = other.payloads_;
+		rawPayloads_ = other.rawPayloads_;
+		rawPayloadsParser_ = other.rawPayloadsParser_;
+		hasRawPayloads_.store(!!rawPayloadsParser_, boost::memory_order_release);
+	}
+	else {
+		payloads_ = other.payloads_;
+		rawPayloads_.reset();
+		rawPayloadsParser_.reset();
+		hasRawPayloads_.store(false, boost::memory_order_release);
+	}
+}
+
+Stanza::PayloadsParser::~PayloadsParser() {
+}
+
+void Stanza::setRawPayloads(const std::string& data, boost::shared_ptr<PayloadsParser> parser) {
+	boost::shared_ptr<const std::string> rawPayloads = boost::make_shared<std::string>(data);
+	boost::mutex::scoped_lock lock(getRawPayloadsMutex(this));
+	payloads_.clear();
+	rawPayloads_ = rawPayloads;
+	rawPayloadsParser_ = parser;
+	hasRawPayloads_.store(true, boost::memory_order_release);
+}
+
+boost::shared_ptr<const std::string> Stanza::getRawPayloads() const {
+	if (!hasRawPayloads_.load(boost::memory_order_acquire)) {
+		return boost::shared_ptr<const std::string>();
+	}
+	boost::mutex::scoped_lock lock(getRawPayloadsMutex(this));
+	return rawPayloads_;
+}
+
+void Stanza::parseRawPayloads() const {
+	// Other threads wait until the payloads are parsed, and only see
+	// payloads_ once it is complete (or once the flag is cleared).
+	boost::mutex::scoped_lock lock(getRawPayloadsMutex(this));
+	if (rawPayloadsParser_) {
+		payloads_ = rawPayloadsParser_->parsePayloads(*rawPayloads_);
+		rawPayloadsParser_.reset();
+		rawPayloads_.reset();
+		hasRawPayloads_.store(false, boost::memory_order_release);
+	}
+}
+
 void Stanza::updatePayload(boost::shared_ptr<Payload> payload) {
+	parseRawPayloadsIfNeeded();
 	foreach (boost::shared_ptr<Payload>& i, payloads_) {
 		if (typeid(*i.get()) == typeid(*payload.get())) {
 			i = payload;
@@ -31,6 +108,7 @@ void Stanza::updatePayload(boost::shared_ptr<Payload> payload) {
 }
 
 boost::shared_ptr<Payload> Stanza::getPayloadOfSameType(boost::shared_ptr<Payload> payload) const {
+	parseRawPayloadsIfNeeded();
 	foreach (const boost::shared_ptr<Payload>& i, payloads_) {
 		if (typeid(*i.get()) == typeid(*payload.get())) {
 			return i;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,6 +11,7 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/optional/optional_fwd.hpp>
 #include <boost/date_time/posix_time/ptime.hpp>
+#include <boost/atomic.hpp>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/ToplevelElement.h>
@@ -23,15 +24,28 @@ namespace Swift {
 		public:
 			typedef boost::shared_ptr<Stanza> ref;
 
+			/**
+			 * Parses payloads that were kept in their serialized form when
+			 * the stanza was received.
+			 */
+			class SWIFTEN_API PayloadsParser {
+				public:
+					virtual ~PayloadsParser();
+
+					virtual std::vector< boost::shared_ptr<Payload> > parsePayloads(const std::string& data) = 0;
+			};
+
 		protected:
 			Stanza();
 
 		public:
 			virtual ~Stanza();
-			SWIFTEN_DEFAULT_COPY_CONSTRUCTOR(Stanza)
+			Stanza(const Stanza& other);
+			Stanza& operator=(const Stanza& other);
 
 			template<typename T> 
 			boost::shared_ptr<T> getPayload() const {
+				parseRawPayloadsIfNeeded();
 				for (size_t i = 0; i < payloads_.size(); ++i) {
 					boost::shared_ptr<T> result(boost::dynamic_pointer_cast<T>(payloads_[i]));
 					if (result) {
@@ -43,6 +57,7 @@ namespace Swift {
 
 			template<typename T> 
 			std::vector< boost::shared_ptr<T> > getPayloads() const {
+				parseRawPayloadsIfNeeded();
 				std::vector< boost::shared_ptr<T> > results;
 				for (size_t i = 0; i < payloads_.size(); ++i) {
 					boost::shared_ptr<T> result(boost::dynamic_pointer_cast<T>(payloads_[i]));
@@ -55,18 +70,53 @@ namespace Swift {
 
 
 			const std::vector< boost::shared_ptr<Payload> >& getPayloads() const {
+				parseRawPayloadsIfNeeded();
 				return payloads_;
 			}
 
 			void addPayload(boost::shared_ptr<Payload> payload) {
+				parseRawPayloadsIfNeeded();
 				payloads_.push_back(payload);
 			}
 
 			template<typename InputIterator>
 			void addPayloads(InputIterator begin, InputIterator end) {
+				parseRawPayloadsIfNeeded();
 				payloads_.insert(payloads_.end(), begin, end);
 			}
 
+			/**
+			 * Replaces the payloads by their serialized form.
+			 *
+			 * The payloads are only parsed (using the given parser) when
+			 * they are first accessed. Until then, serializing the stanza
+			 * writes the serialized payloads as they are.
+			 *
+			 * Parsing is synchronized, so the payloads of a stanza with raw
+			 * payloads can be read (and the stanza serialized) from several
+			 * threads at once. Modifying the payloads still requires that
+			 * no other thread accesses the stanza.
+			 */
+			void setRawPayloads(const std::string& data, boost::shared_ptr<PayloadsParser> parser);
+
+			/**
+			 * Returns whether the payloads are still in the serialized form
+			 * passed to setRawPayloads().
+			 */
+			bool hasRawPayloads() const {
+				return hasRawPayloads_.load(boost::memory_order_acquire) && getRawPayloads();
+			}
+
+			/**
+			 * Returns the serialized payloads passed to setRawPayloads(),
+			 * or a null pointer if they were parsed in the meantime.
+			 *
+			 * The result stays valid when another thread parses the
+			 * payloads, so a serializer can use it instead of checking
+			 * hasRawPayloads() first.
+			 */
+			boost::shared_ptr<const std::string> getRawPayloads() const;
+
 			void updatePayload(boost::shared_ptr<Payload> payload);
 
 			boost::shared_ptr<Payload> getPayloadOfSameType(boost::shared_ptr<Payload>) const;
@@ -85,10 +135,24 @@ namespace Swift {
 			// Falls back to any timestamp if no specific timestamp for the given JID is found.
 			boost::optional<boost::posix_time::ptime> getTimestampFrom(const JID& jid) const;
 	
+		private:
+			void parseRawPayloadsIfNeeded() const {
+				// Only stanzas that still have raw payloads take a lock
+				if (hasRawPayloads_.load(boost::memory_order_acquire)) {
+					parseRawPayloads();
+				}
+			}
+
+			void parseRawPayloads() const;
+			void copyPayloads(const Stanza& other);
+
 		private:
 			std::string id_;
 			JID from_;
 			JID to_;
-			std::vector< boost::shared_ptr<Payload> > payloads_;
+			mutable std::vector< boost::shared_ptr<Payload> > payloads_;
+			mutable boost::shared_ptr<const std::string> rawPayloads_;
+			mutable boost::shared_ptr<PayloadsParser> rawPayloadsParser_;
+			mutable boost::atomic<bool> hasRawPayloads_;
 	};
 }
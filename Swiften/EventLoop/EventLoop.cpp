@@ -1,23 +1,18 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/EventLoop/EventLoop.h>
 
-#include <algorithm>
 #include <iostream>
 #include <cassert>
-#include <boost/bind.hpp>
-#include <boost/lambda/lambda.hpp>
-#include <boost/lambda/bind.hpp>
 #include <boost/thread/locks.hpp>
 
+#include <Swiften/Base/foreach.h>
 #include <Swiften/Base/Log.h>
 
-namespace lambda = boost::lambda;
-
 namespace Swift {
 
 inline void invokeCallback(const Event& event) {
@@ -52,10 +47,11 @@ void EventLoop::handleEvent(const Event& event) {
 	bool doCallback = false;
 	{
 		boost::lock_guard<boost::mutex> lock(eventsMutex_);
-		std::list<Event>::iterator i = std::find(events_.begin(), events_.end(), event);
-		if (i != events_.end()) {
+		PendingEventsMap::iterator i = pendingEvents_.find(event.id);
+		if (i != pendingEvents_.end()) {
 			doCallback = true;
-			events_.erase(i);
+			unlinkFromOwner(i->second);
+			pendingEvents_.erase(i);
 		}
 	}
 	if (doCallback) {
@@ -79,15 +75,39 @@ void EventLoop::postEvent(boost::function<void ()> callback, boost::shared_ptr<E
 		boost::lock_guard<boost::mutex> lock(eventsMutex_);
 		event.id = nextEventID_;
 		nextEventID_++;
-		events_.push_back(event);
+		PendingEvent& pendingEvent = pendingEvents_[event.id];
+		if (owner) {
+			OwnerEventList& ownerEventList = ownerEvents_[owner.get()];
+			pendingEvent.owner = owner.get();
+			pendingEvent.ownerPosition = ownerEventList.insert(ownerEventList.end(), event.id);
+		}
 	}
 	//SWIFT_LOG(debug) << "Posting event " << event.id << std::endl;
 	post(event);
 }
 
 void EventLoop::removeEventsFromOwner(boost::shared_ptr<EventOwner> owner) {
-		boost::lock_guard<boost::mutex> lock(eventsMutex_);
-		events_.remove_if(lambda::bind(&Event::owner, lambda::_1) == owner);
+	boost::lock_guard<boost::mutex> lock(eventsMutex_);
+	OwnerEventsMap::iterator i = ownerEvents_.find(owner.get());
+	if (i == ownerEvents_.end()) {
+		return;
+	}
+	foreach (unsigned int id, i->second) {
+		pendingEvents_.erase(id);
+	}
+	ownerEvents_.erase(i);
+}
+
+void EventLoop::unlinkFromOwner(const PendingEvent& pendingEvent) {
+	if (!pendingEvent.owner) {
+		return;
+	}
+	OwnerEventsMap::iterator i = ownerEvents_.find(pendingEvent.owner);
+	assert(i != ownerEvents_.end());
+	i->second.erase(pendingEvent.ownerPosition);
+	if (i->second.empty()) {
+		ownerEvents_.erase(i);
+	}
 }
 
 }
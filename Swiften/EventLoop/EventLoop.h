@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,6 +8,7 @@
 
 #include <boost/function.hpp>
 #include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
 #include <list>
 #include <deque>
 
@@ -34,10 +35,30 @@ namespace Swift {
 
 			void handleEvent(const Event& event);
 
+		private:
+			typedef std::list<unsigned int> OwnerEventList;
+			typedef boost::unordered_map<EventOwner*, OwnerEventList> OwnerEventsMap;
+
+			/**
+			 * Bookkeeping for an event that has been posted but not yet handled.
+			 * Events with an owner keep a position in the owner's event list, so
+			 * that they can be unlinked from it in constant time.
+			 */
+			struct PendingEvent {
+				PendingEvent() : owner(NULL) {}
+
+				EventOwner* owner;
+				OwnerEventList::iterator ownerPosition;
+			};
+			typedef boost::unordered_map<unsigned int, PendingEvent> PendingEventsMap;
+
+			void unlinkFromOwner(const PendingEvent& pendingEvent);
+
 		private:
 			boost::mutex eventsMutex_;
 			unsigned int nextEventID_;
-			std::list<Event> events_;
+			PendingEventsMap pendingEvents_;
+			OwnerEventsMap ownerEvents_;
 			bool handlingEvents_;
 			std::deque<Event> eventsToHandle_;
 	};
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/EventLoop/LockFreeEventQueue.h>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace Swift {
+
+/*
+ * This is an intrusive MPSC queue (after Dmitry Vyukov): producers swing
+ * head_ to their node with a single exchange and then link the previous
+ * node to it, and the consumer follows the next pointers from the stub
+ * node in tail_.
+ */
+
+LockFreeEventQueue::LockFreeEventQueue() : consumerWaiting_(false), interrupted_(false) {
+	Node* stub = new Node();
+	head_.store(stub);
+	tail_ = stub;
+}
+
+LockFreeEventQueue::~LockFreeEventQueue() {
+	while (tail_) {
+		Node* next = tail_->next.load(boost::memory_order_relaxed);
+		delete tail_;
+		tail_ = next;
+	}
+}
+
+void LockFreeEventQueue::push(const Event& event) {
+	Node* node = new Node(event);
+	Node* previous = head_.exchange(node, boost::memory_order_seq_cst);
+	previous->next.store(node, boost::memory_order_release);
+
+	if (consumerWaiting_.load(boost::memory_order_seq_cst)) {
+		boost::lock_guard<boost::mutex> lock(waitMutex_);
+		eventsAvailable_.notify_one();
+	}
+}
+
+bool LockFreeEventQueue::popAll(std::vector<Event>& events) {
+	Node* last = head_.load(boost::memory_order_acquire);
+	if (last == tail_) {
+		return false;
+	}
+	while (tail_ != last) {
+		Node* next = tail_->next.load(boost::memory_order_acquire);
+		if (!next) {
+			// A producer has claimed its spot but not linked it in yet.
+			boost::this_thread::yield();
+			continue;
+		}
+		events.push_back(next->event);
+		next->event = Event(boost::shared_ptr<EventOwner>(), boost::function<void()>());
+		delete tail_;
+		tail_ = next;
+	}
+	return true;
+}
+
+bool LockFreeEventQueue::isEmpty() const {
+	return head_.load(boost::memory_order_seq_cst) == tail_;
+}
+
+void LockFreeEventQueue::waitForEvents() {
+	boost::unique_lock<boost::mutex> lock(waitMutex_);
+	consumerWaiting_.store(true, boost::memory_order_seq_cst);
+	while (isEmpty() && !interrupted_) {
+		eventsAvailable_.wait(lock);
+	}
+	consumerWaiting_.store(false, boost::memory_order_relaxed);
+	interrupted_ = false;
+}
+
+void LockFreeEventQueue::interrupt() {
+	boost::lock_guard<boost::mutex> lock(waitMutex_);
+	interrupted_ = true;
+	eventsAvailable_.notify_one();
+}
+
+}
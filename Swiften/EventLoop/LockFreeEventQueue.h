@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/EventLoop/Event.h>
+
+namespace Swift {
+	/**
+	 * An unbounded multi-producer, single-consumer queue of events.
+	 *
+	 * Any thread can push() without taking a lock. Only one thread (the one
+	 * running the event loop) may call popAll() and waitForEvents().
+	 * Producers only touch the wakeup mutex when the consumer is actually
+	 * blocked in waitForEvents(), so a busy consumer is never woken up once
+	 * per event.
+	 */
+	class SWIFTEN_API LockFreeEventQueue : public boost::noncopyable {
+		public:
+			LockFreeEventQueue();
+			~LockFreeEventQueue();
+
+			void push(const Event& event);
+
+			/**
+			 * Appends all queued events to \p events, in the order in which
+			 * they were pushed.
+			 *
+			 * \return true if any events were appended.
+			 */
+			bool popAll(std::vector<Event>& events);
+
+			bool isEmpty() const;
+
+			/**
+			 * Blocks until the queue is non-empty, or until interrupt() is
+			 * called.
+			 */
+			void waitForEvents();
+
+			/**
+			 * Wakes up a consumer blocked in waitForEvents().
+			 */
+			void interrupt();
+
+		private:
+			struct Node {
+				Node() : event(boost::shared_ptr<EventOwner>(), boost::function<void()>()), next(NULL) {}
+				Node(const Event& event) : event(event), next(NULL) {}
+
+				Event event;
+				boost::atomic<Node*> next;
+			};
+
+		private:
+			boost::atomic<Node*> head_;
+			Node* tail_;
+			boost::atomic<bool> consumerWaiting_;
+			bool interrupted_;
+			boost::mutex waitMutex_;
+			boost::condition_variable eventsAvailable_;
+	};
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,11 +14,11 @@
 
 namespace Swift {
 
-SimpleEventLoop::SimpleEventLoop() : isRunning_(true) {
+SimpleEventLoop::SimpleEventLoop(QueueType queueType) : queueType_(queueType), isRunning_(true) {
 }
 
 SimpleEventLoop::~SimpleEventLoop() {
-	if (!events_.empty()) {
+	if (!events_.empty() || !lockFreeEvents_.isEmpty()) {
 		std::cerr << "Warning: Pending events in SimpleEventLoop at destruction time" << std::endl;
 	}
 }
@@ -26,13 +26,7 @@ SimpleEventLoop::~SimpleEventLoop() {
 void SimpleEventLoop::doRun(bool breakAfterEvents) {
 	while (isRunning_) {
 		std::vector<Event> events;
-		{
-			boost::unique_lock<boost::mutex> lock(eventsMutex_);
-			while (events_.empty()) {
-				eventsAvailable_.wait(lock);
-			}
-			events.swap(events_);
-		}
+		waitForEvents(events);
 		foreach(const Event& event, events) {
 			handleEvent(event);
 		}
@@ -44,10 +38,7 @@ void SimpleEventLoop::doRun(bool breakAfterEvents) {
 
 void SimpleEventLoop::runOnce() {
 	std::vector<Event> events;
-	{
-		boost::unique_lock<boost::mutex> lock(eventsMutex_);
-		events.swap(events_);
-	}
+	takeEvents(events);
 	foreach(const Event& event, events) {
 		handleEvent(event);
 	}
@@ -61,7 +52,36 @@ void SimpleEventLoop::doStop() {
 	isRunning_ = false;
 }
 
+void SimpleEventLoop::waitForEvents(std::vector<Event>& events) {
+	if (queueType_ == LockFreeQueue) {
+		while (!lockFreeEvents_.popAll(events)) {
+			lockFreeEvents_.waitForEvents();
+		}
+	}
+	else {
+		boost::unique_lock<boost::mutex> lock(eventsMutex_);
+		while (events_.empty()) {
+			eventsAvailable_.wait(lock);
+		}
+		events.swap(events_);
+	}
+}
+
+void SimpleEventLoop::takeEvents(std::vector<Event>& events) {
+	if (queueType_ == LockFreeQueue) {
+		lockFreeEvents_.popAll(events);
+	}
+	else {
+		boost::unique_lock<boost::mutex> lock(eventsMutex_);
+		events.swap(events_);
+	}
+}
+
 void SimpleEventLoop::post(const Event& event) {
+	if (queueType_ == LockFreeQueue) {
+		lockFreeEvents_.push(event);
+		return;
+	}
 	{
 		boost::lock_guard<boost::mutex> lock(eventsMutex_);
 		events_.push_back(event);
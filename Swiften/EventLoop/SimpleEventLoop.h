@@ -13,11 +13,19 @@
 
 #include <Swiften/Base/API.h>
 #include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/EventLoop/LockFreeEventQueue.h>
 
 namespace Swift {
 	class SWIFTEN_API SimpleEventLoop : public EventLoop {
 		public:
-			SimpleEventLoop();
+			enum QueueType {
+				/// Events are queued under a mutex, and every post wakes up the loop.
+				LockingQueue,
+				/// Events are queued without locking, and the loop is only woken up when it is idle.
+				LockFreeQueue
+			};
+
+			SimpleEventLoop(QueueType queueType = LockingQueue);
 			virtual ~SimpleEventLoop();
 
 			void run() {
@@ -37,9 +45,13 @@ namespace Swift {
 		private:
 			void doRun(bool breakAfterEvents);
 			void doStop();
+			void waitForEvents(std::vector<Event>& events);
+			void takeEvents(std::vector<Event>& events);
 
 		private:
+			QueueType queueType_;
 			bool isRunning_;
+			LockFreeEventQueue lockFreeEvents_;
 			std::vector<Event> events_;
 			boost::mutex eventsMutex_;
 			boost::condition_variable eventsAvailable_;
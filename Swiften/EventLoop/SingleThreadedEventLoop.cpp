@@ -14,18 +14,30 @@
 
 namespace Swift {
 
-SingleThreadedEventLoop::SingleThreadedEventLoop() 
-: shouldShutDown_(false)
+SingleThreadedEventLoop::SingleThreadedEventLoop(QueueType queueType) 
+: queueType_(queueType), shouldShutDown_(false)
 {
 }
 
 SingleThreadedEventLoop::~SingleThreadedEventLoop() {
-	if (!events_.empty()) {
+	if (!events_.empty() || !lockFreeEvents_.isEmpty()) {
 		std::cerr << "Warning: Pending events in SingleThreadedEventLoop at destruction time." << std::endl;
 	}
 }
 
 void SingleThreadedEventLoop::waitForEvents() {
+	if (queueType_ == LockFreeQueue) {
+		// stop() interrupts the queue after setting shouldShutDown_, so the wait
+		// below cannot miss it.
+		if (lockFreeEvents_.isEmpty()) {
+			lockFreeEvents_.waitForEvents();
+		}
+		boost::unique_lock<boost::mutex> lock(eventsMutex_);
+		if (shouldShutDown_)
+			throw EventLoopCanceledException();
+		return;
+	}
+
 	boost::unique_lock<boost::mutex> lock(eventsMutex_);
 	while (events_.empty() && !shouldShutDown_) {
 		eventsAvailable_.wait(lock);
@@ -39,7 +51,10 @@ void SingleThreadedEventLoop::handleEvents() {
 	// Make a copy of the list of events so we don't block any threads that post 
 	// events while we process them.
 	std::vector<Event> events;
-	{
+	if (queueType_ == LockFreeQueue) {
+		lockFreeEvents_.popAll(events);
+	}
+	else {
 		boost::unique_lock<boost::mutex> lock(eventsMutex_);
 		events.swap(events_);
 	}
@@ -51,12 +66,26 @@ void SingleThreadedEventLoop::handleEvents() {
 }
 
 void SingleThreadedEventLoop::stop() {
+	if (queueType_ == LockFreeQueue) {
+		{
+			boost::unique_lock<boost::mutex> lock(eventsMutex_);
+			shouldShutDown_ = true;
+		}
+		lockFreeEvents_.interrupt();
+		return;
+	}
+
 	boost::unique_lock<boost::mutex> lock(eventsMutex_);
 	shouldShutDown_ = true;
 	eventsAvailable_.notify_one();
 }
 
 void SingleThreadedEventLoop::post(const Event& event) {
+	if (queueType_ == LockFreeQueue) {
+		lockFreeEvents_.push(event);
+		return;
+	}
+
 	boost::lock_guard<boost::mutex> lock(eventsMutex_);
 	events_.push_back(event);
 	eventsAvailable_.notify_one();
@@ -11,6 +11,7 @@
 #include <boost/thread/condition_variable.hpp>
 
 #include "Swiften/EventLoop/EventLoop.h"
+#include "Swiften/EventLoop/LockFreeEventQueue.h"
 
 // DESCRIPTION:
 //
@@ -31,6 +32,9 @@
 // call SingleThreadedEventLoop::handleEvents() on the main GUI thread. For WPF applications, for instance, 
 // the Dispatcher class can be used to execute the call on the GUI thread.
 //
+// Passing LockFreeQueue to the constructor makes posting events lock-free, and only
+// wakes up waitForEvents() when it is actually blocked.
+//
 
 namespace Swift {
 	class SingleThreadedEventLoop : public EventLoop {
@@ -38,7 +42,10 @@ namespace Swift {
 			class EventLoopCanceledException : public std::exception { };
 
 		public:
-			SingleThreadedEventLoop();
+			enum QueueType { LockingQueue, LockFreeQueue };
+
+		public:
+			SingleThreadedEventLoop(QueueType queueType = LockingQueue);
 			~SingleThreadedEventLoop();
 
 			// Blocks while waiting for new events and returns when new events are available.
@@ -50,7 +57,9 @@ namespace Swift {
 			virtual void post(const Event& event);
 			
 		private:
+			QueueType queueType_;
 			bool shouldShutDown_;
+			LockFreeEventQueue lockFreeEvents_;
 			std::vector<Event> events_;
 			boost::mutex eventsMutex_;
 			boost::condition_variable eventsAvailable_;
@@ -20,6 +20,7 @@ class EventLoopTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST_SUITE(EventLoopTest);
 		CPPUNIT_TEST(testPost);
 		CPPUNIT_TEST(testRemove);
+		CPPUNIT_TEST(testRemove_AfterHandlingSomeEvents);
 		CPPUNIT_TEST(testHandleEvent_Recursive);
 		CPPUNIT_TEST_SUITE_END();
 
@@ -59,6 +60,29 @@ class EventLoopTest : public CppUnit::TestFixture {
 			CPPUNIT_ASSERT_EQUAL(3, events_[1]);
 		}
 
+		void testRemove_AfterHandlingSomeEvents() {
+			DummyEventLoop testling;
+			boost::shared_ptr<MyEventOwner> eventOwner1(new MyEventOwner());
+			boost::shared_ptr<MyEventOwner> eventOwner2(new MyEventOwner());
+
+			testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 1), eventOwner1);
+			testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 2), eventOwner2);
+			testling.processEvents();
+			testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 3), eventOwner1);
+			testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 4), eventOwner2);
+			testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 5));
+			testling.removeEventsFromOwner(eventOwner1);
+			testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 6), eventOwner1);
+			testling.processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(5, static_cast<int>(events_.size()));
+			CPPUNIT_ASSERT_EQUAL(1, events_[0]);
+			CPPUNIT_ASSERT_EQUAL(2, events_[1]);
+			CPPUNIT_ASSERT_EQUAL(4, events_[2]);
+			CPPUNIT_ASSERT_EQUAL(5, events_[3]);
+			CPPUNIT_ASSERT_EQUAL(6, events_[4]);
+		}
+
 		void testHandleEvent_Recursive() {
 			DummyEventLoop testling;
 			boost::shared_ptr<MyEventOwner> eventOwner(new MyEventOwner());
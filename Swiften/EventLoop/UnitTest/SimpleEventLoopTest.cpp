@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,9 @@ class SimpleEventLoopTest : public CppUnit::TestFixture {
 		// iterator not incrementable" on XP
 		//CPPUNIT_TEST(testRun);
 		CPPUNIT_TEST(testPostFromMainThread);
+		CPPUNIT_TEST(testPostFromMainThread_LockFreeQueue);
+		CPPUNIT_TEST(testPostFromOtherThreads_LockFreeQueue);
+		CPPUNIT_TEST(testRunOnce_LockFreeQueue);
 		CPPUNIT_TEST_SUITE_END();
 
 	public:
@@ -43,7 +46,52 @@ class SimpleEventLoopTest : public CppUnit::TestFixture {
 			CPPUNIT_ASSERT_EQUAL(1, counter_);
 		}
 
+		void testPostFromMainThread_LockFreeQueue() {
+			SimpleEventLoop testling(SimpleEventLoop::LockFreeQueue);
+			testling.postEvent(boost::bind(&SimpleEventLoopTest::incrementCounterAndStop, this, &testling));
+			testling.run();
+
+			CPPUNIT_ASSERT_EQUAL(1, counter_);
+		}
+
+		void testPostFromOtherThreads_LockFreeQueue() {
+			SimpleEventLoop testling(SimpleEventLoop::LockFreeQueue);
+			boost::thread_group threads;
+			for (int i = 0; i < 4; ++i) {
+				threads.create_thread(boost::bind(&SimpleEventLoopTest::runPostingThread, this, &testling, 1000));
+			}
+			testling.postEvent(boost::bind(&SimpleEventLoopTest::stopWhenCounterReaches, this, &testling, 4000));
+			testling.run();
+			threads.join_all();
+
+			CPPUNIT_ASSERT_EQUAL(4000, counter_);
+		}
+
+		void testRunOnce_LockFreeQueue() {
+			SimpleEventLoop testling(SimpleEventLoop::LockFreeQueue);
+			testling.postEvent(boost::bind(&SimpleEventLoopTest::incrementCounter, this));
+			testling.postEvent(boost::bind(&SimpleEventLoopTest::incrementCounter, this));
+			testling.runOnce();
+
+			CPPUNIT_ASSERT_EQUAL(2, counter_);
+		}
+
 	private:
+		void runPostingThread(SimpleEventLoop* loop, int count) {
+			for (int i = 0; i < count; ++i) {
+				loop->postEvent(boost::bind(&SimpleEventLoopTest::incrementCounter, this));
+			}
+		}
+
+		void stopWhenCounterReaches(SimpleEventLoop* loop, int count) {
+			if (counter_ == count) {
+				loop->stop();
+			}
+			else {
+				loop->postEvent(boost::bind(&SimpleEventLoopTest::stopWhenCounterReaches, this, loop, count));
+			}
+		}
+
 		void runIncrementingThread(SimpleEventLoop* loop) {
 			for (unsigned int i = 0; i < 10; ++i) {
 				Swift::sleep(1);
@@ -32,6 +32,10 @@
 
 using namespace Swift;
 
+// Number of IBB data packets to keep in flight, so that the throughput of
+// in-band transfers isn't bound by the round trip time to the peer.
+static const unsigned int IBB_WINDOW_SIZE = 8;
+
 DefaultFileTransferTransporter::DefaultFileTransferTransporter(
 		const JID& initiator, 
 		const JID& responder,
@@ -150,6 +154,7 @@ boost::shared_ptr<TransportSession> DefaultFileTransferTransporter::createIBBSen
 	boost::shared_ptr<IBBSendSession> ibbSession = boost::make_shared<IBBSendSession>(
 			sessionID, initiator, responder, stream, router);
 	ibbSession->setBlockSize(blockSize);
+	ibbSession->setWindowSize(IBB_WINDOW_SIZE);
 	return boost::make_shared<IBBSendTransportSession>(ibbSession);
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,7 @@ FileReadBytestream::FileReadBytestream(const boost::filesystem::path& file) : fi
 FileReadBytestream::~FileReadBytestream() {
 	if (stream) {
 		stream->close();
+		delete stream;
 		stream = NULL;
 	}
 }
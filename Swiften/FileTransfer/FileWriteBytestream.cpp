@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -18,6 +18,7 @@ FileWriteBytestream::FileWriteBytestream(const boost::filesystem::path& file) :
 FileWriteBytestream::~FileWriteBytestream() {
 	if (stream) {
 		stream->close();
+		delete stream;
 		stream = NULL;
 	}
 }
@@ -37,6 +38,7 @@ void FileWriteBytestream::write(const std::vector<unsigned char>& data) {
 void FileWriteBytestream::close() {
 	if (stream) {
 		stream->close();
+		delete stream;
 		stream = NULL;
 	}
 }
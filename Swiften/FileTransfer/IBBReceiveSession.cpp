@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -29,7 +29,7 @@ class IBBReceiveSession::IBBResponder : public SetResponder<IBB> {
 					if (sequenceNumber == ibb->getSequenceNumber()) {
 						session->bytestream->write(ibb->getData());
 						receivedSize += ibb->getData().size();
-						sequenceNumber++;
+						sequenceNumber = (sequenceNumber + 1) % 65536;
 						sendResponse(from, id, IBB::ref());
 						if (receivedSize >= session->size) {
 							if (receivedSize > session->size) {
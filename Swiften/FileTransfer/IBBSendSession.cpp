@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/FileTransfer/IBBSendSession.h>
 
+#include <cassert>
+
 #include <boost/bind.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
@@ -16,6 +18,8 @@
 
 namespace Swift {
 
+const unsigned int IBBSendSession::minimumBlockSize = 4096;
+
 IBBSendSession::IBBSendSession(
 		const std::string& id, 
 		const JID& from, 
@@ -28,6 +32,8 @@ IBBSendSession::IBBSendSession(
 			bytestream(bytestream), 
 			router(router), 
 			blockSize(4096), 
+			windowSize(1), 
+			pendingDataRequests(0), 
 			sequenceNumber(0), 
 			active(false), 
 			waitingForData(false) {
@@ -39,10 +45,14 @@ IBBSendSession::~IBBSendSession() {
 }
 
 void IBBSendSession::start() {
+	active = true;
+	sendOpen();
+}
+
+void IBBSendSession::sendOpen() {
 	IBBRequest::ref request = IBBRequest::create(
 			from, to, IBB::createIBBOpen(id, boost::numeric_cast<int>(blockSize)), router);
-	request->onResponse.connect(boost::bind(&IBBSendSession::handleIBBResponse, this, _1, _2));
-	active = true;
+	request->onResponse.connect(boost::bind(&IBBSendSession::handleIBBOpenResponse, this, _1, _2));
 	request->send();
 }
 
@@ -53,34 +63,71 @@ void IBBSendSession::stop() {
 	finish(boost::optional<FileTransferError>());
 }
 
-void IBBSendSession::handleIBBResponse(IBB::ref, ErrorPayload::ref error) {
-	if (!error && active) {
-		if (!bytestream->isFinished()) {
-			sendMoreData();
+void IBBSendSession::handleIBBOpenResponse(IBB::ref, ErrorPayload::ref error) {
+	if (!active) {
+		return;
+	}
+	if (error) {
+		// The receiver wants smaller blocks (XEP-0047, Section 2.2)
+		if (error->getCondition() == ErrorPayload::ResourceConstraint && blockSize / 2 >= minimumBlockSize) {
+			blockSize /= 2;
+			sendOpen();
 		}
 		else {
-			finish(boost::optional<FileTransferError>());
+			finish(FileTransferError(FileTransferError::PeerError));
 		}
 	}
+	else if (!bytestream->isFinished()) {
+		sendMoreData();
+	}
 	else {
+		finish(boost::optional<FileTransferError>());
+	}
+}
+
+void IBBSendSession::handleIBBDataResponse(IBB::ref, ErrorPayload::ref error) {
+	assert(pendingDataRequests > 0);
+	pendingDataRequests--;
+	if (!active) {
+		// A previous block already failed
+		return;
+	}
+	if (error) {
 		finish(FileTransferError(FileTransferError::PeerError));
 	}
+	else if (!bytestream->isFinished()) {
+		sendMoreData();
+	}
+	else if (pendingDataRequests == 0) {
+		finish(boost::optional<FileTransferError>());
+	}
 }
 
 void IBBSendSession::sendMoreData() {
 	try {
-		boost::shared_ptr<ByteArray> data = bytestream->read(blockSize);
-		if (!data->empty()) {
+		while (active && pendingDataRequests < windowSize) {
+			boost::shared_ptr<ByteArray> data = bytestream->read(blockSize);
+			if (data->empty()) {
+				// Some streams only notice they are finished when reading
+				if (bytestream->isFinished()) {
+					if (pendingDataRequests == 0) {
+						finish(boost::optional<FileTransferError>());
+					}
+				}
+				else {
+					waitingForData = true;
+				}
+				break;
+			}
 			waitingForData = false;
 			IBBRequest::ref request = IBBRequest::create(from, to, IBB::createIBBData(id, sequenceNumber, *data), router);
-			sequenceNumber++;
-			request->onResponse.connect(boost::bind(&IBBSendSession::handleIBBResponse, this, _1, _2));
+			// Sequence numbers wrap around after 65535 (XEP-0047, Section 2.2)
+			sequenceNumber = (sequenceNumber + 1) % 65536;
+			pendingDataRequests++;
+			request->onResponse.connect(boost::bind(&IBBSendSession::handleIBBDataResponse, this, _1, _2));
 			request->send();
 			onBytesSent(data->size());
 		}
-		else {
-			waitingForData = true;
-		}
 	}
 	catch (const BytestreamException&) {
 		finish(FileTransferError(FileTransferError::ReadError));
@@ -93,7 +140,7 @@ void IBBSendSession::finish(boost::optional<FileTransferError> error) {
 }
 
 void IBBSendSession::handleDataAvailable() {
-	if (waitingForData) {
+	if (waitingForData && active) {
 		sendMoreData();
 	}
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -41,15 +41,41 @@ namespace Swift {
 				return to;
 			}
 
+			/**
+			 * Sets the block size to request when opening the session.
+			 *
+			 * If the receiver rejects the block size as too large, the
+			 * session is reopened with half the block size, as long as it
+			 * stays at least minimumBlockSize.
+			 */
 			void setBlockSize(unsigned int blockSize) {
 				this->blockSize = blockSize;
 			}
 
+			unsigned int getBlockSize() const {
+				return blockSize;
+			}
+
+			/**
+			 * Sets the maximum number of data packets that can be waiting for
+			 * an acknowledgement at the same time (default: 1).
+			 *
+			 * A larger window avoids waiting a full round trip for every
+			 * block.
+			 */
+			void setWindowSize(unsigned int windowSize) {
+				this->windowSize = windowSize;
+			}
+
 			boost::signal<void (boost::optional<FileTransferError>)> onFinished;
 			boost::signal<void (size_t)> onBytesSent;
 
+			static const unsigned int minimumBlockSize;
+
 		private:
-			void handleIBBResponse(IBB::ref, ErrorPayload::ref);
+			void sendOpen();
+			void handleIBBOpenResponse(IBB::ref, ErrorPayload::ref);
+			void handleIBBDataResponse(IBB::ref, ErrorPayload::ref);
 			void finish(boost::optional<FileTransferError>);
 			void sendMoreData();
 			void handleDataAvailable();
@@ -61,6 +87,8 @@ namespace Swift {
 			boost::shared_ptr<ReadBytestream> bytestream;
 			IQRouter* router;
 			unsigned int blockSize;
+			unsigned int windowSize;
+			unsigned int pendingDataRequests;
 			int sequenceNumber;
 			bool active;
 			bool waitingForData;
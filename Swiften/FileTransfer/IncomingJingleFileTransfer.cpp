@@ -70,8 +70,11 @@ void IncomingJingleFileTransfer::accept(
 
 	assert(!hashCalculator);
 
-	hashCalculator = new IncrementalBytestreamHashCalculator(
-			hashes.find("md5") != hashes.end(), hashes.find("sha-1") != hashes.end(), crypto);
+	std::vector<std::string> hashAlgorithms;
+	foreach(const JingleFileTransferFileInfo::HashElementMap::value_type& hashElement, hashes) {
+		hashAlgorithms.push_back(hashElement.first);
+	}
+	hashCalculator = new IncrementalBytestreamHashCalculator(hashAlgorithms, crypto);
 
 	writeStreamDataReceivedConnection = stream->onWrite.connect(
 			boost::bind(&IncomingJingleFileTransfer::handleWriteStreamDataReceived, this, _1));
@@ -137,11 +140,10 @@ void IncomingJingleFileTransfer::handleSessionInfoReceived(JinglePayload::ref ji
 	if (transferHash) {
 		SWIFT_LOG(debug) << "Received hash information." << std::endl;
 		waitOnHashTimer->stop();
-		if (transferHash->getFileInfo().getHashes().find("sha-1") != transferHash->getFileInfo().getHashes().end()) {
-			hashes["sha-1"] = transferHash->getFileInfo().getHash("sha-1").get();
-		}
-		else if (transferHash->getFileInfo().getHashes().find("md5") != transferHash->getFileInfo().getHashes().end()) {
-			hashes["md5"] = transferHash->getFileInfo().getHash("md5").get();
+		foreach(const JingleFileTransferFileInfo::HashElementMap::value_type& hashElement, transferHash->getFileInfo().getHashes()) {
+			if (hashCalculator && hashCalculator->hasHash(hashElement.first)) {
+				hashes[hashElement.first] = hashElement.second;
+			}
 		}
 		if (state == WaitingForHash) {
 			checkHashAndTerminate();
@@ -246,18 +248,18 @@ bool IncomingJingleFileTransfer::verifyData() {
 		SWIFT_LOG(debug) << "no verification possible, skipping" << std::endl;
 		return true;
 	} 
-	if (hashes.find("sha-1") != hashes.end()) {
-		SWIFT_LOG(debug) << "Verify SHA-1 hash: " << (hashes["sha-1"] == hashCalculator->getSHA1Hash()) << std::endl;
-		return hashes["sha-1"] == hashCalculator->getSHA1Hash();
-	}
-	else if (hashes.find("md5") != hashes.end()) {
-		SWIFT_LOG(debug) << "Verify MD5 hash: " << (hashes["md5"] == hashCalculator->getMD5Hash()) << std::endl;
-		return hashes["md5"] == hashCalculator->getMD5Hash();
-	}
-	else {
-		SWIFT_LOG(debug) << "Unknown hash, skipping" << std::endl;
-		return true;
+	// Verify the strongest hash we have
+	static const char* algorithms[] = { "sha-256", "sha-1", "md5" };
+	for (size_t i = 0; i < sizeof(algorithms) / sizeof(algorithms[0]); ++i) {
+		std::map<std::string, ByteArray>::const_iterator hash = hashes.find(algorithms[i]);
+		if (hash != hashes.end() && !hash->second.empty() && hashCalculator->hasHash(algorithms[i])) {
+			bool verified = hash->second == hashCalculator->getHash(algorithms[i]);
+			SWIFT_LOG(debug) << "Verify " << algorithms[i] << " hash: " << verified << std::endl;
+			return verified;
+		}
 	}
+	SWIFT_LOG(debug) << "Unknown hash, skipping" << std::endl;
+	return true;
 }
 
 void IncomingJingleFileTransfer::handleWaitOnHashTimerTicked() {
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2013-2014 Isode Limited.
+ * Copyright (c) 2013-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,63 +13,159 @@
 
 #include <Swiften/FileTransfer/IncrementalBytestreamHashCalculator.h>
 
+#include <cassert>
+#include <deque>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <Swiften/Base/foreach.h>
 #include <Swiften/StringCodecs/Hexify.h>
 #include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/Hash.h>
 
 namespace Swift {
 
+// Maximum number of buffers waiting to be hashed, before feedData() blocks
+static const size_t MAX_QUEUED_BUFFERS = 32;
+
+class IncrementalBytestreamHashCalculator::Worker {
+	public:
+		Worker(Hash* hash) : hash(hash), busy(false), stopped(false) {
+			thread = new boost::thread(boost::bind(&Worker::run, this));
+		}
+
+		~Worker() {
+			{
+				boost::lock_guard<boost::mutex> lock(mutex);
+				stopped = true;
+			}
+			dataAvailable.notify_one();
+			thread->join();
+			delete thread;
+		}
+
+		void feedData(boost::shared_ptr<const ByteArray> data) {
+			boost::unique_lock<boost::mutex> lock(mutex);
+			assert(!result);
+			while (queue.size() >= MAX_QUEUED_BUFFERS) {
+				dataHashed.wait(lock);
+			}
+			queue.push_back(data);
+			dataAvailable.notify_one();
+		}
+
+		ByteArray getHash() {
+			boost::unique_lock<boost::mutex> lock(mutex);
+			while (!queue.empty() || busy) {
+				dataHashed.wait(lock);
+			}
+			if (!result) {
+				result = hash->getHash();
+			}
+			return *result;
+		}
+
+	private:
+		void run() {
+			boost::unique_lock<boost::mutex> lock(mutex);
+			while (true) {
+				while (queue.empty() && !stopped) {
+					dataAvailable.wait(lock);
+				}
+				if (stopped) {
+					return;
+				}
+				boost::shared_ptr<const ByteArray> data = queue.front();
+				queue.pop_front();
+				busy = true;
+				lock.unlock();
+				hash->update(*data);
+				lock.lock();
+				busy = false;
+				dataHashed.notify_all();
+			}
+		}
+
+	private:
+		boost::scoped_ptr<Hash> hash;
+		boost::thread* thread;
+		boost::mutex mutex;
+		boost::condition_variable dataAvailable;
+		boost::condition_variable dataHashed;
+		std::deque< boost::shared_ptr<const ByteArray> > queue;
+		bool busy;
+		bool stopped;
+		boost::optional<ByteArray> result;
+};
+
 IncrementalBytestreamHashCalculator::IncrementalBytestreamHashCalculator(bool doMD5, bool doSHA1, CryptoProvider* crypto) {
-	md5Hasher = doMD5 ? crypto->createMD5() : NULL;
-	sha1Hasher = doSHA1 ? crypto->createSHA1() : NULL;
+	if (doMD5) {
+		addWorker("md5", crypto);
+	}
+	if (doSHA1) {
+		addWorker("sha-1", crypto);
+	}
+}
+
+IncrementalBytestreamHashCalculator::IncrementalBytestreamHashCalculator(const std::vector<std::string>& algorithms, CryptoProvider* crypto) {
+	foreach (const std::string& algorithm, algorithms) {
+		addWorker(algorithm, crypto);
+	}
 }
 
 IncrementalBytestreamHashCalculator::~IncrementalBytestreamHashCalculator() {
-	delete md5Hasher;
-	delete sha1Hasher;
 }
 
-void IncrementalBytestreamHashCalculator::feedData(const ByteArray& data) {
-	if (md5Hasher) {
-		md5Hasher->update(data);
+void IncrementalBytestreamHashCalculator::addWorker(const std::string& algorithm, CryptoProvider* crypto) {
+	if (workers.find(algorithm) != workers.end()) {
+		return;
 	}
-	if (sha1Hasher) {
-		sha1Hasher->update(data);
+	if (Hash* hash = crypto->createHash(algorithm)) {
+		workers[algorithm] = boost::make_shared<Worker>(hash);
 	}
 }
-/*
-void IncrementalBytestreamHashCalculator::feedData(const SafeByteArray& data) {
-	if (md5Hasher) {
-		md5Hasher->update(createByteArray(data.data(), data.size()));
+
+void IncrementalBytestreamHashCalculator::feedData(const ByteArray& data) {
+	if (workers.empty() || data.empty()) {
+		return;
 	}
-	if (sha1Hasher) {
-		sha1Hasher->update(createByteArray(data.data(), data.size()));
+	// All workers share a single copy of the data
+	boost::shared_ptr<const ByteArray> sharedData = boost::make_shared<ByteArray>(data);
+	typedef std::map<std::string, boost::shared_ptr<Worker> >::value_type WorkerPair;
+	foreach (const WorkerPair& worker, workers) {
+		worker.second->feedData(sharedData);
 	}
-}*/
+}
+
+bool IncrementalBytestreamHashCalculator::hasHash(const std::string& algorithm) const {
+	return workers.find(algorithm) != workers.end();
+}
+
+ByteArray IncrementalBytestreamHashCalculator::getHash(const std::string& algorithm) {
+	std::map<std::string, boost::shared_ptr<Worker> >::const_iterator i = workers.find(algorithm);
+	assert(i != workers.end());
+	return i->second->getHash();
+}
 
 ByteArray IncrementalBytestreamHashCalculator::getSHA1Hash() {
-	assert(sha1Hasher);
-	if (!sha1Hash) {
-		sha1Hash = sha1Hasher->getHash();
-	}
-	return *sha1Hash;
+	return getHash("sha-1");
 }
 
 ByteArray IncrementalBytestreamHashCalculator::getMD5Hash() {
-	assert(md5Hasher);
-	if (!md5Hash) {
-		md5Hash = md5Hasher->getHash();
-	}
-	return *md5Hash;
+	return getHash("md5");
 }
 
 std::string IncrementalBytestreamHashCalculator::getSHA1String() {
-	assert(sha1Hasher);
-	return Hexify::hexify(getSHA1Hash());;
+	return Hexify::hexify(getSHA1Hash());
 }
 
 std::string IncrementalBytestreamHashCalculator::getMD5String() {
-	assert(md5Hasher);
-	return Hexify::hexify(getMD5Hash());;
+	return Hexify::hexify(getMD5Hash());
 }
 
 }
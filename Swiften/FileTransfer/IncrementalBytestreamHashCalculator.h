@@ -5,30 +5,51 @@
  */
 
 /*
- * Copyright (c) 2013-2014 Isode Limited.
+ * Copyright (c) 2013-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include <Swiften/Base/ByteArray.h>
-#include <Swiften/Base/SafeByteArray.h>
 #include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace Swift {
-	class Hash;
 	class CryptoProvider;
 
+	/**
+	 * Calculates hashes over data as it is being transferred.
+	 *
+	 * Every hash is calculated on its own worker thread, so that hashing
+	 * overlaps with the transfer itself. When the workers fall behind,
+	 * feedData() blocks until they have caught up.
+	 */
 	class IncrementalBytestreamHashCalculator {
 	public:
 		IncrementalBytestreamHashCalculator(bool doMD5, bool doSHA1, CryptoProvider* crypto);
+
+		/**
+		 * Calculates the hashes for the given algorithms, named as in hash
+		 * elements (e.g. "sha-256"). Unsupported algorithms are ignored.
+		 */
+		IncrementalBytestreamHashCalculator(const std::vector<std::string>& algorithms, CryptoProvider* crypto);
 		~IncrementalBytestreamHashCalculator();
 
 		void feedData(const ByteArray& data);
-		//void feedData(const SafeByteArray& data);
+
+		bool hasHash(const std::string& algorithm) const;
+
+		/**
+		 * Waits until all data fed so far has been hashed, and returns the
+		 * hash for the given algorithm. After this, no more data can be fed.
+		 */
+		ByteArray getHash(const std::string& algorithm);
 
 		ByteArray getSHA1Hash();
 		ByteArray getMD5Hash();
@@ -37,10 +58,12 @@ namespace Swift {
 		std::string getMD5String();
 
 	private:
-		Hash* md5Hasher;
-		Hash* sha1Hasher;
-		boost::optional<ByteArray> md5Hash;
-		boost::optional<ByteArray> sha1Hash;
+		class Worker;
+
+		void addWorker(const std::string& algorithm, CryptoProvider* crypto);
+
+	private:
+		std::map<std::string, boost::shared_ptr<Worker> > workers;
 	};
 
 }
@@ -42,7 +42,7 @@
 
 using namespace Swift;
 
-static const int DEFAULT_BLOCK_SIZE = 4096;
+static const int DEFAULT_BLOCK_SIZE = 16384;
 
 OutgoingJingleFileTransfer::OutgoingJingleFileTransfer(
 		const JID& toJID,
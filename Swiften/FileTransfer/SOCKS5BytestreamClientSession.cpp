@@ -39,6 +39,8 @@ SOCKS5BytestreamClientSession::SOCKS5BytestreamClientSession(
 	weFailedTimeout = timerFactory->createTimer(3000);
 	weFailedTimeout->onTick.connect(
 			boost::bind(&SOCKS5BytestreamClientSession::handleWeFailedTimeout, this));
+	// Only file data and the SOCKS5 handshake are received
+	connection->setWipeReadBuffers(false);
 }
 
 SOCKS5BytestreamClientSession::~SOCKS5BytestreamClientSession() {
@@ -190,7 +192,7 @@ void SOCKS5BytestreamClientSession::sendData() {
 	if (!readBytestream->isFinished()) {
 		try {
 			boost::shared_ptr<ByteArray> dataToSend = readBytestream->read(boost::numeric_cast<size_t>(chunkSize));
-			connection->write(createSafeByteArray(*dataToSend));
+			connection->writeShared(boost::shared_ptr<const ByteArray>(dataToSend));
 			onBytesSent(dataToSend->size());
 		}
 		catch (const BytestreamException&) {
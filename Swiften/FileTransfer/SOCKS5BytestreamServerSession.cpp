@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -30,6 +30,8 @@ SOCKS5BytestreamServerSession::SOCKS5BytestreamServerSession(
 			chunkSize(131072), 
 			waitingForData(false) {
 	disconnectedConnection = connection->onDisconnected.connect(boost::bind(&SOCKS5BytestreamServerSession::handleDisconnected, this, _1));
+	// Only file data and the SOCKS5 handshake are received
+	connection->setWipeReadBuffers(false);
 }
 
 SOCKS5BytestreamServerSession::~SOCKS5BytestreamServerSession() {
@@ -158,10 +160,10 @@ void SOCKS5BytestreamServerSession::process() {
 void SOCKS5BytestreamServerSession::sendData() {
 	if (!readBytestream->isFinished()) {
 		try {
-			SafeByteArray dataToSend = createSafeByteArray(*readBytestream->read(boost::numeric_cast<size_t>(chunkSize)));
-			if (!dataToSend.empty()) {
-				connection->write(dataToSend);
-				onBytesSent(dataToSend.size());
+			boost::shared_ptr<ByteArray> dataToSend = readBytestream->read(boost::numeric_cast<size_t>(chunkSize));
+			if (!dataToSend->empty()) {
+				connection->writeShared(boost::shared_ptr<const ByteArray>(dataToSend));
+				onBytesSent(dataToSend->size());
 				waitingForData = false;
 			}
 			else {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -30,6 +30,12 @@ class IBBSendSessionTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST(testDataStreamResumeAfterPauseSendsData);
 		CPPUNIT_TEST(testDataStreamResumeBeforePauseDoesNotSendData);
 		CPPUNIT_TEST(testDataStreamResumeAfterResumeDoesNotSendData);
+		CPPUNIT_TEST(testWindow_ResponseSendsUpToWindowSize);
+		CPPUNIT_TEST(testWindow_ResponseContinuesSending);
+		CPPUNIT_TEST(testWindow_FinishesAfterAllResponses);
+		CPPUNIT_TEST(testWindow_ErrorResponseFinishesOnce);
+		CPPUNIT_TEST(testResourceConstraintOnOpenRetriesWithSmallerBlockSize);
+		CPPUNIT_TEST(testResourceConstraintOnOpenWithMinimumBlockSizeFinishesWithError);
 
 		CPPUNIT_TEST_SUITE_END();
 
@@ -202,7 +208,110 @@ class IBBSendSessionTest : public CppUnit::TestFixture {
 			CPPUNIT_ASSERT_EQUAL(5, static_cast<int>(stanzaChannel->sentStanzas.size()));
 		}
 
+		void testWindow_ResponseSendsUpToWindowSize() {
+			boost::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+			testling->setBlockSize(3);
+			testling->setWindowSize(2);
+			testling->start();
+
+			stanzaChannel->onIQReceived(createIBBResult());
+
+			CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(stanzaChannel->sentStanzas.size()));
+			IBB::ref ibb = stanzaChannel->sentStanzas[1]->getPayload<IBB>();
+			CPPUNIT_ASSERT(createByteArray("abc") == ibb->getData());
+			CPPUNIT_ASSERT_EQUAL(0, ibb->getSequenceNumber());
+			ibb = stanzaChannel->sentStanzas[2]->getPayload<IBB>();
+			CPPUNIT_ASSERT(createByteArray("def") == ibb->getData());
+			CPPUNIT_ASSERT_EQUAL(1, ibb->getSequenceNumber());
+		}
+
+		void testWindow_ResponseContinuesSending() {
+			boost::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+			testling->setBlockSize(3);
+			testling->setWindowSize(2);
+			testling->start();
+			stanzaChannel->onIQReceived(createIBBResult());
+
+			stanzaChannel->onIQReceived(createIBBResult(1));
+
+			CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(stanzaChannel->sentStanzas.size()));
+			IBB::ref ibb = stanzaChannel->sentStanzas[3]->getPayload<IBB>();
+			CPPUNIT_ASSERT(createByteArray("g") == ibb->getData());
+			CPPUNIT_ASSERT_EQUAL(2, ibb->getSequenceNumber());
+		}
+
+		void testWindow_FinishesAfterAllResponses() {
+			boost::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+			testling->setBlockSize(3);
+			testling->setWindowSize(4);
+			testling->start();
+			stanzaChannel->onIQReceived(createIBBResult());
+			stanzaChannel->onIQReceived(createIBBResult(1));
+			stanzaChannel->onIQReceived(createIBBResult(3));
+
+			CPPUNIT_ASSERT(!finished);
+
+			stanzaChannel->onIQReceived(createIBBResult(2));
+
+			CPPUNIT_ASSERT(finished);
+			CPPUNIT_ASSERT(!error);
+			CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(stanzaChannel->sentStanzas.size()));
+		}
+
+		void testWindow_ErrorResponseFinishesOnce() {
+			boost::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+			testling->setBlockSize(3);
+			testling->setWindowSize(4);
+			testling->start();
+			stanzaChannel->onIQReceived(createIBBResult());
+			stanzaChannel->onIQReceived(createIBBError(1));
+			CPPUNIT_ASSERT(finished);
+			CPPUNIT_ASSERT(error);
+
+			finished = false;
+			stanzaChannel->onIQReceived(createIBBError(2));
+			stanzaChannel->onIQReceived(createIBBResult(3));
+
+			CPPUNIT_ASSERT(!finished);
+			CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(stanzaChannel->sentStanzas.size()));
+		}
+
+		void testResourceConstraintOnOpenRetriesWithSmallerBlockSize() {
+			boost::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+			testling->setBlockSize(16384);
+			testling->start();
+
+			stanzaChannel->onIQReceived(createIBBError(0, ErrorPayload::ResourceConstraint));
+
+			CPPUNIT_ASSERT(!finished);
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(stanzaChannel->sentStanzas.size()));
+			IBB::ref ibb = stanzaChannel->sentStanzas[1]->getPayload<IBB>();
+			CPPUNIT_ASSERT_EQUAL(IBB::Open, ibb->getAction());
+			CPPUNIT_ASSERT_EQUAL(8192, ibb->getBlockSize());
+			CPPUNIT_ASSERT_EQUAL(8192U, testling->getBlockSize());
+		}
+
+		void testResourceConstraintOnOpenWithMinimumBlockSizeFinishesWithError() {
+			boost::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+			testling->setBlockSize(IBBSendSession::minimumBlockSize);
+			testling->start();
+
+			stanzaChannel->onIQReceived(createIBBError(0, ErrorPayload::ResourceConstraint));
+
+			CPPUNIT_ASSERT(finished);
+			CPPUNIT_ASSERT(error);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(stanzaChannel->sentStanzas.size()));
+		}
+
 	private:
+		IQ::ref createIBBResult(size_t index) {
+			return IQ::createResult(JID("baz@fum.com/dum"), stanzaChannel->sentStanzas[index]->getTo(), stanzaChannel->sentStanzas[index]->getID(), boost::shared_ptr<IBB>());
+		}
+
+		IQ::ref createIBBError(size_t index, ErrorPayload::Condition condition = ErrorPayload::BadRequest) {
+			return IQ::createError(JID("baz@fum.com/dum"), stanzaChannel->sentStanzas[index]->getTo(), stanzaChannel->sentStanzas[index]->getID(), condition);
+		}
+
 		IQ::ref createIBBResult() {
 			return IQ::createResult(JID("baz@fum.com/dum"), stanzaChannel->sentStanzas[stanzaChannel->sentStanzas.size()-1]->getTo(), stanzaChannel->sentStanzas[stanzaChannel->sentStanzas.size()-1]->getID(), boost::shared_ptr<IBB>());
 		}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+#include <Swiften/FileTransfer/IncrementalBytestreamHashCalculator.h>
+#include <Swiften/StringCodecs/Hexify.h>
+
+using namespace Swift;
+
+class IncrementalBytestreamHashCalculatorTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(IncrementalBytestreamHashCalculatorTest);
+		CPPUNIT_TEST(testGetHash_NoData);
+		CPPUNIT_TEST(testGetHash_ManyBlocks);
+		CPPUNIT_TEST(testGetHash_Twice);
+		CPPUNIT_TEST(testConstructor_Algorithms);
+		CPPUNIT_TEST(testConstructor_UnsupportedAlgorithmIsIgnored);
+		CPPUNIT_TEST(testDestructor_PendingData);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void setUp() {
+			crypto = boost::shared_ptr<CryptoProvider>(PlatformCryptoProvider::create());
+		}
+
+		void testGetHash_NoData() {
+			IncrementalBytestreamHashCalculator testling(true, true, crypto.get());
+
+			CPPUNIT_ASSERT_EQUAL(std::string("d41d8cd98f00b204e9800998ecf8427e"), testling.getMD5String());
+			CPPUNIT_ASSERT_EQUAL(std::string("da39a3ee5e6b4b0d3255bfef95601890afd80709"), testling.getSHA1String());
+		}
+
+		void testGetHash_ManyBlocks() {
+			IncrementalBytestreamHashCalculator testling(true, true, crypto.get());
+
+			feedData(testling);
+
+			CPPUNIT_ASSERT_EQUAL(std::string("af1bc752b875dc5d090a75e48cdba75f"), testling.getMD5String());
+			CPPUNIT_ASSERT_EQUAL(std::string("7135b147e1bccf14ef546b6c618e131079dd770e"), testling.getSHA1String());
+		}
+
+		void testGetHash_Twice() {
+			IncrementalBytestreamHashCalculator testling(false, true, crypto.get());
+			feedData(testling);
+
+			testling.getSHA1Hash();
+
+			CPPUNIT_ASSERT_EQUAL(std::string("7135b147e1bccf14ef546b6c618e131079dd770e"), testling.getSHA1String());
+		}
+
+		void testConstructor_Algorithms() {
+			std::vector<std::string> algorithms;
+			algorithms.push_back("sha-256");
+			algorithms.push_back("sha-1");
+			IncrementalBytestreamHashCalculator testling(algorithms, crypto.get());
+
+			feedData(testling);
+
+			CPPUNIT_ASSERT(testling.hasHash("sha-1"));
+			CPPUNIT_ASSERT(testling.hasHash("sha-256"));
+			CPPUNIT_ASSERT(!testling.hasHash("md5"));
+			CPPUNIT_ASSERT_EQUAL(std::string("d7add55e9e60011ea1c74158d390e936b32c266cd7bcaaf1a32c0251ee95e8e3"), Hexify::hexify(testling.getHash("sha-256")));
+			CPPUNIT_ASSERT_EQUAL(std::string("7135b147e1bccf14ef546b6c618e131079dd770e"), testling.getSHA1String());
+		}
+
+		void testConstructor_UnsupportedAlgorithmIsIgnored() {
+			std::vector<std::string> algorithms;
+			algorithms.push_back("sha3-256");
+			algorithms.push_back("md5");
+			IncrementalBytestreamHashCalculator testling(algorithms, crypto.get());
+
+			CPPUNIT_ASSERT(!testling.hasHash("sha3-256"));
+			CPPUNIT_ASSERT(testling.hasHash("md5"));
+		}
+
+		void testDestructor_PendingData() {
+			{
+				IncrementalBytestreamHashCalculator testling(true, true, crypto.get());
+				feedData(testling);
+			}
+		}
+
+	private:
+		// Feeds 1000000 bytes in 4000 byte blocks
+		void feedData(IncrementalBytestreamHashCalculator& calculator) {
+			ByteArray block(4000);
+			for (size_t offset = 0; offset < 1000000; offset += block.size()) {
+				for (size_t i = 0; i < block.size(); ++i) {
+					size_t position = offset + i;
+					block[i] = static_cast<unsigned char>((position * 7 + position / 251) % 256);
+				}
+				calculator.feedData(block);
+			}
+		}
+
+	private:
+		boost::shared_ptr<CryptoProvider> crypto;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IncrementalBytestreamHashCalculatorTest);
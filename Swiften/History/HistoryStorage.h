@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -27,7 +27,27 @@ namespace Swift {
 			virtual std::vector<HistoryMessage> getMessagesFromDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const = 0;
 			virtual std::vector<HistoryMessage> getMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const = 0;
 			virtual std::vector<HistoryMessage> getMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const = 0;
+
+			/**
+			 * Returns the contacts, with the dates of the conversations, of
+			 * the messages from or to \p selfJID that contain all words of
+			 * \p keyword. An empty keyword matches all messages.
+			 *
+			 * Words consist of letters and digits, and a word of the keyword
+			 * matches every word in a message that starts with it, ignoring
+			 * case. So "Hel wor" matches "Hello, world!", and "ello" doesn't.
+			 */
 			virtual ContactsMap getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) const = 0;
+
+			/**
+			 * Returns the messages from or to \p selfJID that contain all
+			 * words of \p keyword (as for getContacts()), most relevant
+			 * first. An empty keyword matches no messages.
+			 *
+			 * At most \p maxResults messages are returned, starting at
+			 * the hit with index \p firstResult.
+			 */
+			virtual std::vector<HistoryMessage> searchMessages(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword, size_t firstResult, size_t maxResults) const = 0;
 			virtual boost::posix_time::ptime getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) const = 0;
 	};
 }
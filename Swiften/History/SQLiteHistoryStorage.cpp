@@ -1,80 +1,318 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <iostream>
+#include <limits>
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <sqlite3.h>
 #include <Swiften/History/SQLiteHistoryStorage.h>
 #include <boost/date_time/gregorian/gregorian.hpp>
+#include <Swiften/Base/foreach.h>
 #include <Swiften/Base/Path.h>
 
-inline std::string getEscapedString(const std::string& s) {
-	std::string result(s);
+namespace {
+	long long getSecondsSinceEpoch(const boost::posix_time::ptime& time) {
+		return (time - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
+	}
 
-	size_t pos = result.find('\'');
-	while (pos != std::string::npos) {
-		result.insert(pos, "'");
-		pos = result.find('\'', pos + 2);
+	boost::posix_time::ptime getTimeFromSecondsSinceEpoch(long long secondsSinceEpoch) {
+		return boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(static_cast<long>(secondsSinceEpoch)));
+	}
+
+	/**
+	 * The string is not copied, so it should stay valid until the statement
+	 * is reset.
+	 */
+	void bindText(sqlite3_stmt* statement, int index, const std::string& text) {
+		sqlite3_bind_text(statement, index, text.c_str(), boost::numeric_cast<int>(text.size()), SQLITE_STATIC);
+	}
+
+	std::string getColumnText(sqlite3_stmt* statement, int column) {
+		const unsigned char* text = sqlite3_column_text(statement, column);
+		return text ? std::string(reinterpret_cast<const char*>(text)) : std::string();
+	}
+
+	/**
+	 * Bytes of multi-byte UTF-8 characters count as word characters, as
+	 * they do for the FTS5 tokenizer (which also treats non-ASCII
+	 * punctuation as separators).
+	 */
+	bool isWordCharacter(unsigned char c) {
+		return c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+	}
+
+	unsigned char toLower(unsigned char c) {
+		return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+	}
+
+	/**
+	 * Splits the keyword into the lower case words it is searched for.
+	 */
+	std::vector<std::string> getWords(const std::string& keyword) {
+		std::vector<std::string> words;
+		std::string word;
+		for (size_t i = 0; i <= keyword.size(); ++i) {
+			if (i < keyword.size() && isWordCharacter(static_cast<unsigned char>(keyword[i]))) {
+				word += static_cast<char>(toLower(static_cast<unsigned char>(keyword[i])));
+			}
+			else if (!word.empty()) {
+				words.push_back(word);
+				word.clear();
+			}
+		}
+		return words;
+	}
+
+	/**
+	 * Creates an FTS5 query that matches all words, also when they are the
+	 * start of a longer word.
+	 */
+	std::string getFullTextQuery(const std::vector<std::string>& words) {
+		std::string query;
+		foreach (const std::string& word, words) {
+			if (!query.empty()) {
+				query += " ";
+			}
+			query += "\"" + word + "\"*";
+		}
+		return query;
+	}
+
+	/**
+	 * SQL function has_word_prefix(text, word), which returns whether a
+	 * word in the text starts with the (lower case) word, ignoring case.
+	 * Without a full-text index, this gives keyword searches the same
+	 * results as the index.
+	 */
+	void hasWordPrefix(sqlite3_context* context, int, sqlite3_value** arguments) {
+		const unsigned char* text = sqlite3_value_text(arguments[0]);
+		const unsigned char* word = sqlite3_value_text(arguments[1]);
+		if (!text || !word) {
+			sqlite3_result_int(context, 0);
+			return;
+		}
+		bool atWordStart = true;
+		for (const unsigned char* p = text; *p; ++p) {
+			if (atWordStart && isWordCharacter(*p)) {
+				size_t i = 0;
+				while (word[i] && toLower(p[i]) == word[i]) {
+					++i;
+				}
+				if (!word[i]) {
+					sqlite3_result_int(context, 1);
+					return;
+				}
+			}
+			atWordStart = !isWordCharacter(*p);
+		}
+		sqlite3_result_int(context, 0);
 	}
-	return result;
 }
 
 namespace Swift {
 
-SQLiteHistoryStorage::SQLiteHistoryStorage(const boost::filesystem::path& file) : db_(0) {
-	thread_ = new boost::thread(boost::bind(&SQLiteHistoryStorage::run, this));
-
+SQLiteHistoryStorage::SQLiteHistoryStorage(const boost::filesystem::path& file, bool useFullTextIndex) : db_(0), hasFullTextIndex_(false), stopping_(false) {
 	sqlite3_open(pathToString(file).c_str(), &db_);
 	if (!db_) {
 		std::cerr << "Error opening database " << pathToString(file) << std::endl;
 	}
+	sqlite3_create_function(db_, "has_word_prefix", 2, SQLITE_UTF8, NULL, &hasWordPrefix, NULL, NULL);
 
-	char* errorMessage;
-	int result = sqlite3_exec(db_, "CREATE TABLE IF NOT EXISTS messages('message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER)", 0, 0, &errorMessage);
-	if (result != SQLITE_OK) {
-		std::cerr << "SQL Error: " << errorMessage << std::endl;
-		sqlite3_free(errorMessage);
+	// With a write-ahead log, readers don't block on the writer thread, and
+	// commits don't need to sync the whole database.
+	execute("PRAGMA journal_mode=WAL");
+	execute("PRAGMA synchronous=NORMAL");
+
+	execute("CREATE TABLE IF NOT EXISTS messages('message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER)");
+	execute("CREATE TABLE IF NOT EXISTS jids('id' INTEGER PRIMARY KEY ASC AUTOINCREMENT, 'jid' STRING UNIQUE NOT NULL)");
+
+	// Conversations are looked up in both directions
+	execute("CREATE INDEX IF NOT EXISTS messages_from ON messages('fromBare', 'toBare', 'type', 'time')");
+	execute("CREATE INDEX IF NOT EXISTS messages_to ON messages('toBare', 'fromBare', 'type', 'time')");
+
+	if (useFullTextIndex) {
+		bool indexExists = sqlite3_exec(db_, "SELECT rowid FROM messages_fts LIMIT 0", 0, 0, 0) == SQLITE_OK;
+		if (!indexExists) {
+			indexExists = sqlite3_exec(db_, "CREATE VIRTUAL TABLE messages_fts USING fts5(message, content='messages', content_rowid='rowid')", 0, 0, 0) == SQLITE_OK;
+		}
+		if (indexExists) {
+			hasFullTextIndex_ = true;
+			updateFullTextIndex();
+		}
 	}
 
-	result = sqlite3_exec(db_, "CREATE TABLE IF NOT EXISTS jids('id' INTEGER PRIMARY KEY ASC AUTOINCREMENT, 'jid' STRING UNIQUE NOT NULL)", 0, 0, &errorMessage);
-	if (result != SQLITE_OK) {
-		std::cerr << "SQL Error: " << errorMessage << std::endl;
-		sqlite3_free(errorMessage);
+	thread_ = new boost::thread(boost::bind(&SQLiteHistoryStorage::run, this));
+}
+
+void SQLiteHistoryStorage::updateFullTextIndex() {
+	// The full-text index refers to the messages by rowid, and the last
+	// indexed rowid is stored along with it. Messages that were added
+	// without updating the index (e.g. by a build whose SQLite lacks FTS5)
+	// are indexed here. A VACUUM can renumber the rowids after messages
+	// were deleted, which lowers the highest rowid; the index is then
+	// rebuilt from scratch.
+	execute("CREATE TABLE IF NOT EXISTS messages_fts_state('lastRowID' INTEGER)");
+	// Without a recorded rowid, the index is rebuilt
+	long long lastRowID = -1;
+	sqlite3_stmt* selectStatement = getStatement("SELECT lastRowID FROM messages_fts_state");
+	if (selectStatement) {
+		if (sqlite3_step(selectStatement) == SQLITE_ROW) {
+			lastRowID = sqlite3_column_int64(selectStatement, 0);
+		}
+		sqlite3_reset(selectStatement);
+	}
+
+	long long maxRowID = 0;
+	selectStatement = getStatement("SELECT ifnull(max(rowid), 0) FROM messages");
+	if (selectStatement) {
+		if (sqlite3_step(selectStatement) == SQLITE_ROW) {
+			maxRowID = sqlite3_column_int64(selectStatement, 0);
+		}
+		sqlite3_reset(selectStatement);
+	}
+
+	if (lastRowID == maxRowID) {
+		return;
+	}
+	execute("BEGIN TRANSACTION");
+	if (lastRowID >= 0 && lastRowID < maxRowID) {
+		sqlite3_stmt* indexStatement = getStatement("INSERT INTO messages_fts(rowid, message) SELECT rowid, message FROM messages WHERE rowid>?");
+		if (indexStatement) {
+			sqlite3_bind_int64(indexStatement, 1, lastRowID);
+			if (sqlite3_step(indexStatement) != SQLITE_DONE) {
+				std::cerr << "SQL Error: " << sqlite3_errmsg(db_) << std::endl;
+			}
+			sqlite3_reset(indexStatement);
+		}
+	}
+	else {
+		execute("INSERT INTO messages_fts(messages_fts) VALUES('rebuild')");
 	}
+	setLastIndexedRowID(maxRowID);
+	execute("COMMIT TRANSACTION");
+}
+
+void SQLiteHistoryStorage::setLastIndexedRowID(long long rowID) const {
+	execute("DELETE FROM messages_fts_state");
+	sqlite3_stmt* insertStatement = getStatement("INSERT INTO messages_fts_state('lastRowID') VALUES(?)");
+	if (!insertStatement) {
+		return;
+	}
+	sqlite3_bind_int64(insertStatement, 1, rowID);
+	if (sqlite3_step(insertStatement) != SQLITE_DONE) {
+		std::cerr << "SQL Error: " << sqlite3_errmsg(db_) << std::endl;
+	}
+	sqlite3_reset(insertStatement);
 }
 
 SQLiteHistoryStorage::~SQLiteHistoryStorage() {
-	sqlite3_close(db_);
+	{
+		boost::lock_guard<boost::mutex> lock(pendingMessagesMutex_);
+		stopping_ = true;
+	}
+	pendingMessagesAvailable_.notify_one();
+	thread_->join();
 	delete thread_;
+
+	boost::lock_guard<boost::mutex> lock(dbMutex_);
+	writePendingMessages();
+	typedef std::pair<std::string, sqlite3_stmt*> StatementPair;
+	foreach (const StatementPair& statement, statements_) {
+		sqlite3_finalize(statement.second);
+	}
+	sqlite3_close(db_);
 }
 
 void SQLiteHistoryStorage::addMessage(const HistoryMessage& message) {
-	int secondsSinceEpoch = (message.getTime() - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
-
-	std::string statement = std::string("INSERT INTO messages('message', 'fromBare', 'fromResource', 'toBare', 'toResource', 'type', 'time', 'offset') VALUES(") +
-					"'" + getEscapedString(message.getMessage()) + "', " +
-					boost::lexical_cast<std::string>(getIDForJID(message.getFromJID().toBare())) + ", '" +
-					getEscapedString(message.getFromJID().getResource()) + "', " +
-					boost::lexical_cast<std::string>(getIDForJID(message.getToJID().toBare())) + ", '" +
-					getEscapedString(message.getToJID().getResource()) + "', " +
-					boost::lexical_cast<std::string>(message.getType()) + ", " +
-					boost::lexical_cast<std::string>(secondsSinceEpoch) + ", " +
-					boost::lexical_cast<std::string>(message.getOffset()) + ")";
-	char* errorMessage;
-	int result = sqlite3_exec(db_, statement.c_str(), 0, 0, &errorMessage);
-	if (result != SQLITE_OK) {
-		std::cerr << "SQL Error: " << errorMessage << std::endl;
-		sqlite3_free(errorMessage);
+	{
+		boost::lock_guard<boost::mutex> lock(pendingMessagesMutex_);
+		pendingMessages_.push_back(message);
 	}
+	pendingMessagesAvailable_.notify_one();
+}
+
+void SQLiteHistoryStorage::run() {
+	boost::unique_lock<boost::mutex> lock(pendingMessagesMutex_);
+	while (true) {
+		while (pendingMessages_.empty() && !stopping_) {
+			pendingMessagesAvailable_.wait(lock);
+		}
+		if (stopping_) {
+			return;
+		}
+		// Messages added while this batch is being written are picked up
+		// by the next batch.
+		lock.unlock();
+		{
+			boost::lock_guard<boost::mutex> dbLock(dbMutex_);
+			writePendingMessages();
+		}
+		lock.lock();
+	}
+}
+
+void SQLiteHistoryStorage::writePendingMessages() const {
+	std::vector<HistoryMessage> messages;
+	{
+		boost::lock_guard<boost::mutex> lock(pendingMessagesMutex_);
+		messages.swap(pendingMessages_);
+	}
+	if (messages.empty()) {
+		return;
+	}
+
+	execute("BEGIN TRANSACTION");
+	long long lastRowID = 0;
+	foreach (const HistoryMessage& message, messages) {
+		long long fromID = getIDForJID(message.getFromJID().toBare());
+		long long toID = getIDForJID(message.getToJID().toBare());
+
+		sqlite3_stmt* insertStatement = getStatement("INSERT INTO messages('message', 'fromBare', 'fromResource', 'toBare', 'toResource', 'type', 'time', 'offset') VALUES(?, ?, ?, ?, ?, ?, ?, ?)");
+		if (!insertStatement) {
+			break;
+		}
+		bindText(insertStatement, 1, message.getMessage());
+		sqlite3_bind_int64(insertStatement, 2, fromID);
+		bindText(insertStatement, 3, message.getFromJID().getResource());
+		sqlite3_bind_int64(insertStatement, 4, toID);
+		bindText(insertStatement, 5, message.getToJID().getResource());
+		sqlite3_bind_int(insertStatement, 6, message.getType());
+		sqlite3_bind_int64(insertStatement, 7, getSecondsSinceEpoch(message.getTime()));
+		sqlite3_bind_int(insertStatement, 8, message.getOffset());
+		if (sqlite3_step(insertStatement) != SQLITE_DONE) {
+			std::cerr << "SQL Error: " << sqlite3_errmsg(db_) << std::endl;
+		}
+		sqlite3_reset(insertStatement);
+		lastRowID = sqlite3_last_insert_rowid(db_);
+
+		if (hasFullTextIndex_) {
+			sqlite3_stmt* indexStatement = getStatement("INSERT INTO messages_fts(rowid, message) VALUES(?, ?)");
+			if (!indexStatement) {
+				break;
+			}
+			sqlite3_bind_int64(indexStatement, 1, lastRowID);
+			bindText(indexStatement, 2, message.getMessage());
+			if (sqlite3_step(indexStatement) != SQLITE_DONE) {
+				std::cerr << "SQL Error: " << sqlite3_errmsg(db_) << std::endl;
+			}
+			sqlite3_reset(indexStatement);
+		}
+	}
+	if (hasFullTextIndex_ && lastRowID) {
+		setLastIndexedRowID(lastRowID);
+	}
+	execute("COMMIT TRANSACTION");
 }
 
 std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
-	sqlite3_stmt* selectStatement;
+	boost::lock_guard<boost::mutex> lock(dbMutex_);
+	writePendingMessages();
 
 	boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
 	boost::optional<long long> contactID = getIDFromJID(contactJID.toBare());
@@ -84,78 +322,87 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID&
 		return std::vector<HistoryMessage>();
 	}
 
-	std::string selectQuery = "SELECT * FROM messages WHERE (type=" + boost::lexical_cast<std::string>(type);
+	// Every alternative repeats all conditions, so that both of them can
+	// be looked up in an index.
+	std::string selectQuery;
 	if (contactJID.isBare()) {
 		// match only bare jid
-		selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND toBare=" +
-				boost::lexical_cast<std::string>(*contactID) + ") OR (fromBare=" +
-				boost::lexical_cast<std::string>(*contactID) + " AND toBare=" + boost::lexical_cast<std::string>(*selfID) + ")))";
+		selectQuery = "SELECT message, fromBare, fromResource, toBare, toResource, type, time, offset FROM messages WHERE "
+				"(fromBare=?1 AND toBare=?2 AND type=?3 AND time>=?4 AND time<?5) OR "
+				"(fromBare=?2 AND toBare=?1 AND type=?3 AND time>=?4 AND time<?5) ORDER BY rowid";
 	}
 	else {
 		// match resource too
-		selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND (toBare=" +
-				boost::lexical_cast<std::string>(*contactID) +" AND toResource='" +
-				getEscapedString(contactJID.getResource()) + "')) OR ((fromBare=" +
-				boost::lexical_cast<std::string>(*contactID) + " AND fromResource='" +
-				getEscapedString(contactJID.getResource()) + "') AND toBare=" +
-				boost::lexical_cast<std::string>(*selfID) + ")))";
+		selectQuery = "SELECT message, fromBare, fromResource, toBare, toResource, type, time, offset FROM messages WHERE "
+				"(fromBare=?1 AND toBare=?2 AND type=?3 AND time>=?4 AND time<?5 AND toResource=?6) OR "
+				"(fromBare=?2 AND toBare=?1 AND type=?3 AND time>=?4 AND time<?5 AND fromResource=?6) ORDER BY rowid";
+	}
+	sqlite3_stmt* selectStatement = getStatement(selectQuery);
+	if (!selectStatement) {
+		return std::vector<HistoryMessage>();
 	}
 
+	long long lowerBound = std::numeric_limits<long long>::min();
+	long long upperBound = std::numeric_limits<long long>::max();
 	if (!date.is_not_a_date()) {
-		int lowerBound = (boost::posix_time::ptime(date) - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
-		int upperBound = lowerBound + 86400;
-
-		selectQuery += " AND (time>=" + boost::lexical_cast<std::string>(lowerBound) +
-				" AND time<" + boost::lexical_cast<std::string>(upperBound) + ")";
+		lowerBound = getSecondsSinceEpoch(boost::posix_time::ptime(date));
+		upperBound = lowerBound + 86400;
 	}
 
-	int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, NULL);
-	if (r != SQLITE_OK) {
-		std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+	sqlite3_bind_int64(selectStatement, 1, *selfID);
+	sqlite3_bind_int64(selectStatement, 2, *contactID);
+	sqlite3_bind_int(selectStatement, 3, type);
+	sqlite3_bind_int64(selectStatement, 4, lowerBound);
+	sqlite3_bind_int64(selectStatement, 5, upperBound);
+	if (!contactJID.isBare()) {
+		bindText(selectStatement, 6, contactJID.getResource());
 	}
-	r = sqlite3_step(selectStatement);
+	std::vector<HistoryMessage> result = readMessages(selectStatement);
+	sqlite3_reset(selectStatement);
+	return result;
+}
+
+std::vector<HistoryMessage> SQLiteHistoryStorage::readMessages(sqlite3_stmt* statement) const {
+	int r = sqlite3_step(statement);
 
 	// Retrieve result
 	std::vector<HistoryMessage> result;
 	while (r == SQLITE_ROW) {
-		std::string message(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 0)));
+		std::string message(getColumnText(statement, 0));
 
 		// fromJID
-		boost::optional<JID> fromJID(getJIDFromID(sqlite3_column_int(selectStatement, 1)));
-		std::string fromResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 2)));
+		boost::optional<JID> fromJID(getJIDFromID(sqlite3_column_int64(statement, 1)));
+		std::string fromResource(getColumnText(statement, 2));
 		if (fromJID) {
 			fromJID = boost::optional<JID>(JID(fromJID->getNode(), fromJID->getDomain(), fromResource));
 		}
 
 		// toJID
-		boost::optional<JID> toJID(getJIDFromID(sqlite3_column_int(selectStatement, 3)));
-		std::string toResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 4)));
+		boost::optional<JID> toJID(getJIDFromID(sqlite3_column_int64(statement, 3)));
+		std::string toResource(getColumnText(statement, 4));
 		if (toJID) {
 			toJID = boost::optional<JID>(JID(toJID->getNode(), toJID->getDomain(), toResource));
 		}
 
 		// message type
-		HistoryMessage::Type type = static_cast<HistoryMessage::Type>(sqlite3_column_int(selectStatement, 5));
+		HistoryMessage::Type type = static_cast<HistoryMessage::Type>(sqlite3_column_int(statement, 5));
 
 		// timestamp
-		int secondsSinceEpoch(sqlite3_column_int(selectStatement, 6));
-		boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
+		boost::posix_time::ptime time(getTimeFromSecondsSinceEpoch(sqlite3_column_int64(statement, 6)));
 
 		// offset from utc
-		int offset = sqlite3_column_int(selectStatement, 7);
+		int offset = sqlite3_column_int(statement, 7);
 
 		result.push_back(HistoryMessage(message, (fromJID ? *fromJID : JID()), (toJID ? *toJID : JID()), type, time, offset));
-		r = sqlite3_step(selectStatement);
+		r = sqlite3_step(statement);
 	}
 	if (r != SQLITE_DONE) {
 		std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
 	}
-	sqlite3_finalize(selectStatement);
-
 	return result;
 }
 
-long long SQLiteHistoryStorage::getIDForJID(const JID& jid) {
+long long SQLiteHistoryStorage::getIDForJID(const JID& jid) const {
 	boost::optional<long long> id = getIDFromJID(jid);
 	if (id) {
 		return *id;
@@ -165,52 +412,70 @@ long long SQLiteHistoryStorage::getIDForJID(const JID& jid) {
 	}
 }
 
-long long SQLiteHistoryStorage::addJID(const JID& jid) {
-	std::string statement = std::string("INSERT INTO jids('jid') VALUES('") + getEscapedString(jid.toString()) + "')";
-	char* errorMessage;
-	int result = sqlite3_exec(db_, statement.c_str(), 0, 0, &errorMessage);
-	if (result != SQLITE_OK) {
-		std::cerr << "SQL Error: " << errorMessage << std::endl;
-		sqlite3_free(errorMessage);
+long long SQLiteHistoryStorage::addJID(const JID& jid) const {
+	sqlite3_stmt* insertStatement = getStatement("INSERT INTO jids('jid') VALUES(?)");
+	if (!insertStatement) {
+		return 0;
+	}
+	std::string jidString = jid.toString();
+	bindText(insertStatement, 1, jidString);
+	if (sqlite3_step(insertStatement) != SQLITE_DONE) {
+		std::cerr << "SQL Error: " << sqlite3_errmsg(db_) << std::endl;
 	}
-	return sqlite3_last_insert_rowid(db_);
+	sqlite3_reset(insertStatement);
+
+	long long id = sqlite3_last_insert_rowid(db_);
+	jidIDs_[jidString] = id;
+	jids_.insert(std::make_pair(id, jid));
+	return id;
 }
 
 boost::optional<JID> SQLiteHistoryStorage::getJIDFromID(long long id) const {
+	boost::unordered_map<long long, JID>::const_iterator i = jids_.find(id);
+	if (i != jids_.end()) {
+		return i->second;
+	}
+
 	boost::optional<JID> result;
-	sqlite3_stmt* selectStatement;
-	std::string selectQuery("SELECT jid FROM jids WHERE id=" + boost::lexical_cast<std::string>(id));
-	int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, NULL);
-	if (r != SQLITE_OK) {
-		std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+	sqlite3_stmt* selectStatement = getStatement("SELECT jid FROM jids WHERE id=?");
+	if (!selectStatement) {
+		return result;
 	}
-	r = sqlite3_step(selectStatement);
-	if (r == SQLITE_ROW) {
-		result = boost::optional<JID>(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 0)));
+	sqlite3_bind_int64(selectStatement, 1, id);
+	if (sqlite3_step(selectStatement) == SQLITE_ROW) {
+		result = boost::optional<JID>(getColumnText(selectStatement, 0));
+		jids_.insert(std::make_pair(id, *result));
 	}
-	sqlite3_finalize(selectStatement);
+	sqlite3_reset(selectStatement);
 	return result;
 }
 
 boost::optional<long long> SQLiteHistoryStorage::getIDFromJID(const JID& jid) const {
+	std::string jidString = jid.toString();
+	boost::unordered_map<std::string, long long>::const_iterator i = jidIDs_.find(jidString);
+	if (i != jidIDs_.end()) {
+		return i->second;
+	}
+
 	boost::optional<long long> result;
-	sqlite3_stmt* selectStatement;
-	std::string selectQuery("SELECT id FROM jids WHERE jid='" + jid.toString() + "'");
-	long long r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, NULL);
-	if (r != SQLITE_OK) {
-		std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+	sqlite3_stmt* selectStatement = getStatement("SELECT id FROM jids WHERE jid=?");
+	if (!selectStatement) {
+		return result;
 	}
-	r = sqlite3_step(selectStatement);
-	if (r == SQLITE_ROW) {
-		result = boost::optional<long long>(sqlite3_column_int(selectStatement, 0));
+	bindText(selectStatement, 1, jidString);
+	if (sqlite3_step(selectStatement) == SQLITE_ROW) {
+		result = boost::optional<long long>(sqlite3_column_int64(selectStatement, 0));
+		jidIDs_[jidString] = *result;
 	}
-	sqlite3_finalize(selectStatement);
+	sqlite3_reset(selectStatement);
 	return result;
 }
 
 ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) const {
+	boost::lock_guard<boost::mutex> lock(dbMutex_);
+	writePendingMessages();
+
 	ContactsMap result;
-	sqlite3_stmt* selectStatement;
 
 	// get id
 	boost::optional<long long> id = getIDFromJID(selfJID);
@@ -219,31 +484,45 @@ ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage
 	}
 
 	// get contacts
-	std::string query = "SELECT DISTINCT messages.'fromBare', messages.'fromResource', messages.'toBare', messages.'toResource', messages.'time' "
-		"FROM messages WHERE (type="
-		+ boost::lexical_cast<std::string>(type) + " AND (toBare="
-		+ boost::lexical_cast<std::string>(*id) + " OR fromBare=" + boost::lexical_cast<std::string>(*id) + "))";
+	std::string query = "SELECT DISTINCT fromBare, fromResource, toBare, toResource, time "
+		"FROM messages WHERE type=?1 AND (toBare=?2 OR fromBare=?2)";
 
 	// match keyword
-	if (getEscapedString(keyword).length()) {
-		query += " AND message LIKE '%" + getEscapedString(keyword) + "%'";
+	std::vector<std::string> words = getWords(keyword);
+	std::vector<std::string> patterns;
+	if (hasFullTextIndex_ && !words.empty()) {
+		// Start from the (few) matching messages instead of all messages
+		query = "SELECT DISTINCT messages.fromBare, messages.fromResource, messages.toBare, messages.toResource, messages.time "
+			"FROM messages_fts CROSS JOIN messages ON messages.rowid=messages_fts.rowid "
+			"WHERE messages_fts MATCH ?3 AND messages.type=?1 AND (messages.toBare=?2 OR messages.fromBare=?2)";
+		patterns.push_back(getFullTextQuery(words));
+	}
+	else {
+		foreach (const std::string& word, words) {
+			patterns.push_back(word);
+			query += " AND has_word_prefix(message, ?" + boost::lexical_cast<std::string>(patterns.size() + 2) + ")";
+		}
 	}
 
-	int r = sqlite3_prepare(db_, query.c_str(), boost::numeric_cast<int>(query.size()), &selectStatement, NULL);
-	if (r != SQLITE_OK) {
-		std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+	sqlite3_stmt* selectStatement = getStatement(query);
+	if (!selectStatement) {
+		return result;
+	}
+	sqlite3_bind_int(selectStatement, 1, type);
+	sqlite3_bind_int64(selectStatement, 2, *id);
+	for (size_t i = 0; i < patterns.size(); ++i) {
+		bindText(selectStatement, boost::numeric_cast<int>(i) + 3, patterns[i]);
 	}
 
-	r = sqlite3_step(selectStatement);
+	int r = sqlite3_step(selectStatement);
 	while (r == SQLITE_ROW) {
-		int fromBareID = sqlite3_column_int(selectStatement, 0);
-		std::string fromResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 1)));
-		int toBareID = sqlite3_column_int(selectStatement, 2);
-		std::string toResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 3)));
+		long long fromBareID = sqlite3_column_int64(selectStatement, 0);
+		std::string fromResource(getColumnText(selectStatement, 1));
+		long long toBareID = sqlite3_column_int64(selectStatement, 2);
+		std::string toResource(getColumnText(selectStatement, 3));
 		std::string resource;
 
-		int secondsSinceEpoch(sqlite3_column_int(selectStatement, 4));
-		boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
+		boost::posix_time::ptime time(getTimeFromSecondsSinceEpoch(sqlite3_column_int64(selectStatement, 4)));
 
 		boost::optional<JID> contactJID;
 
@@ -271,13 +550,66 @@ ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage
 	if (r != SQLITE_DONE) {
 		std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
 	}
-	sqlite3_finalize(selectStatement);
+	sqlite3_reset(selectStatement);
 
 	return result;
 }
 
+std::vector<HistoryMessage> SQLiteHistoryStorage::searchMessages(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword, size_t firstResult, size_t maxResults) const {
+	boost::lock_guard<boost::mutex> lock(dbMutex_);
+	writePendingMessages();
+
+	boost::optional<long long> id = getIDFromJID(selfJID.toBare());
+	if (!id) {
+		return std::vector<HistoryMessage>();
+	}
+
+	std::vector<std::string> words = getWords(keyword);
+	if (words.empty()) {
+		return std::vector<HistoryMessage>();
+	}
+
+	std::string query;
+	std::vector<std::string> patterns;
+	if (hasFullTextIndex_) {
+		query = "SELECT messages.message, messages.fromBare, messages.fromResource, messages.toBare, messages.toResource, messages.type, messages.time, messages.offset "
+			"FROM messages_fts CROSS JOIN messages ON messages.rowid=messages_fts.rowid "
+			"WHERE messages.type=?1 AND (messages.toBare=?2 OR messages.fromBare=?2) AND messages_fts MATCH ?5 "
+			"ORDER BY messages_fts.rank, messages.time DESC LIMIT ?3 OFFSET ?4";
+		patterns.push_back(getFullTextQuery(words));
+	}
+	else {
+		// Without an index, the most recent messages are returned first
+		query = "SELECT message, fromBare, fromResource, toBare, toResource, type, time, offset "
+			"FROM messages WHERE type=?1 AND (toBare=?2 OR fromBare=?2)";
+		foreach (const std::string& word, words) {
+			patterns.push_back(word);
+			query += " AND has_word_prefix(message, ?" + boost::lexical_cast<std::string>(patterns.size() + 4) + ")";
+		}
+		query += " ORDER BY time DESC LIMIT ?3 OFFSET ?4";
+	}
+
+	sqlite3_stmt* selectStatement = getStatement(query);
+	if (!selectStatement) {
+		return std::vector<HistoryMessage>();
+	}
+	sqlite3_bind_int(selectStatement, 1, type);
+	sqlite3_bind_int64(selectStatement, 2, *id);
+	sqlite3_bind_int64(selectStatement, 3, boost::numeric_cast<long long>(maxResults));
+	sqlite3_bind_int64(selectStatement, 4, boost::numeric_cast<long long>(firstResult));
+	for (size_t i = 0; i < patterns.size(); ++i) {
+		bindText(selectStatement, boost::numeric_cast<int>(i) + 5, patterns[i]);
+	}
+
+	std::vector<HistoryMessage> result = readMessages(selectStatement);
+	sqlite3_reset(selectStatement);
+	return result;
+}
+
 boost::gregorian::date SQLiteHistoryStorage::getNextDateWithLogs(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder) const {
-	sqlite3_stmt* selectStatement;
+	boost::lock_guard<boost::mutex> lock(dbMutex_);
+	writePendingMessages();
+
 	boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
 	boost::optional<long long> contactID = getIDFromJID(contactJID.toBare());
 
@@ -286,42 +618,56 @@ boost::gregorian::date SQLiteHistoryStorage::getNextDateWithLogs(const JID& self
 		return boost::gregorian::date(boost::gregorian::not_a_date_time);
 	}
 
-	std::string selectQuery = "SELECT time FROM messages WHERE (type=" + boost::lexical_cast<std::string>(type);
-	if (contactJID.isBare()) {
-		// match only bare jid
-		selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND toBare=" +
-				boost::lexical_cast<std::string>(*contactID) + ") OR (fromBare=" +
-				boost::lexical_cast<std::string>(*contactID) + " AND toBare=" + boost::lexical_cast<std::string>(*selfID) + ")))";
-	}
-	else {
+	long long timeStamp = getSecondsSinceEpoch(boost::posix_time::ptime(date)) + (reverseOrder ? 0 : 86400);
+
+	// Look up both directions separately, so that each lookup only needs
+	// to read a single index entry.
+	std::string sentResourceColumn;
+	std::string receivedResourceColumn;
+	if (!contactJID.isBare()) {
 		// match resource too
-		selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND (toBare=" +
-				boost::lexical_cast<std::string>(*contactID) +" AND toResource='" +
-				getEscapedString(contactJID.getResource()) + "')) OR ((fromBare=" +
-				boost::lexical_cast<std::string>(*contactID) + " AND fromResource='" +
-				getEscapedString(contactJID.getResource()) + "') AND toBare=" +
-				boost::lexical_cast<std::string>(*selfID) + ")))";
+		sentResourceColumn = "toResource";
+		receivedResourceColumn = "fromResource";
 	}
+	boost::optional<long long> sentTime = getNextTimeWithLogs(*selfID, *contactID, sentResourceColumn, contactJID.getResource(), type, timeStamp, reverseOrder);
+	boost::optional<long long> receivedTime = getNextTimeWithLogs(*contactID, *selfID, receivedResourceColumn, contactJID.getResource(), type, timeStamp, reverseOrder);
 
-	int timeStamp = (boost::posix_time::ptime(date) - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds() + (reverseOrder ? 0 : 86400);
+	boost::optional<long long> nextTime = sentTime;
+	if (receivedTime && (!nextTime || (reverseOrder ? *receivedTime > *nextTime : *receivedTime < *nextTime))) {
+		nextTime = receivedTime;
+	}
+	if (nextTime) {
+		return getTimeFromSecondsSinceEpoch(*nextTime).date();
+	}
 
-	selectQuery += " AND time" + (reverseOrder ? std::string("<") : std::string(">")) + boost::lexical_cast<std::string>(timeStamp);
-	selectQuery += " ORDER BY time " + (reverseOrder ? std::string("DESC") : std::string("ASC")) + " LIMIT 1";
+	return boost::gregorian::date(boost::gregorian::not_a_date_time);
+}
 
-	int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, NULL);
-	if (r != SQLITE_OK) {
-		std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+boost::optional<long long> SQLiteHistoryStorage::getNextTimeWithLogs(long long fromID, long long toID, const std::string& resourceColumn, const std::string& resource, HistoryMessage::Type type, long long time, bool reverseOrder) const {
+	std::string selectQuery = "SELECT time FROM messages WHERE fromBare=?1 AND toBare=?2 AND type=?3";
+	selectQuery += " AND time" + (reverseOrder ? std::string("<") : std::string(">")) + "?4";
+	if (!resourceColumn.empty()) {
+		selectQuery += " AND " + resourceColumn + "=?5";
 	}
+	selectQuery += " ORDER BY time " + (reverseOrder ? std::string("DESC") : std::string("ASC")) + " LIMIT 1";
 
-	r = sqlite3_step(selectStatement);
-	if (r == SQLITE_ROW) {
-		int secondsSinceEpoch(sqlite3_column_int(selectStatement, 0));
-		boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
-		std::cout << "next day is: " << time.date() << "\n";
-		return time.date();
+	boost::optional<long long> result;
+	sqlite3_stmt* selectStatement = getStatement(selectQuery);
+	if (!selectStatement) {
+		return result;
 	}
-
-	return boost::gregorian::date(boost::gregorian::not_a_date_time);
+	sqlite3_bind_int64(selectStatement, 1, fromID);
+	sqlite3_bind_int64(selectStatement, 2, toID);
+	sqlite3_bind_int(selectStatement, 3, type);
+	sqlite3_bind_int64(selectStatement, 4, time);
+	if (!resourceColumn.empty()) {
+		bindText(selectStatement, 5, resource);
+	}
+	if (sqlite3_step(selectStatement) == SQLITE_ROW) {
+		result = sqlite3_column_int64(selectStatement, 0);
+	}
+	sqlite3_reset(selectStatement);
+	return result;
 }
 
 std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
@@ -345,6 +691,9 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromPreviousDate(co
 }
 
 boost::posix_time::ptime SQLiteHistoryStorage::getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) const {
+	boost::lock_guard<boost::mutex> lock(dbMutex_);
+	writePendingMessages();
+
 	boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
 	boost::optional<long long> mucID = getIDFromJID(mucJID.toBare());
 
@@ -353,30 +702,49 @@ boost::posix_time::ptime SQLiteHistoryStorage::getLastTimeStampFromMUC(const JID
 		return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
 	}
 
-
-	sqlite3_stmt* selectStatement;
-	std::string selectQuery = "SELECT messages.'time', messages.'offset' from messages WHERE type=1 AND (toBare=" +
-				boost::lexical_cast<std::string>(*selfID) + " AND fromBare=" +
-				boost::lexical_cast<std::string>(*mucID) + ") ORDER BY time DESC LIMIT 1";
-
-	int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, NULL);
-	if (r != SQLITE_OK) {
-		std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+	sqlite3_stmt* selectStatement = getStatement("SELECT time, offset FROM messages WHERE toBare=? AND fromBare=? AND type=1 ORDER BY time DESC LIMIT 1");
+	if (!selectStatement) {
+		return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
 	}
+	sqlite3_bind_int64(selectStatement, 1, *selfID);
+	sqlite3_bind_int64(selectStatement, 2, *mucID);
 
-	r = sqlite3_step(selectStatement);
-	if (r == SQLITE_ROW) {
-		int secondsSinceEpoch(sqlite3_column_int(selectStatement, 0));
-		boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
+	boost::posix_time::ptime result(boost::posix_time::not_a_date_time);
+	if (sqlite3_step(selectStatement) == SQLITE_ROW) {
+		boost::posix_time::ptime time(getTimeFromSecondsSinceEpoch(sqlite3_column_int64(selectStatement, 0)));
 		int offset = sqlite3_column_int(selectStatement, 1);
 
-		return time - boost::posix_time::hours(offset);
+		result = time - boost::posix_time::hours(offset);
 	}
+	sqlite3_reset(selectStatement);
+	return result;
+}
 
-	return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
+void SQLiteHistoryStorage::execute(const std::string& statement) const {
+	char* errorMessage;
+	int result = sqlite3_exec(db_, statement.c_str(), 0, 0, &errorMessage);
+	if (result != SQLITE_OK) {
+		std::cerr << "SQL Error: " << errorMessage << std::endl;
+		sqlite3_free(errorMessage);
+	}
 }
 
-void SQLiteHistoryStorage::run() {
+sqlite3_stmt* SQLiteHistoryStorage::getStatement(const std::string& query) const {
+	std::map<std::string, sqlite3_stmt*>::const_iterator i = statements_.find(query);
+	if (i != statements_.end()) {
+		sqlite3_clear_bindings(i->second);
+		return i->second;
+	}
+
+	sqlite3_stmt* statement = NULL;
+	int r = sqlite3_prepare_v2(db_, query.c_str(), boost::numeric_cast<int>(query.size()), &statement, NULL);
+	if (r != SQLITE_OK) {
+		std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+		sqlite3_finalize(statement);
+		return NULL;
+	}
+	statements_[query] = statement;
+	return statement;
 }
 
 }
@@ -1,12 +1,16 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
 #include <boost/optional.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/History/HistoryStorage.h>
@@ -14,15 +18,35 @@
 #include <boost/filesystem/path.hpp>
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace Swift {
+	/**
+	 * Stores the message history in an SQLite database.
+	 *
+	 * Messages passed to addMessage() are queued, and written by a
+	 * background thread, in one transaction per batch. Queries first write
+	 * out any queued messages, so they always see all added messages.
+	 *
+	 * If SQLite was built with FTS5, the messages are kept in a full-text
+	 * index for keyword searches. Otherwise, keyword searches scan all
+	 * messages, with the same results in a different order (except that
+	 * only ASCII letters are compared case-insensitively). Messages that
+	 * were added without updating the index are indexed when the database
+	 * is opened with it again.
+	 */
 	class SWIFTEN_API SQLiteHistoryStorage : public HistoryStorage {
 		public:
-			SQLiteHistoryStorage(const boost::filesystem::path& file);
+			/**
+			 * If \p useFullTextIndex is false, the full-text index is not
+			 * used (nor updated), even if SQLite supports it.
+			 */
+			SQLiteHistoryStorage(const boost::filesystem::path& file, bool useFullTextIndex = true);
 			~SQLiteHistoryStorage();
 
 			void addMessage(const HistoryMessage& message);
 			ContactsMap getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) const;
+			std::vector<HistoryMessage> searchMessages(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword, size_t firstResult, size_t maxResults) const;
 			std::vector<HistoryMessage> getMessagesFromDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
 			std::vector<HistoryMessage> getMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
 			std::vector<HistoryMessage> getMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
@@ -31,13 +55,40 @@ namespace Swift {
 		private:
 			void run();
 			boost::gregorian::date getNextDateWithLogs(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder) const;
-			long long getIDForJID(const JID&);
-			long long addJID(const JID&);
+			boost::optional<long long> getNextTimeWithLogs(long long fromID, long long toID, const std::string& resourceColumn, const std::string& resource, HistoryMessage::Type type, long long time, bool reverseOrder) const;
+			long long getIDForJID(const JID&) const;
+			long long addJID(const JID&) const;
 
 			boost::optional<JID> getJIDFromID(long long id) const;
 			boost::optional<long long> getIDFromJID(const JID& jid) const;
 
+			std::vector<HistoryMessage> readMessages(sqlite3_stmt* statement) const;
+			void writePendingMessages() const;
+			void updateFullTextIndex();
+			void setLastIndexedRowID(long long rowID) const;
+			void execute(const std::string& statement) const;
+
+			/**
+			 * Returns a cached prepared statement for the query, or NULL if
+			 * the query could not be prepared.
+			 *
+			 * The statement should be reset after use.
+			 */
+			sqlite3_stmt* getStatement(const std::string& query) const;
+
 			sqlite3* db_;
 			boost::thread* thread_;
+			bool hasFullTextIndex_;
+
+			// Protects the database connection, statements, and JID caches
+			mutable boost::mutex dbMutex_;
+			mutable std::map<std::string, sqlite3_stmt*> statements_;
+			mutable boost::unordered_map<std::string, long long> jidIDs_;
+			mutable boost::unordered_map<long long, JID> jids_;
+
+			mutable boost::mutex pendingMessagesMutex_;
+			boost::condition_variable pendingMessagesAvailable_;
+			mutable std::vector<HistoryMessage> pendingMessages_;
+			bool stopping_;
 	};
 }
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Base/foreach.h>
+#include <Swiften/History/SQLiteHistoryStorage.h>
+
+using namespace Swift;
+
+class SQLiteHistoryStorageTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(SQLiteHistoryStorageTest);
+		CPPUNIT_TEST(testGetMessagesFromDate);
+		CPPUNIT_TEST(testGetMessagesFromDate_Resource);
+		CPPUNIT_TEST(testGetMessagesFromDate_UnknownContact);
+		CPPUNIT_TEST(testGetMessagesFromNextDate);
+		CPPUNIT_TEST(testGetMessagesFromPreviousDate);
+		CPPUNIT_TEST(testGetContacts);
+		CPPUNIT_TEST(testGetContacts_Keyword);
+		CPPUNIT_TEST(testGetContacts_KeywordPrefix);
+		CPPUNIT_TEST(testSearchMessages);
+		CPPUNIT_TEST(testSearchMessages_Paged);
+		CPPUNIT_TEST(testSearchMessages_AllWords);
+		CPPUNIT_TEST(testSearchMessages_QuotedKeyword);
+		CPPUNIT_TEST(testSearchMessages_WordPrefixes);
+		CPPUNIT_TEST(testSearchMessages_MessagesAddedWithoutIndex);
+		CPPUNIT_TEST(testGetLastTimeStampFromMUC);
+		CPPUNIT_TEST(testDestroy_WritesQueuedMessages);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void setUp() {
+			self = JID("me@example.com/home");
+			contact = JID("contact@example.com/work");
+		}
+
+		void testGetMessagesFromDate() {
+			boost::shared_ptr<SQLiteHistoryStorage> testling(createStorage());
+			HistoryMessage message1("Hi", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00"));
+			HistoryMessage message2("Hello", contact, self, HistoryMessage::Chat, time("2015-03-02 10:01:00"));
+			testling->addMessage(message1);
+			testling->addMessage(HistoryMessage("Other day", self, contact, HistoryMessage::Chat, time("2015-03-03 10:00:00")));
+			testling->addMessage(HistoryMessage("Other contact", self, JID("other@example.com"), HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+			testling->addMessage(message2);
+
+			std::vector<HistoryMessage> messages = testling->getMessagesFromDate(self, contact.toBare(), HistoryMessage::Chat, date("2015-03-02"));
+
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(messages.size()));
+			CPPUNIT_ASSERT(message1 == messages[0]);
+			CPPUNIT_ASSERT(message2 == messages[1]);
+		}
+
+		void testGetMessagesFromDate_Resource() {
+			boost::shared_ptr<SQLiteHistoryStorage> testling(createStorage());
+			testling->addMessage(HistoryMessage("Hi", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+			testling->addMessage(HistoryMessage("Hi", self, JID("contact@example.com/home"), HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+
+			std::vector<HistoryMessage> messages = testling->getMessagesFromDate(self, contact, HistoryMessage::Chat, date("2015-03-02"));
+
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(messages.size()));
+			CPPUNIT_ASSERT_EQUAL(contact, messages[0].getToJID());
+		}
+
+		void testGetMessagesFromDate_UnknownContact() {
+			boost::shared_ptr<SQLiteHistoryStorage> testling(createStorage());
+			testling->addMessage(HistoryMessage("Hi", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+
+			CPPUNIT_ASSERT(testling->getMessagesFromDate(self, JID("other@example.com"), HistoryMessage::Chat, date("2015-03-02")).empty());
+		}
+
+		void testGetMessagesFromNextDate() {
+			boost::shared_ptr<SQLiteHistoryStorage> testling(createStorage());
+			testling->addMessage(HistoryMessage("1", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+			testling->addMessage(HistoryMessage("2", contact, self, HistoryMessage::Chat, time("2015-03-05 10:00:00")));
+			testling->addMessage(HistoryMessage("3", self, contact, HistoryMessage::Chat, time("2015-03-07 10:00:00")));
+
+			std::vector<HistoryMessage> messages = testling->getMessagesFromNextDate(self, contact.toBare(), HistoryMessage::Chat, date("2015-03-02"));
+
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(messages.size()));
+			CPPUNIT_ASSERT_EQUAL(std::string("2"), messages[0].getMessage());
+			CPPUNIT_ASSERT(testling->getMessagesFromNextDate(self, contact.toBare(), HistoryMessage::Chat, date("2015-03-07")).empty());
+		}
+
+		void testGetMessagesFromPreviousDate() {
+			boost::shared_ptr<SQLiteHistoryStorage> testling(createStorage());
+			testling->addMessage(HistoryMessage("1", contact, self, HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+			testling->addMessage(HistoryMessage("2", self, contact, HistoryMessage::Chat, time("2015-03-05 10:00:00")));
+			testling->addMessage(HistoryMessage("3", contact, self, HistoryMessage::Chat, time("2015-03-07 10:00:00")));
+
+			std::vector<HistoryMessage> messages = testling->getMessagesFromPreviousDate(self, contact.toBare(), HistoryMessage::Chat, date("2015-03-07"));
+
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(messages.size()));
+			CPPUNIT_ASSERT_EQUAL(std::string("2"), messages[0].getMessage());
+			CPPUNIT_ASSERT(testling->getMessagesFromPreviousDate(self, contact.toBare(), HistoryMessage::Chat, date("2015-03-02")).empty());
+		}
+
+		void testGetContacts() {
+			boost::shared_ptr<SQLiteHistoryStorage> testling(createStorage());
+			testling->addMessage(HistoryMessage("1", self.toBare(), contact.toBare(), HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+			testling->addMessage(HistoryMessage("2", JID("other@example.com"), self.toBare(), HistoryMessage::Chat, time("2015-03-05 10:00:00")));
+			testling->addMessage(HistoryMessage("3", self.toBare(), contact.toBare(), HistoryMessage::Chat, time("2015-03-07 10:00:00")));
+			testling->addMessage(HistoryMessage("4", self.toBare(), JID("room@example.com"), HistoryMessage::Groupchat, time("2015-03-07 10:00:00")));
+
+			ContactsMap contacts = testling->getContacts(self.toBare(), HistoryMessage::Chat, "");
+
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(contacts.size()));
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(contacts[contact.toBare()].size()));
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(contacts[JID("other@example.com")].size()));
+		}
+
+		void testGetContacts_Keyword() {
+			foreach (boost::shared_ptr<SQLiteHistoryStorage> testling, createStoragesWithAndWithoutIndex()) {
+				testling->addMessage(HistoryMessage("Let's meet tomorrow", self.toBare(), contact.toBare(), HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+				testling->addMessage(HistoryMessage("It's Bob's", JID("other@example.com"), self.toBare(), HistoryMessage::Chat, time("2015-03-05 10:00:00")));
+
+				ContactsMap contacts = testling->getContacts(self.toBare(), HistoryMessage::Chat, "Bob's");
+
+				CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(contacts.size()));
+				CPPUNIT_ASSERT(contacts.find(JID("other@example.com")) != contacts.end());
+			}
+		}
+
+		void testGetContacts_KeywordPrefix() {
+			foreach (boost::shared_ptr<SQLiteHistoryStorage> testling, createStoragesWithAndWithoutIndex()) {
+				testling->addMessage(HistoryMessage("Let's meet tomorrow", self.toBare(), contact.toBare(), HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+				testling->addMessage(HistoryMessage("No time", JID("other@example.com"), self.toBare(), HistoryMessage::Chat, time("2015-03-05 10:00:00")));
+
+				ContactsMap contacts = testling->getContacts(self.toBare(), HistoryMessage::Chat, "tomor");
+
+				CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(contacts.size()));
+				CPPUNIT_ASSERT(contacts.find(contact.toBare()) != contacts.end());
+			}
+		}
+
+		void testSearchMessages() {
+			foreach (boost::shared_ptr<SQLiteHistoryStorage> testling, createStoragesWithAndWithoutIndex()) {
+				testling->addMessage(HistoryMessage("Did you bring the apples and the pears and the plums?", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+				testling->addMessage(HistoryMessage("Apples, apples", contact, self, HistoryMessage::Chat, time("2015-03-02 10:01:00")));
+				testling->addMessage(HistoryMessage("Pears", contact, self, HistoryMessage::Chat, time("2015-03-02 10:02:00")));
+				testling->addMessage(HistoryMessage("Apples", JID("other@example.com"), JID("someone@example.com"), HistoryMessage::Chat, time("2015-03-02 10:02:00")));
+				testling->addMessage(HistoryMessage("Apples", JID("room@example.com"), self, HistoryMessage::Groupchat, time("2015-03-02 10:02:00")));
+
+				std::vector<HistoryMessage> messages = testling->searchMessages(self, HistoryMessage::Chat, "apples", 0, 10);
+
+				CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(messages.size()));
+				CPPUNIT_ASSERT_EQUAL(std::string("Apples, apples"), messages[0].getMessage());
+				CPPUNIT_ASSERT_EQUAL(contact, messages[0].getFromJID());
+				CPPUNIT_ASSERT_EQUAL(std::string("Did you bring the apples and the pears and the plums?"), messages[1].getMessage());
+			}
+		}
+
+		void testSearchMessages_Paged() {
+			foreach (boost::shared_ptr<SQLiteHistoryStorage> testling, createStoragesWithAndWithoutIndex()) {
+				for (int i = 0; i < 25; ++i) {
+					testling->addMessage(HistoryMessage("Hello", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00") + boost::posix_time::minutes(i)));
+				}
+
+				std::vector<HistoryMessage> page1 = testling->searchMessages(self, HistoryMessage::Chat, "hello", 0, 10);
+				std::vector<HistoryMessage> page3 = testling->searchMessages(self, HistoryMessage::Chat, "hello", 20, 10);
+
+				CPPUNIT_ASSERT_EQUAL(10, static_cast<int>(page1.size()));
+				CPPUNIT_ASSERT_EQUAL(5, static_cast<int>(page3.size()));
+				// Equally relevant hits are sorted by time, most recent first
+				CPPUNIT_ASSERT_EQUAL(time("2015-03-02 10:24:00"), page1[0].getTime());
+				CPPUNIT_ASSERT_EQUAL(time("2015-03-02 10:00:00"), page3[4].getTime());
+			}
+		}
+
+		void testSearchMessages_AllWords() {
+			foreach (boost::shared_ptr<SQLiteHistoryStorage> testling, createStoragesWithAndWithoutIndex()) {
+				testling->addMessage(HistoryMessage("Red apples", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+				testling->addMessage(HistoryMessage("Green apples", self, contact, HistoryMessage::Chat, time("2015-03-02 10:01:00")));
+
+				std::vector<HistoryMessage> messages = testling->searchMessages(self, HistoryMessage::Chat, "apples  green", 0, 10);
+
+				CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(messages.size()));
+				CPPUNIT_ASSERT_EQUAL(std::string("Green apples"), messages[0].getMessage());
+			}
+		}
+
+		void testSearchMessages_QuotedKeyword() {
+			foreach (boost::shared_ptr<SQLiteHistoryStorage> testling, createStoragesWithAndWithoutIndex()) {
+				testling->addMessage(HistoryMessage("He said \"hello\" AND left", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+
+				CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(testling->searchMessages(self, HistoryMessage::Chat, "\"hello\" AND", 0, 10).size()));
+				CPPUNIT_ASSERT(testling->searchMessages(self, HistoryMessage::Chat, "", 0, 10).empty());
+			}
+		}
+
+		void testSearchMessages_WordPrefixes() {
+			foreach (boost::shared_ptr<SQLiteHistoryStorage> testling, createStoragesWithAndWithoutIndex()) {
+				testling->addMessage(HistoryMessage("Hello, world!", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+
+				CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(testling->searchMessages(self, HistoryMessage::Chat, "hel WOR", 0, 10).size()));
+				CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(testling->getContacts(self.toBare(), HistoryMessage::Chat, "hel WOR").size()));
+				CPPUNIT_ASSERT(testling->searchMessages(self, HistoryMessage::Chat, "ello", 0, 10).empty());
+				CPPUNIT_ASSERT(testling->getContacts(self.toBare(), HistoryMessage::Chat, "ello").empty());
+				CPPUNIT_ASSERT(testling->searchMessages(self, HistoryMessage::Chat, "hello worlds", 0, 10).empty());
+			}
+		}
+
+		void testSearchMessages_MessagesAddedWithoutIndex() {
+			boost::filesystem::path file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("swiften-history-%%%%-%%%%.db");
+			{
+				SQLiteHistoryStorage testling(file);
+				testling.addMessage(HistoryMessage("Red apples", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+			}
+			{
+				SQLiteHistoryStorage testling(file, false);
+				testling.addMessage(HistoryMessage("Green apples", self, contact, HistoryMessage::Chat, time("2015-03-02 10:01:00")));
+			}
+
+			size_t messages;
+			{
+				SQLiteHistoryStorage testling(file);
+				messages = testling.searchMessages(self, HistoryMessage::Chat, "apples", 0, 10).size();
+			}
+			boost::filesystem::remove(file);
+			boost::filesystem::remove(file.string() + "-wal");
+			boost::filesystem::remove(file.string() + "-shm");
+
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(messages));
+		}
+
+		void testGetLastTimeStampFromMUC() {
+			boost::shared_ptr<SQLiteHistoryStorage> testling(createStorage());
+			JID room("room@conference.example.com");
+			testling->addMessage(HistoryMessage("1", JID("room@conference.example.com/alice"), self.toBare(), HistoryMessage::Groupchat, time("2015-03-02 10:00:00"), 1));
+			testling->addMessage(HistoryMessage("2", JID("room@conference.example.com/bob"), self.toBare(), HistoryMessage::Groupchat, time("2015-03-02 11:00:00"), 1));
+			testling->addMessage(HistoryMessage("3", self.toBare(), room, HistoryMessage::Groupchat, time("2015-03-02 12:00:00"), 1));
+
+			CPPUNIT_ASSERT_EQUAL(time("2015-03-02 10:00:00"), testling->getLastTimeStampFromMUC(self, room));
+			CPPUNIT_ASSERT(testling->getLastTimeStampFromMUC(self, JID("other@conference.example.com")).is_not_a_date_time());
+		}
+
+		void testDestroy_WritesQueuedMessages() {
+			boost::filesystem::path file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("swiften-history-%%%%-%%%%.db");
+			{
+				SQLiteHistoryStorage testling(file);
+				for (int i = 0; i < 100; ++i) {
+					testling.addMessage(HistoryMessage("Hi", self, contact, HistoryMessage::Chat, time("2015-03-02 10:00:00")));
+				}
+			}
+
+			size_t messages;
+			{
+				SQLiteHistoryStorage testling(file);
+				messages = testling.getMessagesFromDate(self, contact.toBare(), HistoryMessage::Chat, date("2015-03-02")).size();
+			}
+			boost::filesystem::remove(file);
+			boost::filesystem::remove(file.string() + "-wal");
+			boost::filesystem::remove(file.string() + "-shm");
+
+			CPPUNIT_ASSERT_EQUAL(100, static_cast<int>(messages));
+		}
+
+	private:
+		SQLiteHistoryStorage* createStorage() {
+			return new SQLiteHistoryStorage(":memory:");
+		}
+
+		/**
+		 * Keyword searches should give the same results with and without
+		 * the full-text index.
+		 */
+		std::vector< boost::shared_ptr<SQLiteHistoryStorage> > createStoragesWithAndWithoutIndex() {
+			std::vector< boost::shared_ptr<SQLiteHistoryStorage> > result;
+			result.push_back(boost::make_shared<SQLiteHistoryStorage>(":memory:", true));
+			result.push_back(boost::make_shared<SQLiteHistoryStorage>(":memory:", false));
+			return result;
+		}
+
+		static boost::posix_time::ptime time(const std::string& time) {
+			return boost::posix_time::time_from_string(time);
+		}
+
+		static boost::gregorian::date date(const std::string& date) {
+			return boost::gregorian::from_string(date);
+		}
+
+	private:
+		JID self;
+		JID contact;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SQLiteHistoryStorageTest);
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2011-2014 Isode Limited.
+ * Copyright (c) 2011-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -19,7 +19,6 @@
 
 #include <Swiften/Base/Log.h>
 #include <Swiften/Base/String.h>
-#include <Swiften/Base/Concat.h>
 #include <Swiften/Base/ByteArray.h>
 #include <Swiften/Network/HostAddressPort.h>
 #include <Swiften/Parser/BOSHBodyExtractor.h>
@@ -185,26 +184,55 @@ void BOSHConnection::startStream(const std::string& to, unsigned long long rid)
 
 void BOSHConnection::handleDataRead(boost::shared_ptr<SafeByteArray> data) {
 	onBOSHDataRead(*data);
-	buffer_ = concat(buffer_, *data);
-	std::string response = safeByteArrayToString(buffer_);
-	if (response.find("\r\n\r\n") == std::string::npos) {
-		onBOSHDataRead(createSafeByteArray("[[Previous read incomplete, pending]]"));
-		return;
-	}
-	
-	std::string httpCode = response.substr(response.find(" ") + 1, 3);
-	if (httpCode != "200") {
-		onHTTPError(httpCode);
-		return;
-	}
+	size_t offset = 0;
+	do {
+		bool hadHeaders = responseParser_.hasHeaders();
+		offset += responseParser_.parse(vecptr(*data) + offset, data->size() - offset);
+		if (responseParser_.hasError()) {
+			SWIFT_LOG(warning) << "Invalid HTTP response" << std::endl;
+			std::string httpCode = responseParser_.getStatusCode();
+			responseParser_.reset();
+			onHTTPError(httpCode);
+			return;
+		}
+		if (!responseParser_.hasHeaders()) {
+			onBOSHDataRead(createSafeByteArray("[[Previous read incomplete, pending]]"));
+			return;
+		}
+
+		if (responseParser_.getStatusCode() != "200") {
+			if (!hadHeaders) {
+				onHTTPError(responseParser_.getStatusCode());
+			}
+			if (!responseParser_.isComplete()) {
+				return;
+			}
+		}
+		else if (responseParser_.isComplete()) {
+			if (!handleResponseBody(responseParser_.getBody())) {
+				SWIFT_LOG(warning) << "Invalid BOSH body" << std::endl;
+			}
+		}
+		else if (responseParser_.isBodyDelimitedByClose()) {
+			// Without a length, see whether the body is complete every time
+			if (!handleResponseBody(responseParser_.getBody())) {
+				return;
+			}
+		}
+		else {
+			return;
+		}
+		responseParser_.reset();
+	} while (offset < data->size());
+}
 
-	BOSHBodyExtractor parser(parserFactory_, createByteArray(response.substr(response.find("\r\n\r\n") + 4)));
+bool BOSHConnection::handleResponseBody(const ByteArray& body) {
+	BOSHBodyExtractor parser(parserFactory_, body);
 	if (parser.getBody()) {
 		if (parser.getBody()->attributes.getAttribute("type") == "terminate") {
 			BOSHError::Type errorType = parseTerminationCondition(parser.getBody()->attributes.getAttribute("condition"));
 			onSessionTerminated(errorType == BOSHError::NoError ? boost::shared_ptr<BOSHError>() : boost::make_shared<BOSHError>(errorType));
 		}
-		buffer_.clear();
 		if (waitingForStartResponse_) {
 			waitingForStartResponse_ = false;
 			sid_ = parser.getBody()->attributes.getAttribute("sid");
@@ -223,8 +251,9 @@ void BOSHConnection::handleDataRead(boost::shared_ptr<SafeByteArray> data) {
 		/* Say we're good to go again, so don't add anything after here in the method */
 		pending_ = false;
 		onXMPPDataRead(payload);
+		return true;
 	}
-
+	return false;
 }
 
 BOSHError::Type BOSHConnection::parseTerminationCondition(const std::string& text) {
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2011 Isode Limited.
+ * Copyright (c) 2011-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -19,6 +19,7 @@
 #include <Swiften/Network/Connection.h>
 #include <Swiften/Network/Connector.h>
 #include <Swiften/Network/HostAddressPort.h>
+#include <Swiften/Network/HTTPResponseParser.h>
 #include <Swiften/Base/String.h>
 #include <Swiften/Base/URL.h>
 #include <Swiften/Base/Error.h>
@@ -89,6 +90,7 @@ namespace Swift {
 			static std::pair<SafeByteArray, size_t> createHTTPRequest(const SafeByteArray& data, bool streamRestart, bool terminate, unsigned long long rid, const std::string& sid, const URL& boshURL);
 			void handleConnectFinished(Connection::ref);
 			void handleDataRead(boost::shared_ptr<SafeByteArray> data);
+			bool handleResponseBody(const ByteArray& body);
 			void handleDisconnected(const boost::optional<Connection::Error>& error);
 			void write(const SafeByteArray& data, bool streamRestart, bool terminate); /* FIXME: refactor */
 			BOSHError::Type parseTerminationCondition(const std::string& text);
@@ -101,7 +103,7 @@ namespace Swift {
 			std::string sid_;
 			bool waitingForStartResponse_;
 			unsigned long long rid_;
-			SafeByteArray buffer_;
+			HTTPResponseParser responseParser_;
 			bool pending_;
 			bool connectionReady_;
 	};
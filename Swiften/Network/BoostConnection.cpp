@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -23,41 +23,157 @@
 #include <Swiften/Network/HostAddressPort.h>
 #include <Swiften/Base/sleep.h>
 #include <Swiften/Base/SafeAllocator.h>
+#include <Swiften/Base/foreach.h>
 
 namespace Swift {
 
 static const size_t BUFFER_SIZE = 4096;
+static const size_t MAX_BUFFER_SIZE = 65536;
+static const size_t WRITE_BUFFER_SIZE = 16384;
+static const int FULL_READS_BEFORE_GROWING = 4;
+static const size_t MAX_POOLED_READ_BUFFERS = 4;
 
 // -----------------------------------------------------------------------------
 
-// A reference-counted non-modifiable buffer class.
-class SharedBuffer {
+// A small free list of read buffers. Buffers handed out by acquire() find
+// their way back here when the last reference to them is dropped, which is
+// typically on the event loop thread after onDataRead has been handled.
+class BoostConnection::ReadBufferPool : public boost::enable_shared_from_this<ReadBufferPool> {
 	public:
-		SharedBuffer(const SafeByteArray& data) :
-				data_(new std::vector<char, SafeAllocator<char> >(data.begin(), data.end())),
-				buffer_(boost::asio::buffer(*data_)) {
+		ReadBufferPool() : wipe_(true) {
+		}
+
+		~ReadBufferPool() {
+			foreach (SafeByteArray* buffer, buffers_) {
+				delete buffer;
+			}
+		}
+
+		void setWipe(bool wipe) {
+			boost::lock_guard<boost::mutex> lock(mutex_);
+			wipe_ = wipe;
+		}
+
+		// Returns a buffer of the given size to read into. Growing a buffer
+		// fills it with zeros, so this should only be used when the
+		// connection's read buffer was handed out, or the read size changed.
+		boost::shared_ptr<SafeByteArray> acquire(size_t size) {
+			SafeByteArray* buffer = take(size);
+			buffer->resize(size);
+			return boost::shared_ptr<SafeByteArray>(buffer, Releaser(shared_from_this()));
+		}
+
+		// Returns a buffer holding a copy of the given data. Unlike resize(),
+		// assign() does not initialize the buffer before copying.
+		boost::shared_ptr<SafeByteArray> acquireCopy(const unsigned char* data, size_t size) {
+			SafeByteArray* buffer = take(size);
+			buffer->assign(data, data + size);
+			return boost::shared_ptr<SafeByteArray>(buffer, Releaser(shared_from_this()));
+		}
+
+	private:
+		struct Releaser {
+			Releaser(boost::shared_ptr<ReadBufferPool> pool) : pool(pool) {
+			}
+
+			void operator()(SafeByteArray* buffer) const {
+				pool->release(buffer);
+			}
+
+			boost::shared_ptr<ReadBufferPool> pool;
+		};
+
+		// Prefers a buffer that is large enough already, so it does not need
+		// to grow.
+		SafeByteArray* take(size_t size) {
+			{
+				boost::lock_guard<boost::mutex> lock(mutex_);
+				if (!buffers_.empty()) {
+					std::vector<SafeByteArray*>::iterator i = buffers_.begin();
+					while (i + 1 != buffers_.end() && (*i)->size() < size) {
+						++i;
+					}
+					SafeByteArray* buffer = *i;
+					buffers_.erase(i);
+					return buffer;
+				}
+			}
+			SafeByteArray* buffer = new SafeByteArray();
+			buffer->reserve(size);
+			return buffer;
+		}
+
+		void release(SafeByteArray* buffer) {
+			bool wipe;
+			{
+				boost::lock_guard<boost::mutex> lock(mutex_);
+				wipe = wipe_;
+			}
+			if (wipe && !buffer->empty()) {
+				secureZeroMemory(reinterpret_cast<char*>(vecptr(*buffer)), buffer->size());
+			}
+			{
+				boost::lock_guard<boost::mutex> lock(mutex_);
+				if (buffers_.size() < MAX_POOLED_READ_BUFFERS) {
+					buffers_.push_back(buffer);
+					return;
+				}
+			}
+			delete buffer;
+		}
+
+	private:
+		bool wipe_;
+		boost::mutex mutex_;
+		std::vector<SafeByteArray*> buffers_;
+};
+
+// -----------------------------------------------------------------------------
+
+// A reference-counted sequence of non-modifiable buffers, which is written
+// out in one gathering write.
+class SharedBufferSequence {
+	public:
+		SharedBufferSequence(std::vector<BoostConnection::WriteBuffer>& data) : data_(boost::make_shared<Data>()) {
+			data_->data.swap(data);
+			data_->buffers.reserve(data_->data.size());
+			foreach (const BoostConnection::WriteBuffer& buffer, data_->data) {
+				if (buffer.safeData && !buffer.safeData->empty()) {
+					data_->buffers.push_back(boost::asio::buffer(vecptr(*buffer.safeData), buffer.safeData->size()));
+				}
+				else if (buffer.data && !buffer.data->empty()) {
+					data_->buffers.push_back(boost::asio::buffer(vecptr(*buffer.data), buffer.data->size()));
+				}
+			}
 		}
 
 		// ConstBufferSequence requirements.
 		typedef boost::asio::const_buffer value_type;
-		typedef const boost::asio::const_buffer* const_iterator;
-		const boost::asio::const_buffer* begin() const { return &buffer_; }
-		const boost::asio::const_buffer* end() const { return &buffer_ + 1; }
+		typedef std::vector<boost::asio::const_buffer>::const_iterator const_iterator;
+		const_iterator begin() const { return data_->buffers.begin(); }
+		const_iterator end() const { return data_->buffers.end(); }
 
 	private:
-		boost::shared_ptr< std::vector<char, SafeAllocator<char> > > data_;
-		boost::asio::const_buffer buffer_;
+		struct Data {
+			std::vector<BoostConnection::WriteBuffer> data;
+			std::vector<boost::asio::const_buffer> buffers;
+		};
+		boost::shared_ptr<Data> data_;
 };
 
 // -----------------------------------------------------------------------------
 
 BoostConnection::BoostConnection(boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) :
-	eventLoop(eventLoop), ioService(ioService), socket_(*ioService), writing_(false), closeSocketAfterNextWrite_(false) {
+	eventLoop(eventLoop), ioService(ioService), socket_(*ioService), readBufferPool_(boost::make_shared<ReadBufferPool>()), readSize_(BUFFER_SIZE), consecutiveFullReads_(0), writing_(false), closeSocketAfterNextWrite_(false) {
 }
 
 BoostConnection::~BoostConnection() {
 }
 
+void BoostConnection::setWipeReadBuffers(bool wipe) {
+	readBufferPool_->setWipe(wipe);
+}
+
 void BoostConnection::listen() {
 	doRead();
 }
@@ -92,17 +208,51 @@ void BoostConnection::closeSocket() {
 
 void BoostConnection::write(const SafeByteArray& data) {
 	boost::lock_guard<boost::mutex> lock(writeMutex_);
+	// Coalesce consecutive copied writes into one buffer while a write is in
+	// progress. On an idle connection, the data is sent right away, so it
+	// only needs a copy of its own size.
+	if (writeQueueTail_) {
+		append(*writeQueueTail_, data);
+	}
+	else if (writing_) {
+		writeQueueTail_ = boost::make_shared<SafeByteArray>();
+		writeQueueTail_->reserve(std::max(data.size(), WRITE_BUFFER_SIZE));
+		append(*writeQueueTail_, data);
+		writeQueue_.push_back(WriteBuffer(writeQueueTail_));
+	}
+	else {
+		writeQueue_.push_back(WriteBuffer(boost::make_shared<SafeByteArray>(data)));
+	}
 	if (!writing_) {
 		writing_ = true;
-		doWrite(data);
+		doWrite();
 	}
-	else {
-		append(writeQueue_, data);
+}
+
+void BoostConnection::writeShared(boost::shared_ptr<const SafeByteArray> data) {
+	boost::lock_guard<boost::mutex> lock(writeMutex_);
+	writeQueue_.push_back(WriteBuffer(data));
+	writeQueueTail_.reset();
+	if (!writing_) {
+		writing_ = true;
+		doWrite();
+	}
+}
+
+void BoostConnection::writeShared(boost::shared_ptr<const ByteArray> data) {
+	boost::lock_guard<boost::mutex> lock(writeMutex_);
+	writeQueue_.push_back(WriteBuffer(data));
+	writeQueueTail_.reset();
+	if (!writing_) {
+		writing_ = true;
+		doWrite();
 	}
 }
 
-void BoostConnection::doWrite(const SafeByteArray& data) {
-	boost::asio::async_write(socket_, SharedBuffer(data),
+// Needs to be called with writeMutex_ held.
+void BoostConnection::doWrite() {
+	writeQueueTail_.reset();
+	boost::asio::async_write(socket_, SharedBufferSequence(writeQueue_),
 			boost::bind(&BoostConnection::handleDataWritten, shared_from_this(), boost::asio::placeholders::error));
 }
 
@@ -118,7 +268,12 @@ void BoostConnection::handleConnectFinished(const boost::system::error_code& err
 }
 
 void BoostConnection::doRead() {
-	readBuffer_ = boost::make_shared<SafeByteArray>(BUFFER_SIZE);
+	if (!readBuffer_) {
+		readBuffer_ = readBufferPool_->acquire(readSize_);
+	}
+	else if (readBuffer_->size() != readSize_) {
+		readBuffer_->resize(readSize_);
+	}
 	socket_.async_read_some(
 			boost::asio::buffer(*readBuffer_),
 			boost::bind(&BoostConnection::handleSocketRead, shared_from_this(), boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
@@ -127,8 +282,32 @@ void BoostConnection::doRead() {
 void BoostConnection::handleSocketRead(const boost::system::error_code& error, size_t bytesTransferred) {
 	SWIFT_LOG(debug) << "Socket read " << error << std::endl;
 	if (!error) {
-		readBuffer_->resize(bytesTransferred);
-		eventLoop->postEvent(boost::bind(boost::ref(onDataRead), readBuffer_), shared_from_this());
+		// Grow the read size when the peer keeps filling our buffers, and shrink
+		// it again when the traffic calms down.
+		if (bytesTransferred == readSize_) {
+			if (++consecutiveFullReads_ >= FULL_READS_BEFORE_GROWING && readSize_ < MAX_BUFFER_SIZE) {
+				readSize_ *= 2;
+				consecutiveFullReads_ = 0;
+			}
+		}
+		else {
+			consecutiveFullReads_ = 0;
+			if (bytesTransferred < readSize_ / 4 && readSize_ > BUFFER_SIZE) {
+				readSize_ /= 2;
+			}
+		}
+
+		// A full buffer is handed out as it is. Otherwise, the data is copied
+		// out, so the read buffer keeps its size and is reused for the next
+		// read without being filled up again.
+		boost::shared_ptr<SafeByteArray> data;
+		if (bytesTransferred == readBuffer_->size()) {
+			data.swap(readBuffer_);
+		}
+		else {
+			data = readBufferPool_->acquireCopy(vecptr(*readBuffer_), bytesTransferred);
+		}
+		eventLoop->postEvent(boost::bind(boost::ref(onDataRead), data), shared_from_this());
 		doRead();
 	}
 	else if (/*error == boost::asio::error::eof ||*/ error == boost::asio::error::operation_aborted) {
@@ -159,8 +338,7 @@ void BoostConnection::handleDataWritten(const boost::system::error_code& error)
 			}
 		}
 		else {
-			doWrite(writeQueue_);
-			writeQueue_.clear();
+			doWrite();
 		}
 	}
 }
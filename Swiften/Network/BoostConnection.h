@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,6 +14,7 @@
 #include <Swiften/Base/API.h>
 #include <Swiften/Network/Connection.h>
 #include <Swiften/EventLoop/EventOwner.h>
+#include <Swiften/Base/ByteArray.h>
 #include <Swiften/Base/SafeByteArray.h>
 
 namespace boost {
@@ -40,6 +41,8 @@ namespace Swift {
 			virtual void connect(const HostAddressPort& address);
 			virtual void disconnect();
 			virtual void write(const SafeByteArray& data);
+			virtual void writeShared(boost::shared_ptr<const SafeByteArray> data);
+			virtual void writeShared(boost::shared_ptr<const ByteArray> data);
 
 			boost::asio::ip::tcp::socket& getSocket() {
 				return socket_;
@@ -47,24 +50,50 @@ namespace Swift {
 
 			HostAddressPort getLocalAddress() const;
 
+			/**
+			 * Read buffers are recycled, and are securely wiped before they are
+			 * reused (which is the default). Connections that never carry
+			 * credentials or other secrets can turn this off to save a pass
+			 * over every received byte.
+			 *
+			 * This applies to all buffers that are released after the call.
+			 */
+			virtual void setWipeReadBuffers(bool wipe);
+
 		private:
+			class ReadBufferPool;
+
+			// A queued buffer, which either holds sensitive or plain data.
+			struct WriteBuffer {
+				WriteBuffer(boost::shared_ptr<const SafeByteArray> safeData) : safeData(safeData) {}
+				WriteBuffer(boost::shared_ptr<const ByteArray> data) : data(data) {}
+
+				boost::shared_ptr<const SafeByteArray> safeData;
+				boost::shared_ptr<const ByteArray> data;
+			};
+			friend class SharedBufferSequence;
+
 			BoostConnection(boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop);
 
 			void handleConnectFinished(const boost::system::error_code& error);
 			void handleSocketRead(const boost::system::error_code& error, size_t bytesTransferred);
 			void handleDataWritten(const boost::system::error_code& error);
 			void doRead();
-			void doWrite(const SafeByteArray& data);
+			void doWrite();
 			void closeSocket();
 
 		private:
 			EventLoop* eventLoop;
 			boost::shared_ptr<boost::asio::io_service> ioService;
 			boost::asio::ip::tcp::socket socket_;
+			boost::shared_ptr<ReadBufferPool> readBufferPool_;
 			boost::shared_ptr<SafeByteArray> readBuffer_;
+			size_t readSize_;
+			int consecutiveFullReads_;
 			boost::mutex writeMutex_;
 			bool writing_;
-			SafeByteArray writeQueue_;
+			std::vector<WriteBuffer> writeQueue_;
+			boost::shared_ptr<SafeByteArray> writeQueueTail_;
 			bool closeSocketAfterNextWrite_;
 	};
 }
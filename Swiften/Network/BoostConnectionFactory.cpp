@@ -1,19 +1,25 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Network/BoostConnectionFactory.h>
 #include <Swiften/Network/BoostConnection.h>
+#include <Swiften/Network/BoostIOServicePool.h>
 
 namespace Swift {
 
-BoostConnectionFactory::BoostConnectionFactory(boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : ioService(ioService), eventLoop(eventLoop) {
+BoostConnectionFactory::BoostConnectionFactory(boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : ioService(ioService), ioServicePool(NULL), eventLoop(eventLoop), wipeReadBuffers(true) {
+}
+
+BoostConnectionFactory::BoostConnectionFactory(BoostIOServicePool* ioServicePool, EventLoop* eventLoop) : ioServicePool(ioServicePool), eventLoop(eventLoop), wipeReadBuffers(true) {
 }
 
 boost::shared_ptr<Connection> BoostConnectionFactory::createConnection() {
-	return BoostConnection::create(ioService, eventLoop);
+	BoostConnection::ref connection = BoostConnection::create(ioServicePool ? ioServicePool->getIOService() : ioService, eventLoop);
+	connection->setWipeReadBuffers(wipeReadBuffers);
+	return connection;
 }
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,15 +13,30 @@
 
 namespace Swift {
 	class BoostConnection;
+	class BoostIOServicePool;
 
 	class BoostConnectionFactory : public ConnectionFactory {
 		public:
 			BoostConnectionFactory(boost::shared_ptr<boost::asio::io_service>, EventLoop* eventLoop);
 
+			/**
+			 * Spreads the created connections over the io_services of \p ioServicePool.
+			 */
+			BoostConnectionFactory(BoostIOServicePool* ioServicePool, EventLoop* eventLoop);
+
 			virtual boost::shared_ptr<Connection> createConnection();
 
+			/**
+			 * \see BoostConnection::setWipeReadBuffers()
+			 */
+			void setWipeReadBuffers(bool wipe) {
+				wipeReadBuffers = wipe;
+			}
+
 		private:
 			boost::shared_ptr<boost::asio::io_service> ioService;
+			BoostIOServicePool* ioServicePool;
 			EventLoop* eventLoop;
+			bool wipeReadBuffers;
 	};
 }
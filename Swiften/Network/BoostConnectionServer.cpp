@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,13 +13,17 @@
 #include <boost/optional.hpp>
 
 #include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/Network/BoostIOServicePool.h>
 
 namespace Swift {
 
-BoostConnectionServer::BoostConnectionServer(int port, boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : port_(port), ioService_(ioService), eventLoop(eventLoop), acceptor_(NULL) {
+BoostConnectionServer::BoostConnectionServer(int port, boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : port_(port), ioService_(ioService), ioServicePool_(NULL), eventLoop(eventLoop), acceptor_(NULL) {
 }
 
-BoostConnectionServer::BoostConnectionServer(const HostAddress &address, int port, boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : address_(address), port_(port), ioService_(ioService), eventLoop(eventLoop), acceptor_(NULL) {
+BoostConnectionServer::BoostConnectionServer(const HostAddress &address, int port, boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : address_(address), port_(port), ioService_(ioService), ioServicePool_(NULL), eventLoop(eventLoop), acceptor_(NULL) {
+}
+
+BoostConnectionServer::BoostConnectionServer(const HostAddress &address, int port, BoostIOServicePool* ioServicePool, EventLoop* eventLoop) : address_(address), port_(port), ioService_(ioServicePool->getMainIOService()), ioServicePool_(ioServicePool), eventLoop(eventLoop), acceptor_(NULL) {
 }
 
 void BoostConnectionServer::start() {
@@ -70,7 +74,7 @@ void BoostConnectionServer::stop(boost::optional<Error> e) {
 }
 
 void BoostConnectionServer::acceptNextConnection() {
-	BoostConnection::ref newConnection(BoostConnection::create(ioService_, eventLoop));
+	BoostConnection::ref newConnection(BoostConnection::create(ioServicePool_ ? ioServicePool_->getIOService() : ioService_, eventLoop));
 	acceptor_->async_accept(newConnection->getSocket(), 
 		boost::bind(&BoostConnectionServer::handleAccept, shared_from_this(), newConnection, boost::asio::placeholders::error));
 }
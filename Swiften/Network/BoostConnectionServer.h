@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -19,6 +19,8 @@
 #include <boost/optional/optional_fwd.hpp>
 
 namespace Swift {
+	class BoostIOServicePool;
+
 	class SWIFTEN_API BoostConnectionServer : public ConnectionServer, public EventOwner, public boost::enable_shared_from_this<BoostConnectionServer> {
 		public:
 			typedef boost::shared_ptr<BoostConnectionServer> ref;
@@ -31,6 +33,14 @@ namespace Swift {
 				return ref(new BoostConnectionServer(address, port, ioService, eventLoop));
 			}
 
+			/**
+			 * Creates a server that spreads the accepted connections over the
+			 * io_services of \p ioServicePool.
+			 */
+			static ref create(const HostAddress &address, int port, BoostIOServicePool* ioServicePool, EventLoop* eventLoop) {
+				return ref(new BoostConnectionServer(address, port, ioServicePool, eventLoop));
+			}
+
 			virtual boost::optional<Error> tryStart(); // FIXME: This should become the new start
 			virtual void start();
 			virtual void stop();
@@ -42,6 +52,7 @@ namespace Swift {
 		private:
 			BoostConnectionServer(int port, boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop);
 			BoostConnectionServer(const HostAddress &address, int port, boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop);
+			BoostConnectionServer(const HostAddress &address, int port, BoostIOServicePool* ioServicePool, EventLoop* eventLoop);
 
 			void stop(boost::optional<Error> e);
 			void acceptNextConnection();
@@ -51,6 +62,7 @@ namespace Swift {
 			HostAddress address_;
 			int port_;
 			boost::shared_ptr<boost::asio::io_service> ioService_;
+			BoostIOServicePool* ioServicePool_;
 			EventLoop* eventLoop;
 			boost::asio::ip::tcp::acceptor* acceptor_;
 	};
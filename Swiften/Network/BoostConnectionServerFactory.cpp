@@ -6,17 +6,24 @@
 
 #include <Swiften/Network/BoostConnectionServerFactory.h>
 #include <Swiften/Network/BoostConnectionServer.h>
+#include <Swiften/Network/BoostIOServicePool.h>
 
 namespace Swift {
 
-BoostConnectionServerFactory::BoostConnectionServerFactory(boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : ioService(ioService), eventLoop(eventLoop) {
+BoostConnectionServerFactory::BoostConnectionServerFactory(boost::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : ioService(ioService), ioServicePool(NULL), eventLoop(eventLoop) {
+}
+
+BoostConnectionServerFactory::BoostConnectionServerFactory(BoostIOServicePool* ioServicePool, EventLoop* eventLoop) : ioService(ioServicePool->getMainIOService()), ioServicePool(ioServicePool), eventLoop(eventLoop) {
 }
 
 boost::shared_ptr<ConnectionServer> BoostConnectionServerFactory::createConnectionServer(int port) {
-	return BoostConnectionServer::create(port, ioService, eventLoop);
+	return createConnectionServer(HostAddress(), port);
 }
 
 boost::shared_ptr<ConnectionServer> BoostConnectionServerFactory::createConnectionServer(const Swift::HostAddress &hostAddress, int port) {
+	if (ioServicePool) {
+		return BoostConnectionServer::create(hostAddress, port, ioServicePool, eventLoop);
+	}
 	return BoostConnectionServer::create(hostAddress, port, ioService, eventLoop);
 }
 
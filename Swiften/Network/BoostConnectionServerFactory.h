@@ -13,10 +13,12 @@
 
 namespace Swift {
 	class ConnectionServer;
+	class BoostIOServicePool;
 
 	class BoostConnectionServerFactory : public ConnectionServerFactory {
 		public:
 			BoostConnectionServerFactory(boost::shared_ptr<boost::asio::io_service>, EventLoop* eventLoop);
+			BoostConnectionServerFactory(BoostIOServicePool* ioServicePool, EventLoop* eventLoop);
 
 			virtual boost::shared_ptr<ConnectionServer> createConnectionServer(int port);
 
@@ -24,6 +26,7 @@ namespace Swift {
 
 		private:
 			boost::shared_ptr<boost::asio::io_service> ioService;
+			BoostIOServicePool* ioServicePool;
 			EventLoop* eventLoop;
 	};
 }
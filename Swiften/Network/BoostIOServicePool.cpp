@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Network/BoostIOServicePool.h>
+
+#include <cassert>
+
+#include <Swiften/Base/foreach.h>
+#include <Swiften/Network/BoostIOServiceThread.h>
+
+namespace Swift {
+
+BoostIOServicePool::BoostIOServicePool(size_t size) : next_(0) {
+	assert(size > 0);
+	for (size_t i = 0; i < size; ++i) {
+		threads_.push_back(new BoostIOServiceThread());
+	}
+}
+
+BoostIOServicePool::~BoostIOServicePool() {
+	foreach (BoostIOServiceThread* thread, threads_) {
+		delete thread;
+	}
+}
+
+boost::shared_ptr<boost::asio::io_service> BoostIOServicePool::getIOService() {
+	if (threads_.size() == 1) {
+		return threads_[0]->getIOService();
+	}
+	return threads_[next_.fetch_add(1, boost::memory_order_relaxed) % threads_.size()]->getIOService();
+}
+
+boost::shared_ptr<boost::asio::io_service> BoostIOServicePool::getMainIOService() const {
+	return threads_[0]->getIOService();
+}
+
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <vector>
+#include <boost/asio/io_service.hpp>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <Swiften/Base/API.h>
+
+namespace Swift {
+	class BoostIOServiceThread;
+
+	/**
+	 * A fixed set of io_services, each run by its own BoostIOServiceThread.
+	 *
+	 * Because every io_service is run by exactly one thread, everything bound
+	 * to one of them (e.g. all handlers of a BoostConnection) is implicitly
+	 * serialized, just like with a single BoostIOServiceThread. Different
+	 * connections can however be served by different threads.
+	 */
+	class SWIFTEN_API BoostIOServicePool : public boost::noncopyable {
+		public:
+			BoostIOServicePool(size_t size = 1);
+			~BoostIOServicePool();
+
+			size_t getSize() const {
+				return threads_.size();
+			}
+
+			/**
+			 * Returns the next io_service to bind a new object to, in
+			 * round-robin order. Can be called from any thread.
+			 */
+			boost::shared_ptr<boost::asio::io_service> getIOService();
+
+			/**
+			 * Returns the first io_service of the pool, which is used for
+			 * everything that is not spread over the pool (e.g. timers).
+			 */
+			boost::shared_ptr<boost::asio::io_service> getMainIOService() const;
+
+			BoostIOServiceThread* getThread(size_t index) const {
+				return threads_[index];
+			}
+
+		private:
+			std::vector<BoostIOServiceThread*> threads_;
+			boost::atomic<size_t> next_;
+	};
+}
@@ -10,6 +10,7 @@
 #include <Swiften/Base/Override.h>
 #include <Swiften/Network/NetworkFactories.h>
 #include <Swiften/Network/BoostIOServiceThread.h>
+#include <Swiften/Network/BoostIOServicePool.h>
 
 namespace Swift {
 	class EventLoop;
@@ -18,7 +19,12 @@ namespace Swift {
 
 	class SWIFTEN_API BoostNetworkFactories : public NetworkFactories {
 		public:
-			BoostNetworkFactories(EventLoop* eventLoop);
+			/**
+			 * \param ioServiceThreads The number of threads doing the network
+			 *	I/O. Connections are spread over these threads, but all events
+			 *	are still delivered through \p eventLoop.
+			 */
+			BoostNetworkFactories(EventLoop* eventLoop, size_t ioServiceThreads = 1);
 			virtual ~BoostNetworkFactories();
 
 			virtual TimerFactory* getTimerFactory() const SWIFTEN_OVERRIDE {
@@ -30,7 +36,11 @@ namespace Swift {
 			}
 
 			BoostIOServiceThread* getIOServiceThread() {
-				return &ioServiceThread;
+				return ioServicePool.getThread(0);
+			}
+
+			BoostIOServicePool* getIOServicePool() {
+				return &ioServicePool;
 			}
 
 			DomainNameResolver* getDomainNameResolver() const SWIFTEN_OVERRIDE {
@@ -72,9 +82,10 @@ namespace Swift {
 			}
 
 		private:
-			BoostIOServiceThread ioServiceThread;
+			BoostIOServicePool ioServicePool;
 			TimerFactory* timerFactory;
 			ConnectionFactory* connectionFactory;
+			DomainNameResolver* platformDomainNameResolver;
 			DomainNameResolver* domainNameResolver;
 			ConnectionServerFactory* connectionServerFactory;
 			NATTraverser* natTraverser;
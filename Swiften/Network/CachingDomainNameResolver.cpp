@@ -1,30 +1,272 @@
 /*
- * Copyright (c) 2012 Isode Limited.
+ * Copyright (c) 2012-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Network/CachingDomainNameResolver.h>
 
+#include <algorithm>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/bind.hpp>
+#include <boost/enable_shared_from_this.hpp>
 #include <boost/smart_ptr/make_shared.hpp>
 
+#include <Swiften/Base/foreach.h>
+#include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
+#include <Swiften/IDN/IDNConverter.h>
+#include <Swiften/Network/Timer.h>
+#include <Swiften/Network/TimerFactory.h>
+
 namespace Swift {
 
-CachingDomainNameResolver::CachingDomainNameResolver(DomainNameResolver* realResolver, EventLoop*) : realResolver(realResolver) {
+class CachingDomainNameResolver::CachedServiceQuery : public DomainNameServiceQuery, public EventOwner, public boost::enable_shared_from_this<CachedServiceQuery> {
+	public:
+		CachedServiceQuery(CachingDomainNameResolver* resolver, const std::string& serviceLookupPrefix, const std::string& domain) : resolver(resolver), serviceLookupPrefix(serviceLookupPrefix), domain(domain) {
+		}
+
+		virtual void run() {
+			resolver->runServiceQuery(shared_from_this());
+		}
+
+		void emitResult(const std::vector<DomainNameServiceQuery::Result>& results, boost::optional<DomainNameResolveError> error) {
+			onResult(results, error);
+		}
+
+		CachingDomainNameResolver* resolver;
+		std::string serviceLookupPrefix;
+		std::string domain;
+};
+
+class CachingDomainNameResolver::CachedAddressQuery : public DomainNameAddressQuery, public EventOwner, public boost::enable_shared_from_this<CachedAddressQuery> {
+	public:
+		CachedAddressQuery(CachingDomainNameResolver* resolver, const std::string& name) : resolver(resolver), name(name) {
+		}
+
+		virtual void run() {
+			resolver->runAddressQuery(shared_from_this());
+		}
+
+		void emitResult(const std::vector<HostAddress>& addresses, boost::optional<DomainNameResolveError> error) {
+			onResult(addresses, error);
+		}
+
+		CachingDomainNameResolver* resolver;
+		std::string name;
+};
+
+namespace {
+	// Bound into an event to keep an object alive until that event has
+	// been handled.
+	template<typename T>
+	void release(boost::shared_ptr<T>) {
+	}
 }
 
-CachingDomainNameResolver::~CachingDomainNameResolver() {
+CachingDomainNameResolver::CachingDomainNameResolver(DomainNameResolver* realResolver, IDNConverter* idnConverter, EventLoop* eventLoop, TimerFactory* timerFactory) : realResolver(realResolver), idnConverter(idnConverter), eventLoop(eventLoop), timerFactory(timerFactory), defaultTTL(300), negativeTTL(30), maximumTTL(3600) {
+}
 
+CachingDomainNameResolver::~CachingDomainNameResolver() {
+	for (std::map<std::string, ServiceEntry>::iterator i = serviceEntries.begin(); i != serviceEntries.end(); ++i) {
+		if (i->second.lookup) {
+			i->second.lookup->onResult.disconnect_all_slots();
+		}
+		if (i->second.expiryTimer) {
+			i->second.expiryTimer->stop();
+			i->second.expiryTimer->onTick.disconnect_all_slots();
+		}
+	}
+	for (std::map<std::string, AddressEntry>::iterator i = addressEntries.begin(); i != addressEntries.end(); ++i) {
+		if (i->second.lookup) {
+			i->second.lookup->onResult.disconnect_all_slots();
+		}
+		if (i->second.expiryTimer) {
+			i->second.expiryTimer->stop();
+			i->second.expiryTimer->onTick.disconnect_all_slots();
+		}
+	}
 }
 
 DomainNameServiceQuery::ref CachingDomainNameResolver::createServiceQuery(const std::string& serviceLookupPrefix, const std::string& domain) {
-	//TODO: Cache
-	return realResolver->createServiceQuery(serviceLookupPrefix, domain);
+	return boost::make_shared<CachedServiceQuery>(this, serviceLookupPrefix, domain);
 }
 
 DomainNameAddressQuery::ref CachingDomainNameResolver::createAddressQuery(const std::string& name) {
-	//TODO: Cache
-	return realResolver->createAddressQuery(name);
+	return boost::make_shared<CachedAddressQuery>(this, name);
+}
+
+void CachingDomainNameResolver::clear() {
+	for (std::map<std::string, ServiceEntry>::iterator i = serviceEntries.begin(); i != serviceEntries.end(); ) {
+		if (i->second.results) {
+			i->second.expiryTimer->stop();
+			i->second.expiryTimer->onTick.disconnect_all_slots();
+			serviceEntries.erase(i++);
+		}
+		else {
+			++i;
+		}
+	}
+	for (std::map<std::string, AddressEntry>::iterator i = addressEntries.begin(); i != addressEntries.end(); ) {
+		if (i->second.complete) {
+			i->second.expiryTimer->stop();
+			i->second.expiryTimer->onTick.disconnect_all_slots();
+			addressEntries.erase(i++);
+		}
+		else {
+			++i;
+		}
+	}
+}
+
+void CachingDomainNameResolver::runServiceQuery(boost::shared_ptr<CachedServiceQuery> query) {
+	std::string domain = getNormalizedName(query->domain);
+	std::string key = query->serviceLookupPrefix + domain;
+	ServiceEntry& entry = serviceEntries[key];
+	if (entry.results) {
+		eventLoop->postEvent(boost::bind(&CachedServiceQuery::emitResult, query, shuffle(*entry.results), entry.error), query);
+		return;
+	}
+	entry.waiters.push_back(query);
+	if (!entry.lookup) {
+		entry.lookup = realResolver->createServiceQuery(query->serviceLookupPrefix, domain);
+		entry.lookup->onResult.connect(boost::bind(&CachingDomainNameResolver::handleServiceResult, this, key, _1, _2));
+		entry.lookup->run();
+	}
+}
+
+void CachingDomainNameResolver::handleServiceResult(const std::string& key, const std::vector<DomainNameServiceQuery::Result>& results, boost::optional<DomainNameResolveError> error) {
+	std::map<std::string, ServiceEntry>::iterator i = serviceEntries.find(key);
+	if (i == serviceEntries.end()) {
+		return;
+	}
+	ServiceEntry& entry = i->second;
+
+	// The lookup is still emitting its result, so it can't be destroyed yet
+	eventLoop->postEvent(boost::bind(&release<DomainNameServiceQuery>, entry.lookup));
+	entry.lookup.reset();
+
+	int ttl = getNegativeTTL(error);
+	if (!error && !results.empty()) {
+		ttl = -1;
+		foreach (const DomainNameServiceQuery::Result& result, results) {
+			if (result.ttl >= 0 && (ttl < 0 || result.ttl < ttl)) {
+				ttl = result.ttl;
+			}
+		}
+		if (ttl < 0) {
+			ttl = defaultTTL;
+		}
+	}
+	ttl = std::min(ttl, maximumTTL);
+
+	std::vector< boost::weak_ptr<CachedServiceQuery> > waiters;
+	waiters.swap(entry.waiters);
+	if (ttl > 0) {
+		entry.results = results;
+		entry.error = error;
+		entry.expiryTimer = createExpiryTimer(ttl);
+		entry.expiryTimer->onTick.connect(boost::bind(&CachingDomainNameResolver::handleServiceExpired, this, key));
+		entry.expiryTimer->start();
+	}
+	else {
+		serviceEntries.erase(i);
+	}
+
+	foreach (const boost::weak_ptr<CachedServiceQuery>& waiter, waiters) {
+		if (boost::shared_ptr<CachedServiceQuery> query = waiter.lock()) {
+			query->emitResult(shuffle(results), error);
+		}
+	}
+}
+
+void CachingDomainNameResolver::runAddressQuery(boost::shared_ptr<CachedAddressQuery> query) {
+	std::string name = getNormalizedName(query->name);
+	AddressEntry& entry = addressEntries[name];
+	if (entry.complete) {
+		eventLoop->postEvent(boost::bind(&CachedAddressQuery::emitResult, query, entry.addresses, entry.error), query);
+		return;
+	}
+	entry.waiters.push_back(query);
+	if (!entry.lookup) {
+		entry.lookup = realResolver->createAddressQuery(name);
+		entry.lookup->onResult.connect(boost::bind(&CachingDomainNameResolver::handleAddressResult, this, name, _1, _2));
+		entry.lookup->run();
+	}
+}
+
+void CachingDomainNameResolver::handleAddressResult(const std::string& key, const std::vector<HostAddress>& addresses, boost::optional<DomainNameResolveError> error) {
+	std::map<std::string, AddressEntry>::iterator i = addressEntries.find(key);
+	if (i == addressEntries.end()) {
+		return;
+	}
+	AddressEntry& entry = i->second;
+
+	eventLoop->postEvent(boost::bind(&release<DomainNameAddressQuery>, entry.lookup));
+	entry.lookup.reset();
+
+	int ttl = std::min(!error && !addresses.empty() ? defaultTTL : getNegativeTTL(error), maximumTTL);
+
+	std::vector< boost::weak_ptr<CachedAddressQuery> > waiters;
+	waiters.swap(entry.waiters);
+	if (ttl > 0) {
+		entry.complete = true;
+		entry.addresses = addresses;
+		entry.error = error;
+		entry.expiryTimer = createExpiryTimer(ttl);
+		entry.expiryTimer->onTick.connect(boost::bind(&CachingDomainNameResolver::handleAddressExpired, this, key));
+		entry.expiryTimer->start();
+	}
+	else {
+		addressEntries.erase(i);
+	}
+
+	foreach (const boost::weak_ptr<CachedAddressQuery>& waiter, waiters) {
+		if (boost::shared_ptr<CachedAddressQuery> query = waiter.lock()) {
+			query->emitResult(addresses, error);
+		}
+	}
+}
+
+void CachingDomainNameResolver::handleServiceExpired(const std::string& key) {
+	std::map<std::string, ServiceEntry>::iterator i = serviceEntries.find(key);
+	if (i != serviceEntries.end() && i->second.results) {
+		eventLoop->postEvent(boost::bind(&release<Timer>, i->second.expiryTimer));
+		serviceEntries.erase(i);
+	}
+}
+
+void CachingDomainNameResolver::handleAddressExpired(const std::string& key) {
+	std::map<std::string, AddressEntry>::iterator i = addressEntries.find(key);
+	if (i != addressEntries.end() && i->second.complete) {
+		eventLoop->postEvent(boost::bind(&release<Timer>, i->second.expiryTimer));
+		addressEntries.erase(i);
+	}
+}
+
+int CachingDomainNameResolver::getNegativeTTL(boost::optional<DomainNameResolveError> error) const {
+	// Other failures (no network, timeouts, server failures) can go away
+	// at any moment, so the next query should retry them.
+	return error && error->getType() == DomainNameResolveError::NonExistentDomainError ? negativeTTL : 0;
+}
+
+boost::shared_ptr<Timer> CachingDomainNameResolver::createExpiryTimer(int seconds) {
+	return timerFactory->createTimer(seconds * 1000);
+}
+
+std::string CachingDomainNameResolver::getNormalizedName(const std::string& name) {
+	// IDNA encoding only case-folds labels with non-ASCII characters.
+	// Names that can't be encoded are left for the real resolver to fail on.
+	boost::optional<std::string> encodedName = idnConverter->getIDNAEncoded(name);
+	return boost::to_lower_copy(encodedName ? *encodedName : name);
+}
+
+std::vector<DomainNameServiceQuery::Result> CachingDomainNameResolver::shuffle(const std::vector<DomainNameServiceQuery::Result>& results) {
+	// Redo the weighted ordering for every query, so that cached results
+	// still spread clients over the servers of equal priority.
+	std::vector<DomainNameServiceQuery::Result> shuffledResults(results);
+	DomainNameServiceQuery::sortResults(shuffledResults, randomGenerator);
+	return shuffledResults;
 }
 
 }
@@ -1,31 +1,129 @@
 /*
- * Copyright (c) 2012 Isode Limited.
+ * Copyright (c) 2012-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/BoostRandomGenerator.h>
+#include <Swiften/Network/DomainNameAddressQuery.h>
 #include <Swiften/Network/DomainNameResolver.h>
-#include <Swiften/Network/StaticDomainNameResolver.h>
+#include <Swiften/Network/DomainNameServiceQuery.h>
+#include <Swiften/Network/HostAddress.h>
 
-/*
- * FIXME: Does not do any caching yet.
- */
 namespace Swift {
 	class EventLoop;
+	class IDNConverter;
+	class Timer;
+	class TimerFactory;
 
-	class CachingDomainNameResolver : public DomainNameResolver {
+	/**
+	 * A resolver that caches the results of another resolver.
+	 *
+	 * Service results are kept for the smallest TTL of their records,
+	 * address results (for which the platform resolvers do not report a
+	 * TTL) for the default TTL, and answers that a name does not exist for
+	 * the negative TTL. Other failed or empty lookups are not cached.
+	 * Queries for a name that is already being looked up wait for the
+	 * outstanding lookup instead of starting a new one.
+	 *
+	 * Names are cached (and passed on to the real resolver) in their
+	 * IDNA-encoded, lower case form, so that all spellings of a name share
+	 * one entry.
+	 */
+	class SWIFTEN_API CachingDomainNameResolver : public DomainNameResolver {
 		public:
-			CachingDomainNameResolver(DomainNameResolver* realResolver, EventLoop* eventLoop);
+			CachingDomainNameResolver(DomainNameResolver* realResolver, IDNConverter* idnConverter, EventLoop* eventLoop, TimerFactory* timerFactory);
 			~CachingDomainNameResolver();
 
 			virtual DomainNameServiceQuery::ref createServiceQuery(const std::string& serviceLookupPrefix, const std::string& domain);
 			virtual DomainNameAddressQuery::ref createAddressQuery(const std::string& name);
 
+			/**
+			 * Sets the time (in seconds) to keep results that don't carry
+			 * a TTL of their own.
+			 */
+			void setDefaultTTL(int seconds) {
+				defaultTTL = seconds;
+			}
+
+			/**
+			 * Sets the time (in seconds) to remember that a name does not
+			 * exist.
+			 */
+			void setNegativeTTL(int seconds) {
+				negativeTTL = seconds;
+			}
+
+			/**
+			 * Sets the maximum time (in seconds) to keep any result.
+			 */
+			void setMaximumTTL(int seconds) {
+				maximumTTL = seconds;
+			}
+
+			/**
+			 * Drops all cached results.
+			 *
+			 * Lookups that are in progress are not affected.
+			 */
+			void clear();
+
+		private:
+			class CachedServiceQuery;
+			class CachedAddressQuery;
+			friend class CachedServiceQuery;
+			friend class CachedAddressQuery;
+
+			struct ServiceEntry {
+				boost::optional< std::vector<DomainNameServiceQuery::Result> > results;
+				boost::optional<DomainNameResolveError> error;
+				boost::shared_ptr<Timer> expiryTimer;
+				DomainNameServiceQuery::ref lookup;
+				std::vector< boost::weak_ptr<CachedServiceQuery> > waiters;
+			};
+
+			struct AddressEntry {
+				AddressEntry() : complete(false) {}
+
+				bool complete;
+				std::vector<HostAddress> addresses;
+				boost::optional<DomainNameResolveError> error;
+				boost::shared_ptr<Timer> expiryTimer;
+				DomainNameAddressQuery::ref lookup;
+				std::vector< boost::weak_ptr<CachedAddressQuery> > waiters;
+			};
+
+			void runServiceQuery(boost::shared_ptr<CachedServiceQuery> query);
+			void handleServiceResult(const std::string& key, const std::vector<DomainNameServiceQuery::Result>& results, boost::optional<DomainNameResolveError> error);
+			void runAddressQuery(boost::shared_ptr<CachedAddressQuery> query);
+			void handleAddressResult(const std::string& key, const std::vector<HostAddress>& addresses, boost::optional<DomainNameResolveError> error);
+			void handleServiceExpired(const std::string& key);
+			void handleAddressExpired(const std::string& key);
+			int getNegativeTTL(boost::optional<DomainNameResolveError> error) const;
+			boost::shared_ptr<Timer> createExpiryTimer(int seconds);
+			std::string getNormalizedName(const std::string& name);
+			std::vector<DomainNameServiceQuery::Result> shuffle(const std::vector<DomainNameServiceQuery::Result>& results);
+
 		private:
 			DomainNameResolver* realResolver;
+			IDNConverter* idnConverter;
+			EventLoop* eventLoop;
+			TimerFactory* timerFactory;
+			BoostRandomGenerator randomGenerator;
+			int defaultTTL;
+			int negativeTTL;
+			int maximumTTL;
+			std::map<std::string, ServiceEntry> serviceEntries;
+			std::map<std::string, AddressEntry> addressEntries;
 	};
 }
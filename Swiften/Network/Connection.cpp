@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,3 +13,14 @@ Connection::Connection() {
 
 Connection::~Connection() {
 }
+
+void Connection::writeShared(boost::shared_ptr<const SafeByteArray> data) {
+	write(*data);
+}
+
+void Connection::writeShared(boost::shared_ptr<const ByteArray> data) {
+	write(createSafeByteArray(*data));
+}
+
+void Connection::setWipeReadBuffers(bool) {
+}
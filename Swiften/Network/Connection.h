@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,6 +10,7 @@
 #include <Swiften/Base/boost_bsignals.h>
 
 #include <Swiften/Base/API.h>
+#include <Swiften/Base/ByteArray.h>
 #include <Swiften/Base/SafeByteArray.h>
 
 namespace Swift {
@@ -32,6 +33,34 @@ namespace Swift {
 			virtual void disconnect() = 0;
 			virtual void write(const SafeByteArray& data) = 0;
 
+			/**
+			 * Writes \p data, without copying it if the connection supports
+			 * that. The data must not be modified after it has been passed in.
+			 *
+			 * The default implementation calls write().
+			 */
+			virtual void writeShared(boost::shared_ptr<const SafeByteArray> data);
+
+			/**
+			 * Writes \p data like writeShared(), but for data that isn't
+			 * sensitive (e.g. file contents), and therefore doesn't need to live
+			 * in (and be wiped from) a SafeByteArray.
+			 *
+			 * The default implementation calls write().
+			 */
+			virtual void writeShared(boost::shared_ptr<const ByteArray> data);
+
+			/**
+			 * Tells the connection whether the buffers it reads into need to
+			 * be securely wiped before they are reused or freed. Connections
+			 * that only carry data that isn't sensitive (e.g. file contents)
+			 * can turn this off to save a pass over every received byte.
+			 *
+			 * The default implementation does nothing, so the data is handled
+			 * as sensitive.
+			 */
+			virtual void setWipeReadBuffers(bool wipe);
+
 			virtual HostAddressPort getLocalAddress() const = 0;
 
 		public:
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,6 +11,19 @@
 namespace Swift {
 	class DomainNameResolveError : public Error {
 		public:
-			DomainNameResolveError() {}
+			enum Type {
+				UnknownError,
+				/** The name server answered that the name does not exist. */
+				NonExistentDomainError
+			};
+
+			DomainNameResolveError(Type type = UnknownError) : type(type) {}
+
+			Type getType() const {
+				return type;
+			}
+
+		private:
+			Type type;
 	};
 }
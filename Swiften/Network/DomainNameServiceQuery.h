@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -23,11 +23,13 @@ namespace Swift {
 			typedef boost::shared_ptr<DomainNameServiceQuery> ref;
 
 			struct Result {
-				Result(const std::string& hostname = "", int port = -1, int priority = -1, int weight = -1) : hostname(hostname), port(port), priority(priority), weight(weight) {}
+				Result(const std::string& hostname = "", int port = -1, int priority = -1, int weight = -1, int ttl = -1) : hostname(hostname), port(port), priority(priority), weight(weight), ttl(ttl) {}
 				std::string hostname;
 				int port;
 				int priority;
 				int weight;
+				/** Time to live in seconds, or -1 if unknown */
+				int ttl;
 			};
 
 			virtual ~DomainNameServiceQuery();
@@ -35,6 +37,11 @@ namespace Swift {
 			virtual void run() = 0;
 			static void sortResults(std::vector<DomainNameServiceQuery::Result>& queries, RandomGenerator& generator);
 
-			boost::signal<void (const std::vector<Result>&)> onResult;
+			/**
+			 * Emitted with the records found, and an error if the lookup
+			 * failed. An empty result without an error means the name
+			 * exists, but has no records of the service.
+			 */
+			boost::signal<void (const std::vector<Result>&, boost::optional<DomainNameResolveError>)> onResult;
 	};
 }
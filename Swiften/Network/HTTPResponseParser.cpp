@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Network/HTTPResponseParser.h>
+
+#include <algorithm>
+#include <cassert>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/Base/Log.h>
+
+namespace Swift {
+
+namespace {
+	// Longest status, header, or chunk size line that is accepted
+	const size_t MAX_LINE_SIZE = 65536;
+
+	// Limits how much is allocated up front for a Content-Length body
+	const size_t MAX_BODY_RESERVE = 1024 * 1024;
+}
+
+HTTPResponseParser::HTTPResponseParser() : state(StatusLine), remaining(0) {
+}
+
+void HTTPResponseParser::reset() {
+	state = StatusLine;
+	line.clear();
+	statusCode.clear();
+	headers.clear();
+	remaining = 0;
+	body.clear();
+}
+
+size_t HTTPResponseParser::parse(const unsigned char* data, size_t size) {
+	size_t i = 0;
+	while (i < size && state != Complete && state != Error) {
+		switch (state) {
+			case StatusLine:
+			case Headers:
+			case ChunkSize:
+			case ChunkEnd:
+			case Trailers: {
+				const unsigned char* end = std::find(data + i, data + size, '\n');
+				size_t lineSize = static_cast<size_t>(end - (data + i));
+				if (line.size() + lineSize > MAX_LINE_SIZE) {
+					SWIFT_LOG(warning) << "HTTP response line too long" << std::endl;
+					state = Error;
+					break;
+				}
+				line.append(reinterpret_cast<const char*>(data + i), lineSize);
+				i += lineSize;
+				if (i < size) {
+					// Skip the newline
+					++i;
+					if (!line.empty() && line[line.size() - 1] == '\r') {
+						line.erase(line.size() - 1);
+					}
+					handleLine();
+					line.clear();
+				}
+				break;
+			}
+			case Body:
+			case ChunkData: {
+				size_t count = std::min(size - i, remaining);
+				body.insert(body.end(), data + i, data + i + count);
+				i += count;
+				remaining -= count;
+				if (remaining == 0) {
+					state = (state == Body ? Complete : ChunkEnd);
+				}
+				break;
+			}
+			case BodyUntilClose:
+				body.insert(body.end(), data + i, data + size);
+				i = size;
+				break;
+			case Complete:
+			case Error:
+				assert(false);
+				break;
+		}
+	}
+	return i;
+}
+
+void HTTPResponseParser::handleLine() {
+	switch (state) {
+		case StatusLine: {
+			// HTTP-Version SP Status-Code SP Reason-Phrase
+			size_t codeStart = line.find(' ');
+			if (!boost::starts_with(line, "HTTP/") || codeStart == std::string::npos || line.size() < codeStart + 4) {
+				state = Error;
+				return;
+			}
+			statusCode = line.substr(codeStart + 1, 3);
+			for (size_t i = 0; i < statusCode.size(); ++i) {
+				if (statusCode[i] < '0' || statusCode[i] > '9') {
+					state = Error;
+					return;
+				}
+			}
+			state = Headers;
+			break;
+		}
+		case Headers: {
+			if (line.empty()) {
+				handleHeadersEnd();
+				return;
+			}
+			size_t colon = line.find(':');
+			if (colon == std::string::npos) {
+				state = Error;
+				return;
+			}
+			headers.push_back(std::make_pair(boost::trim_copy(line.substr(0, colon)), boost::trim_copy(line.substr(colon + 1))));
+			break;
+		}
+		case ChunkSize:
+			handleChunkSize();
+			break;
+		case ChunkEnd:
+			state = line.empty() ? ChunkSize : Error;
+			break;
+		case Trailers:
+			// Trailer fields are not used
+			if (line.empty()) {
+				state = Complete;
+			}
+			break;
+		default:
+			assert(false);
+			break;
+	}
+}
+
+void HTTPResponseParser::handleHeadersEnd() {
+	// Informational, 204 (No Content) and 304 (Not Modified) responses have no body
+	if (statusCode[0] == '1' || statusCode == "204" || statusCode == "304") {
+		state = Complete;
+		return;
+	}
+
+	std::string transferEncoding = getHeader("Transfer-Encoding");
+	if (!transferEncoding.empty() && !boost::iequals(transferEncoding, "identity")) {
+		if (!boost::iends_with(transferEncoding, "chunked")) {
+			// Without chunked as the final coding, the body ends with the connection
+			state = BodyUntilClose;
+			return;
+		}
+		state = ChunkSize;
+		return;
+	}
+
+	std::string contentLength = getHeader("Content-Length");
+	if (contentLength.empty()) {
+		state = BodyUntilClose;
+		return;
+	}
+	if (contentLength.find_first_not_of("0123456789") != std::string::npos) {
+		state = Error;
+		return;
+	}
+	try {
+		remaining = boost::lexical_cast<size_t>(contentLength);
+	}
+	catch (const boost::bad_lexical_cast&) {
+		state = Error;
+		return;
+	}
+	body.reserve(std::min(remaining, MAX_BODY_RESERVE));
+	state = remaining == 0 ? Complete : Body;
+}
+
+void HTTPResponseParser::handleChunkSize() {
+	// chunk-size [ chunk-extension ]
+	size_t size = 0;
+	size_t i = 0;
+	for (; i < line.size(); ++i) {
+		char c = line[i];
+		size_t digit;
+		if (c >= '0' && c <= '9') {
+			digit = static_cast<size_t>(c - '0');
+		}
+		else if (c >= 'a' && c <= 'f') {
+			digit = static_cast<size_t>(c - 'a' + 10);
+		}
+		else if (c >= 'A' && c <= 'F') {
+			digit = static_cast<size_t>(c - 'A' + 10);
+		}
+		else {
+			break;
+		}
+		if (size > (static_cast<size_t>(-1) >> 4)) {
+			state = Error;
+			return;
+		}
+		size = (size << 4) | digit;
+	}
+	if (i == 0 || (i < line.size() && line[i] != ';' && line[i] != ' ' && line[i] != '\t')) {
+		state = Error;
+		return;
+	}
+	if (size == 0) {
+		state = Trailers;
+	}
+	else {
+		remaining = size;
+		state = ChunkData;
+	}
+}
+
+std::string HTTPResponseParser::getHeader(const std::string& name) const {
+	for (size_t i = 0; i < headers.size(); ++i) {
+		if (boost::iequals(headers[i].first, name)) {
+			return headers[i].second;
+		}
+	}
+	return std::string();
+}
+
+}
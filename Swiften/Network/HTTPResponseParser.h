@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/ByteArray.h>
+
+namespace Swift {
+	/**
+	 * Incremental parser for HTTP/1.1 responses.
+	 *
+	 * Data can be passed in as it is read from the connection. Every byte is
+	 * looked at once, and the body is collected as it arrives, using the
+	 * Content-Length header or chunked transfer coding to find its end.
+	 * Responses without either end when the connection is closed, so they
+	 * are never complete.
+	 */
+	class SWIFTEN_API HTTPResponseParser {
+		public:
+			HTTPResponseParser();
+
+			/**
+			 * Parses the next part of the response, and returns the number of
+			 * bytes that were used. This is less than size if the response
+			 * was completed (or found to be invalid) before the end of the
+			 * data.
+			 */
+			size_t parse(const unsigned char* data, size_t size);
+
+			/**
+			 * Starts parsing a new response.
+			 */
+			void reset();
+
+			bool hasError() const {
+				return state == Error;
+			}
+
+			/**
+			 * Returns whether the status line and all headers were parsed.
+			 */
+			bool hasHeaders() const {
+				return state != StatusLine && state != Headers && state != Error;
+			}
+
+			bool isComplete() const {
+				return state == Complete;
+			}
+
+			/**
+			 * Returns whether the body of the response ends when the
+			 * connection is closed.
+			 */
+			bool isBodyDelimitedByClose() const {
+				return state == BodyUntilClose;
+			}
+
+			/**
+			 * The 3-digit status code (e.g. "200").
+			 */
+			const std::string& getStatusCode() const {
+				return statusCode;
+			}
+
+			/**
+			 * Returns the value of the first header with the given name
+			 * (compared case-insensitively), or an empty string.
+			 */
+			std::string getHeader(const std::string& name) const;
+
+			/**
+			 * The body received so far, with any chunked transfer coding
+			 * removed.
+			 */
+			const ByteArray& getBody() const {
+				return body;
+			}
+
+		private:
+			enum State {
+				StatusLine,
+				Headers,
+				Body,
+				BodyUntilClose,
+				ChunkSize,
+				ChunkData,
+				ChunkEnd,
+				Trailers,
+				Complete,
+				Error
+			};
+
+			void handleLine();
+			void handleHeadersEnd();
+			void handleChunkSize();
+
+		private:
+			State state;
+			std::string line;
+			std::string statusCode;
+			std::vector< std::pair<std::string, std::string> > headers;
+			size_t remaining;
+			ByteArray body;
+	};
+}
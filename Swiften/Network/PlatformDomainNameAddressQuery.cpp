@@ -6,6 +6,7 @@
 
 #include <Swiften/Network/PlatformDomainNameAddressQuery.h>
 
+#include <boost/asio/error.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 #include <Swiften/Network/PlatformDomainNameResolver.h>
@@ -53,14 +54,19 @@ void PlatformDomainNameAddressQuery::runBlocking() {
 					shared_from_this());
 		}
 	}
+	catch (const boost::system::system_error& e) {
+		// Asio reports EAI_NONAME as host_not_found, and server failures
+		// and timeouts (EAI_AGAIN) as host_not_found_try_again.
+		emitError(e.code() == boost::asio::error::host_not_found ? DomainNameResolveError::NonExistentDomainError : DomainNameResolveError::UnknownError);
+	}
 	catch (...) {
 		//std::cout << "PlatformDomainNameResolver::doRun(): Error 2" << std::endl;
 		emitError();
 	}
 }
 
-void PlatformDomainNameAddressQuery::emitError() {
-	eventLoop->postEvent(boost::bind(boost::ref(onResult), std::vector<HostAddress>(), boost::optional<DomainNameResolveError>(DomainNameResolveError())), shared_from_this());
+void PlatformDomainNameAddressQuery::emitError(DomainNameResolveError::Type type) {
+	eventLoop->postEvent(boost::bind(boost::ref(onResult), std::vector<HostAddress>(), boost::optional<DomainNameResolveError>(DomainNameResolveError(type))), shared_from_this());
 }
 
 }
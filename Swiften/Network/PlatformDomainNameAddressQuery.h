@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -26,7 +26,7 @@ namespace Swift {
 
 		private:
 			void runBlocking();
-			void emitError();
+			void emitError(DomainNameResolveError::Type type = DomainNameResolveError::UnknownError);
 
 		private:
 			boost::asio::io_service ioService;
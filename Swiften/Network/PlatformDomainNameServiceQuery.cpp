@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,6 +12,8 @@
 
 #include <Swiften/Base/Platform.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <limits>
 #include <boost/numeric/conversion/cast.hpp>
 #ifdef SWIFTEN_PLATFORM_WINDOWS
 #undef UNICODE
@@ -23,6 +25,7 @@
 #else
 #include <arpa/nameser.h>
 #include <arpa/nameser_compat.h>
+#include <netdb.h>
 #include <resolv.h>
 #endif
 #include <boost/bind.hpp>
@@ -62,8 +65,9 @@ void PlatformDomainNameServiceQuery::runBlocking() {
 #if defined(SWIFTEN_PLATFORM_WINDOWS)
 	DNS_RECORD* responses;
 	// FIXME: This conversion doesn't work if unicode is deffed above
-	if (DnsQuery(service.c_str(), DNS_TYPE_SRV, DNS_QUERY_STANDARD, NULL, &responses, NULL) != ERROR_SUCCESS) {
-		emitError();
+	DNS_STATUS status = DnsQuery(service.c_str(), DNS_TYPE_SRV, DNS_QUERY_STANDARD, NULL, &responses, NULL);
+	if (status != ERROR_SUCCESS) {
+		emitError(status == DNS_ERROR_RCODE_NAME_ERROR ? DomainNameResolveError::NonExistentDomainError : DomainNameResolveError::UnknownError);
 		return;
 	}
 
@@ -74,6 +78,7 @@ void PlatformDomainNameServiceQuery::runBlocking() {
 			record.priority = currentEntry->Data.SRV.wPriority;
 			record.weight = currentEntry->Data.SRV.wWeight;
 			record.port = currentEntry->Data.SRV.wPort;
+			record.ttl = boost::numeric_cast<int>(std::min<unsigned long>(currentEntry->dwTtl, std::numeric_limits<int>::max()));
 				
 			// The pNameTarget is actually a PCWSTR, so I would have expected this 
 			// conversion to not work at all, but it does.
@@ -94,8 +99,15 @@ void PlatformDomainNameServiceQuery::runBlocking() {
 	response.resize(NS_PACKETSZ);
 	int responseLength = res_query(const_cast<char*>(service.c_str()), ns_c_in, ns_t_srv, reinterpret_cast<u_char*>(vecptr(response)), response.size());
 	if (responseLength == -1) {
-		SWIFT_LOG(debug) << "Error" << std::endl;
-		emitError();
+		SWIFT_LOG(debug) << "Error: " << h_errno << std::endl;
+		if (h_errno == NO_DATA) {
+			emitResult(records);
+		}
+		else {
+			// Only an answer that the name doesn't exist is final; other
+			// failures (e.g. timeouts or SERVFAIL) may go away on retry.
+			emitError(h_errno == HOST_NOT_FOUND ? DomainNameResolveError::NonExistentDomainError : DomainNameResolveError::UnknownError);
+		}
 		return;
 	}
 
@@ -124,6 +136,13 @@ void PlatformDomainNameServiceQuery::runBlocking() {
 
 		int entryLength = dn_skipname(currentEntry, messageEnd);
 		currentEntry += entryLength;
+
+		// TTL (after type and class)
+		if (currentEntry + NS_RRFIXEDSZ >= messageEnd) {
+			emitError();
+			return;
+		}
+		record.ttl = boost::numeric_cast<int>(std::min<unsigned long>(ns_get32(currentEntry + 4), std::numeric_limits<int>::max()));
 		currentEntry += NS_RRFIXEDSZ;
 
 		// Priority
@@ -172,11 +191,15 @@ void PlatformDomainNameServiceQuery::runBlocking() {
 	BoostRandomGenerator generator;
 	DomainNameServiceQuery::sortResults(records, generator);
 	//std::cout << "Sending out " << records.size() << " SRV results " << std::endl;
-	eventLoop->postEvent(boost::bind(boost::ref(onResult), records), shared_from_this());
+	emitResult(records);
+}
+
+void PlatformDomainNameServiceQuery::emitResult(const std::vector<DomainNameServiceQuery::Result>& records) {
+	eventLoop->postEvent(boost::bind(boost::ref(onResult), records, boost::optional<DomainNameResolveError>()), shared_from_this());
 }
 
-void PlatformDomainNameServiceQuery::emitError() {
-	eventLoop->postEvent(boost::bind(boost::ref(onResult), std::vector<DomainNameServiceQuery::Result>()), shared_from_this());
+void PlatformDomainNameServiceQuery::emitError(DomainNameResolveError::Type type) {
+	eventLoop->postEvent(boost::bind(boost::ref(onResult), std::vector<DomainNameServiceQuery::Result>(), boost::optional<DomainNameResolveError>(DomainNameResolveError(type))), shared_from_this());
 }
 
 }
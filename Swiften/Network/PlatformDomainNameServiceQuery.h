@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -24,7 +24,8 @@ namespace Swift {
 
 		private:
 			void runBlocking();
-			void emitError();
+			void emitResult(const std::vector<DomainNameServiceQuery::Result>& records);
+			void emitError(DomainNameResolveError::Type type = DomainNameResolveError::UnknownError);
 
 		private:
 			EventLoop* eventLoop;
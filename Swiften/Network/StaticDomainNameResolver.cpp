@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -33,7 +33,7 @@ namespace {
 		}
 
 		void emitOnResult(std::vector<DomainNameServiceQuery::Result> results) {
-			onResult(results);
+			onResult(results, boost::optional<DomainNameResolveError>());
 		}
 
 		EventLoop* eventLoop;
@@ -55,7 +55,7 @@ namespace {
 						boost::bind(&AddressQuery::emitOnResult, shared_from_this(), i->second, boost::optional<DomainNameResolveError>()));
 			}
 			else {
-				eventLoop->postEvent(boost::bind(&AddressQuery::emitOnResult, shared_from_this(), std::vector<HostAddress>(), boost::optional<DomainNameResolveError>(DomainNameResolveError())), owner);
+				eventLoop->postEvent(boost::bind(&AddressQuery::emitOnResult, shared_from_this(), std::vector<HostAddress>(), boost::optional<DomainNameResolveError>(DomainNameResolveError(DomainNameResolveError::NonExistentDomainError))), owner);
 			}
 		}
 
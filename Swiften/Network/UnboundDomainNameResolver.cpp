@@ -4,8 +4,16 @@
  * See Documentation/Licenses/BSD-simplified.txt for more information.
  */
 
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
 #include "UnboundDomainNameResolver.h"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 #include <boost/bind.hpp>
@@ -66,9 +74,15 @@ class UnboundDomainNameServiceQuery : public DomainNameServiceQuery, public Unbo
 
 		void handleResult(int err, struct ub_result* result) {
 			std::vector<DomainNameServiceQuery::Result> serviceRecords;
+			boost::optional<DomainNameResolveError> error;
 
 			if(err != 0) {
 				SWIFT_LOG(debug) << "resolve error: " << ub_strerror(err) << std::endl;
+				error = DomainNameResolveError();
+			} else if(result->nxdomain) {
+				error = DomainNameResolveError(DomainNameResolveError::NonExistentDomainError);
+			} else if(result->rcode != LDNS_RCODE_NOERROR) {
+				error = DomainNameResolveError();
 			} else {
 				if(result->havedata) {
 					ldns_pkt* replyPacket = 0;
@@ -87,6 +101,7 @@ class UnboundDomainNameServiceQuery : public DomainNameServiceQuery, public Unbo
 							serviceRecord.priority = ldns_rdf2native_int16(ldns_rr_rdf(rr, 0));
 							serviceRecord.weight = ldns_rdf2native_int16(ldns_rr_rdf(rr, 1));
 							serviceRecord.port = ldns_rdf2native_int16(ldns_rr_rdf(rr, 2));
+							serviceRecord.ttl = static_cast<int>(std::min<uint32_t>(ldns_rr_ttl(rr), std::numeric_limits<int>::max()));
 
 							ldns_buffer_rewind(buffer);
 							if ((ldns_rdf2buffer_str_dname(buffer, ldns_rr_rdf(rr, 3)) != LDNS_STATUS_OK) ||
@@ -109,7 +124,7 @@ class UnboundDomainNameServiceQuery : public DomainNameServiceQuery, public Unbo
 			}
 
 			ub_resolve_free(result);
-			onResult(serviceRecords);
+			onResult(serviceRecords, error);
 		}
 
 	private:
@@ -145,6 +160,8 @@ class UnboundDomainNameAddressQuery : public DomainNameAddressQuery, public Unbo
 			if(err != 0) {
 				SWIFT_LOG(debug) << "resolve error: " << ub_strerror(err) << std::endl;
 				error = DomainNameResolveError();
+			} else if(result->nxdomain) {
+				error = DomainNameResolveError(DomainNameResolveError::NonExistentDomainError);
 			} else {
 				if(result->havedata) {
 					for(int i=0; result->data[i]; i++) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011 Isode Limited.
+ * Copyright (c) 2011-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -37,6 +37,9 @@ class BOSHConnectionTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST(testWrite_Receive);
 	CPPUNIT_TEST(testWrite_ReceiveTwice);
 	CPPUNIT_TEST(testRead_Fragment);
+	CPPUNIT_TEST(testRead_Chunked);
+	CPPUNIT_TEST(testRead_ManyFragments);
+	CPPUNIT_TEST(testRead_HTTPError);
 	CPPUNIT_TEST(testHTTPRequest);
 	CPPUNIT_TEST(testHTTPRequest_Empty);
 	CPPUNIT_TEST_SUITE_END();	
@@ -51,6 +54,8 @@ class BOSHConnectionTest : public CppUnit::TestFixture {
 			disconnected = false;
 			disconnectedError = false;
 			dataRead.clear();
+			dataReadCount = 0;
+			httpErrors.clear();
 		}
 
 		void tearDown() {
@@ -169,6 +174,73 @@ class BOSHConnectionTest : public CppUnit::TestFixture {
 			CPPUNIT_ASSERT_EQUAL(std::string("<blah/>"), byteArrayToString(dataRead));
 		}
 
+		void testRead_Chunked() {
+			BOSHConnection::ref testling = createTestling();
+			testling->connect();
+			eventLoop->processEvents();
+			testling->setSID("mySID");
+			testling->write(createSafeByteArray("<mypayload/>"));
+			boost::shared_ptr<MockConnection> connection = connectionFactory->connections[0];
+			connection->onDataRead(boost::make_shared<SafeByteArray>(createSafeByteArray(
+				"HTTP/1.1 200 OK\r\n"
+				"Transfer-Encoding: chunked\r\n"
+				"\r\n"
+				"9\r\n"
+				"<body><bl\r\n")));
+			connection->onDataRead(boost::make_shared<SafeByteArray>(createSafeByteArray(
+				"b\r\n"
+				"ah/></body>\r\n")));
+			CPPUNIT_ASSERT(dataRead.empty());
+			CPPUNIT_ASSERT(!testling->isReadyToSend());
+			connection->onDataRead(boost::make_shared<SafeByteArray>(createSafeByteArray(
+				"0\r\n"
+				"\r\n")));
+
+			CPPUNIT_ASSERT_EQUAL(std::string("<blah/>"), byteArrayToString(dataRead));
+			CPPUNIT_ASSERT(testling->isReadyToSend());
+		}
+
+		void testRead_ManyFragments() {
+			BOSHConnection::ref testling = createTestling();
+			testling->connect();
+			eventLoop->processEvents();
+			testling->setSID("mySID");
+			testling->write(createSafeByteArray("<mypayload/>"));
+			std::string payload;
+			for (int i = 0; i < 1000; ++i) {
+				payload += "<message><body>" + boost::lexical_cast<std::string>(i) + "</body></message>";
+			}
+			std::string response = "<body xmlns='http://jabber.org/protocol/httpbind'>" + payload + "</body>";
+
+			std::string data = "HTTP/1.1 200 OK\r\nContent-Length: " + boost::lexical_cast<std::string>(response.size()) + "\r\n\r\n" + response;
+			for (size_t i = 0; i < data.size(); i += 100) {
+				connectionFactory->connections[0]->onDataRead(boost::make_shared<SafeByteArray>(createSafeByteArray(data.substr(i, 100))));
+			}
+
+			CPPUNIT_ASSERT_EQUAL(1, dataReadCount);
+			CPPUNIT_ASSERT_EQUAL(payload, byteArrayToString(dataRead));
+		}
+
+		void testRead_HTTPError() {
+			BOSHConnection::ref testling = createTestling();
+			testling->connect();
+			eventLoop->processEvents();
+			testling->setSID("mySID");
+			testling->write(createSafeByteArray("<mypayload/>"));
+			boost::shared_ptr<MockConnection> connection = connectionFactory->connections[0];
+			connection->onDataRead(boost::make_shared<SafeByteArray>(createSafeByteArray(
+				"HTTP/1.1 404 Not Found\r\n"
+				"Content-Length: 9\r\n"
+				"\r\n"
+				"Not")));
+			connection->onDataRead(boost::make_shared<SafeByteArray>(createSafeByteArray(
+				" Found")));
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), httpErrors.size());
+			CPPUNIT_ASSERT_EQUAL(std::string("404"), httpErrors[0]);
+			CPPUNIT_ASSERT(dataRead.empty());
+		}
+
 		void testHTTPRequest() {
 			std::string data = "<blah/>";
 			std::string sid = "wigglebloom";
@@ -198,6 +270,7 @@ class BOSHConnectionTest : public CppUnit::TestFixture {
 			c->onDisconnected.connect(boost::bind(&BOSHConnectionTest::handleDisconnected, this, _1));
 			c->onXMPPDataRead.connect(boost::bind(&BOSHConnectionTest::handleDataRead, this, _1));
 			c->onSessionStarted.connect(boost::bind(&BOSHConnectionTest::handleSID, this, _1));
+			c->onHTTPError.connect(boost::bind(&BOSHConnectionTest::handleHTTPError, this, _1));
 			c->setRID(42);
 			return c;
 		}
@@ -214,6 +287,11 @@ class BOSHConnectionTest : public CppUnit::TestFixture {
 
 		void handleDataRead(const SafeByteArray& d) {
 			append(dataRead, d);
+			++dataReadCount;
+		}
+
+		void handleHTTPError(const std::string& error) {
+			httpErrors.push_back(error);
 		}
 
 		void handleSID(const std::string& s) {
@@ -291,6 +369,8 @@ class BOSHConnectionTest : public CppUnit::TestFixture {
 		bool disconnected;
 		bool disconnectedError;
 		ByteArray dataRead;
+		int dataReadCount;
+		std::vector<std::string> httpErrors;
 		PlatformXMLParserFactory parserFactory;
 		StaticDomainNameResolver* resolver;
 		TimerFactory* timerFactory;
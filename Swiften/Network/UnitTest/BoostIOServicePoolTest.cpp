@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <set>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <Swiften/Network/BoostIOServicePool.h>
+#include <Swiften/Base/sleep.h>
+
+using namespace Swift;
+
+class BoostIOServicePoolTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(BoostIOServicePoolTest);
+		CPPUNIT_TEST(testGetIOService_SingleThread);
+		CPPUNIT_TEST(testGetIOService_RoundRobin);
+		CPPUNIT_TEST(testIOServicesRunOnSeparateThreads);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void testGetIOService_SingleThread() {
+			BoostIOServicePool testling;
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getSize());
+			CPPUNIT_ASSERT(testling.getIOService() == testling.getMainIOService());
+			CPPUNIT_ASSERT(testling.getIOService() == testling.getMainIOService());
+		}
+
+		void testGetIOService_RoundRobin() {
+			BoostIOServicePool testling(3);
+
+			boost::shared_ptr<boost::asio::io_service> first = testling.getIOService();
+			boost::shared_ptr<boost::asio::io_service> second = testling.getIOService();
+			boost::shared_ptr<boost::asio::io_service> third = testling.getIOService();
+
+			CPPUNIT_ASSERT(first != second);
+			CPPUNIT_ASSERT(second != third);
+			CPPUNIT_ASSERT(first != third);
+			CPPUNIT_ASSERT(first == testling.getIOService());
+		}
+
+		void testIOServicesRunOnSeparateThreads() {
+			BoostIOServicePool testling(3);
+
+			for (size_t i = 0; i < testling.getSize(); ++i) {
+				testling.getIOService()->post(boost::bind(&BoostIOServicePoolTest::recordThread, this));
+			}
+			for (int i = 0; i < 100 && getThreadCount() < 3; ++i) {
+				Swift::sleep(10);
+			}
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), getThreadCount());
+		}
+
+	private:
+		void recordThread() {
+			boost::lock_guard<boost::mutex> lock(threadsMutex_);
+			threads_.insert(boost::this_thread::get_id());
+		}
+
+		size_t getThreadCount() {
+			boost::lock_guard<boost::mutex> lock(threadsMutex_);
+			return threads_.size();
+		}
+
+	private:
+		boost::mutex threadsMutex_;
+		std::set<boost::thread::id> threads_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BoostIOServicePoolTest);
@@ -0,0 +1,410 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <boost/bind.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
+#include <Swiften/IDN/IDNConverter.h>
+#include <Swiften/IDN/PlatformIDNConverter.h>
+#include <Swiften/Network/CachingDomainNameResolver.h>
+#include <Swiften/Network/DummyTimerFactory.h>
+#include <Swiften/Network/StaticDomainNameResolver.h>
+
+using namespace Swift;
+
+class CachingDomainNameResolverTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(CachingDomainNameResolverTest);
+		CPPUNIT_TEST(testServiceQuery_ResultIsCached);
+		CPPUNIT_TEST(testServiceQuery_ConcurrentQueriesShareLookup);
+		CPPUNIT_TEST(testServiceQuery_ExpiresAfterTTL);
+		CPPUNIT_TEST(testServiceQuery_TTLIsLimitedToMaximum);
+		CPPUNIT_TEST(testServiceQuery_NonExistentDomainIsCachedForNegativeTTL);
+		CPPUNIT_TEST(testServiceQuery_TransientErrorIsNotCached);
+		CPPUNIT_TEST(testServiceQuery_EmptyResultIsNotCached);
+		CPPUNIT_TEST(testServiceQuery_DomainIsNormalized);
+		CPPUNIT_TEST(testAddressQuery_ResultIsCachedForDefaultTTL);
+		CPPUNIT_TEST(testAddressQuery_ConcurrentQueriesShareLookup);
+		CPPUNIT_TEST(testAddressQuery_NonExistentDomainIsCachedForNegativeTTL);
+		CPPUNIT_TEST(testAddressQuery_TransientErrorIsNotCached);
+		CPPUNIT_TEST(testAddressQuery_DestroyedQueryDoesNotReceiveResult);
+		CPPUNIT_TEST(testAddressQuery_NameIsNormalized);
+		CPPUNIT_TEST(testClear);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void setUp() {
+			eventLoop = new DummyEventLoop();
+			timerFactory = new DummyTimerFactory();
+			realResolver = new CountingDomainNameResolver(eventLoop);
+			idnConverter = boost::shared_ptr<IDNConverter>(PlatformIDNConverter::create());
+			testling = new CachingDomainNameResolver(realResolver, idnConverter.get(), eventLoop, timerFactory);
+			testling->setDefaultTTL(300);
+			testling->setNegativeTTL(30);
+			testling->setMaximumTTL(3600);
+			serviceResults = 0;
+			serviceErrors = 0;
+			addressResults = 0;
+			addressErrors = 0;
+		}
+
+		void tearDown() {
+			delete testling;
+			delete realResolver;
+			delete timerFactory;
+			delete eventLoop;
+		}
+
+		void testServiceQuery_ResultIsCached() {
+			realResolver->addService("_xmpp-client._tcp.foo.com", DomainNameServiceQuery::Result("xmpp.foo.com", 5222, 0, 0, 60));
+
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, realResolver->serviceQueries);
+			CPPUNIT_ASSERT_EQUAL(2, serviceResults);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(lastServiceResult.size()));
+			CPPUNIT_ASSERT_EQUAL(std::string("xmpp.foo.com"), lastServiceResult[0].hostname);
+			CPPUNIT_ASSERT_EQUAL(5222, lastServiceResult[0].port);
+		}
+
+		void testServiceQuery_ConcurrentQueriesShareLookup() {
+			realResolver->addService("_xmpp-client._tcp.foo.com", DomainNameServiceQuery::Result("xmpp.foo.com", 5222, 0, 0, 60));
+
+			for (int i = 0; i < 1000; ++i) {
+				runServiceQuery("foo.com");
+			}
+			runServiceQuery("bar.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->serviceQueries);
+			CPPUNIT_ASSERT_EQUAL(1001, serviceResults);
+		}
+
+		void testServiceQuery_ExpiresAfterTTL() {
+			realResolver->addService("_xmpp-client._tcp.foo.com", DomainNameServiceQuery::Result("xmpp1.foo.com", 5222, 0, 0, 120));
+			realResolver->addService("_xmpp-client._tcp.foo.com", DomainNameServiceQuery::Result("xmpp2.foo.com", 5222, 0, 0, 60));
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			timerFactory->setTime(59999);
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+			CPPUNIT_ASSERT_EQUAL(1, realResolver->serviceQueries);
+
+			timerFactory->setTime(60000);
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->serviceQueries);
+			CPPUNIT_ASSERT_EQUAL(3, serviceResults);
+		}
+
+		void testServiceQuery_TTLIsLimitedToMaximum() {
+			realResolver->addService("_xmpp-client._tcp.foo.com", DomainNameServiceQuery::Result("xmpp.foo.com", 5222, 0, 0, 86400));
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			timerFactory->setTime(3600 * 1000);
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->serviceQueries);
+		}
+
+		void testServiceQuery_NonExistentDomainIsCachedForNegativeTTL() {
+			realResolver->error = DomainNameResolveError(DomainNameResolveError::NonExistentDomainError);
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, realResolver->serviceQueries);
+			CPPUNIT_ASSERT_EQUAL(2, serviceErrors);
+			CPPUNIT_ASSERT_EQUAL(DomainNameResolveError::NonExistentDomainError, lastServiceError->getType());
+			CPPUNIT_ASSERT(lastServiceResult.empty());
+
+			timerFactory->setTime(30 * 1000);
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->serviceQueries);
+		}
+
+		void testServiceQuery_TransientErrorIsNotCached() {
+			realResolver->error = DomainNameResolveError();
+			runServiceQuery("foo.com");
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, realResolver->serviceQueries);
+			CPPUNIT_ASSERT_EQUAL(2, serviceErrors);
+			CPPUNIT_ASSERT_EQUAL(DomainNameResolveError::UnknownError, lastServiceError->getType());
+
+			realResolver->error.reset();
+			realResolver->addService("_xmpp-client._tcp.foo.com", DomainNameServiceQuery::Result("xmpp.foo.com", 5222, 0, 0, 60));
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->serviceQueries);
+			CPPUNIT_ASSERT_EQUAL(2, serviceErrors);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(lastServiceResult.size()));
+		}
+
+		void testServiceQuery_EmptyResultIsNotCached() {
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->serviceQueries);
+			CPPUNIT_ASSERT_EQUAL(2, serviceResults);
+			CPPUNIT_ASSERT_EQUAL(0, serviceErrors);
+			CPPUNIT_ASSERT(lastServiceResult.empty());
+		}
+
+		void testServiceQuery_DomainIsNormalized() {
+			realResolver->addService("_xmpp-client._tcp.xn--bcher-kva.com", DomainNameServiceQuery::Result("xmpp.foo.com", 5222, 0, 0, 60));
+
+			runServiceQuery("B\xc3\xbc" "cher.COM");
+			eventLoop->processEvents();
+			runServiceQuery("b\xc3\xbc" "cher.com");
+			eventLoop->processEvents();
+			runServiceQuery("xn--bcher-kva.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, realResolver->serviceQueries);
+			CPPUNIT_ASSERT_EQUAL(3, serviceResults);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(lastServiceResult.size()));
+		}
+
+		void testAddressQuery_ResultIsCachedForDefaultTTL() {
+			realResolver->addAddress("xmpp.foo.com", HostAddress("1.2.3.4"));
+			runAddressQuery("xmpp.foo.com");
+			eventLoop->processEvents();
+
+			timerFactory->setTime(300 * 1000 - 1);
+			runAddressQuery("xmpp.foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, realResolver->addressQueries);
+			CPPUNIT_ASSERT_EQUAL(2, addressResults);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(lastAddressResult.size()));
+			CPPUNIT_ASSERT_EQUAL(std::string("1.2.3.4"), lastAddressResult[0].toString());
+
+			timerFactory->setTime(300 * 1000);
+			runAddressQuery("xmpp.foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->addressQueries);
+		}
+
+		void testAddressQuery_ConcurrentQueriesShareLookup() {
+			realResolver->addAddress("xmpp.foo.com", HostAddress("1.2.3.4"));
+
+			for (int i = 0; i < 1000; ++i) {
+				runAddressQuery("xmpp.foo.com");
+			}
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, realResolver->addressQueries);
+			CPPUNIT_ASSERT_EQUAL(1000, addressResults);
+			CPPUNIT_ASSERT_EQUAL(0, addressErrors);
+		}
+
+		void testAddressQuery_NonExistentDomainIsCachedForNegativeTTL() {
+			runAddressQuery("xmpp.foo.com");
+			eventLoop->processEvents();
+			runAddressQuery("xmpp.foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, realResolver->addressQueries);
+			CPPUNIT_ASSERT_EQUAL(2, addressErrors);
+			CPPUNIT_ASSERT_EQUAL(DomainNameResolveError::NonExistentDomainError, lastAddressError->getType());
+
+			timerFactory->setTime(30 * 1000);
+			realResolver->addAddress("xmpp.foo.com", HostAddress("1.2.3.4"));
+			runAddressQuery("xmpp.foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->addressQueries);
+			CPPUNIT_ASSERT_EQUAL(2, addressErrors);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(lastAddressResult.size()));
+		}
+
+		void testAddressQuery_TransientErrorIsNotCached() {
+			realResolver->addAddress("xmpp.foo.com", HostAddress("1.2.3.4"));
+			realResolver->error = DomainNameResolveError();
+			runAddressQuery("xmpp.foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, addressErrors);
+			CPPUNIT_ASSERT_EQUAL(DomainNameResolveError::UnknownError, lastAddressError->getType());
+
+			realResolver->error.reset();
+			runAddressQuery("xmpp.foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->addressQueries);
+			CPPUNIT_ASSERT_EQUAL(1, addressErrors);
+			CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(lastAddressResult.size()));
+		}
+
+		void testAddressQuery_DestroyedQueryDoesNotReceiveResult() {
+			realResolver->addAddress("xmpp.foo.com", HostAddress("1.2.3.4"));
+
+			runAddressQuery("xmpp.foo.com");
+			DomainNameAddressQuery::ref query = testling->createAddressQuery("xmpp.foo.com");
+			query->onResult.connect(boost::bind(&CachingDomainNameResolverTest::handleAddressResult, this, _1, _2));
+			query->run();
+			query.reset();
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, realResolver->addressQueries);
+			CPPUNIT_ASSERT_EQUAL(1, addressResults);
+		}
+
+		void testAddressQuery_NameIsNormalized() {
+			realResolver->addAddress("xmpp.foo.com", HostAddress("1.2.3.4"));
+
+			runAddressQuery("XMPP.Foo.COM");
+			runAddressQuery("xmpp.foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(1, realResolver->addressQueries);
+			CPPUNIT_ASSERT_EQUAL(2, addressResults);
+			CPPUNIT_ASSERT_EQUAL(0, addressErrors);
+		}
+
+		void testClear() {
+			realResolver->addAddress("xmpp.foo.com", HostAddress("1.2.3.4"));
+			realResolver->addService("_xmpp-client._tcp.foo.com", DomainNameServiceQuery::Result("xmpp.foo.com", 5222, 0, 0, 60));
+			runAddressQuery("xmpp.foo.com");
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			testling->clear();
+			runAddressQuery("xmpp.foo.com");
+			runServiceQuery("foo.com");
+			eventLoop->processEvents();
+
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->addressQueries);
+			CPPUNIT_ASSERT_EQUAL(2, realResolver->serviceQueries);
+		}
+
+	private:
+		/**
+		 * A resolver that counts the lookups, and fails them with \p error
+		 * if it is set.
+		 */
+		struct CountingDomainNameResolver : public StaticDomainNameResolver {
+			CountingDomainNameResolver(EventLoop* eventLoop) : StaticDomainNameResolver(eventLoop), eventLoop(eventLoop), serviceQueries(0), addressQueries(0) {
+			}
+
+			virtual boost::shared_ptr<DomainNameServiceQuery> createServiceQuery(const std::string& serviceLookupPrefix, const std::string& domain) {
+				++serviceQueries;
+				if (error) {
+					return boost::make_shared<FailingServiceQuery>(eventLoop, *error);
+				}
+				return StaticDomainNameResolver::createServiceQuery(serviceLookupPrefix, domain);
+			}
+
+			virtual boost::shared_ptr<DomainNameAddressQuery> createAddressQuery(const std::string& name) {
+				++addressQueries;
+				if (error) {
+					return boost::make_shared<FailingAddressQuery>(eventLoop, *error);
+				}
+				return StaticDomainNameResolver::createAddressQuery(name);
+			}
+
+			EventLoop* eventLoop;
+			boost::optional<DomainNameResolveError> error;
+			int serviceQueries;
+			int addressQueries;
+		};
+
+		struct FailingServiceQuery : public DomainNameServiceQuery, public EventOwner, public boost::enable_shared_from_this<FailingServiceQuery> {
+			FailingServiceQuery(EventLoop* eventLoop, const DomainNameResolveError& error) : eventLoop(eventLoop), error(error) {
+			}
+
+			virtual void run() {
+				eventLoop->postEvent(boost::bind(boost::ref(onResult), std::vector<DomainNameServiceQuery::Result>(), boost::optional<DomainNameResolveError>(error)), shared_from_this());
+			}
+
+			EventLoop* eventLoop;
+			DomainNameResolveError error;
+		};
+
+		struct FailingAddressQuery : public DomainNameAddressQuery, public EventOwner, public boost::enable_shared_from_this<FailingAddressQuery> {
+			FailingAddressQuery(EventLoop* eventLoop, const DomainNameResolveError& error) : eventLoop(eventLoop), error(error) {
+			}
+
+			virtual void run() {
+				eventLoop->postEvent(boost::bind(boost::ref(onResult), std::vector<HostAddress>(), boost::optional<DomainNameResolveError>(error)), shared_from_this());
+			}
+
+			EventLoop* eventLoop;
+			DomainNameResolveError error;
+		};
+
+		void runServiceQuery(const std::string& domain) {
+			DomainNameServiceQuery::ref query = testling->createServiceQuery("_xmpp-client._tcp.", domain);
+			query->onResult.connect(boost::bind(&CachingDomainNameResolverTest::handleServiceResult, this, _1, _2));
+			query->run();
+			serviceQueries.push_back(query);
+		}
+
+		void runAddressQuery(const std::string& name) {
+			DomainNameAddressQuery::ref query = testling->createAddressQuery(name);
+			query->onResult.connect(boost::bind(&CachingDomainNameResolverTest::handleAddressResult, this, _1, _2));
+			query->run();
+			addressQueries.push_back(query);
+		}
+
+		void handleServiceResult(const std::vector<DomainNameServiceQuery::Result>& result, boost::optional<DomainNameResolveError> error) {
+			++serviceResults;
+			if (error) {
+				++serviceErrors;
+			}
+			lastServiceResult = result;
+			lastServiceError = error;
+		}
+
+		void handleAddressResult(const std::vector<HostAddress>& result, boost::optional<DomainNameResolveError> error) {
+			++addressResults;
+			if (error) {
+				++addressErrors;
+			}
+			lastAddressResult = result;
+			lastAddressError = error;
+		}
+
+	private:
+		DummyEventLoop* eventLoop;
+		DummyTimerFactory* timerFactory;
+		CountingDomainNameResolver* realResolver;
+		boost::shared_ptr<IDNConverter> idnConverter;
+		CachingDomainNameResolver* testling;
+		std::vector<DomainNameServiceQuery::ref> serviceQueries;
+		std::vector<DomainNameAddressQuery::ref> addressQueries;
+		int serviceResults;
+		int serviceErrors;
+		int addressResults;
+		int addressErrors;
+		std::vector<DomainNameServiceQuery::Result> lastServiceResult;
+		boost::optional<DomainNameResolveError> lastServiceError;
+		std::vector<HostAddress> lastAddressResult;
+		boost::optional<DomainNameResolveError> lastAddressError;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CachingDomainNameResolverTest);
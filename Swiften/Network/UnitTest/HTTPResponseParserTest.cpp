@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <string>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Network/HTTPResponseParser.h>
+
+using namespace Swift;
+
+class HTTPResponseParserTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(HTTPResponseParserTest);
+		CPPUNIT_TEST(testParse_ContentLength);
+		CPPUNIT_TEST(testParse_ContentLength_ByteByByte);
+		CPPUNIT_TEST(testParse_ContentLength_Empty);
+		CPPUNIT_TEST(testParse_Chunked);
+		CPPUNIT_TEST(testParse_Chunked_ByteByByte);
+		CPPUNIT_TEST(testParse_NoContent);
+		CPPUNIT_TEST(testParse_BodyDelimitedByClose);
+		CPPUNIT_TEST(testParse_StopsAtEndOfResponse);
+		CPPUNIT_TEST(testParse_InvalidStatusLine);
+		CPPUNIT_TEST(testParse_InvalidHeader);
+		CPPUNIT_TEST(testParse_InvalidContentLength);
+		CPPUNIT_TEST(testParse_InvalidChunkSize);
+		CPPUNIT_TEST(testReset);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void testParse_ContentLength() {
+			HTTPResponseParser testling;
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(67), parse(testling, "HTTP/1.1 200 OK\r\ncontent-length: 10\r\nContent-Type: text/xml\r\n\r\n0123"));
+			CPPUNIT_ASSERT(testling.hasHeaders());
+			CPPUNIT_ASSERT(!testling.isComplete());
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(6), parse(testling, "456789"));
+
+			CPPUNIT_ASSERT(testling.isComplete());
+			CPPUNIT_ASSERT_EQUAL(std::string("200"), testling.getStatusCode());
+			CPPUNIT_ASSERT_EQUAL(std::string("text/xml"), testling.getHeader("content-type"));
+			CPPUNIT_ASSERT_EQUAL(std::string("0123456789"), byteArrayToString(testling.getBody()));
+		}
+
+		void testParse_ContentLength_ByteByByte() {
+			HTTPResponseParser testling;
+			std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 7\r\n\r\n<body/>";
+
+			for (size_t i = 0; i < response.size(); ++i) {
+				CPPUNIT_ASSERT(!testling.isComplete());
+				CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), parse(testling, response.substr(i, 1)));
+			}
+
+			CPPUNIT_ASSERT(testling.isComplete());
+			CPPUNIT_ASSERT_EQUAL(std::string("<body/>"), byteArrayToString(testling.getBody()));
+		}
+
+		void testParse_ContentLength_Empty() {
+			HTTPResponseParser testling;
+
+			parse(testling, "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+
+			CPPUNIT_ASSERT(testling.isComplete());
+			CPPUNIT_ASSERT(testling.getBody().empty());
+		}
+
+		void testParse_Chunked() {
+			HTTPResponseParser testling;
+
+			parse(testling, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\n<body\r\n");
+			CPPUNIT_ASSERT(!testling.isComplete());
+			parse(testling, "A;foo=bar\r\n><message/\r\n1\r\n>");
+			CPPUNIT_ASSERT(!testling.isComplete());
+			parse(testling, "\r\n0\r\nX-Trailer: foo\r\n\r\n");
+
+			CPPUNIT_ASSERT(testling.isComplete());
+			CPPUNIT_ASSERT_EQUAL(std::string("<body><message/>"), byteArrayToString(testling.getBody()));
+		}
+
+		void testParse_Chunked_ByteByByte() {
+			HTTPResponseParser testling;
+			std::string response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n1f\r\n0123456789012345678901234567890\r\n0\r\n\r\n";
+
+			for (size_t i = 0; i < response.size(); ++i) {
+				CPPUNIT_ASSERT(!testling.isComplete());
+				CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), parse(testling, response.substr(i, 1)));
+			}
+
+			CPPUNIT_ASSERT(testling.isComplete());
+			CPPUNIT_ASSERT_EQUAL(std::string("abc0123456789012345678901234567890"), byteArrayToString(testling.getBody()));
+		}
+
+		void testParse_NoContent() {
+			HTTPResponseParser testling;
+
+			parse(testling, "HTTP/1.1 204 No Content\r\nContent-Length: 10\r\n\r\n");
+
+			CPPUNIT_ASSERT(testling.isComplete());
+			CPPUNIT_ASSERT_EQUAL(std::string("204"), testling.getStatusCode());
+		}
+
+		void testParse_BodyDelimitedByClose() {
+			HTTPResponseParser testling;
+
+			parse(testling, "HTTP/1.0 200 OK\r\n\r\n<body>");
+			parse(testling, "</body>");
+
+			CPPUNIT_ASSERT(!testling.isComplete());
+			CPPUNIT_ASSERT(testling.isBodyDelimitedByClose());
+			CPPUNIT_ASSERT_EQUAL(std::string("<body></body>"), byteArrayToString(testling.getBody()));
+		}
+
+		void testParse_StopsAtEndOfResponse() {
+			HTTPResponseParser testling;
+			std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nabc";
+
+			CPPUNIT_ASSERT_EQUAL(response.size(), parse(testling, response + "HTTP/1.1 404 Not Found\r\n"));
+			CPPUNIT_ASSERT(testling.isComplete());
+			CPPUNIT_ASSERT_EQUAL(std::string("abc"), byteArrayToString(testling.getBody()));
+		}
+
+		void testParse_InvalidStatusLine() {
+			HTTPResponseParser testling;
+
+			parse(testling, "HTTP/1.1 OK\r\n");
+
+			CPPUNIT_ASSERT(testling.hasError());
+			CPPUNIT_ASSERT(!testling.hasHeaders());
+		}
+
+		void testParse_InvalidHeader() {
+			HTTPResponseParser testling;
+
+			parse(testling, "HTTP/1.1 200 OK\r\nContent-Length 3\r\n\r\nabc");
+
+			CPPUNIT_ASSERT(testling.hasError());
+		}
+
+		void testParse_InvalidContentLength() {
+			HTTPResponseParser testling;
+
+			parse(testling, "HTTP/1.1 200 OK\r\nContent-Length: -3\r\n\r\nabc");
+
+			CPPUNIT_ASSERT(testling.hasError());
+		}
+
+		void testParse_InvalidChunkSize() {
+			HTTPResponseParser testling;
+
+			parse(testling, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nxyz\r\n");
+
+			CPPUNIT_ASSERT(testling.hasError());
+		}
+
+		void testReset() {
+			HTTPResponseParser testling;
+			parse(testling, "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 3\r\n\r\nabc");
+
+			testling.reset();
+			parse(testling, "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\ndef");
+
+			CPPUNIT_ASSERT(testling.isComplete());
+			CPPUNIT_ASSERT_EQUAL(std::string("200"), testling.getStatusCode());
+			CPPUNIT_ASSERT_EQUAL(std::string("def"), byteArrayToString(testling.getBody()));
+		}
+
+	private:
+		size_t parse(HTTPResponseParser& testling, const std::string& data) {
+			ByteArray bytes = createByteArray(data);
+			return testling.parse(vecptr(bytes), bytes.size());
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HTTPResponseParserTest);
@@ -1,18 +1,24 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Parser/ExpatParser.h>
 
+#include <cassert>
+#include <cstring>
+#include <deque>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <expat.h>
 #include <boost/numeric/conversion/cast.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+#include <boost/unordered_map.hpp>
 
-#include <Swiften/Base/String.h>
-#include <Swiften/Parser/XMLParserClient.h>
+#include <Swiften/Parser/XMLViewParserClient.h>
+#include <Swiften/Parser/XMLViewParserClientAdapter.h>
 
 #pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
 
@@ -20,70 +26,130 @@ namespace Swift {
 
 static const char NAMESPACE_SEPARATOR = '\x01';
 
+// Bounds the memory a peer can make us use by sending lots of different
+// namespaces.
+static const size_t MAX_INTERNED_NAMESPACES = 256;
+
 struct ExpatParser::Private {
-	XML_Parser parser_;
-};
+	Private(XMLViewParserClient* client) : client_(client) {
+	}
 
-static void handleStartElement(void* parser, const XML_Char* name, const XML_Char** attributes) {
-	std::pair<std::string,std::string> nsTagPair = String::getSplittedAtFirst(name, NAMESPACE_SEPARATOR);
-	if (nsTagPair.second == "") {
-		nsTagPair.second = nsTagPair.first;
-		nsTagPair.first = "";
+	/**
+	 * Splits an Expat name ("namespace<SEPARATOR>name", or just "name")
+	 * into its name and (interned) namespace.
+	 */
+	StringView splitName(const XML_Char* qualifiedName, const std::string*& ns) {
+		size_t size = std::strlen(qualifiedName);
+		const char* separator = static_cast<const char*>(std::memchr(qualifiedName, NAMESPACE_SEPARATOR, size));
+		if (!separator) {
+			ns = &emptyNamespace_;
+			return StringView(qualifiedName, size);
+		}
+		ns = &getNamespace(StringView(qualifiedName, static_cast<size_t>(separator - qualifiedName)));
+		return StringView(separator + 1, size - static_cast<size_t>(separator - qualifiedName) - 1);
 	}
-	AttributeMap attributeValues;
-	const XML_Char** currentAttribute = attributes;
-	while (*currentAttribute) {
-		std::pair<std::string,std::string> nsAttributePair = String::getSplittedAtFirst(*currentAttribute, NAMESPACE_SEPARATOR);
-		if (nsAttributePair.second == "") {
-			nsAttributePair.second = nsAttributePair.first;
-			nsAttributePair.first = "";
+
+	const std::string& getNamespace(const StringView& ns) {
+		if (ns.empty()) {
+			return emptyNamespace_;
+		}
+		NamespaceMap::const_iterator i = namespaces_.find(ns);
+		if (i != namespaces_.end()) {
+			return *i->second;
 		}
-		attributeValues.addAttribute(nsAttributePair.second, nsAttributePair.first, std::string(*(currentAttribute+1)));
-		currentAttribute += 2;
+		if (namespaces_.size() < MAX_INTERNED_NAMESPACES) {
+			namespaceStorage_.push_back(ns.toString());
+			const std::string& result = namespaceStorage_.back();
+			namespaces_.insert(std::make_pair(StringView(result), &result));
+			return result;
+		}
+		uninternedNamespaces_.push_back(ns.toString());
+		return uninternedNamespaces_.back();
 	}
 
-	static_cast<XMLParser*>(parser)->getClient()->handleStartElement(nsTagPair.second, nsTagPair.first, attributeValues);
-}
+	static void handleStartElement(void* data, const XML_Char* name, const XML_Char** attributes) {
+		Private* p = static_cast<Private*>(data);
+		p->uninternedNamespaces_.clear();
 
-static void handleEndElement(void* parser, const XML_Char* name) {
-	std::pair<std::string,std::string> nsTagPair = String::getSplittedAtFirst(name, NAMESPACE_SEPARATOR);
-	if (nsTagPair.second == "") {
-		nsTagPair.second = nsTagPair.first;
-		nsTagPair.first = "";
+		const std::string* ns = NULL;
+		StringView element = p->splitName(name, ns);
+
+		p->attributes_.clear();
+		for (const XML_Char** currentAttribute = attributes; *currentAttribute; currentAttribute += 2) {
+			const std::string* attributeNS = NULL;
+			StringView attributeName = p->splitName(*currentAttribute, attributeNS);
+			p->attributes_.push_back(XMLViewParserClient::AttributeView(attributeName, *attributeNS, StringView(*(currentAttribute + 1))));
+		}
+
+		p->client_->handleStartElement(element, *ns, p->attributes_);
 	}
-	static_cast<XMLParser*>(parser)->getClient()->handleEndElement(nsTagPair.second, nsTagPair.first);
-}
 
-static void handleCharacterData(void* parser, const XML_Char* data, int len) {
-	assert(len >= 0);
-	static_cast<XMLParser*>(parser)->getClient()->handleCharacterData(std::string(data, static_cast<size_t>(len)));
-}
+	static void handleEndElement(void* data, const XML_Char* name) {
+		Private* p = static_cast<Private*>(data);
+		p->uninternedNamespaces_.clear();
 
-static void handleXMLDeclaration(void*, const XML_Char*, const XML_Char*, int) {
-}
+		const std::string* ns = NULL;
+		StringView element = p->splitName(name, ns);
+		p->client_->handleEndElement(element, *ns);
+	}
+
+	static void handleCharacterData(void* data, const XML_Char* characterData, int len) {
+		assert(len >= 0);
+		static_cast<Private*>(data)->client_->handleCharacterData(StringView(characterData, static_cast<size_t>(len)));
+	}
 
-static void handleEntityDeclaration(void* parser, const XML_Char*, int, const XML_Char*, int, const XML_Char*, const XML_Char*, const XML_Char*, const XML_Char*) {
-	static_cast<ExpatParser*>(parser)->stopParser();
+	static void handleXMLDeclaration(void*, const XML_Char*, const XML_Char*, int) {
+	}
+
+	static void handleEntityDeclaration(void* data, const XML_Char*, int, const XML_Char*, int, const XML_Char*, const XML_Char*, const XML_Char*, const XML_Char*) {
+		XML_StopParser(static_cast<Private*>(data)->parser_, static_cast<XML_Bool>(0));
+	}
+
+	typedef boost::unordered_map<StringView, const std::string*> NamespaceMap;
+
+	XML_Parser parser_;
+	XMLViewParserClient* client_;
+	boost::shared_ptr<XMLViewParserClientAdapter> adapter_;
+
+	// Reused for every start element
+	std::vector<XMLViewParserClient::AttributeView> attributes_;
+
+	// A deque never moves its elements, so the keys of namespaces_ (which
+	// point into namespaceStorage_) stay valid.
+	NamespaceMap namespaces_;
+	std::deque<std::string> namespaceStorage_;
+	std::deque<std::string> uninternedNamespaces_;
+	const std::string emptyNamespace_;
+};
+
+ExpatParser::ExpatParser(XMLParserClient* client) : XMLParser(client) {
+	boost::shared_ptr<XMLViewParserClientAdapter> adapter(new XMLViewParserClientAdapter(client));
+	p = boost::make_shared<Private>(adapter.get());
+	p->adapter_ = adapter;
+	initialize();
 }
 
+ExpatParser::ExpatParser(XMLViewParserClient* client) : XMLParser(NULL), p(new Private(client)) {
+	initialize();
+}
 
-ExpatParser::ExpatParser(XMLParserClient* client) : XMLParser(client), p(new Private()) {
+void ExpatParser::initialize() {
 	p->parser_ = XML_ParserCreateNS("UTF-8", NAMESPACE_SEPARATOR);
-	XML_SetUserData(p->parser_, this);
-	XML_SetElementHandler(p->parser_, handleStartElement, handleEndElement);
-	XML_SetCharacterDataHandler(p->parser_, handleCharacterData);
-	XML_SetXmlDeclHandler(p->parser_, handleXMLDeclaration);
-	XML_SetEntityDeclHandler(p->parser_, handleEntityDeclaration);
+	XML_SetUserData(p->parser_, p.get());
+	XML_SetElementHandler(p->parser_, &Private::handleStartElement, &Private::handleEndElement);
+	XML_SetCharacterDataHandler(p->parser_, &Private::handleCharacterData);
+	XML_SetXmlDeclHandler(p->parser_, &Private::handleXMLDeclaration);
+	XML_SetEntityDeclHandler(p->parser_, &Private::handleEntityDeclaration);
 }
 
 ExpatParser::~ExpatParser() {
 	XML_ParserFree(p->parser_);
 }
 
-bool ExpatParser::parse(const std::string& data) {
-	bool success = XML_Parse(p->parser_, data.c_str(), boost::numeric_cast<int>(data.size()), false) == XML_STATUS_OK;
+bool ExpatParser::parse(const unsigned char* data, size_t size) {
+	bool success = XML_Parse(p->parser_, reinterpret_cast<const char*>(data), boost::numeric_cast<int>(size), false) == XML_STATUS_OK;
 	/*if (!success) {
-		std::cout << "ERROR: " << XML_ErrorString(XML_GetErrorCode(p->parser_)) << " while parsing " << data << std::endl;
+		std::cout << "ERROR: " << XML_ErrorString(XML_GetErrorCode(p->parser_)) << " while parsing " << std::string(reinterpret_cast<const char*>(data), size) << std::endl;
 	}*/
 	return success;
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,15 +13,30 @@
 #include <Swiften/Parser/XMLParser.h>
 
 namespace Swift {
+	class XMLViewParserClient;
+
 	class SWIFTEN_API ExpatParser : public XMLParser, public boost::noncopyable {
 		public:
 			ExpatParser(XMLParserClient* client);
+
+			/**
+			 * Creates a parser that passes views on the parsed data to the
+			 * client, without allocating strings for names, attributes,
+			 * or character data.
+			 *
+			 * getClient() returns NULL for parsers created this way.
+			 */
+			ExpatParser(XMLViewParserClient* client);
 			~ExpatParser();
 
-			bool parse(const std::string& data);
+			using XMLParser::parse;
+			bool parse(const unsigned char* data, size_t size);
 
 			void stopParser();
 
+		private:
+			void initialize();
+
 		private:
 			struct Private;
 			boost::shared_ptr<Private> p;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -27,6 +27,11 @@ namespace Swift {
 				return (tag_.empty() ? true : element == tag_) && (xmlns_.empty() ? true : xmlns_ == ns);
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement(tag_, xmlns_));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new PARSER_TYPE(parsers_);
 			}
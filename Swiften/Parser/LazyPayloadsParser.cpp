@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Parser/LazyPayloadsParser.h>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <Swiften/Parser/MessageParser.h>
+#include <Swiften/Parser/XMLParser.h>
+#include <Swiften/Parser/XMLParserClient.h>
+#include <Swiften/Parser/XMLParserFactory.h>
+
+namespace Swift {
+
+namespace {
+	class StanzaParserClient : public XMLParserClient {
+		public:
+			StanzaParserClient(StanzaParser* parser) : parser_(parser) {
+			}
+
+			virtual void handleStartElement(const std::string& element, const std::string& ns, const AttributeMap& attributes) {
+				parser_->handleStartElement(element, ns, attributes);
+			}
+
+			virtual void handleEndElement(const std::string& element, const std::string& ns) {
+				parser_->handleEndElement(element, ns);
+			}
+
+			virtual void handleCharacterData(const std::string& data) {
+				parser_->handleCharacterData(data);
+			}
+
+		private:
+			StanzaParser* parser_;
+	};
+}
+
+LazyPayloadsParser::LazyPayloadsParser(PayloadParserFactoryCollection* payloadParserFactories, XMLParserFactory* xmlParserFactory) : payloadParserFactories_(payloadParserFactories), xmlParserFactory_(xmlParserFactory) {
+}
+
+std::vector< boost::shared_ptr<Payload> > LazyPayloadsParser::parsePayloads(const std::string& data) {
+	// The payloads are wrapped in a stanza element, and parsed the same way
+	// as if they had been parsed with the original stanza.
+	MessageParser stanzaParser(payloadParserFactories_);
+	StanzaParserClient client(&stanzaParser);
+	boost::scoped_ptr<XMLParser> xmlParser(xmlParserFactory_->createXMLParser(&client));
+	if (xmlParser->parse("<message>") && xmlParser->parse(data)) {
+		xmlParser->parse("</message>");
+	}
+	return stanzaParser.getStanza()->getPayloads();
+}
+
+}
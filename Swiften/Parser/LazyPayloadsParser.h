@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Elements/Stanza.h>
+
+namespace Swift {
+	class PayloadParserFactoryCollection;
+	class XMLParserFactory;
+
+	/**
+	 * Parses the serialized payloads of stanzas received in raw forwarding
+	 * mode.
+	 *
+	 * The factory collections must outlive all stanzas referring to this
+	 * parser.
+	 */
+	class SWIFTEN_API LazyPayloadsParser : public Stanza::PayloadsParser {
+		public:
+			LazyPayloadsParser(PayloadParserFactoryCollection* payloadParserFactories, XMLParserFactory* xmlParserFactory);
+
+			virtual std::vector< boost::shared_ptr<Payload> > parsePayloads(const std::string& data);
+
+		private:
+			PayloadParserFactoryCollection* payloadParserFactories_;
+			XMLParserFactory* xmlParserFactory_;
+	};
+}
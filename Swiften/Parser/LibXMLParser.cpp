@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,6 +12,7 @@
 #include <cstring>
 #include <libxml/parser.h>
 #include <string>
+#include <boost/thread/once.hpp>
 
 #include <Swiften/Parser/XMLParserClient.h>
 
@@ -62,14 +63,11 @@ static void handleError(void*, const char* /*m*/, ... ) {
 static void handleWarning(void*, const char*, ... ) {
 }
 
-bool LibXMLParser::initialized = false;
+static boost::once_flag initializeFlag = BOOST_ONCE_INIT;
 
 LibXMLParser::LibXMLParser(XMLParserClient* client) : XMLParser(client), p(new Private()) {
 	// Initialize libXML for multithreaded applications
-	if (!initialized) {
-		xmlInitParser();
-		initialized = true;
-	}
+	boost::call_once(&xmlInitParser, initializeFlag);
 
 	memset(&p->handler_, 0, sizeof(p->handler_) );
 	p->handler_.initialized = XML_SAX2_MAGIC;
@@ -90,8 +88,8 @@ LibXMLParser::~LibXMLParser() {
 	}
 }
 
-bool LibXMLParser::parse(const std::string& data) {
-	if (xmlParseChunk(p->context_, data.c_str(), boost::numeric_cast<int>(data.size()), false) == XML_ERR_OK) {
+bool LibXMLParser::parse(const unsigned char* data, size_t size) {
+	if (xmlParseChunk(p->context_, reinterpret_cast<const char*>(data), boost::numeric_cast<int>(size), false) == XML_ERR_OK) {
 		return true;
 	}
 	xmlError* error = xmlCtxtGetLastError(p->context_);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,20 +12,15 @@
 #include <Swiften/Parser/XMLParser.h>
 
 namespace Swift {
-	/**
-	 * Warning: This constructor is not thread-safe, because it depends on global state to
-	 * check whether it is initialized.
-	 */
 	class LibXMLParser : public XMLParser, public boost::noncopyable {
 		public:
 			LibXMLParser(XMLParserClient* client);
 			~LibXMLParser();
 
-			bool parse(const std::string& data);
+			using XMLParser::parse;
+			bool parse(const unsigned char* data, size_t size);
 
 		private:
-			static bool initialized;
-
 			struct Private;
 			boost::shared_ptr<Private> p;
 	};
@@ -1,11 +1,15 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <Swiften/Base/API.h>
 #include <Swiften/Parser/AttributeMap.h>
 
@@ -17,6 +21,13 @@ namespace Swift {
 	 * A factory for PayloadParsers.
 	 */
 	class SWIFTEN_API PayloadParserFactory {
+		public:
+			/**
+			 * A top-level element name and namespace. An empty string matches
+			 * any element name or namespace.
+			 */
+			typedef std::pair<std::string, std::string> ParsedElement;
+
 		public:
 			virtual ~PayloadParserFactory();
 
@@ -29,5 +40,16 @@ namespace Swift {
 			 * Creates a new payload parser.
 			 */
 			virtual PayloadParser* createPayloadParser() = 0;
+
+			/**
+			 * Retrieves the elements this factory can parse, if canParse() only
+			 * depends on the element name and namespace. This allows
+			 * PayloadParserFactoryCollection to look up the factory without
+			 * calling canParse().
+			 *
+			 * The default implementation returns false, meaning canParse()
+			 * always needs to be called.
+			 */
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const;
 	};
 }
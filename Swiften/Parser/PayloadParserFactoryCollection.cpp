@@ -1,26 +1,58 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
-#include <boost/bind.hpp>
 #include <algorithm>
 
+#include <Swiften/Base/foreach.h>
 #include <Swiften/Parser/PayloadParserFactoryCollection.h>
 #include <Swiften/Parser/PayloadParserFactory.h>
 
 namespace Swift {
 
-PayloadParserFactoryCollection::PayloadParserFactoryCollection() : defaultFactory_(NULL) {
+PayloadParserFactoryCollection::PayloadParserFactoryCollection() : nextOrder_(0), defaultFactory_(NULL) {
 }
 
 void PayloadParserFactoryCollection::addFactory(PayloadParserFactory* factory) {
-	factories_.push_back(factory);
+	Entry entry(factory, nextOrder_++);
+	std::vector<PayloadParserFactory::ParsedElement> parsedElements;
+	if (factory->getParsedElements(parsedElements)) {
+		foreach (const PayloadParserFactory::ParsedElement& parsedElement, parsedElements) {
+			index_[parsedElement.second][parsedElement.first].push_back(entry);
+		}
+	}
+	else {
+		unindexedFactories_.push_back(entry);
+	}
 }
 
 void PayloadParserFactoryCollection::removeFactory(PayloadParserFactory* factory) {
-	factories_.erase(std::remove(factories_.begin(), factories_.end(), factory), factories_.end());
+	Entry entry(factory, 0);
+	std::vector<PayloadParserFactory::ParsedElement> parsedElements;
+	if (factory->getParsedElements(parsedElements)) {
+		foreach (const PayloadParserFactory::ParsedElement& parsedElement, parsedElements) {
+			NamespaceIndex::iterator i = index_.find(parsedElement.second);
+			if (i == index_.end()) {
+				continue;
+			}
+			ElementIndex::iterator j = i->second.find(parsedElement.first);
+			if (j == i->second.end()) {
+				continue;
+			}
+			j->second.erase(std::remove(j->second.begin(), j->second.end(), entry), j->second.end());
+			if (j->second.empty()) {
+				i->second.erase(j);
+				if (i->second.empty()) {
+					index_.erase(i);
+				}
+			}
+		}
+	}
+	else {
+		unindexedFactories_.erase(std::remove(unindexedFactories_.begin(), unindexedFactories_.end(), entry), unindexedFactories_.end());
+	}
 }
 
 void PayloadParserFactoryCollection::setDefaultFactory(PayloadParserFactory* factory) {
@@ -28,10 +60,49 @@ void PayloadParserFactoryCollection::setDefaultFactory(PayloadParserFactory* fac
 }
 
 PayloadParserFactory* PayloadParserFactoryCollection::getPayloadParserFactory(const std::string& element, const std::string& ns, const AttributeMap& attributes) {
-	std::vector<PayloadParserFactory*>::reverse_iterator i = std::find_if(
-			factories_.rbegin(), factories_.rend(),
-			boost::bind(&PayloadParserFactory::canParse, _1, element, ns, attributes));
-	return (i != factories_.rend() ? *i : defaultFactory_);
+	const Entry* indexedEntry = findIndexedEntry(element, ns);
+
+	// Factories that can't be indexed only need to be asked if they were added
+	// after the best indexed match.
+	for (EntryList::const_reverse_iterator i = unindexedFactories_.rbegin(); i != unindexedFactories_.rend(); ++i) {
+		if (indexedEntry && i->order < indexedEntry->order) {
+			break;
+		}
+		if (i->factory->canParse(element, ns, attributes)) {
+			return i->factory;
+		}
+	}
+	return indexedEntry ? indexedEntry->factory : defaultFactory_;
+}
+
+const PayloadParserFactoryCollection::Entry* PayloadParserFactoryCollection::findIndexedEntry(const std::string& element, const std::string& ns) const {
+	static const std::string any;
+	const Entry* result = NULL;
+	NamespaceIndex::const_iterator i = index_.find(ns);
+	if (i != index_.end()) {
+		findLastEntry(i->second, element, result);
+	}
+	if (!ns.empty()) {
+		i = index_.find(any);
+		if (i != index_.end()) {
+			findLastEntry(i->second, element, result);
+		}
+	}
+	return result;
+}
+
+void PayloadParserFactoryCollection::findLastEntry(const ElementIndex& elementIndex, const std::string& element, const Entry*& result) {
+	static const std::string any;
+	ElementIndex::const_iterator i = elementIndex.find(element);
+	if (i != elementIndex.end() && (!result || i->second.back().order > result->order)) {
+		result = &i->second.back();
+	}
+	if (!element.empty()) {
+		i = elementIndex.find(any);
+		if (i != elementIndex.end() && (!result || i->second.back().order > result->order)) {
+			result = &i->second.back();
+		}
+	}
 }
 
 }
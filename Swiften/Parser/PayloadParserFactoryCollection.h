@@ -1,12 +1,14 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <string>
 #include <vector>
+#include <boost/unordered_map.hpp>
 
 #include <Swiften/Parser/AttributeMap.h>
 #include <Swiften/Base/API.h>
@@ -14,6 +16,14 @@
 namespace Swift {
 	class PayloadParserFactory;
 
+	/**
+	 * A collection of PayloadParserFactories, where factories added later
+	 * take precedence over factories added earlier.
+	 *
+	 * Factories that report their parsed elements through
+	 * PayloadParserFactory::getParsedElements() are indexed by namespace and
+	 * element name. Only the remaining factories are asked through canParse().
+	 */
 	class SWIFTEN_API PayloadParserFactoryCollection {
 		public:
 			PayloadParserFactoryCollection();
@@ -25,7 +35,27 @@ namespace Swift {
 			PayloadParserFactory* getPayloadParserFactory(const std::string& element, const std::string& ns, const AttributeMap& attributes);
 
 		private:
-			std::vector<PayloadParserFactory*> factories_;
+			struct Entry {
+				Entry(PayloadParserFactory* factory, unsigned int order) : factory(factory), order(order) {}
+
+				bool operator==(const Entry& other) const {
+					return factory == other.factory;
+				}
+
+				PayloadParserFactory* factory;
+				unsigned int order;
+			};
+			typedef std::vector<Entry> EntryList;
+			typedef boost::unordered_map<std::string, EntryList> ElementIndex;
+			typedef boost::unordered_map<std::string, ElementIndex> NamespaceIndex;
+
+			const Entry* findIndexedEntry(const std::string& element, const std::string& ns) const;
+			static void findLastEntry(const ElementIndex& elementIndex, const std::string& element, const Entry*& result);
+
+		private:
+			unsigned int nextOrder_;
+			NamespaceIndex index_;
+			EntryList unindexedFactories_;
 			PayloadParserFactory* defaultFactory_;
 	};
 }
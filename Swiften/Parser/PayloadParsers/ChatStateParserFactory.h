@@ -23,6 +23,14 @@ namespace Swift {
 					 || element == "paused" || element == "inactive" || element == "gone");
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				const char* states[] = { "active", "composing", "paused", "inactive", "gone" };
+				for (size_t i = 0; i < sizeof(states) / sizeof(states[0]); ++i) {
+					elements.push_back(ParsedElement(states[i], "http://jabber.org/protocol/chatstates"));
+				}
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new ChatStateParser();
 			}
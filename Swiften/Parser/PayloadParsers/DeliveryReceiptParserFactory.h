@@ -21,6 +21,11 @@ namespace Swift {
 				return ns == "urn:xmpp:receipts" && element == "received";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("received", "urn:xmpp:receipts"));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new DeliveryReceiptParser();
 			}
@@ -21,6 +21,11 @@ namespace Swift {
 				return ns == "urn:xmpp:receipts" && element == "request";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("request", "urn:xmpp:receipts"));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new DeliveryReceiptRequestParser();
 			}
@@ -21,6 +21,11 @@ namespace Swift {
 				return element == "error";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("error", ""));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new ErrorParser(factories);
 			}
@@ -21,6 +21,11 @@ namespace Swift {
 				return ns == "jabber:x:data";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("", "jabber:x:data"));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new FormParser();
 			}
@@ -22,6 +22,11 @@ namespace Swift {
 				return element == "content" && ns == "urn:xmpp:jingle:1";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("content", "urn:xmpp:jingle:1"));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new JingleContentPayloadParser(factories);
 			}
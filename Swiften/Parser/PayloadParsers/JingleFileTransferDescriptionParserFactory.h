@@ -28,6 +28,11 @@ namespace Swift {
 				return element == "description" && ns == "urn:xmpp:jingle:apps:file-transfer:4";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("description", "urn:xmpp:jingle:apps:file-transfer:4"));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new JingleFileTransferDescriptionParser(factories);
 			}
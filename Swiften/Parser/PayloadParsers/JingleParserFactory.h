@@ -22,6 +22,11 @@ namespace Swift {
 				return element == "jingle" && ns == "urn:xmpp:jingle:1";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("jingle", "urn:xmpp:jingle:1"));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new JingleParser(factories);
 			}
@@ -21,6 +21,11 @@ namespace Swift {
 				return element == "query" && ns == "http://jabber.org/protocol/muc#owner";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("query", "http://jabber.org/protocol/muc#owner"));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new MUCOwnerPayloadParser(factories);
 			}
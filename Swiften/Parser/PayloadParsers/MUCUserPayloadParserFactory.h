@@ -19,6 +19,11 @@ namespace Swift {
 				return element == "x" && ns == "http://jabber.org/protocol/muc#user";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("x", "http://jabber.org/protocol/muc#user"));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new MUCUserPayloadParser(factories);
 			}
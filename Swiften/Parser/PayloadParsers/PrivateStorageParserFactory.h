@@ -21,6 +21,11 @@ namespace Swift {
 				return element == "query" && ns == "jabber:iq:private";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("query", "jabber:iq:private"));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new PrivateStorageParser(factories);
 			}
@@ -20,6 +20,11 @@ namespace Swift {
 				return ns == "http://jabber.org/protocol/pubsub#errors";
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("", "http://jabber.org/protocol/pubsub#errors"));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new PubSubErrorParser();
 			}
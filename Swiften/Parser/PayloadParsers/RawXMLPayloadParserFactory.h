@@ -19,6 +19,11 @@ namespace Swift {
 				return true;
 			}
 
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement("", ""));
+				return true;
+			}
+
 			virtual PayloadParser* createPayloadParser() {
 				return new RawXMLPayloadParser();
 			}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,16 +7,21 @@
 #include <Swiften/Parser/StanzaParser.h>
 
 #include <iostream>
+#include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
 #include <cassert>
 
+#include <Swiften/Base/foreach.h>
 #include <Swiften/Parser/PayloadParser.h>
 #include <Swiften/Parser/PayloadParserFactory.h>
 #include <Swiften/Parser/PayloadParserFactoryCollection.h>
 #include <Swiften/Parser/UnknownPayloadParser.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
+static const char* XML_NAMESPACE = "http://www.w3.org/XML/1998/namespace";
+
 StanzaParser::StanzaParser(PayloadParserFactoryCollection* factories) : 
 		currentDepth_(0), factories_(factories) {
 }
@@ -24,8 +29,16 @@ StanzaParser::StanzaParser(PayloadParserFactoryCollection* factories) :
 StanzaParser::~StanzaParser() {
 }
 
+void StanzaParser::setRawPayloadsParser(boost::shared_ptr<Stanza::PayloadsParser> parser) {
+	rawPayloadsParser_ = parser;
+	rawPayloadsWriter_ = parser ? boost::shared_ptr<XMLWriter>(new XMLWriter(rawPayloads_)) : boost::shared_ptr<XMLWriter>();
+}
+
 void StanzaParser::handleStartElement(const std::string& element, const std::string& ns, const AttributeMap& attributes) {
-	if (inStanza()) {
+	if (inStanza() && rawPayloadsWriter_) {
+		writeRawStartElement(element, ns, attributes);
+	}
+	else if (inStanza()) {
 		if (!inPayload()) {
 			assert(!currentPayloadParser_);
 			PayloadParserFactory* payloadParserFactory = factories_->getPayloadParserFactory(element, ns, attributes);
@@ -57,9 +70,41 @@ void StanzaParser::handleStartElement(const std::string& element, const std::str
 	++currentDepth_;
 }
 
+void StanzaParser::writeRawStartElement(const std::string& element, const std::string& ns, const AttributeMap& attributes) {
+	rawPayloadsWriter_->startElement(element);
+	// The namespace of a payload is always written, so it can be parsed
+	// on its own later on. An empty namespace is written as well, or the
+	// element would end up in the namespace of its parent.
+	if (rawPayloadNamespaces_.empty() || rawPayloadNamespaces_.back() != ns) {
+		rawPayloadsWriter_->addAttribute("xmlns", ns);
+	}
+	int prefixes = 0;
+	foreach (const AttributeMap::Entry& entry, attributes.getEntries()) {
+		const std::string& attributeNS = entry.getAttribute().getNamespace();
+		if (attributeNS.empty()) {
+			rawPayloadsWriter_->addAttribute(entry.getAttribute().getName(), entry.getValue());
+		}
+		else if (attributeNS == XML_NAMESPACE) {
+			rawPayloadsWriter_->addAttribute("xml:" + entry.getAttribute().getName(), entry.getValue());
+		}
+		else {
+			// The original prefix is not known, so declare a new one
+			std::string prefix = "ns" + boost::lexical_cast<std::string>(prefixes++);
+			rawPayloadsWriter_->addAttribute("xmlns:" + prefix, attributeNS);
+			rawPayloadsWriter_->addAttribute(prefix + ":" + entry.getAttribute().getName(), entry.getValue());
+		}
+	}
+	rawPayloadNamespaces_.push_back(ns);
+}
+
 void StanzaParser::handleEndElement(const std::string& element, const std::string& ns) {
 	assert(inStanza());
-	if (inPayload()) {
+	if (inPayload() && rawPayloadsWriter_) {
+		rawPayloadsWriter_->endElement();
+		rawPayloadNamespaces_.pop_back();
+		--currentDepth_;
+	}
+	else if (inPayload()) {
 		assert(currentPayloadParser_);
 		currentPayloadParser_->handleEndElement(element, ns);
 		--currentDepth_;
@@ -73,6 +118,9 @@ void StanzaParser::handleEndElement(const std::string& element, const std::strin
 	}
 	else {
 		--currentDepth_;
+		if (rawPayloadsParser_ && !rawPayloads_.empty()) {
+			getStanza()->setRawPayloads(rawPayloads_, rawPayloadsParser_);
+		}
 	}
 }
 
@@ -80,6 +128,9 @@ void StanzaParser::handleCharacterData(const std::string& data) {
 	if (currentPayloadParser_) {
 		currentPayloadParser_->handleCharacterData(data);
 	}
+	else if (rawPayloadsWriter_ && inPayload()) {
+		rawPayloadsWriter_->addText(data);
+	}
 }
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,8 +9,10 @@
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 
-#include <Swiften/Base/API.h>
 #include <string>
+#include <vector>
+
+#include <Swiften/Base/API.h>
 #include <Swiften/Elements/Stanza.h>
 #include <Swiften/Parser/ElementParser.h>
 #include <Swiften/Parser/AttributeMap.h>
@@ -18,6 +20,7 @@
 namespace Swift {
 	class PayloadParser;
 	class PayloadParserFactoryCollection;
+	class XMLWriter;
 
 	class SWIFTEN_API StanzaParser : public ElementParser, public boost::noncopyable {
 		public:
@@ -28,6 +31,16 @@ namespace Swift {
 			void handleEndElement(const std::string& element, const std::string& ns);
 			void handleCharacterData(const std::string& data);
 
+			/**
+			 * Keeps the payloads of the stanza in serialized form instead of
+			 * parsing them, and lets the stanza parse them with the given
+			 * parser when they are first accessed.
+			 *
+			 * Only the stanza attributes are parsed in this mode, which is
+			 * all that is needed to route a stanza.
+			 */
+			void setRawPayloadsParser(boost::shared_ptr<Stanza::PayloadsParser> parser);
+
 			virtual boost::shared_ptr<ToplevelElement> getElement() const = 0;
 			virtual void handleStanzaAttributes(const AttributeMap&) {}
 
@@ -44,10 +57,15 @@ namespace Swift {
 				return currentDepth_ > 0;
 			}
 
+			void writeRawStartElement(const std::string& element, const std::string& ns, const AttributeMap& attributes);
 
 		private:
 			int currentDepth_;
 			PayloadParserFactoryCollection* factories_;
 			boost::shared_ptr<PayloadParser> currentPayloadParser_;
+			boost::shared_ptr<Stanza::PayloadsParser> rawPayloadsParser_;
+			std::string rawPayloads_;
+			boost::shared_ptr<XMLWriter> rawPayloadsWriter_;
+			std::vector<std::string> rawPayloadNamespaces_;
 	};
 }
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#ifdef HAVE_EXPAT
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <string>
+#include <vector>
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/Base/foreach.h>
+#include <Swiften/Parser/ExpatParser.h>
+#include <Swiften/Parser/XMLViewParserClient.h>
+
+using namespace Swift;
+
+class ExpatParserTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(ExpatParserTest);
+		CPPUNIT_TEST(testParse_ViewClient);
+		CPPUNIT_TEST(testParse_ViewClient_Attributes);
+		CPPUNIT_TEST(testParse_ViewClient_InternsNamespaces);
+		CPPUNIT_TEST(testParse_ViewClient_ManyNamespaces);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void testParse_ViewClient() {
+			ExpatParser testling(&client_);
+
+			CPPUNIT_ASSERT(testling.parse(
+				"<query xmlns='jabber:iq:version'>"
+					"<name>Swift</name>"
+				"</query>"));
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(5), client_.events.size());
+			CPPUNIT_ASSERT_EQUAL(std::string("start query jabber:iq:version"), client_.events[0]);
+			CPPUNIT_ASSERT_EQUAL(std::string("start name jabber:iq:version"), client_.events[1]);
+			CPPUNIT_ASSERT_EQUAL(std::string("data Swift"), client_.events[2]);
+			CPPUNIT_ASSERT_EQUAL(std::string("end name jabber:iq:version"), client_.events[3]);
+			CPPUNIT_ASSERT_EQUAL(std::string("end query jabber:iq:version"), client_.events[4]);
+			CPPUNIT_ASSERT(!testling.getClient());
+		}
+
+		void testParse_ViewClient_Attributes() {
+			ExpatParser testling(&client_);
+
+			CPPUNIT_ASSERT(testling.parse("<x xmlns='foo' xmlns:bar='baz' type='a&amp;b' bar:att='c'/>"));
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), client_.events.size());
+			CPPUNIT_ASSERT_EQUAL(std::string("start x foo type=a&b baz:att=c"), client_.events[0]);
+			CPPUNIT_ASSERT_EQUAL(std::string("end x foo"), client_.events[1]);
+		}
+
+		void testParse_ViewClient_InternsNamespaces() {
+			ExpatParser testling(&client_);
+
+			CPPUNIT_ASSERT(testling.parse("<a xmlns='foo'><b/><c xmlns='bar'/></a>"));
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), client_.namespaces.size());
+			CPPUNIT_ASSERT(client_.namespaces[0] == client_.namespaces[1]);
+			CPPUNIT_ASSERT(client_.namespaces[0] != client_.namespaces[2]);
+			CPPUNIT_ASSERT_EQUAL(std::string("bar"), *client_.namespaces[2]);
+		}
+
+		void testParse_ViewClient_ManyNamespaces() {
+			ExpatParser testling(&client_);
+
+			CPPUNIT_ASSERT(testling.parse("<a xmlns='foo'>"));
+			for (int i = 0; i < 1000; ++i) {
+				std::string ns = "urn:test:" + boost::lexical_cast<std::string>(i);
+				CPPUNIT_ASSERT(testling.parse("<b xmlns='" + ns + "'/>"));
+				CPPUNIT_ASSERT_EQUAL("end b " + ns, client_.events.back());
+			}
+		}
+
+	private:
+		class Client : public XMLViewParserClient {
+			public:
+				virtual void handleStartElement(const StringView& element, const std::string& ns, const std::vector<AttributeView>& attributes) {
+					std::string event = "start " + element.toString() + " " + ns;
+					foreach (const AttributeView& attribute, attributes) {
+						event += " ";
+						if (!attribute.getNamespace().empty()) {
+							event += attribute.getNamespace() + ":";
+						}
+						event += attribute.getName().toString() + "=" + attribute.getValue().toString();
+					}
+					events.push_back(event);
+					namespaces.push_back(&ns);
+				}
+
+				virtual void handleEndElement(const StringView& element, const std::string& ns) {
+					events.push_back("end " + element.toString() + " " + ns);
+				}
+
+				virtual void handleCharacterData(const StringView& data) {
+					events.push_back("data " + data.toString());
+				}
+
+				std::vector<std::string> events;
+				std::vector<const std::string*> namespaces;
+		} client_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ExpatParserTest);
+
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,11 @@ class PayloadParserFactoryCollectionTest : public CppUnit::TestFixture
 		CPPUNIT_TEST(testGetPayloadParserFactory_TwoMatchingFactories);
 		CPPUNIT_TEST(testGetPayloadParserFactory_MatchWithDefaultFactory);
 		CPPUNIT_TEST(testGetPayloadParserFactory_NoMatchWithDefaultFactory);
+		CPPUNIT_TEST(testGetPayloadParserFactory_Indexed);
+		CPPUNIT_TEST(testGetPayloadParserFactory_IndexedWithWildcards);
+		CPPUNIT_TEST(testGetPayloadParserFactory_IndexedAddedAfterUnindexed);
+		CPPUNIT_TEST(testGetPayloadParserFactory_UnindexedAddedAfterIndexed);
+		CPPUNIT_TEST(testRemoveFactory_Indexed);
 		CPPUNIT_TEST_SUITE_END();
 
 	public:
@@ -87,6 +92,71 @@ class PayloadParserFactoryCollectionTest : public CppUnit::TestFixture
 
 			CPPUNIT_ASSERT(factory == &factory2);
 		}
+
+		void testGetPayloadParserFactory_Indexed() {
+			PayloadParserFactoryCollection testling;
+			IndexedDummyFactory factory1("foo", "ns1");
+			testling.addFactory(&factory1);
+			IndexedDummyFactory factory2("foo", "ns2");
+			testling.addFactory(&factory2);
+			IndexedDummyFactory factory3("bar", "ns1");
+			testling.addFactory(&factory3);
+
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &factory1);
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns2", AttributeMap()) == &factory2);
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("bar", "ns1", AttributeMap()) == &factory3);
+			CPPUNIT_ASSERT(!testling.getPayloadParserFactory("bar", "ns2", AttributeMap()));
+		}
+
+		void testGetPayloadParserFactory_IndexedWithWildcards() {
+			PayloadParserFactoryCollection testling;
+			IndexedDummyFactory anyElementFactory("", "ns1");
+			testling.addFactory(&anyElementFactory);
+			IndexedDummyFactory anyNamespaceFactory("foo", "");
+			testling.addFactory(&anyNamespaceFactory);
+			IndexedDummyFactory exactFactory("bar", "ns1");
+			testling.addFactory(&exactFactory);
+
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("baz", "ns1", AttributeMap()) == &anyElementFactory);
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &anyNamespaceFactory);
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns2", AttributeMap()) == &anyNamespaceFactory);
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("bar", "ns1", AttributeMap()) == &exactFactory);
+		}
+
+		void testGetPayloadParserFactory_IndexedAddedAfterUnindexed() {
+			PayloadParserFactoryCollection testling;
+			DummyFactory factory1("foo");
+			testling.addFactory(&factory1);
+			IndexedDummyFactory factory2("foo", "ns1");
+			testling.addFactory(&factory2);
+
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &factory2);
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns2", AttributeMap()) == &factory1);
+		}
+
+		void testGetPayloadParserFactory_UnindexedAddedAfterIndexed() {
+			PayloadParserFactoryCollection testling;
+			IndexedDummyFactory factory1("foo", "ns1");
+			testling.addFactory(&factory1);
+			DummyFactory factory2("foo");
+			testling.addFactory(&factory2);
+
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &factory2);
+		}
+
+		void testRemoveFactory_Indexed() {
+			PayloadParserFactoryCollection testling;
+			IndexedDummyFactory factory1("foo", "ns1");
+			testling.addFactory(&factory1);
+			IndexedDummyFactory factory2("foo", "ns1");
+			testling.addFactory(&factory2);
+
+			testling.removeFactory(&factory2);
+			CPPUNIT_ASSERT(testling.getPayloadParserFactory("foo", "ns1", AttributeMap()) == &factory1);
+
+			testling.removeFactory(&factory1);
+			CPPUNIT_ASSERT(!testling.getPayloadParserFactory("foo", "ns1", AttributeMap()));
+		}
 	
 	
 	private:
@@ -98,6 +168,20 @@ class PayloadParserFactoryCollectionTest : public CppUnit::TestFixture
 			virtual PayloadParser* createPayloadParser() { return NULL; }
 			std::string element;
 		};
+
+		struct IndexedDummyFactory : public PayloadParserFactory {
+			IndexedDummyFactory(const std::string& element, const std::string& ns) : element(element), ns(ns) {}
+			virtual bool canParse(const std::string& e, const std::string& n, const AttributeMap&) const {
+				return (element.empty() || element == e) && (ns.empty() || ns == n);
+			}
+			virtual bool getParsedElements(std::vector<ParsedElement>& elements) const {
+				elements.push_back(ParsedElement(element, ns));
+				return true;
+			}
+			virtual PayloadParser* createPayloadParser() { return NULL; }
+			std::string element;
+			std::string ns;
+		};
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PayloadParserFactoryCollectionTest);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -31,6 +31,8 @@ class XMLParserTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST(testParse_InvalidXML);
 		CPPUNIT_TEST(testParse_InErrorState);
 		CPPUNIT_TEST(testParse_Incremental);
+		CPPUNIT_TEST(testParse_Buffer);
+		CPPUNIT_TEST(testParse_BufferSplitInCharacter);
 		CPPUNIT_TEST(testParse_WhitespaceInAttribute);
 		CPPUNIT_TEST(testParse_AttributeWithoutNamespace);
 		CPPUNIT_TEST(testParse_AttributeWithNamespace);
@@ -217,6 +219,40 @@ class XMLParserTest : public CppUnit::TestFixture {
 			CPPUNIT_ASSERT_EQUAL(std::string("iq"), client_.events[1].data);
 		}
 
+		void testParse_Buffer() {
+			ParserType testling(&client_);
+			const std::string data("<iq type=\"get\"/>");
+
+			CPPUNIT_ASSERT(testling.parse(reinterpret_cast<const unsigned char*>(data.data()), data.size()));
+			CPPUNIT_ASSERT(testling.parse(NULL, 0));
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), client_.events.size());
+			CPPUNIT_ASSERT_EQUAL(Client::StartElement, client_.events[0].type);
+			CPPUNIT_ASSERT_EQUAL(std::string("iq"), client_.events[0].data);
+			CPPUNIT_ASSERT_EQUAL(std::string("get"), client_.events[0].attributes.getAttribute("type"));
+			CPPUNIT_ASSERT_EQUAL(Client::EndElement, client_.events[1].type);
+			CPPUNIT_ASSERT_EQUAL(std::string("iq"), client_.events[1].data);
+		}
+
+		void testParse_BufferSplitInCharacter() {
+			ParserType testling(&client_);
+			const unsigned char data[] = "<body>caf\xc3\xa9</body>";
+			const size_t split = 10;
+
+			CPPUNIT_ASSERT(testling.parse(data, split));
+			CPPUNIT_ASSERT(testling.parse(data + split, sizeof(data) - 1 - split));
+
+			std::string text;
+			for (size_t i = 0; i < client_.events.size(); ++i) {
+				if (client_.events[i].type == Client::CharacterData) {
+					text += client_.events[i].data;
+				}
+			}
+			CPPUNIT_ASSERT_EQUAL(std::string("caf\xc3\xa9"), text);
+			CPPUNIT_ASSERT_EQUAL(Client::EndElement, client_.events.back().type);
+			CPPUNIT_ASSERT_EQUAL(std::string("body"), client_.events.back().data);
+		}
+
 		void testParse_WhitespaceInAttribute() {
 			ParserType testling(&client_);
 
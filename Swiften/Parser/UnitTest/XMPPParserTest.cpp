@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,12 +14,16 @@
 #include <Swiften/Parser/ElementParser.h>
 #include <Swiften/Parser/XMPPParserClient.h>
 #include <Swiften/Parser/PayloadParserFactoryCollection.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
 #include <Swiften/Parser/PlatformXMLParserFactory.h>
 #include <Swiften/Elements/Presence.h>
 #include <Swiften/Elements/IQ.h>
 #include <Swiften/Elements/Message.h>
+#include <Swiften/Elements/Body.h>
 #include <Swiften/Elements/StreamFeatures.h>
 #include <Swiften/Elements/UnknownElement.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+#include <Swiften/Serializer/XMPPSerializer.h>
 
 using namespace Swift;
 
@@ -35,6 +39,9 @@ class XMPPParserTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST(testParse_StrayCharacterData);
 		CPPUNIT_TEST(testParse_InvalidStreamStart);
 		CPPUNIT_TEST(testParse_ElementEndAfterInvalidStreamStart);
+		CPPUNIT_TEST(testParse_RawForwarding);
+		CPPUNIT_TEST(testParse_RawForwarding_WithoutPayloads);
+		CPPUNIT_TEST(testParse_RawForwarding_EmptyNamespace);
 		CPPUNIT_TEST_SUITE_END();
 
 	public:
@@ -157,6 +164,69 @@ class XMPPParserTest : public CppUnit::TestFixture {
 			CPPUNIT_ASSERT(!testling.parse("<tream/>"));
 		}
 
+		void testParse_RawForwarding() {
+			FullPayloadParserFactoryCollection factories;
+			XMPPParser testling(&client_, &factories, &xmlParserFactory_);
+			testling.setRawForwarding(true);
+
+			CPPUNIT_ASSERT(testling.parse("<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams'>"));
+			CPPUNIT_ASSERT(testling.parse(
+				"<message to='juliet@capulet.lit' type='chat'>"
+					"<body>Hello &amp; bye</body>"
+					"<x xmlns='jabber:x:foo' xml:lang='en'><y>&lt;</y><z xmlns='jabber:x:bar'/></x>"
+				"</message>"));
+
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(client_.events.size()));
+			boost::shared_ptr<Message> message = boost::dynamic_pointer_cast<Message>(client_.events[1].element);
+			CPPUNIT_ASSERT(message);
+			CPPUNIT_ASSERT_EQUAL(JID("juliet@capulet.lit"), message->getTo());
+			CPPUNIT_ASSERT_EQUAL(Message::Chat, message->getType());
+			CPPUNIT_ASSERT(message->hasRawPayloads());
+			CPPUNIT_ASSERT_EQUAL(std::string(
+					"<body xmlns=\"jabber:client\">Hello &amp; bye</body>"
+					"<x xmlns=\"jabber:x:foo\" xml:lang=\"en\"><y>&lt;</y><z xmlns=\"jabber:x:bar\"/></x>"),
+				*message->getRawPayloads());
+
+			boost::shared_ptr<Body> body = message->getPayload<Body>();
+			CPPUNIT_ASSERT(body);
+			CPPUNIT_ASSERT_EQUAL(std::string("Hello & bye"), body->getText());
+			CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(message->getPayloads().size()));
+			CPPUNIT_ASSERT(!message->hasRawPayloads());
+		}
+
+		void testParse_RawForwarding_WithoutPayloads() {
+			XMPPParser testling(&client_, &factories_, &xmlParserFactory_);
+			testling.setRawForwarding(true);
+
+			CPPUNIT_ASSERT(testling.parse("<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams'>"));
+			CPPUNIT_ASSERT(testling.parse("<presence type='unavailable'/>"));
+
+			boost::shared_ptr<Presence> presence = boost::dynamic_pointer_cast<Presence>(client_.events[1].element);
+			CPPUNIT_ASSERT(presence);
+			CPPUNIT_ASSERT_EQUAL(Presence::Unavailable, presence->getType());
+			CPPUNIT_ASSERT(!presence->hasRawPayloads());
+			CPPUNIT_ASSERT(presence->getPayloads().empty());
+		}
+
+		void testParse_RawForwarding_EmptyNamespace() {
+			FullPayloadParserFactoryCollection factories;
+			XMPPParser testling(&client_, &factories, &xmlParserFactory_);
+			testling.setRawForwarding(true);
+			std::string payloads = "<x xmlns=\"foo\"><y xmlns=\"\"><z/></y></x><w xmlns=\"\"/>";
+
+			CPPUNIT_ASSERT(testling.parse("<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams'>"));
+			CPPUNIT_ASSERT(testling.parse("<message>" + payloads + "</message>"));
+			boost::shared_ptr<Message> message = boost::dynamic_pointer_cast<Message>(client_.events[1].element);
+			CPPUNIT_ASSERT_EQUAL(payloads, *message->getRawPayloads());
+
+			// Forwarding the stanza keeps the elements out of jabber:client
+			FullPayloadSerializerCollection serializers;
+			XMPPSerializer serializer(&serializers, ClientStreamType, false);
+			CPPUNIT_ASSERT(testling.parse(safeByteArrayToString(serializer.serializeElement(message))));
+			boost::shared_ptr<Message> forwarded = boost::dynamic_pointer_cast<Message>(client_.events[2].element);
+			CPPUNIT_ASSERT_EQUAL(payloads, *forwarded->getRawPayloads());
+		}
+
 	private:
 		class Client : public XMPPParserClient {
 			public:
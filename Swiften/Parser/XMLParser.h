@@ -1,11 +1,12 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 #include <Swiften/Base/API.h>
@@ -18,7 +19,15 @@ namespace Swift {
 			XMLParser(XMLParserClient* client);
 			virtual ~XMLParser();
 
-			virtual bool parse(const std::string& data) = 0;
+			/**
+			 * Parses the next chunk of the document directly from the given
+			 * buffer, without copying it.
+			 */
+			virtual bool parse(const unsigned char* data, size_t size) = 0;
+
+			bool parse(const std::string& data) {
+				return parse(reinterpret_cast<const unsigned char*>(data.data()), data.size());
+			}
 
 			XMLParserClient* getClient() const {
 				return client_;
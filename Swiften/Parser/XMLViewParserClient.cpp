@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Parser/XMLViewParserClient.h>
+
+namespace Swift {
+
+XMLViewParserClient::~XMLViewParserClient() {
+}
+
+}
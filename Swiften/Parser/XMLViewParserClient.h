@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/StringView.h>
+
+namespace Swift {
+	/**
+	 * An XML parser client that receives non-owning views on the parsed
+	 * data, so the parser doesn't need to allocate strings per callback.
+	 *
+	 * Views (element names, attribute names and values, character data)
+	 * are only valid during the callback. Namespaces are passed as
+	 * strings interned by the parser, which normally stay valid for the
+	 * lifetime of the parser.
+	 *
+	 * Existing XMLParserClients can be used through an
+	 * XMLViewParserClientAdapter.
+	 */
+	class SWIFTEN_API XMLViewParserClient {
+		public:
+			class AttributeView {
+				public:
+					AttributeView(const StringView& name, const std::string& ns, const StringView& value) : name(name), ns(&ns), value(value) {
+					}
+
+					const StringView& getName() const {
+						return name;
+					}
+
+					const std::string& getNamespace() const {
+						return *ns;
+					}
+
+					const StringView& getValue() const {
+						return value;
+					}
+
+				private:
+					StringView name;
+					const std::string* ns;
+					StringView value;
+			};
+
+			virtual ~XMLViewParserClient();
+
+			virtual void handleStartElement(const StringView& element, const std::string& ns, const std::vector<AttributeView>& attributes) = 0;
+			virtual void handleEndElement(const StringView& element, const std::string& ns) = 0;
+			virtual void handleCharacterData(const StringView& data) = 0;
+	};
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Parser/XMLViewParserClientAdapter.h>
+
+#include <Swiften/Base/foreach.h>
+#include <Swiften/Parser/AttributeMap.h>
+#include <Swiften/Parser/XMLParserClient.h>
+
+namespace Swift {
+
+XMLViewParserClientAdapter::XMLViewParserClientAdapter(XMLParserClient* client) : client_(client) {
+}
+
+void XMLViewParserClientAdapter::handleStartElement(const StringView& element, const std::string& ns, const std::vector<AttributeView>& attributes) {
+	AttributeMap attributeMap;
+	foreach (const AttributeView& attribute, attributes) {
+		attributeMap.addAttribute(attribute.getName().toString(), attribute.getNamespace(), attribute.getValue().toString());
+	}
+	element_.assign(element.data(), element.size());
+	client_->handleStartElement(element_, ns, attributeMap);
+}
+
+void XMLViewParserClientAdapter::handleEndElement(const StringView& element, const std::string& ns) {
+	element_.assign(element.data(), element.size());
+	client_->handleEndElement(element_, ns);
+}
+
+void XMLViewParserClientAdapter::handleCharacterData(const StringView& data) {
+	characterData_.assign(data.data(), data.size());
+	client_->handleCharacterData(characterData_);
+}
+
+}
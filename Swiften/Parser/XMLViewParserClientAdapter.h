@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Parser/XMLViewParserClient.h>
+
+namespace Swift {
+	class XMLParserClient;
+
+	/**
+	 * Forwards the callbacks of an XMLViewParserClient to an
+	 * XMLParserClient, copying the views into strings.
+	 */
+	class SWIFTEN_API XMLViewParserClientAdapter : public XMLViewParserClient {
+		public:
+			XMLViewParserClientAdapter(XMLParserClient* client);
+
+			virtual void handleStartElement(const StringView& element, const std::string& ns, const std::vector<AttributeView>& attributes);
+			virtual void handleEndElement(const StringView& element, const std::string& ns);
+			virtual void handleCharacterData(const StringView& data);
+
+			XMLParserClient* getClient() const {
+				return client_;
+			}
+
+		private:
+			XMLParserClient* client_;
+
+			// Reused between callbacks, to avoid reallocating for every call
+			std::string element_;
+			std::string characterData_;
+	};
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,6 +8,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <boost/smart_ptr/make_shared.hpp>
 
 #include <Swiften/Elements/ProtocolHeader.h>
 #include <string>
@@ -41,6 +42,7 @@
 #include <Swiften/Parser/TLSProceedParser.h>
 #include <Swiften/Parser/ComponentHandshakeParser.h>
 #include <Swiften/Parser/XMLParserFactory.h>
+#include <Swiften/Parser/LazyPayloadsParser.h>
 
 // TODO: Whenever an error occurs in the handlers, stop the parser by returing
 // a bool value, and stopping the XML parser
@@ -54,6 +56,7 @@ XMPPParser::XMPPParser(
 				xmlParser_(0),
 				client_(client), 
 				payloadParserFactories_(payloadParserFactories), 
+				xmlParserFactory_(xmlParserFactory),
 				level_(0),
 				currentElementParser_(0),
 				parseErrorOccurred_(false) {
@@ -70,6 +73,20 @@ bool XMPPParser::parse(const std::string& data) {
 	return xmlParseResult && !parseErrorOccurred_;
 }
 
+bool XMPPParser::parse(const unsigned char* data, size_t size) {
+	bool xmlParseResult = xmlParser_->parse(data, size);
+	return xmlParseResult && !parseErrorOccurred_;
+}
+
+void XMPPParser::setRawForwarding(bool enabled) {
+	if (enabled && !lazyPayloadsParser_) {
+		lazyPayloadsParser_ = boost::make_shared<LazyPayloadsParser>(payloadParserFactories_, xmlParserFactory_);
+	}
+	else if (!enabled) {
+		lazyPayloadsParser_.reset();
+	}
+}
+
 void XMPPParser::handleStartElement(const std::string& element, const std::string& ns, const AttributeMap& attributes) {
 	if (!parseErrorOccurred_) {
 		if (level_ == TopLevel) {
@@ -127,15 +144,22 @@ void XMPPParser::handleCharacterData(const std::string& data) {
 	}
 }
 
+StanzaParser* XMPPParser::prepareStanzaParser(StanzaParser* parser) {
+	if (lazyPayloadsParser_) {
+		parser->setRawPayloadsParser(lazyPayloadsParser_);
+	}
+	return parser;
+}
+
 ElementParser* XMPPParser::createElementParser(const std::string& element, const std::string& ns) {
 	if (element == "presence") {
-		return new PresenceParser(payloadParserFactories_);
+		return prepareStanzaParser(new PresenceParser(payloadParserFactories_));
 	}
 	else if (element == "iq") {
-		return new IQParser(payloadParserFactories_);
+		return prepareStanzaParser(new IQParser(payloadParserFactories_));
 	}
 	else if (element == "message") {
-		return new MessageParser(payloadParserFactories_);
+		return prepareStanzaParser(new MessageParser(payloadParserFactories_));
 	}
 	else if (element == "features"  && ns == "http://etherx.jabber.org/streams") {
 		return new StreamFeaturesParser();
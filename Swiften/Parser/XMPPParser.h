@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <cstddef>
+#include <string>
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
 
@@ -19,6 +21,8 @@ namespace Swift {
 	class XMLParserFactory;	
 	class ElementParser;
 	class PayloadParserFactoryCollection;
+	class LazyPayloadsParser;
+	class StanzaParser;
 
 	class SWIFTEN_API XMPPParser : public XMLParserClient, boost::noncopyable {
 		public:
@@ -29,6 +33,17 @@ namespace Swift {
 			~XMPPParser();
 
 			bool parse(const std::string&);
+			bool parse(const unsigned char* data, size_t size);
+
+			/**
+			 * Enables or disables raw forwarding mode.
+			 *
+			 * In raw forwarding mode, only the attributes of stanzas are
+			 * parsed. Their payloads are kept in serialized form, parsed
+			 * when they are first accessed, and written out as they are
+			 * when the stanza is serialized without having been accessed.
+			 */
+			void setRawForwarding(bool enabled);
 
 		private:
 			virtual void handleStartElement(
@@ -39,11 +54,14 @@ namespace Swift {
 			virtual void handleCharacterData(const std::string& data);
 
 			ElementParser* createElementParser(const std::string& element, const std::string& xmlns);
+			StanzaParser* prepareStanzaParser(StanzaParser* parser);
 
 		private:
 			XMLParser* xmlParser_;
 			XMPPParserClient* client_;
 			PayloadParserFactoryCollection* payloadParserFactories_;
+			XMLParserFactory* xmlParserFactory_;
+			boost::shared_ptr<LazyPayloadsParser> lazyPayloadsParser_;
 			enum Level {
 				TopLevel = 0,
 				StreamLevel = 1,
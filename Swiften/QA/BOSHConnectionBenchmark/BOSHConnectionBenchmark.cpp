@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Base/URL.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/Network/BOSHConnection.h>
+#include <Swiften/Network/Connection.h>
+#include <Swiften/Network/ConnectionFactory.h>
+#include <Swiften/Network/Connector.h>
+#include <Swiften/Network/DummyTimerFactory.h>
+#include <Swiften/Network/StaticDomainNameResolver.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+
+using namespace Swift;
+
+namespace {
+	/**
+	 * A connection that connects immediately, and drops what is written.
+	 */
+	class BenchmarkConnection : public Connection {
+		public:
+			BenchmarkConnection(EventLoop* eventLoop) : eventLoop(eventLoop) {
+			}
+
+			virtual void listen() {
+			}
+
+			virtual void connect(const HostAddressPort&) {
+				eventLoop->postEvent(boost::bind(boost::ref(onConnectFinished), false));
+			}
+
+			virtual void disconnect() {
+			}
+
+			virtual void write(const SafeByteArray&) {
+			}
+
+			virtual HostAddressPort getLocalAddress() const {
+				return HostAddressPort();
+			}
+
+			void read(const SafeByteArray& data) {
+				onDataRead(boost::make_shared<SafeByteArray>(data));
+			}
+
+		private:
+			EventLoop* eventLoop;
+	};
+
+	class BenchmarkConnectionFactory : public ConnectionFactory {
+		public:
+			BenchmarkConnectionFactory(EventLoop* eventLoop) : eventLoop(eventLoop) {
+			}
+
+			virtual boost::shared_ptr<Connection> createConnection() {
+				connection = boost::make_shared<BenchmarkConnection>(eventLoop);
+				return connection;
+			}
+
+			EventLoop* eventLoop;
+			boost::shared_ptr<BenchmarkConnection> connection;
+	};
+
+	void handleXMPPDataRead(size_t* bytes, const SafeByteArray& data) {
+		*bytes += data.size();
+	}
+
+	/**
+	 * Creates an HTTP response with a BOSH body holding payloadSize bytes
+	 * of stanzas.
+	 */
+	std::string createResponse(size_t payloadSize, bool chunked) {
+		std::string stanza = "<message from='juliet@capulet.lit/balcony' to='romeo@montague.lit/orchard' type='chat'><body>Wherefore art thou Romeo?</body></message>";
+		std::string body = "<body xmlns='http://jabber.org/protocol/httpbind'>";
+		while (body.size() < payloadSize) {
+			body += stanza;
+		}
+		body += "</body>";
+
+		std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/xml; charset=utf-8\r\n";
+		if (chunked) {
+			response += "Transfer-Encoding: chunked\r\n\r\n";
+			const size_t chunkSize = 8192;
+			for (size_t i = 0; i < body.size(); i += chunkSize) {
+				std::string chunk = body.substr(i, chunkSize);
+				std::ostringstream chunkHeader;
+				chunkHeader << std::hex << chunk.size() << "\r\n";
+				response += chunkHeader.str() + chunk + "\r\n";
+			}
+			response += "0\r\n\r\n";
+		}
+		else {
+			response += "Content-Length: " + boost::lexical_cast<std::string>(body.size()) + "\r\n\r\n" + body;
+		}
+		return response;
+	}
+
+	void benchmark(size_t payloadSize, size_t readSize, bool chunked, int responses) {
+		DummyEventLoop eventLoop;
+		StaticDomainNameResolver resolver(&eventLoop);
+		resolver.addAddress("wonderland.lit", HostAddress("127.0.0.1"));
+		DummyTimerFactory timerFactory;
+		BenchmarkConnectionFactory connectionFactory(&eventLoop);
+		PlatformXMLParserFactory parserFactory;
+
+		Connector::ref connector = Connector::create("wonderland.lit", 5280, boost::optional<std::string>(), &resolver, &connectionFactory, &timerFactory);
+		BOSHConnection::ref connection = BOSHConnection::create(URL("http", "wonderland.lit", 5280, "/http-bind"), connector, &parserFactory);
+		size_t bytes = 0;
+		connection->onXMPPDataRead.connect(boost::bind(&handleXMPPDataRead, &bytes, _1));
+		connection->connect();
+		eventLoop.processEvents();
+		connection->setSID("MyShinySID");
+		connection->setRID(1);
+
+		// Cut the response up the way a connection would read it
+		std::string response = createResponse(payloadSize, chunked);
+		std::vector<SafeByteArray> reads;
+		for (size_t i = 0; i < response.size(); i += readSize) {
+			reads.push_back(createSafeByteArray(response.substr(i, readSize)));
+		}
+
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		for (int i = 0; i < responses; ++i) {
+			connection->write(createSafeByteArray(""));
+			for (size_t j = 0; j < reads.size(); ++j) {
+				connectionFactory.connection->read(reads[j]);
+			}
+		}
+		double seconds = static_cast<double>((boost::posix_time::microsec_clock::universal_time() - start).total_microseconds()) / 1000000.0;
+		std::cout << std::setw(8) << std::right << payloadSize / 1024 << " KiB body, " << std::setw(5) << readSize << " byte reads" << (chunked ? ", chunked" : "         ") << ": " << std::fixed << std::setprecision(1) << static_cast<double>(bytes) / (1024 * 1024) / seconds << " MB/s (" << bytes << " bytes)" << std::endl;
+		connection->disconnect();
+	}
+}
+
+/**
+ * Measures how fast a BOSHConnection turns HTTP responses with large
+ * bodies, read in small pieces, into XMPP data.
+ */
+int main(int argc, char* argv[]) {
+	size_t maximumSize = 4096;
+	if (argc > 1) {
+		maximumSize = boost::lexical_cast<size_t>(argv[1]);
+	}
+
+	for (size_t size = 16; size <= maximumSize; size *= 4) {
+		int responses = static_cast<int>(std::max<size_t>(1, 4096 / size));
+		benchmark(size * 1024, 1460, false, responses);
+		benchmark(size * 1024, 16384, false, responses);
+		benchmark(size * 1024, 1460, true, responses);
+	}
+	return 0;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/EventLoop/SimpleEventLoop.h>
+#include <Swiften/FileTransfer/FileReadBytestream.h>
+#include <Swiften/Network/BoostConnection.h>
+#include <Swiften/Network/BoostIOServiceThread.h>
+#include <Swiften/Network/HostAddress.h>
+#include <Swiften/Network/HostAddressPort.h>
+
+using namespace Swift;
+
+namespace {
+	const size_t chunkSize = 131072;
+
+	void drain(boost::asio::ip::tcp::socket* socket, unsigned long long bytes) {
+		std::vector<char> buffer(262144);
+		unsigned long long received = 0;
+		while (received < bytes) {
+			received += socket->read_some(boost::asio::buffer(buffer));
+		}
+	}
+
+	void feed(boost::asio::ip::tcp::socket* socket, unsigned long long bytes) {
+		std::vector<char> buffer(chunkSize);
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			buffer[i] = static_cast<char>(i * 7);
+		}
+		for (unsigned long long sent = 0; sent < bytes; sent += buffer.size()) {
+			boost::asio::write(*socket, boost::asio::buffer(buffer));
+		}
+	}
+
+	/**
+	 * Receives data the way the SOCKS5 bytestream sessions do: every read is
+	 * copied into a ByteArray for the WriteBytestream.
+	 */
+	class Receiver {
+		public:
+			Receiver(Connection::ref connection, unsigned long long size, SimpleEventLoop* eventLoop) : size(size), received(0), eventLoop(eventLoop) {
+				connection->onDataRead.connect(boost::bind(&Receiver::handleDataRead, this, _1));
+			}
+
+			void handleDataRead(boost::shared_ptr<SafeByteArray> data) {
+				ByteArray bytes = createByteArray(vecptr(*data), data->size());
+				received += bytes.size();
+				if (received >= size) {
+					eventLoop->stop();
+				}
+			}
+
+		private:
+			unsigned long long size;
+			unsigned long long received;
+			SimpleEventLoop* eventLoop;
+	};
+
+	/**
+	 * Sends a file the way the SOCKS5 bytestream sessions do: the next chunk
+	 * is read when the previous one has been written.
+	 */
+	class FileSender {
+		public:
+			FileSender(const boost::filesystem::path& file, Connection::ref connection, bool shared, SimpleEventLoop* eventLoop) : stream(file), connection(connection), shared(shared), eventLoop(eventLoop) {
+				connection->onDataWritten.connect(boost::bind(&FileSender::sendData, this));
+			}
+
+			void sendData() {
+				boost::shared_ptr<ByteArray> data = stream.read(chunkSize);
+				if (data->empty()) {
+					eventLoop->stop();
+				}
+				else if (shared) {
+					connection->writeShared(boost::shared_ptr<const ByteArray>(data));
+				}
+				else {
+					connection->write(createSafeByteArray(*data));
+				}
+			}
+
+		private:
+			FileReadBytestream stream;
+			Connection::ref connection;
+			bool shared;
+			SimpleEventLoop* eventLoop;
+	};
+
+	void printResult(const std::string& name, unsigned long long bytes, const boost::posix_time::ptime& start, std::clock_t startClock) {
+		double time = static_cast<double>((boost::posix_time::microsec_clock::universal_time() - start).total_microseconds());
+		double cpuTime = static_cast<double>(std::clock() - startClock) / CLOCKS_PER_SEC;
+		std::cout
+				<< std::setw(24) << name
+				<< std::setw(12) << std::fixed << std::setprecision(1) << static_cast<double>(bytes) / time
+				<< std::setw(12) << std::setprecision(2) << cpuTime
+				<< std::endl;
+	}
+
+	void runFileRead(const boost::filesystem::path& file, unsigned long long size) {
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		std::clock_t startClock = std::clock();
+		FileReadBytestream stream(file);
+		while (!stream.read(chunkSize)->empty()) {
+		}
+		printResult("file read", size, start, startClock);
+	}
+
+	void runTransfer(const boost::filesystem::path& file, unsigned long long size, bool shared) {
+		SimpleEventLoop eventLoop;
+		BoostIOServiceThread* ioServiceThread = new BoostIOServiceThread();
+		boost::asio::io_service serverIOService;
+		boost::asio::ip::tcp::acceptor acceptor(serverIOService, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+		boost::asio::ip::tcp::socket serverSocket(serverIOService);
+
+		BoostConnection::ref connection = BoostConnection::create(ioServiceThread->getIOService(), &eventLoop);
+		connection->connect(HostAddressPort(HostAddress("127.0.0.1"), acceptor.local_endpoint().port()));
+		acceptor.accept(serverSocket);
+
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		std::clock_t startClock = std::clock();
+		boost::thread reader(boost::bind(&drain, &serverSocket, size));
+		FileSender sender(file, connection, shared, &eventLoop);
+		sender.sendData();
+		eventLoop.run();
+		reader.join();
+		printResult(shared ? "writeShared(ByteArray)" : "write(SafeByteArray)", size, start, startClock);
+
+		connection->disconnect();
+		delete ioServiceThread;
+		eventLoop.runOnce();
+	}
+
+	void runReceive(unsigned long long size, bool wipe) {
+		SimpleEventLoop eventLoop;
+		BoostIOServiceThread* ioServiceThread = new BoostIOServiceThread();
+		boost::asio::io_service serverIOService;
+		boost::asio::ip::tcp::acceptor acceptor(serverIOService, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+		boost::asio::ip::tcp::socket serverSocket(serverIOService);
+
+		BoostConnection::ref connection = BoostConnection::create(ioServiceThread->getIOService(), &eventLoop);
+		connection->setWipeReadBuffers(wipe);
+		Receiver receiver(connection, size, &eventLoop);
+		connection->connect(HostAddressPort(HostAddress("127.0.0.1"), acceptor.local_endpoint().port()));
+		acceptor.accept(serverSocket);
+
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		std::clock_t startClock = std::clock();
+		boost::thread writer(boost::bind(&feed, &serverSocket, size));
+		eventLoop.run();
+		writer.join();
+		printResult(wipe ? "receive, wiped" : "receive, not wiped", size, start, startClock);
+
+		connection->disconnect();
+		delete ioServiceThread;
+		eventLoop.runOnce();
+	}
+}
+
+/**
+ * Sends a file (default: 1 GiB) over a loopback connection, copying each chunk
+ * into a SafeByteArray (as the SOCKS5 bytestream sessions used to), and
+ * handing the chunks to the connection as they were read.
+ *
+ * Then receives the same amount of data, with the read buffers wiped (as
+ * the SOCKS5 bytestream sessions used to) and not wiped.
+ *
+ * Usage: BytestreamBenchmark [size in MiB]
+ */
+int main(int argc, char* argv[]) {
+	unsigned long long size = 1024ULL * 1024 * static_cast<unsigned long long>(argc > 1 ? std::atoi(argv[1]) : 1024);
+
+	boost::filesystem::path file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("swift-bytestream-%%%%-%%%%");
+	{
+		std::vector<char> block(1024 * 1024);
+		for (size_t i = 0; i < block.size(); ++i) {
+			block[i] = static_cast<char>(i * 7);
+		}
+		boost::filesystem::ofstream output(file, std::ios_base::out|std::ios_base::binary);
+		for (unsigned long long written = 0; written < size; written += block.size()) {
+			output.write(&block[0], static_cast<std::streamsize>(block.size()));
+		}
+	}
+
+	std::cout
+			<< std::setw(24) << "path"
+			<< std::setw(12) << "MB/s"
+			<< std::setw(12) << "CPU s"
+			<< std::endl;
+	runFileRead(file, size);
+	runTransfer(file, size, false);
+	runTransfer(file, size, true);
+	runReceive(size, true);
+	runReceive(size, false);
+
+	boost::filesystem::remove(file);
+	return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+
+#include <Swiften/Base/sleep.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/Network/BoostConnection.h>
+#include <Swiften/Network/BoostIOServiceThread.h>
+#include <Swiften/Network/HostAddress.h>
+#include <Swiften/Network/HostAddressPort.h>
+
+using namespace Swift;
+
+namespace {
+	const size_t stanzaCount = 200000;
+	const size_t idleStanzaCount = 20000;
+
+	enum WriteMode {
+		CopiedWrites,
+		SharedWrites,
+		IdleWrites
+	};
+
+	void drain(boost::asio::ip::tcp::socket* socket, size_t bytes) {
+		std::vector<char> buffer(65536);
+		size_t received = 0;
+		while (received < bytes) {
+			received += socket->read_some(boost::asio::buffer(buffer));
+		}
+	}
+
+	/**
+	 * Writes copies of a stanza over a loopback connection, either through
+	 * write() (which copies each stanza once into the write queue), or
+	 * through writeShared() with buffers that were serialized up front.
+	 *
+	 * With IdleWrites, each stanza is passed to write() only after the
+	 * previous one was received, as on a connection that is mostly idle.
+	 */
+	void runBenchmark(WriteMode mode) {
+		bool shared = mode == SharedWrites;
+		size_t count = mode == IdleWrites ? idleStanzaCount : stanzaCount;
+		DummyEventLoop eventLoop;
+		BoostIOServiceThread* ioServiceThread = new BoostIOServiceThread();
+		boost::asio::io_service serverIOService;
+		boost::asio::ip::tcp::acceptor acceptor(serverIOService, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+		boost::asio::ip::tcp::socket serverSocket(serverIOService);
+
+		BoostConnection::ref connection = BoostConnection::create(ioServiceThread->getIOService(), &eventLoop);
+		connection->connect(HostAddressPort(HostAddress("127.0.0.1"), acceptor.local_endpoint().port()));
+		acceptor.accept(serverSocket);
+
+		SafeByteArray stanza = createSafeByteArray(
+				"<message to='juliet@capulet.lit/balcony' from='romeo@montague.lit/orchard' type='chat' id='a1b2c3'>"
+				"<body>Art thou not Romeo, and a Montague? Neither, fair saint, if either thee dislike.</body>"
+				"<active xmlns='http://jabber.org/protocol/chatstates'/>"
+				"</message>");
+		std::vector< boost::shared_ptr<const SafeByteArray> > serializedStanzas;
+		if (shared) {
+			for (size_t i = 0; i < count; ++i) {
+				serializedStanzas.push_back(boost::make_shared<SafeByteArray>(stanza));
+			}
+		}
+
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		if (mode == IdleWrites) {
+			for (size_t i = 0; i < count; ++i) {
+				connection->write(stanza);
+				drain(&serverSocket, stanza.size());
+			}
+		}
+		else {
+			boost::thread reader(boost::bind(&drain, &serverSocket, stanza.size() * count));
+			for (size_t i = 0; i < count; ++i) {
+				if (shared) {
+					connection->writeShared(serializedStanzas[i]);
+				}
+				else {
+					connection->write(stanza);
+				}
+			}
+			reader.join();
+		}
+		double time = static_cast<double>((boost::posix_time::microsec_clock::universal_time() - start).total_microseconds());
+
+		std::cout
+				<< std::setw(14) << (shared ? "writeShared()" : (mode == IdleWrites ? "idle write()" : "write()"))
+				<< std::setw(14) << std::fixed << std::setprecision(1) << (stanza.size() * count) / time
+				<< std::setw(14) << std::setprecision(0) << count * 1000000.0 / time
+				<< std::endl;
+
+		connection->disconnect();
+		connection.reset();
+		delete ioServiceThread;
+		while (eventLoop.hasEvents()) {
+			eventLoop.processEvents();
+		}
+	}
+}
+
+int main(int, char**) {
+	std::cout
+			<< std::setw(14) << "path"
+			<< std::setw(14) << "MB/s"
+			<< std::setw(14) << "stanzas/s"
+			<< std::endl;
+	runBenchmark(CopiedWrites);
+	runBenchmark(SharedWrites);
+	runBenchmark(IdleWrites);
+	return 0;
+}
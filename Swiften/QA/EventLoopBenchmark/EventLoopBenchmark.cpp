@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+
+#include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
+#include <Swiften/EventLoop/SimpleEventLoop.h>
+
+using namespace Swift;
+
+namespace {
+	struct BenchmarkEventOwner : public EventOwner {};
+
+	/**
+	 * Event loop that keeps all posted events pending until they are
+	 * explicitly dispatched, newest first.
+	 */
+	class PendingEventLoop : public EventLoop {
+		public:
+			virtual void post(const Event& event) {
+				events_.push_back(event);
+			}
+
+			void dispatchAll() {
+				while (!events_.empty()) {
+					Event event = events_.back();
+					events_.pop_back();
+					handleEvent(event);
+				}
+			}
+
+		private:
+			std::vector<Event> events_;
+	};
+
+	size_t handledEvents = 0;
+
+	void handleBenchmarkEvent() {
+		++handledEvents;
+	}
+
+	double elapsedMicroseconds(const boost::posix_time::ptime& start) {
+		return static_cast<double>((boost::posix_time::microsec_clock::universal_time() - start).total_microseconds());
+	}
+
+	void runBenchmark(size_t pendingEvents) {
+		const size_t eventsPerOwner = 10;
+		std::vector<boost::shared_ptr<EventOwner> > owners;
+		for (size_t i = 0; i < (pendingEvents + eventsPerOwner - 1) / eventsPerOwner; ++i) {
+			owners.push_back(boost::make_shared<BenchmarkEventOwner>());
+		}
+
+		PendingEventLoop eventLoop;
+		handledEvents = 0;
+
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < pendingEvents; ++i) {
+			eventLoop.postEvent(&handleBenchmarkEvent, owners[i % owners.size()]);
+		}
+		double postTime = elapsedMicroseconds(start);
+
+		// Cancel every other owner, like connections being torn down while
+		// their reads are still queued.
+		start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < owners.size(); i += 2) {
+			eventLoop.removeEventsFromOwner(owners[i]);
+		}
+		double removeTime = elapsedMicroseconds(start);
+
+		start = boost::posix_time::microsec_clock::universal_time();
+		eventLoop.dispatchAll();
+		double dispatchTime = elapsedMicroseconds(start);
+
+		std::cout
+				<< std::setw(8) << pendingEvents
+				<< std::setw(14) << std::fixed << std::setprecision(3) << postTime * 1000.0 / pendingEvents
+				<< std::setw(14) << removeTime * 1000.0 / ((owners.size() + 1) / 2)
+				<< std::setw(14) << dispatchTime * 1000.0 / pendingEvents
+				<< std::setw(10) << handledEvents
+				<< std::endl;
+	}
+
+	size_t expectedEvents = 0;
+
+	void handleProducedEvent(SimpleEventLoop* eventLoop) {
+		if (++handledEvents == expectedEvents) {
+			eventLoop->stop();
+		}
+	}
+
+	void produceEvents(SimpleEventLoop* eventLoop, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			eventLoop->postEvent(boost::bind(&handleProducedEvent, eventLoop));
+		}
+	}
+
+	void runProducerBenchmark(SimpleEventLoop::QueueType queueType, size_t producers) {
+		const size_t eventsPerProducer = 200000 / producers;
+		SimpleEventLoop eventLoop(queueType);
+		handledEvents = 0;
+		expectedEvents = eventsPerProducer * producers;
+
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		boost::thread_group threads;
+		for (size_t i = 0; i < producers; ++i) {
+			threads.create_thread(boost::bind(&produceEvents, &eventLoop, eventsPerProducer));
+		}
+		eventLoop.run();
+		threads.join_all();
+		double time = elapsedMicroseconds(start);
+
+		std::cout
+				<< std::setw(12) << (queueType == SimpleEventLoop::LockFreeQueue ? "lock-free" : "locking")
+				<< std::setw(10) << producers
+				<< std::setw(16) << std::fixed << std::setprecision(0) << handledEvents * 1000000.0 / time
+				<< std::endl;
+	}
+}
+
+int main(int, char**) {
+	std::cout
+			<< std::setw(8) << "pending"
+			<< std::setw(14) << "post (ns)"
+			<< std::setw(14) << "remove (ns)"
+			<< std::setw(14) << "dispatch (ns)"
+			<< std::setw(10) << "handled"
+			<< std::endl;
+	for (size_t pendingEvents = 10; pendingEvents <= 100000; pendingEvents *= 10) {
+		runBenchmark(pendingEvents);
+	}
+
+	std::cout << std::endl
+			<< std::setw(12) << "queue"
+			<< std::setw(10) << "producers"
+			<< std::setw(16) << "events/s"
+			<< std::endl;
+	const size_t producerCounts[] = { 1, 4, 16 };
+	for (size_t i = 0; i < sizeof(producerCounts) / sizeof(producerCounts[0]); ++i) {
+		runProducerBenchmark(SimpleEventLoop::LockingQueue, producerCounts[i]);
+		runProducerBenchmark(SimpleEventLoop::LockFreeQueue, producerCounts[i]);
+	}
+	return 0;
+}
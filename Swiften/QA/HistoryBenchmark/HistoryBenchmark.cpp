@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/History/SQLiteHistoryStorage.h>
+
+using namespace Swift;
+
+namespace {
+	std::string getWord(size_t index) {
+		return "word" + boost::lexical_cast<std::string>(index) + "x";
+	}
+
+	std::string createMessage(size_t wordCount) {
+		std::string message("Message");
+		for (size_t i = 0; i < 8; ++i) {
+			message += " " + getWord(static_cast<size_t>(std::rand()) % wordCount);
+		}
+		return message;
+	}
+
+	double elapsedSeconds(const boost::posix_time::ptime& start) {
+		return static_cast<double>((boost::posix_time::microsec_clock::universal_time() - start).total_microseconds()) / 1000000.0;
+	}
+}
+
+/**
+ * Fills a history with (by default) a million chat messages with 500
+ * contacts, spread over 3 years, and then looks up the logs of random days,
+ * and searches for random words.
+ */
+int main(int argc, char* argv[]) {
+	size_t messageCount = 1000000;
+	if (argc > 1) {
+		messageCount = boost::lexical_cast<size_t>(argv[1]);
+	}
+	const size_t contactCount = 500;
+	const int days = 3 * 365;
+	const size_t queryCount = 1000;
+	const size_t wordCount = 10000;
+	const size_t searchCount = 100;
+
+	JID self("me@example.com/home");
+	std::vector<JID> contacts;
+	for (size_t i = 0; i < contactCount; ++i) {
+		contacts.push_back(JID("contact" + boost::lexical_cast<std::string>(i) + "@example.com/resource"));
+	}
+	boost::posix_time::ptime firstDay(boost::gregorian::date(2012, 1, 1));
+
+	boost::filesystem::path file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("history-benchmark-%%%%-%%%%.db");
+	{
+		SQLiteHistoryStorage storage(file);
+
+		std::srand(0);
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < messageCount; ++i) {
+			const JID& contact = contacts[static_cast<size_t>(std::rand()) % contactCount];
+			boost::posix_time::ptime time = firstDay + boost::posix_time::seconds(static_cast<long>(i * (days * 86400LL / messageCount)));
+			if (i % 2 == 0) {
+				storage.addMessage(HistoryMessage(createMessage(wordCount), self, contact, HistoryMessage::Chat, time));
+			}
+			else {
+				storage.addMessage(HistoryMessage(createMessage(wordCount), contact, self, HistoryMessage::Chat, time));
+			}
+		}
+		double queueTime = elapsedSeconds(start);
+		// Queries wait for all queued messages to be written
+		storage.getMessagesFromDate(self, contacts[0].toBare(), HistoryMessage::Chat, firstDay.date());
+		double insertTime = elapsedSeconds(start);
+		std::cout << "Inserted " << messageCount << " messages: " << std::fixed << std::setprecision(0) << messageCount / insertTime << " messages/s (addMessage: " << std::setprecision(2) << queueTime * 1000000.0 / messageCount << " us/message)" << std::endl;
+
+		size_t results = 0;
+		start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < queryCount; ++i) {
+			const JID& contact = contacts[static_cast<size_t>(std::rand()) % contactCount];
+			boost::gregorian::date date = firstDay.date() + boost::gregorian::days(std::rand() % days);
+			results += storage.getMessagesFromDate(self, contact.toBare(), HistoryMessage::Chat, date).size();
+		}
+		double queryTime = elapsedSeconds(start);
+		std::cout << "Looked up " << queryCount << " days (" << results << " messages): " << std::setprecision(1) << queryTime * 1000000.0 / queryCount << " us/query" << std::endl;
+
+		start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < queryCount; ++i) {
+			const JID& contact = contacts[static_cast<size_t>(std::rand()) % contactCount];
+			boost::gregorian::date date = firstDay.date() + boost::gregorian::days(std::rand() % days);
+			storage.getMessagesFromNextDate(self, contact.toBare(), HistoryMessage::Chat, date);
+		}
+		queryTime = elapsedSeconds(start);
+		std::cout << "Looked up " << queryCount << " next days: " << queryTime * 1000000.0 / queryCount << " us/query" << std::endl;
+
+		results = 0;
+		start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < searchCount; ++i) {
+			results += storage.searchMessages(self, HistoryMessage::Chat, getWord(static_cast<size_t>(std::rand()) % wordCount), 0, 20).size();
+		}
+		queryTime = elapsedSeconds(start);
+		std::cout << "Searched " << searchCount << " words (" << results << " hits on first pages): " << std::setprecision(2) << queryTime * 1000.0 / searchCount << " ms/search" << std::endl;
+
+		results = 0;
+		start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < searchCount; ++i) {
+			results += storage.getContacts(self.toBare(), HistoryMessage::Chat, getWord(static_cast<size_t>(std::rand()) % wordCount)).size();
+		}
+		queryTime = elapsedSeconds(start);
+		std::cout << "Searched contacts for " << searchCount << " words (" << results << " contacts): " << queryTime * 1000.0 / searchCount << " ms/search" << std::endl;
+	}
+	boost::filesystem::remove(file);
+	boost::filesystem::remove(file.string() + "-wal");
+	boost::filesystem::remove(file.string() + "-shm");
+	return 0;
+}
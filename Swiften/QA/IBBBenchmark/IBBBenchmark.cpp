@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/optional.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Client/StanzaChannel.h>
+#include <Swiften/Elements/ProtocolHeader.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/FileTransfer/ByteArrayReadBytestream.h>
+#include <Swiften/FileTransfer/ByteArrayWriteBytestream.h>
+#include <Swiften/FileTransfer/IBBReceiveSession.h>
+#include <Swiften/FileTransfer/IBBSendSession.h>
+#include <Swiften/Network/DummyConnection.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+#include <Swiften/Queries/IQRouter.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+#include <Swiften/StreamStack/ConnectionLayer.h>
+#include <Swiften/StreamStack/StreamStack.h>
+#include <Swiften/StreamStack/XMPPLayer.h>
+
+using namespace Swift;
+
+namespace {
+	/**
+	 * Delivers data between connections with a fixed one-way latency and a
+	 * limited bandwidth, using a virtual clock.
+	 */
+	class Network {
+		public:
+			Network(EventLoop* eventLoop, double latency, double bandwidth) : eventLoop(eventLoop), latency(latency), bandwidth(bandwidth), now(0) {
+			}
+
+			void connect(boost::shared_ptr<DummyConnection> from, boost::shared_ptr<DummyConnection> to) {
+				from->onDataSent.connect(boost::bind(&Network::send, this, from, to, _1));
+			}
+
+			/**
+			 * Runs until no more events or packets are pending, and returns
+			 * the virtual time this took.
+			 */
+			double run() {
+				while (true) {
+					static_cast<DummyEventLoop*>(eventLoop)->processEvents();
+					if (packets.empty()) {
+						return now;
+					}
+					now = packets.begin()->first;
+					Packet packet = packets.begin()->second;
+					packets.erase(packets.begin());
+					packet.first->receive(packet.second);
+				}
+			}
+
+		private:
+			typedef std::pair<boost::shared_ptr<DummyConnection>, SafeByteArray> Packet;
+
+			void send(boost::shared_ptr<DummyConnection> from, boost::shared_ptr<DummyConnection> to, const SafeByteArray& data) {
+				double& linkFree = linkFreeTimes[from.get()];
+				linkFree = std::max(now, linkFree) + static_cast<double>(data.size()) / bandwidth;
+				packets.insert(std::make_pair(linkFree + latency, Packet(to, data)));
+			}
+
+		private:
+			EventLoop* eventLoop;
+			double latency;
+			double bandwidth;
+			double now;
+			std::map<DummyConnection*, double> linkFreeTimes;
+			std::multimap<double, Packet> packets;
+	};
+
+	/**
+	 * An XMPP endpoint that sends and parses stanzas over a DummyConnection.
+	 */
+	class Endpoint : public StanzaChannel {
+		public:
+			Endpoint(const JID& jid, EventLoop* eventLoop) : jid(jid), nextID(0) {
+				connection = boost::make_shared<DummyConnection>(eventLoop);
+				xmppLayer = new XMPPLayer(&payloadParserFactories, &payloadSerializers, &xmlParserFactory, ClientStreamType);
+				xmppLayer->onElement.connect(boost::bind(&Endpoint::handleElement, this, _1));
+				connectionLayer = new ConnectionLayer(connection);
+				streamStack = new StreamStack(xmppLayer, connectionLayer);
+				router = new IQRouter(this);
+			}
+
+			~Endpoint() {
+				delete router;
+				delete streamStack;
+				delete connectionLayer;
+				delete xmppLayer;
+			}
+
+			void start() {
+				xmppLayer->writeHeader(ProtocolHeader());
+			}
+
+			virtual void sendIQ(boost::shared_ptr<IQ> iq) {
+				iq->setFrom(jid);
+				xmppLayer->writeElement(iq);
+			}
+
+			virtual void sendMessage(boost::shared_ptr<Message>) {
+			}
+
+			virtual void sendPresence(boost::shared_ptr<Presence>) {
+			}
+
+			virtual std::string getNewIQID() {
+				return boost::lexical_cast<std::string>(nextID++);
+			}
+
+			virtual bool isAvailable() const {
+				return true;
+			}
+
+			virtual bool getStreamManagementEnabled() const {
+				return false;
+			}
+
+			virtual std::vector<Certificate::ref> getPeerCertificateChain() const {
+				return std::vector<Certificate::ref>();
+			}
+
+		private:
+			void handleElement(boost::shared_ptr<ToplevelElement> element) {
+				if (boost::shared_ptr<IQ> iq = boost::dynamic_pointer_cast<IQ>(element)) {
+					onIQReceived(iq);
+				}
+			}
+
+		public:
+			JID jid;
+			boost::shared_ptr<DummyConnection> connection;
+			IQRouter* router;
+
+		private:
+			FullPayloadParserFactoryCollection payloadParserFactories;
+			FullPayloadSerializerCollection payloadSerializers;
+			PlatformXMLParserFactory xmlParserFactory;
+			XMPPLayer* xmppLayer;
+			ConnectionLayer* connectionLayer;
+			StreamStack* streamStack;
+			size_t nextID;
+	};
+
+	void handleFinished(boost::optional<FileTransferError> error, bool* finished, bool* failed) {
+		*finished = true;
+		*failed = error.is_initialized();
+	}
+
+	void runTransfer(unsigned int blockSize, unsigned int windowSize, const ByteArray& file, double latency, double bandwidth) {
+		DummyEventLoop eventLoop;
+		Network network(&eventLoop, latency, bandwidth);
+		Endpoint sender(JID("sender@example.com/ft"), &eventLoop);
+		Endpoint receiver(JID("receiver@example.com/ft"), &eventLoop);
+		network.connect(sender.connection, receiver.connection);
+		network.connect(receiver.connection, sender.connection);
+		sender.start();
+		receiver.start();
+
+		boost::shared_ptr<ByteArrayWriteBytestream> output = boost::make_shared<ByteArrayWriteBytestream>();
+		IBBReceiveSession receiveSession("session", sender.jid, receiver.jid, file.size(), output, receiver.router);
+		receiveSession.start();
+
+		bool finished = false;
+		bool failed = false;
+		IBBSendSession sendSession("session", sender.jid, receiver.jid, boost::make_shared<ByteArrayReadBytestream>(file), sender.router);
+		sendSession.setBlockSize(blockSize);
+		sendSession.setWindowSize(windowSize);
+		sendSession.onFinished.connect(boost::bind(&handleFinished, _1, &finished, &failed));
+		sendSession.start();
+
+		double time = network.run();
+		if (!finished || failed || output->getData() != file) {
+			std::cout << "Transfer with block size " << blockSize << " and window " << windowSize << " failed" << std::endl;
+			return;
+		}
+		std::cout << "Block size " << std::setw(5) << blockSize << ", window " << std::setw(2) << windowSize << ": " << std::fixed << std::setprecision(2) << time << " s, " << std::setprecision(1) << static_cast<double>(file.size()) / time / 1024.0 << " KiB/s" << std::endl;
+	}
+}
+
+/**
+ * Transfers a 1 MiB file over IBB between two endpoints connected by a
+ * simulated 50 ms latency, 1 MiB/s link, with different block and window
+ * sizes.
+ */
+int main(int, char**) {
+	const double latency = 0.05;
+	const double bandwidth = 1024 * 1024;
+
+	ByteArray file(1024 * 1024);
+	for (size_t i = 0; i < file.size(); ++i) {
+		file[i] = static_cast<unsigned char>(i * 7);
+	}
+
+	runTransfer(4096, 1, file, latency, bandwidth);
+	runTransfer(16384, 1, file, latency, bandwidth);
+	runTransfer(4096, 8, file, latency, bandwidth);
+	runTransfer(16384, 8, file, latency, bandwidth);
+	return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Base/foreach.h>
+#include <Swiften/Elements/RawXMLPayload.h>
+#include <Swiften/Queries/IQChannel.h>
+#include <Swiften/Queries/IQHandler.h>
+#include <Swiften/Queries/IQRouter.h>
+#include <Swiften/Queries/Request.h>
+
+using namespace Swift;
+
+namespace {
+	class BenchmarkIQChannel : public IQChannel {
+		public:
+			BenchmarkIQChannel() : nextID(0) {}
+
+			virtual void sendIQ(boost::shared_ptr<IQ>) {}
+
+			virtual std::string getNewIQID() {
+				return boost::lexical_cast<std::string>(nextID++);
+			}
+
+			virtual bool isAvailable() const {
+				return true;
+			}
+
+		private:
+			size_t nextID;
+	};
+
+	class BenchmarkRequest : public Request {
+		public:
+			BenchmarkRequest(const JID& receiver, boost::shared_ptr<Payload> payload, IQRouter* router, size_t* responses) : Request(IQ::Get, receiver, payload, router), responses(responses) {
+			}
+
+			virtual void handleResponse(boost::shared_ptr<Payload>, boost::shared_ptr<ErrorPayload>) {
+				++*responses;
+			}
+
+		private:
+			size_t* responses;
+	};
+
+	/**
+	 * A responder-like handler that never matches results, as installed
+	 * by a typical client for disco, version, ping, ...
+	 */
+	class GetHandler : public IQHandler {
+		public:
+			virtual bool handleIQ(boost::shared_ptr<IQ> iq) {
+				return iq->getType() == IQ::Get;
+			}
+	};
+
+	double elapsedMicroseconds(const boost::posix_time::ptime& start) {
+		return static_cast<double>((boost::posix_time::microsec_clock::universal_time() - start).total_microseconds());
+	}
+}
+
+/**
+ * Sends 10k requests (e.g. vCard fetches for a large roster), and then
+ * routes their responses back in random order.
+ */
+int main(int, char**) {
+	const size_t outstandingRequests = 10000;
+
+	BenchmarkIQChannel channel;
+	IQRouter router(&channel);
+	std::vector<boost::shared_ptr<GetHandler> > handlers;
+	for (size_t i = 0; i < 10; ++i) {
+		handlers.push_back(boost::make_shared<GetHandler>());
+		router.addHandler(handlers.back());
+	}
+
+	size_t responses = 0;
+	boost::shared_ptr<Payload> payload = boost::make_shared<RawXMLPayload>("<vCard xmlns='vcard-temp'/>");
+	std::vector<boost::shared_ptr<IQ> > results;
+	for (size_t i = 0; i < outstandingRequests; ++i) {
+		JID receiver("contact" + boost::lexical_cast<std::string>(i) + "@example.com");
+		boost::shared_ptr<BenchmarkRequest> request = boost::make_shared<BenchmarkRequest>(receiver, payload, &router, &responses);
+		std::string id = request->send();
+		results.push_back(IQ::createResult(JID(), receiver, id));
+	}
+	std::random_shuffle(results.begin(), results.end());
+
+	boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+	foreach (boost::shared_ptr<IQ> result, results) {
+		channel.onIQReceived(result);
+	}
+	double time = elapsedMicroseconds(start);
+	std::cout << "Routed " << responses << " responses with " << outstandingRequests << " outstanding requests: " << std::fixed << std::setprecision(2) << time / results.size() << " us/response, total " << std::setprecision(1) << time / 1000.0 << " ms" << std::endl;
+	return 0;
+}
@@ -8,8 +8,12 @@
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/smart_ptr/make_shared.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/read.hpp>
 
 #include <string>
+#include <boost/lexical_cast.hpp>
 #include <Swiften/Base/Algorithm.h>
 #include <Swiften/Base/sleep.h>
 #include <Swiften/Network/BoostConnection.h>
@@ -28,6 +32,10 @@ class BoostConnectionTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST(testDestructor_PendingEvents);
 		CPPUNIT_TEST(testWrite);
 		CPPUNIT_TEST(testWriteMultipleSimultaniouslyQueuesWrites);
+		CPPUNIT_TEST(testWrite_MixedCopiedAndSharedData);
+		CPPUNIT_TEST(testRead_LargeAmountOfData);
+		CPPUNIT_TEST(testRead_LargeAmountOfData_WithoutWipingReadBuffers);
+		CPPUNIT_TEST(testRead_PartialReads);
 #ifdef TEST_IPV6
 		CPPUNIT_TEST(testWrite_IPv6);
 #endif
@@ -129,6 +137,94 @@ class BoostConnectionTest : public CppUnit::TestFixture {
 			}
 		}
 
+		void testWrite_MixedCopiedAndSharedData() {
+			boost::asio::ip::tcp::acceptor acceptor(*boostIOService, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+			boost::asio::ip::tcp::socket serverSocket(*boostIOService);
+
+			BoostConnection::ref testling(BoostConnection::create(boostIOServiceThread_->getIOService(), eventLoop_));
+			testling->connect(HostAddressPort(HostAddress("127.0.0.1"), acceptor.local_endpoint().port()));
+			acceptor.accept(serverSocket);
+
+			ByteArray expectedData;
+			for (int i = 0; i < 1000; ++i) {
+				std::string data = "<message id='" + boost::lexical_cast<std::string>(i) + "'/>";
+				if (i % 3 == 0) {
+					testling->writeShared(createSafeByteArrayRef(data));
+				}
+				else if (i % 3 == 1) {
+					testling->writeShared(boost::shared_ptr<const ByteArray>(boost::make_shared<ByteArray>(createByteArray(data))));
+				}
+				else {
+					testling->write(createSafeByteArray(data));
+				}
+				append(expectedData, createByteArray(data));
+			}
+
+			ByteArray data(expectedData.size());
+			boost::asio::read(serverSocket, boost::asio::buffer(data));
+			CPPUNIT_ASSERT(expectedData == data);
+
+			testling->disconnect();
+		}
+
+		void testRead_LargeAmountOfData() {
+			readLargeAmountOfData(true);
+		}
+
+		void testRead_LargeAmountOfData_WithoutWipingReadBuffers() {
+			readLargeAmountOfData(false);
+		}
+
+		void testRead_PartialReads() {
+			boost::asio::ip::tcp::acceptor acceptor(*boostIOService, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+			boost::asio::ip::tcp::socket serverSocket(*boostIOService);
+
+			BoostConnection::ref testling(BoostConnection::create(boostIOServiceThread_->getIOService(), eventLoop_));
+			testling->onDataRead.connect(boost::bind(&BoostConnectionTest::handleDataRead, this, _1));
+			testling->connect(HostAddressPort(HostAddress("127.0.0.1"), acceptor.local_endpoint().port()));
+			acceptor.accept(serverSocket);
+
+			// Every message is read on its own, and copied out of the read buffer
+			ByteArray data;
+			for (size_t i = 0; i < 20; ++i) {
+				ByteArray message = createByteArray("<message>" + std::string(i * 10, static_cast<char>('a' + i)) + "</message>");
+				append(data, message);
+				boost::asio::write(serverSocket, boost::asio::buffer(message));
+				while (receivedData.size() < data.size()) {
+					Swift::sleep(10);
+					eventLoop_->processEvents();
+				}
+			}
+			CPPUNIT_ASSERT(data == receivedData);
+
+			testling->disconnect();
+		}
+
+		void readLargeAmountOfData(bool wipeReadBuffers) {
+			ByteArray data;
+			for (size_t i = 0; i < 1024 * 1024; ++i) {
+				data.push_back(static_cast<unsigned char>(i % 251));
+			}
+
+			boost::asio::ip::tcp::acceptor acceptor(*boostIOService, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+			boost::asio::ip::tcp::socket serverSocket(*boostIOService);
+
+			BoostConnection::ref testling(BoostConnection::create(boostIOServiceThread_->getIOService(), eventLoop_));
+			testling->setWipeReadBuffers(wipeReadBuffers);
+			testling->onDataRead.connect(boost::bind(&BoostConnectionTest::handleDataRead, this, _1));
+			testling->connect(HostAddressPort(HostAddress("127.0.0.1"), acceptor.local_endpoint().port()));
+			acceptor.accept(serverSocket);
+			boost::asio::write(serverSocket, boost::asio::buffer(data));
+
+			while (receivedData.size() < data.size()) {
+				Swift::sleep(10);
+				eventLoop_->processEvents();
+			}
+			CPPUNIT_ASSERT(data == receivedData);
+
+			testling->disconnect();
+		}
+
 		void doWrite(BoostConnection* connection) {
 			connection->write(createSafeByteArray("<stream:stream>"));
 			connection->write(createSafeByteArray("\r\n\r\n")); // Temporarily, while we don't have an xmpp server running on ipv6
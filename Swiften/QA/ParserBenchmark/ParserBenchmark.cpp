@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Base/foreach.h>
+#include <Swiften/Elements/ProtocolHeader.h>
+#include <Swiften/Parser/PayloadParserFactory.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+#include <Swiften/Parser/XMPPParser.h>
+#include <Swiften/Parser/XMPPParserClient.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+#include <Swiften/StreamStack/XMPPLayer.h>
+
+using namespace Swift;
+
+namespace {
+	/**
+	 * A mix of stanzas as seen by a typical client: chat messages with
+	 * chat states and receipts, presence with caps and avatars, and
+	 * disco/roster/pubsub IQs.
+	 */
+	const char* corpus[] = {
+		"<message to='juliet@capulet.lit/balcony' from='romeo@montague.lit/orchard' type='chat' id='m1'>"
+			"<body>Art thou not Romeo, and a Montague?</body>"
+			"<active xmlns='http://jabber.org/protocol/chatstates'/>"
+			"<request xmlns='urn:xmpp:receipts'/>"
+		"</message>",
+		"<message to='juliet@capulet.lit/balcony' from='romeo@montague.lit/orchard' type='chat' id='m2'>"
+			"<composing xmlns='http://jabber.org/protocol/chatstates'/>"
+		"</message>",
+		"<message to='romeo@montague.lit/orchard' from='juliet@capulet.lit/balcony' id='m3'>"
+			"<received xmlns='urn:xmpp:receipts' id='m1'/>"
+		"</message>",
+		"<presence from='juliet@capulet.lit/balcony'>"
+			"<show>away</show><status>In the garden</status><priority>5</priority>"
+			"<c xmlns='http://jabber.org/protocol/caps' hash='sha-1' node='http://swift.im' ver='QgayPKawpkPSDYmwT/WM94uAlu0='/>"
+			"<x xmlns='vcard-temp:x:update'><photo>01b87fcd030b72895ff8e88db57ec525450f000d</photo></x>"
+			"<delay xmlns='urn:xmpp:delay' from='capulet.lit' stamp='2002-09-10T23:41:07Z'/>"
+		"</presence>",
+		"<presence from='coven@chat.shakespeare.lit/thirdwitch' to='hag66@shakespeare.lit/pda'>"
+			"<x xmlns='http://jabber.org/protocol/muc#user'><item affiliation='member' role='participant'/></x>"
+		"</presence>",
+		"<iq from='capulet.lit' to='juliet@capulet.lit/balcony' type='result' id='i1'>"
+			"<query xmlns='http://jabber.org/protocol/disco#info'>"
+				"<identity category='server' type='im' name='Capulet'/>"
+				"<feature var='http://jabber.org/protocol/disco#info'/>"
+				"<feature var='urn:xmpp:ping'/>"
+			"</query>"
+		"</iq>",
+		"<iq from='juliet@capulet.lit' to='juliet@capulet.lit/balcony' type='set' id='i2'>"
+			"<query xmlns='jabber:iq:roster'><item jid='nurse@capulet.lit' subscription='both'><group>Servants</group></item></query>"
+		"</iq>",
+		"<message from='pubsub.shakespeare.lit' to='francisco@denmark.lit' id='m4'>"
+			"<event xmlns='http://jabber.org/protocol/pubsub#event'>"
+				"<items node='princely_musings'><item id='ae890ac52d0df67ed7cfdf51b644e901'/></items>"
+			"</event>"
+		"</message>",
+		"<iq from='juliet@capulet.lit/balcony' to='romeo@montague.lit/orchard' type='error' id='i3'>"
+			"<error type='cancel'><service-unavailable xmlns='urn:ietf:params:xml:ns:xmpp-stanzas'/></error>"
+		"</iq>",
+	};
+
+	class CountingParserClient : public XMPPParserClient {
+		public:
+			CountingParserClient() : elements(0) {}
+
+			virtual void handleStreamStart(const ProtocolHeader&) {}
+			virtual void handleElement(boost::shared_ptr<ToplevelElement>) { ++elements; }
+			virtual void handleStreamEnd() {}
+
+			size_t elements;
+	};
+
+	class XMPPLayerExposed : public XMPPLayer {
+		public:
+			XMPPLayerExposed(PayloadParserFactoryCollection* payloadParserFactories, PayloadSerializerCollection* payloadSerializers, XMLParserFactory* xmlParserFactory) : XMPPLayer(payloadParserFactories, payloadSerializers, xmlParserFactory, ClientStreamType) {
+			}
+
+			using XMPPLayer::handleDataRead;
+	};
+
+	void increment(size_t* counter) {
+		++*counter;
+	}
+
+	double elapsedMicroseconds(const boost::posix_time::ptime& start) {
+		return static_cast<double>((boost::posix_time::microsec_clock::universal_time() - start).total_microseconds());
+	}
+
+	void runFactoryLookupBenchmark(FullPayloadParserFactoryCollection& factories) {
+		typedef std::pair<std::string, std::string> Key;
+		std::vector<Key> keys;
+		keys.push_back(Key("body", ""));
+		keys.push_back(Key("active", "http://jabber.org/protocol/chatstates"));
+		keys.push_back(Key("request", "urn:xmpp:receipts"));
+		keys.push_back(Key("show", ""));
+		keys.push_back(Key("c", "http://jabber.org/protocol/caps"));
+		keys.push_back(Key("x", "vcard-temp:x:update"));
+		keys.push_back(Key("x", "http://jabber.org/protocol/muc#user"));
+		keys.push_back(Key("query", "http://jabber.org/protocol/disco#info"));
+		keys.push_back(Key("query", "jabber:iq:roster"));
+		keys.push_back(Key("event", "http://jabber.org/protocol/pubsub#event"));
+		keys.push_back(Key("error", ""));
+		keys.push_back(Key("unknown", "urn:example:unknown"));
+
+		const size_t iterations = 200000;
+		size_t found = 0;
+		AttributeMap attributes;
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < iterations; ++i) {
+			foreach (const Key& key, keys) {
+				if (factories.getPayloadParserFactory(key.first, key.second, attributes)) {
+					++found;
+				}
+			}
+		}
+		double time = elapsedMicroseconds(start);
+		std::cout << "Factory lookups: " << std::fixed << std::setprecision(1) << time * 1000.0 / (iterations * keys.size()) << " ns/lookup (" << found << " found)" << std::endl;
+	}
+
+	void runParseBenchmark(FullPayloadParserFactoryCollection& factories, bool rawForwarding) {
+		const size_t iterations = 20000;
+		PlatformXMLParserFactory xmlParserFactory;
+		CountingParserClient client;
+		XMPPParser parser(&client, &factories, &xmlParserFactory);
+		parser.setRawForwarding(rawForwarding);
+		parser.parse("<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams' to='capulet.lit' version='1.0'>");
+
+		size_t bytes = 0;
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < iterations; ++i) {
+			for (size_t j = 0; j < sizeof(corpus) / sizeof(corpus[0]); ++j) {
+				std::string stanza(corpus[j]);
+				bytes += stanza.size();
+				if (!parser.parse(stanza)) {
+					std::cerr << "Parse error" << std::endl;
+					return;
+				}
+			}
+		}
+		double time = elapsedMicroseconds(start);
+		std::cout << (rawForwarding ? "Stanza parsing (raw forwarding): " : "Stanza parsing: ") << std::fixed << std::setprecision(0) << client.elements * 1000000.0 / time << " stanzas/s, " << std::setprecision(1) << bytes / time << " MB/s" << std::endl;
+	}
+
+	/**
+	 * Feeds bursts of large messages through an XMPPLayer, the way a
+	 * connection delivers them after a burst of offline messages or a
+	 * history fetch.
+	 */
+	void runStreamBenchmark(FullPayloadParserFactoryCollection& factories) {
+		const size_t burstSize = 64 * 1024;
+		const size_t bursts = 4000;
+
+		std::string body;
+		while (body.size() < 4096) {
+			body += "Two households, both alike in dignity, in fair Verona, where we lay our scene. ";
+		}
+		std::string message =
+			"<message to='juliet@capulet.lit/balcony' from='romeo@montague.lit/orchard' type='chat' id='m1'>"
+				"<body>" + body + "</body>"
+				"<active xmlns='http://jabber.org/protocol/chatstates'/>"
+			"</message>";
+		SafeByteArray burst;
+		while (burst.size() + message.size() <= burstSize) {
+			burst.insert(burst.end(), message.begin(), message.end());
+		}
+
+		PlatformXMLParserFactory xmlParserFactory;
+		FullPayloadSerializerCollection serializers;
+		XMPPLayerExposed layer(&factories, &serializers, &xmlParserFactory);
+		size_t elements = 0;
+		layer.onElement.connect(boost::bind(&increment, &elements));
+		layer.handleDataRead(createSafeByteArray("<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams' from='capulet.lit' version='1.0'>"));
+
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < bursts; ++i) {
+			layer.handleDataRead(burst);
+		}
+		double time = elapsedMicroseconds(start);
+		std::cout << "Stream parsing: " << std::fixed << std::setprecision(1) << static_cast<double>(burst.size() * bursts) / time << " MB/s (" << elements << " messages)" << std::endl;
+	}
+}
+
+int main(int, char**) {
+	FullPayloadParserFactoryCollection factories;
+	runFactoryLookupBenchmark(factories);
+	runParseBenchmark(factories, false);
+	runParseBenchmark(factories, true);
+	runStreamBenchmark(factories);
+	return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <openssl/evp.h>
+#include <openssl/pkcs12.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/TLS/OpenSSL/OpenSSLContext.h>
+#include <Swiften/TLS/OpenSSL/OpenSSLContextFactory.h>
+#include <Swiften/TLS/OpenSSL/OpenSSLSessionCache.h>
+#include <Swiften/TLS/OpenSSL/UnitTest/SelfSignedCertificate.h>
+
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+
+using namespace Swift;
+
+namespace {
+	/**
+	 * Creates a server context with a fresh self-signed certificate.
+	 */
+	SSL_CTX* createServerContext() {
+		ByteArray data = SelfSignedCertificate::create()->getData();
+		const unsigned char* p = vecptr(data);
+		PKCS12* pkcs12 = d2i_PKCS12(NULL, &p, static_cast<long>(data.size()));
+		EVP_PKEY* key = NULL;
+		X509* certificate = NULL;
+		PKCS12_parse(pkcs12, "", &key, &certificate, NULL);
+		PKCS12_free(pkcs12);
+
+		SSL_CTX* context = SSL_CTX_new(SSLv23_server_method());
+		SSL_CTX_use_certificate(context, certificate);
+		SSL_CTX_use_PrivateKey(context, key);
+		X509_free(certificate);
+		EVP_PKEY_free(key);
+		return context;
+	}
+
+	/**
+	 * Runs a handshake between a client context and an in-memory server.
+	 */
+	class Handshake {
+		public:
+			Handshake(TLSContext* client, SSL_CTX* serverContext) : client(client), connected(false), error(false) {
+				server = SSL_new(serverContext);
+				serverIn = BIO_new(BIO_s_mem());
+				serverOut = BIO_new(BIO_s_mem());
+				SSL_set_bio(server, serverIn, serverOut);
+				SSL_set_accept_state(server);
+				client->onDataForNetwork.connect(boost::bind(&Handshake::handleDataFromClient, this, _1));
+				client->onConnected.connect(boost::bind(&Handshake::handleConnected, this));
+				client->onError.connect(boost::bind(&Handshake::handleError, this));
+			}
+
+			~Handshake() {
+				SSL_free(server);
+			}
+
+			bool run() {
+				client->connect();
+				while (!error) {
+					int result = SSL_do_handshake(server);
+					if (result != 1 && SSL_get_error(server, result) != SSL_ERROR_WANT_READ) {
+						return false;
+					}
+					int size = BIO_pending(serverOut);
+					if (size > 0) {
+						SafeByteArray data(static_cast<size_t>(size));
+						BIO_read(serverOut, vecptr(data), size);
+						client->handleDataFromNetwork(data);
+					}
+					else if (result == 1 && connected) {
+						return true;
+					}
+					else if (BIO_pending(serverIn) == 0) {
+						return false;
+					}
+				}
+				return false;
+			}
+
+			bool isSessionReused() const {
+				return SSL_session_reused(server) != 0;
+			}
+
+		private:
+			void handleDataFromClient(const SafeByteArray& data) {
+				BIO_write(serverIn, vecptr(data), static_cast<int>(data.size()));
+			}
+
+			void handleConnected() {
+				connected = true;
+			}
+
+			void handleError() {
+				error = true;
+			}
+
+		private:
+			TLSContext* client;
+			SSL* server;
+			BIO* serverIn;
+			BIO* serverOut;
+			bool connected;
+			bool error;
+	};
+
+	enum Mode { NewContextPerConnection, SharedContext, SharedContextWithResumption };
+
+	void benchmark(Mode mode, const std::string& description, SSL_CTX* serverContext, int handshakes) {
+		OpenSSLContextFactory factory;
+		int reused = 0;
+		int failed = 0;
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		for (int i = 0; i < handshakes; ++i) {
+			TLSContext* client;
+			if (mode == NewContextPerConnection) {
+				client = new OpenSSLContext(boost::shared_ptr<SSL_CTX>(OpenSSLContext::createClientContext(), SSL_CTX_free), boost::shared_ptr<OpenSSLSessionCache>());
+			}
+			else {
+				client = factory.createTLSContext();
+			}
+			if (mode == SharedContextWithResumption) {
+				client->setServerName("example.com");
+			}
+			{
+				Handshake handshake(client, serverContext);
+				if (!handshake.run()) {
+					++failed;
+				}
+				if (handshake.isSessionReused()) {
+					++reused;
+				}
+			}
+			delete client;
+		}
+		double seconds = static_cast<double>((boost::posix_time::microsec_clock::universal_time() - start).total_microseconds()) / 1000000.0;
+		std::cout << std::setw(36) << std::left << description << ": " << std::fixed << std::setprecision(1) << handshakes / seconds << " handshakes/s (" << reused << " resumed, " << failed << " failed)" << std::endl;
+	}
+}
+
+/**
+ * Measures client handshakes against an in-process OpenSSL server, with a
+ * context per connection, a shared context, and a shared context that
+ * resumes sessions.
+ */
+int main(int argc, char* argv[]) {
+	int handshakes = 1000;
+	if (argc > 1) {
+		handshakes = boost::lexical_cast<int>(argv[1]);
+	}
+
+	SSL_library_init();
+	SSL_CTX* serverContext = createServerContext();
+	benchmark(NewContextPerConnection, "New client context per connection", serverContext, handshakes);
+	benchmark(SharedContext, "Shared client context", serverContext, handshakes);
+	benchmark(SharedContextWithResumption, "Shared client context, resumption", serverContext, handshakes);
+	SSL_CTX_free(serverContext);
+	return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+#include <Swiften/StreamStack/LowLayer.h>
+#include <Swiften/StreamStack/StreamLayer.h>
+#include <Swiften/StreamStack/StreamStack.h>
+#include <Swiften/StreamStack/TLSLayer.h>
+#include <Swiften/StreamStack/XMPPLayer.h>
+#include <Swiften/TLS/OpenSSL/OpenSSLContextFactory.h>
+#include <Swiften/TLS/OpenSSL/UnitTest/SelfSignedCertificate.h>
+#include <Swiften/TLS/PKCS12Certificate.h>
+#include <Swiften/TLS/TLSContext.h>
+
+using namespace Swift;
+
+namespace {
+	/**
+	 * The network below the TLS layer, connected to an in-memory server.
+	 */
+	class BenchmarkNetworkLayer : public LowLayer {
+		public:
+			BenchmarkNetworkLayer(TLSContext* server) : server(server) {
+				server->onDataForNetwork.connect(boost::bind(&BenchmarkNetworkLayer::handleDataFromServer, this, _1));
+			}
+
+			virtual void writeData(const SafeByteArray& data) {
+				server->handleDataFromNetwork(data);
+			}
+
+			void flush() {
+				while (!fromServer.empty()) {
+					SafeByteArray data = fromServer.front();
+					fromServer.pop_front();
+					writeDataToParentLayer(data);
+				}
+			}
+
+			void deliver(const SafeByteArray& data) {
+				writeDataToParentLayer(data);
+			}
+
+		private:
+			void handleDataFromServer(const SafeByteArray& data) {
+				fromServer.push_back(data);
+			}
+
+		public:
+			TLSContext* server;
+			std::deque<SafeByteArray> fromServer;
+	};
+
+	/**
+	 * Counts the decrypted data instead of passing it to the XMPP layer.
+	 */
+	class CountingLayer : public StreamLayer {
+		public:
+			CountingLayer() : bytes(0), reads(0) {}
+
+			virtual void writeData(const SafeByteArray& data) {
+				writeDataToChildLayer(data);
+			}
+
+			virtual void handleDataRead(const SafeByteArray& data) {
+				bytes += data.size();
+				++reads;
+			}
+
+			size_t bytes;
+			size_t reads;
+	};
+
+	void benchmark(OpenSSLContextFactory& clientFactory, OpenSSLContextFactory& serverFactory, size_t recordSize, size_t totalSize) {
+		FullPayloadParserFactoryCollection parserFactories;
+		FullPayloadSerializerCollection serializers;
+		PlatformXMLParserFactory xmlParserFactory;
+		XMPPLayer xmppLayer(&parserFactories, &serializers, &xmlParserFactory, ClientStreamType);
+		boost::shared_ptr<TLSContext> server(serverFactory.createServerTLSContext());
+		BenchmarkNetworkLayer networkLayer(server.get());
+		TLSLayer tlsLayer(&clientFactory);
+		CountingLayer countingLayer;
+		StreamStack stack(&xmppLayer, &networkLayer);
+		stack.addLayer(&tlsLayer);
+		stack.addLayer(&countingLayer);
+
+		server->accept();
+		tlsLayer.connect();
+		networkLayer.flush();
+
+		// Encrypt everything up front, and cut it up the way a connection
+		// would read it.
+		SafeByteArray record(recordSize, 'a');
+		for (size_t i = 0; i < totalSize / recordSize; ++i) {
+			server->handleDataFromApplication(record);
+		}
+		SafeByteArray encrypted;
+		while (!networkLayer.fromServer.empty()) {
+			encrypted.insert(encrypted.end(), networkLayer.fromServer.front().begin(), networkLayer.fromServer.front().end());
+			networkLayer.fromServer.pop_front();
+		}
+		const size_t readSize = 65536;
+		std::vector<SafeByteArray> reads;
+		for (size_t i = 0; i < encrypted.size(); i += readSize) {
+			reads.push_back(SafeByteArray(encrypted.begin() + static_cast<long>(i), encrypted.begin() + static_cast<long>(std::min(i + readSize, encrypted.size()))));
+		}
+
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		for (size_t i = 0; i < reads.size(); ++i) {
+			networkLayer.deliver(reads[i]);
+		}
+		double seconds = static_cast<double>((boost::posix_time::microsec_clock::universal_time() - start).total_microseconds()) / 1000000.0;
+		std::cout << std::setw(6) << std::right << recordSize << " byte records: " << std::fixed << std::setprecision(1) << static_cast<double>(countingLayer.bytes) / (1024 * 1024) / seconds << " MB/s decrypted, " << countingLayer.reads << " reads by the parent layer for " << reads.size() << " network reads" << std::endl;
+	}
+}
+
+/**
+ * Measures the rate at which a client TLSLayer decrypts data that arrives
+ * in 64 KiB network reads, for small (stanza-sized) and full TLS records.
+ */
+int main(int argc, char* argv[]) {
+	size_t totalSize = 256 * 1024 * 1024;
+	if (argc > 1) {
+		totalSize = boost::lexical_cast<size_t>(argv[1]) * 1024 * 1024;
+	}
+
+	OpenSSLContextFactory clientFactory;
+	OpenSSLContextFactory serverFactory;
+	serverFactory.setServerCertificate(SelfSignedCertificate::create());
+
+	benchmark(clientFactory, serverFactory, 100, totalSize / 8);
+	benchmark(clientFactory, serverFactory, 1024, totalSize / 2);
+	benchmark(clientFactory, serverFactory, 16384, totalSize);
+	return 0;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,11 +12,13 @@
 #include <Swiften/Base/foreach.h>
 #include <Swiften/Queries/IQHandler.h>
 #include <Swiften/Queries/IQChannel.h>
+#include <Swiften/Queries/Request.h>
 #include <Swiften/Elements/ErrorPayload.h>
 
 namespace Swift {
 
 static void noop(IQHandler*) {}
+static void noopRequest(Request*) {}
 
 IQRouter::IQRouter(IQChannel* channel) : channel_(channel), queueRemoves_(false) {
 	channel->onIQReceived.connect(boost::bind(&IQRouter::handleIQ, this, _1));
@@ -34,14 +36,14 @@ void IQRouter::handleIQ(boost::shared_ptr<IQ> iq) {
 	queueRemoves_ = true;
 
 	bool handled = false;
+	if (iq->getType() == IQ::Result || iq->getType() == IQ::Error) {
+		handled = handleResponse(iq);
+	}
 	// Go through the handlers in reverse order, to give precedence to the last added handler
 	std::vector<boost::shared_ptr<IQHandler> >::const_reverse_iterator i = handlers_.rbegin();
 	std::vector<boost::shared_ptr<IQHandler> >::const_reverse_iterator rend = handlers_.rend();
-	for (; i != rend; ++i) {
-		handled |= (*i)->handleIQ(iq);
-		if (handled) {
-			break;
-		}
+	for (; !handled && i != rend; ++i) {
+		handled = (*i)->handleIQ(iq);
 	}
 	if (!handled && (iq->getType() == IQ::Get || iq->getType() == IQ::Set) ) {
 		sendIQ(IQ::createError(iq->getFrom(), iq->getID(), ErrorPayload::FeatureNotImplemented, ErrorPayload::Cancel));
@@ -52,6 +54,27 @@ void IQRouter::handleIQ(boost::shared_ptr<IQ> iq) {
 	queueRemoves_ = false;
 }
 
+bool IQRouter::handleResponse(boost::shared_ptr<IQ> iq) {
+	typedef boost::unordered_multimap<std::string, boost::shared_ptr<Request> >::const_iterator RequestIterator;
+	std::pair<RequestIterator, RequestIterator> range = requests_.equal_range(iq->getID());
+	if (range.first == range.second) {
+		return false;
+	}
+
+	// Requests remove themselves when they handle the response, so keep
+	// the candidates alive outside of the table while dispatching.
+	std::vector<boost::shared_ptr<Request> > candidates;
+	for (RequestIterator i = range.first; i != range.second; ++i) {
+		candidates.push_back(i->second);
+	}
+	foreach (boost::shared_ptr<Request> request, candidates) {
+		if (static_cast<IQHandler*>(request.get())->handleIQ(iq)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void IQRouter::processPendingRemoves() {
 	foreach(boost::shared_ptr<IQHandler> handler, queuedRemoves_) {
 		erase(handlers_, handler);
@@ -80,6 +103,25 @@ void IQRouter::removeHandler(boost::shared_ptr<IQHandler> handler) {
 	}
 }
 
+void IQRouter::addRequest(Request* request) {
+	addRequest(boost::shared_ptr<Request>(request, noopRequest));
+}
+
+void IQRouter::addRequest(boost::shared_ptr<Request> request) {
+	requests_.insert(std::make_pair(request->getID(), request));
+}
+
+void IQRouter::removeRequest(Request* request) {
+	typedef boost::unordered_multimap<std::string, boost::shared_ptr<Request> >::iterator RequestIterator;
+	std::pair<RequestIterator, RequestIterator> range = requests_.equal_range(request->getID());
+	for (RequestIterator i = range.first; i != range.second; ++i) {
+		if (i->second.get() == request) {
+			requests_.erase(i);
+			return;
+		}
+	}
+}
+
 void IQRouter::sendIQ(boost::shared_ptr<IQ> iq) {
 	if (from_.isValid() && !iq->getFrom().isValid()) {
 		iq->setFrom(from_);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include <vector>
 #include <string>
 
@@ -16,6 +17,7 @@
 namespace Swift {
 	class IQChannel;
 	class IQHandler;
+	class Request;
 
 	class SWIFTEN_API IQRouter {
 		public:
@@ -52,6 +54,18 @@ namespace Swift {
 			void addHandler(boost::shared_ptr<IQHandler> handler);
 			void removeHandler(boost::shared_ptr<IQHandler> handler);
 
+			/**
+			 * Registers a request that is waiting for its response.
+			 *
+			 * Incoming results and errors are matched against pending
+			 * requests by ID before any of the generic handlers are tried,
+			 * so the cost of routing a response does not depend on the
+			 * number of outstanding requests.
+			 */
+			void addRequest(Request* request);
+			void addRequest(boost::shared_ptr<Request> request);
+			void removeRequest(Request* request);
+
 			/**
 			 * Sends an IQ stanza.
 			 *
@@ -76,6 +90,7 @@ namespace Swift {
 
 		private:
 			void handleIQ(boost::shared_ptr<IQ> iq);
+			bool handleResponse(boost::shared_ptr<IQ> iq);
 			void processPendingRemoves();
 
 		private:
@@ -84,6 +99,7 @@ namespace Swift {
 			JID from_;
 			std::vector< boost::shared_ptr<IQHandler> > handlers_;
 			std::vector< boost::shared_ptr<IQHandler> > queuedRemoves_;
+			boost::unordered_multimap<std::string, boost::shared_ptr<Request> > requests_;
 			bool queueRemoves_;
 	};
 }
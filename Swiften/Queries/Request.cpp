@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -36,10 +36,10 @@ std::string Request::send() {
 	iq->setID(id_);
 
 	try {
-		router_->addHandler(shared_from_this());
+		router_->addRequest(shared_from_this());
 	}
 	catch (const std::exception&) {
-		router_->addHandler(this);
+		router_->addRequest(this);
 	}
 
 	router_->sendIQ(iq);
@@ -67,7 +67,7 @@ bool Request::handleIQ(boost::shared_ptr<IQ> iq) {
 						handleResponse(boost::shared_ptr<Payload>(), ErrorPayload::ref(new ErrorPayload(ErrorPayload::UndefinedCondition)));
 					}
 				}
-				router_->removeHandler(this);
+				router_->removeRequest(this);
 				handled = true;
 			}
 		}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,9 +10,11 @@
 #include <boost/smart_ptr/make_shared.hpp>
 #include <boost/bind.hpp>
 
+#include <Swiften/Elements/RawXMLPayload.h>
 #include <Swiften/Queries/IQHandler.h>
 #include <Swiften/Queries/IQRouter.h>
 #include <Swiften/Queries/DummyIQChannel.h>
+#include <Swiften/Queries/Request.h>
 
 using namespace Swift;
 
@@ -27,6 +29,9 @@ class IQRouterTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST(testSendIQ_WithFrom);
 		CPPUNIT_TEST(testSendIQ_WithoutFrom);
 		CPPUNIT_TEST(testHandleIQ_WithFrom);
+		CPPUNIT_TEST(testHandleIQ_ResponseRoutedToRequest);
+		CPPUNIT_TEST(testHandleIQ_ResponseFromOtherSenderGoesToHandlers);
+		CPPUNIT_TEST(testHandleIQ_GetWithRequestIDGoesToHandlers);
 		CPPUNIT_TEST_SUITE_END();
 
 	public:
@@ -137,7 +142,60 @@ class IQRouterTest : public CppUnit::TestFixture {
 			CPPUNIT_ASSERT_EQUAL(JID("foo@bar.com/baz"), channel_->iqs_[0]->getFrom());
 		}
 
+		void testHandleIQ_ResponseRoutedToRequest() {
+			IQRouter testling(channel_);
+			DummyIQHandler handler(true, &testling);
+			boost::shared_ptr<DummyRequest> request1 = boost::make_shared<DummyRequest>(JID("foo@bar.com/baz"), &testling);
+			boost::shared_ptr<DummyRequest> request2 = boost::make_shared<DummyRequest>(JID("foo@bar.com/qux"), &testling);
+			request1->send();
+			request2->send();
+
+			channel_->onIQReceived(IQ::createResult(JID(), JID("foo@bar.com/qux"), request2->getID()));
+			channel_->onIQReceived(IQ::createResult(JID(), JID("foo@bar.com/qux"), request2->getID()));
+
+			CPPUNIT_ASSERT_EQUAL(0, request1->responses);
+			CPPUNIT_ASSERT_EQUAL(1, request2->responses);
+			CPPUNIT_ASSERT_EQUAL(1, handler.called);
+		}
+
+		void testHandleIQ_ResponseFromOtherSenderGoesToHandlers() {
+			IQRouter testling(channel_);
+			DummyIQHandler handler(true, &testling);
+			boost::shared_ptr<DummyRequest> request = boost::make_shared<DummyRequest>(JID("foo@bar.com/baz"), &testling);
+			request->send();
+
+			channel_->onIQReceived(IQ::createResult(JID(), JID("foo@bar.com/qux"), request->getID()));
+
+			CPPUNIT_ASSERT_EQUAL(0, request->responses);
+			CPPUNIT_ASSERT_EQUAL(1, handler.called);
+		}
+
+		void testHandleIQ_GetWithRequestIDGoesToHandlers() {
+			IQRouter testling(channel_);
+			DummyIQHandler handler(true, &testling);
+			boost::shared_ptr<DummyRequest> request = boost::make_shared<DummyRequest>(JID("foo@bar.com/baz"), &testling);
+			request->send();
+
+			boost::shared_ptr<IQ> iq = boost::make_shared<IQ>(IQ::Get);
+			iq->setFrom(JID("foo@bar.com/baz"));
+			iq->setID(request->getID());
+			channel_->onIQReceived(iq);
+
+			CPPUNIT_ASSERT_EQUAL(0, request->responses);
+			CPPUNIT_ASSERT_EQUAL(1, handler.called);
+		}
+
 	private:
+		struct DummyRequest : public Request {
+			DummyRequest(const JID& receiver, IQRouter* router) : Request(IQ::Get, receiver, boost::make_shared<RawXMLPayload>("<query xmlns='jabber:iq:version'/>"), router), responses(0) {
+			}
+
+			virtual void handleResponse(boost::shared_ptr<Payload>, boost::shared_ptr<ErrorPayload>) {
+				responses++;
+			}
+			int responses;
+		};
+
 		struct DummyIQHandler : public IQHandler {
 			DummyIQHandler(bool handle, IQRouter* router) : handle(handle), router(router), called(0) {
 				router->addHandler(this);
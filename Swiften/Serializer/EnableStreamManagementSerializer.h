@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -18,8 +18,13 @@ namespace Swift {
 			EnableStreamManagementSerializer() : GenericElementSerializer<EnableStreamManagement>() {
 			}
 
-			virtual SafeByteArray serialize(boost::shared_ptr<ToplevelElement>) const {
-				return createSafeByteArray(XMLElement("enable", "urn:xmpp:sm:2").serialize());
+			virtual SafeByteArray serialize(boost::shared_ptr<ToplevelElement> el) const {
+				boost::shared_ptr<EnableStreamManagement> e(boost::dynamic_pointer_cast<EnableStreamManagement>(el));
+				XMLElement element("enable", "urn:xmpp:sm:2");
+				if (e->getResume()) {
+					element.setAttribute("resume", "true");
+				}
+				return createSafeByteArray(element.serialize());
 			}
 	};
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,13 +20,13 @@ namespace Swift {
 
 			virtual void setStanzaSpecificAttributes(
 					boost::shared_ptr<ToplevelElement> stanza, 
-					XMLElement& element) const {
+					XMLWriter& writer) const {
 				setStanzaSpecificAttributesGeneric(
-						boost::dynamic_pointer_cast<STANZA_TYPE>(stanza), element);
+						boost::dynamic_pointer_cast<STANZA_TYPE>(stanza), writer);
 			}
 
 			virtual void setStanzaSpecificAttributesGeneric(
 					boost::shared_ptr<STANZA_TYPE>, 
-					XMLElement&) const = 0;
+					XMLWriter&) const = 0;
 	};
 }
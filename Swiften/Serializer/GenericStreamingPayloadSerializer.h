@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+
+#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
+namespace Swift {
+	/**
+	 * Base class for payload serializers that write their payload directly
+	 * into an XMLWriter, instead of returning a string.
+	 */
+	template<typename PAYLOAD_TYPE>
+	class GenericStreamingPayloadSerializer : public GenericPayloadSerializer<PAYLOAD_TYPE> {
+		public:
+			virtual std::string serializePayload(boost::shared_ptr<PAYLOAD_TYPE> payload) const {
+				std::string result;
+				XMLWriter writer(result);
+				writePayload(payload, writer);
+				return result;
+			}
+
+			virtual void write(boost::shared_ptr<Payload> payload, XMLWriter& writer) const {
+				writePayload(boost::dynamic_pointer_cast<PAYLOAD_TYPE>(payload), writer);
+			}
+
+			virtual void writePayload(boost::shared_ptr<PAYLOAD_TYPE>, XMLWriter&) const = 0;
+	};
+}
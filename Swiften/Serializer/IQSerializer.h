@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,7 +8,7 @@
 
 #include <Swiften/Serializer/GenericStanzaSerializer.h>
 #include <Swiften/Elements/IQ.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 #include <boost/optional.hpp>
 
@@ -22,12 +22,12 @@ namespace Swift {
 		private:
 			virtual void setStanzaSpecificAttributesGeneric(
 					boost::shared_ptr<IQ> iq, 
-					XMLElement& element) const {
+					XMLWriter& writer) const {
 				switch (iq->getType()) {
-					case IQ::Get: element.setAttribute("type","get"); break;
-					case IQ::Set: element.setAttribute("type","set"); break;
-					case IQ::Result: element.setAttribute("type","result"); break;
-					case IQ::Error: element.setAttribute("type","error"); break;
+					case IQ::Get: writer.addAttribute("type","get"); break;
+					case IQ::Set: writer.addAttribute("type","set"); break;
+					case IQ::Result: writer.addAttribute("type","result"); break;
+					case IQ::Error: writer.addAttribute("type","error"); break;
 				}
 			}
 	};
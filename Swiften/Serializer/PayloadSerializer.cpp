@@ -1,14 +1,23 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Serializer/PayloadSerializer.h>
 
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
 namespace Swift {
 
 PayloadSerializer::~PayloadSerializer() {
 }
 
+void PayloadSerializer::write(boost::shared_ptr<Payload> payload, XMLWriter& writer) const {
+	std::string serializedPayload = serialize(payload);
+	if (!serializedPayload.empty()) {
+		writer.addRawXML(serializedPayload);
+	}
+}
+
 }
@@ -1,10 +1,11 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
 #include <algorithm>
 
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
@@ -17,13 +18,32 @@ PayloadSerializerCollection::PayloadSerializerCollection() {
 
 void PayloadSerializerCollection::addSerializer(PayloadSerializer* serializer) {
 	serializers_.push_back(serializer);
+	boost::lock_guard<boost::mutex> lock(serializerCacheMutex_);
+	serializerCache_.clear();
 }
 
 void PayloadSerializerCollection::removeSerializer(PayloadSerializer* serializer) {
 	serializers_.erase(std::remove(serializers_.begin(), serializers_.end(), serializer), serializers_.end());
+	boost::lock_guard<boost::mutex> lock(serializerCacheMutex_);
+	serializerCache_.clear();
 }
 
 PayloadSerializer* PayloadSerializerCollection::getPayloadSerializer(boost::shared_ptr<Payload> payload) const {
+	if (!payload) {
+		return findPayloadSerializer(payload);
+	}
+	TypeIndex type(typeid(*payload));
+	boost::lock_guard<boost::mutex> lock(serializerCacheMutex_);
+	SerializerCache::const_iterator i = serializerCache_.find(type);
+	if (i != serializerCache_.end()) {
+		return i->second;
+	}
+	PayloadSerializer* serializer = findPayloadSerializer(payload);
+	serializerCache_.insert(std::make_pair(type, serializer));
+	return serializer;
+}
+
+PayloadSerializer* PayloadSerializerCollection::findPayloadSerializer(boost::shared_ptr<Payload> payload) const {
 	std::vector<PayloadSerializer*>::const_iterator i = std::find_if(
 			serializers_.begin(), serializers_.end(),
 			boost::bind(&PayloadSerializer::canSerialize, _1, payload));
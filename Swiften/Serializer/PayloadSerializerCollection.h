@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,8 +8,11 @@
 
 #include <vector>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <Swiften/Base/API.h>
+#include <Swiften/Base/TypeIndex.h>
 #include <Swiften/Elements/Payload.h>
 
 namespace Swift {
@@ -25,6 +28,19 @@ namespace Swift {
 			PayloadSerializer* getPayloadSerializer(boost::shared_ptr<Payload>) const;
 
 		private:
+			PayloadSerializer* findPayloadSerializer(boost::shared_ptr<Payload>) const;
+
+		private:
+			typedef boost::unordered_map<TypeIndex, PayloadSerializer*> SerializerCache;
+
 			std::vector<PayloadSerializer*> serializers_;
+
+			/**
+			 * Serializer for each dynamic payload type seen so far (NULL if
+			 * there is none). Filled in lazily by a scan over serializers_, so
+			 * subclasses of serialized payload types are handled as well.
+			 */
+			mutable SerializerCache serializerCache_;
+			mutable boost::mutex serializerCacheMutex_;
 	};
 }
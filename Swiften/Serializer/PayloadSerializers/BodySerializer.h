@@ -1,23 +1,23 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
-#include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/GenericStreamingPayloadSerializer.h>
 #include <Swiften/Elements/Body.h>
 
 namespace Swift {
-	class BodySerializer : public GenericPayloadSerializer<Body> {
+	class BodySerializer : public GenericStreamingPayloadSerializer<Body> {
 		public:
-			BodySerializer() : GenericPayloadSerializer<Body>() {}
+			BodySerializer() : GenericStreamingPayloadSerializer<Body>() {}
 
-			virtual std::string serializePayload(boost::shared_ptr<Body> body)  const {
-				XMLTextNode textNode(body->getText());
-				return "<body>" + textNode.serialize() + "</body>";
+			virtual void writePayload(boost::shared_ptr<Body> body, XMLWriter& writer)  const {
+				writer.startElement("body");
+				writer.addText(body->getText());
+				writer.endElement();
 			}
 	};
 }
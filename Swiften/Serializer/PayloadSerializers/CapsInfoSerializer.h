@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,14 +7,14 @@
 #pragma once
 
 #include <Swiften/Base/API.h>
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/GenericStreamingPayloadSerializer.h>
 #include <Swiften/Elements/CapsInfo.h>
 
 namespace Swift {
-	class SWIFTEN_API CapsInfoSerializer : public GenericPayloadSerializer<CapsInfo> {
+	class SWIFTEN_API CapsInfoSerializer : public GenericStreamingPayloadSerializer<CapsInfo> {
 		public:
 			CapsInfoSerializer();
 
-			virtual std::string serializePayload(boost::shared_ptr<CapsInfo>)  const;
+			virtual void writePayload(boost::shared_ptr<CapsInfo>, XMLWriter&)  const;
 	};
 }
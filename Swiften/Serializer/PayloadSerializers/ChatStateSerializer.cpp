@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,20 +8,19 @@
 
 namespace Swift {
 
-ChatStateSerializer::ChatStateSerializer() : GenericPayloadSerializer<ChatState>() {
+ChatStateSerializer::ChatStateSerializer() : GenericStreamingPayloadSerializer<ChatState>() {
 }
 
-std::string ChatStateSerializer::serializePayload(boost::shared_ptr<ChatState> chatState)  const {
-	std::string result("<");
+void ChatStateSerializer::writePayload(boost::shared_ptr<ChatState> chatState, XMLWriter& writer)  const {
 	switch (chatState->getChatState()) {
-		case ChatState::Active: result += "active"; break;
-		case ChatState::Composing: result += "composing"; break;
-		case ChatState::Paused: result += "paused"; break;
-		case ChatState::Inactive: result += "inactive"; break;
-		case ChatState::Gone: result += "gone"; break;
+		case ChatState::Active: writer.startElement("active"); break;
+		case ChatState::Composing: writer.startElement("composing"); break;
+		case ChatState::Paused: writer.startElement("paused"); break;
+		case ChatState::Inactive: writer.startElement("inactive"); break;
+		case ChatState::Gone: writer.startElement("gone"); break;
 	}
-	result += " xmlns=\"http://jabber.org/protocol/chatstates\"/>";
-	return result;
+	writer.addAttribute("xmlns", "http://jabber.org/protocol/chatstates");
+	writer.endElement();
 }
 
 }
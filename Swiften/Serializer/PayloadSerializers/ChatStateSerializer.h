@@ -1,19 +1,19 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/GenericStreamingPayloadSerializer.h>
 #include <Swiften/Elements/ChatState.h>
 
 namespace Swift {
-	class ChatStateSerializer : public GenericPayloadSerializer<ChatState> {
+	class ChatStateSerializer : public GenericStreamingPayloadSerializer<ChatState> {
 		public:
 			ChatStateSerializer();
 
-			virtual std::string serializePayload(boost::shared_ptr<ChatState> error)  const;
+			virtual void writePayload(boost::shared_ptr<ChatState> chatState, XMLWriter& writer)  const;
 	};
 }
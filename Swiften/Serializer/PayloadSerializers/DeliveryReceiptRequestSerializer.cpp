@@ -4,19 +4,25 @@
  * See http://www.opensource.org/licenses/bsd-license.php for more information.
  */
 
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
 #include <Swiften/Serializer/PayloadSerializers/DeliveryReceiptRequestSerializer.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
 
 #include <Swiften/Base/Log.h>
 
 namespace Swift {
 
-DeliveryReceiptRequestSerializer::DeliveryReceiptRequestSerializer() : GenericPayloadSerializer<DeliveryReceiptRequest>() {
+DeliveryReceiptRequestSerializer::DeliveryReceiptRequestSerializer() : GenericStreamingPayloadSerializer<DeliveryReceiptRequest>() {
 }
 
-std::string DeliveryReceiptRequestSerializer::serializePayload(boost::shared_ptr<DeliveryReceiptRequest> /* request*/) const {
-	XMLElement requestXML("request", "urn:xmpp:receipts");
-	return requestXML.serialize();
+void DeliveryReceiptRequestSerializer::writePayload(boost::shared_ptr<DeliveryReceiptRequest> /* request*/, XMLWriter& writer) const {
+	writer.startElement("request");
+	writer.addAttribute("xmlns", "urn:xmpp:receipts");
+	writer.endElement();
 }
 
 }
@@ -4,17 +4,23 @@
  * See http://www.opensource.org/licenses/bsd-license.php for more information.
  */
 
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
 #pragma once
 
 #include <Swiften/Base/API.h>
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/GenericStreamingPayloadSerializer.h>
 #include <Swiften/Elements/DeliveryReceipt.h>
 
 namespace Swift {
-	class SWIFTEN_API DeliveryReceiptSerializer : public GenericPayloadSerializer<DeliveryReceipt> {
+	class SWIFTEN_API DeliveryReceiptSerializer : public GenericStreamingPayloadSerializer<DeliveryReceipt> {
 		public:
 			DeliveryReceiptSerializer();
 
-			virtual std::string serializePayload(boost::shared_ptr<DeliveryReceipt> receipt) const;
+			virtual void writePayload(boost::shared_ptr<DeliveryReceipt> receipt, XMLWriter& writer) const;
 	};
 }
@@ -1,36 +1,33 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/GenericStreamingPayloadSerializer.h>
 #include <Swiften/Elements/StatusShow.h>
 
 namespace Swift {
-	class StatusShowSerializer : public GenericPayloadSerializer<StatusShow> {
+	class StatusShowSerializer : public GenericStreamingPayloadSerializer<StatusShow> {
 		public:
-			StatusShowSerializer() : GenericPayloadSerializer<StatusShow>() {}
+			StatusShowSerializer() : GenericStreamingPayloadSerializer<StatusShow>() {}
 
-			virtual std::string serializePayload(boost::shared_ptr<StatusShow> statusShow)  const {
+			virtual void writePayload(boost::shared_ptr<StatusShow> statusShow, XMLWriter& writer)  const {
 				if (statusShow->getType () == StatusShow::Online || statusShow->getType() == StatusShow::None) {
-					return "";
+					return;
 				}
-				else {
-					std::string result("<show>");
-					switch (statusShow->getType()) {
-						case StatusShow::Away: result += "away"; break;
-						case StatusShow::XA: result += "xa"; break;
-						case StatusShow::FFC: result += "chat"; break;
-						case StatusShow::DND: result += "dnd"; break;
-						case StatusShow::Online: assert(false); break;
-						case StatusShow::None: assert(false); break;
-					}
-					result += "</show>";
-					return result;
+				writer.startElement("show");
+				switch (statusShow->getType()) {
+					case StatusShow::Away: writer.addText("away"); break;
+					case StatusShow::XA: writer.addText("xa"); break;
+					case StatusShow::FFC: writer.addText("chat"); break;
+					case StatusShow::DND: writer.addText("dnd"); break;
+					case StatusShow::Online: assert(false); break;
+					case StatusShow::None: assert(false); break;
 				}
+				writer.endElement();
 			}
 	};
 }
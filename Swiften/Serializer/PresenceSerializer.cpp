@@ -1,11 +1,11 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Serializer/PresenceSerializer.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 #include <Swiften/Base/Log.h>
 #include <boost/shared_ptr.hpp>
 
@@ -18,15 +18,15 @@ PresenceSerializer::PresenceSerializer(PayloadSerializerCollection* payloadSeria
 
 void PresenceSerializer::setStanzaSpecificAttributesGeneric(
 		boost::shared_ptr<Presence> presence, 
-		XMLElement& element) const {
+		XMLWriter& writer) const {
 	switch (presence->getType()) {
-		case Presence::Unavailable: element.setAttribute("type","unavailable"); break;
-		case Presence::Probe: element.setAttribute("type","probe"); break;
-		case Presence::Subscribe: element.setAttribute("type","subscribe"); break;
-		case Presence::Subscribed: element.setAttribute("type","subscribed"); break;
-		case Presence::Unsubscribe: element.setAttribute("type","unsubscribe"); break;
-		case Presence::Unsubscribed: element.setAttribute("type","unsubscribed"); break;
-		case Presence::Error: element.setAttribute("type","error"); break;
+		case Presence::Unavailable: writer.addAttribute("type","unavailable"); break;
+		case Presence::Probe: writer.addAttribute("type","probe"); break;
+		case Presence::Subscribe: writer.addAttribute("type","subscribe"); break;
+		case Presence::Subscribed: writer.addAttribute("type","subscribed"); break;
+		case Presence::Unsubscribe: writer.addAttribute("type","unsubscribe"); break;
+		case Presence::Unsubscribed: writer.addAttribute("type","unsubscribed"); break;
+		case Presence::Error: writer.addAttribute("type","error"); break;
 		case Presence::Available: break;
 	}
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,6 @@ namespace Swift {
 		private:
 			virtual void setStanzaSpecificAttributesGeneric(
 					boost::shared_ptr<Presence> presence, 
-					XMLElement& element) const;
+					XMLWriter& writer) const;
 	};
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,14 +11,16 @@
 #include <iostream>
 
 #include <Swiften/Base/foreach.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 #include <Swiften/Serializer/PayloadSerializer.h>
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
 #include <Swiften/Elements/Stanza.h>
 
 namespace Swift {
 
+// Large enough for most stanzas, so the output is rarely reallocated
+static const size_t INITIAL_BUFFER_SIZE = 512;
+
 StanzaSerializer::StanzaSerializer(const std::string& tag, PayloadSerializerCollection* payloadSerializers, const boost::optional<std::string>& explicitNS) : tag_(tag), payloadSerializers_(payloadSerializers), explicitDefaultNS_(explicitNS) {
 }
 
@@ -34,33 +36,46 @@ SafeByteArray StanzaSerializer::serialize(boost::shared_ptr<ToplevelElement> ele
 SafeByteArray StanzaSerializer::serialize(boost::shared_ptr<ToplevelElement> element, const std::string& xmlns) const {
 	boost::shared_ptr<Stanza> stanza(boost::dynamic_pointer_cast<Stanza>(element));
 
-	XMLElement stanzaElement(tag_, explicitDefaultNS_ ? explicitDefaultNS_.get() : xmlns);
+	SafeByteArray result;
+	result.reserve(INITIAL_BUFFER_SIZE);
+	XMLWriter writer(result);
+
+	// Attributes are written in alphabetical order
+	writer.startElement(tag_);
 	if (stanza->getFrom().isValid()) {
-		stanzaElement.setAttribute("from", stanza->getFrom());
+		writer.addAttribute("from", stanza->getFrom());
+	}
+	if (!stanza->getID().empty()) {
+		writer.addAttribute("id", stanza->getID());
 	}
 	if (stanza->getTo().isValid()) {
-		stanzaElement.setAttribute("to", stanza->getTo());
+		writer.addAttribute("to", stanza->getTo());
 	}
-	if (!stanza->getID().empty()) {
-		stanzaElement.setAttribute("id", stanza->getID());
+	setStanzaSpecificAttributes(stanza, writer);
+	const std::string& ns = explicitDefaultNS_ ? explicitDefaultNS_.get() : xmlns;
+	if (!ns.empty()) {
+		writer.addAttribute("xmlns", ns);
 	}
-	setStanzaSpecificAttributes(stanza, stanzaElement);
 
-	std::string serializedPayloads;
-	foreach (const boost::shared_ptr<Payload>& payload, stanza->getPayloads()) {
-		PayloadSerializer* serializer = payloadSerializers_->getPayloadSerializer(payload);
-		if (serializer) {
-			serializedPayloads += serializer->serialize(payload);
-		}
-		else {
-			std::cerr << "Could not find serializer for " << typeid(*(payload.get())).name() << std::endl;
-		}
+	// Take the raw payloads once, as another thread may parse them
+	boost::shared_ptr<const std::string> rawPayloads = stanza->getRawPayloads();
+	if (rawPayloads) {
+		writer.addRawXML(*rawPayloads);
 	}
-	if (!serializedPayloads.empty()) {
-		stanzaElement.addNode(boost::shared_ptr<XMLNode>(new XMLRawTextNode(serializedPayloads)));
+	else {
+		foreach (const boost::shared_ptr<Payload>& payload, stanza->getPayloads()) {
+			PayloadSerializer* serializer = payloadSerializers_->getPayloadSerializer(payload);
+			if (serializer) {
+				serializer->write(payload, writer);
+			}
+			else {
+				std::cerr << "Could not find serializer for " << typeid(*(payload.get())).name() << std::endl;
+			}
+		}
 	}
+	writer.endElement();
 
-	return createSafeByteArray(stanzaElement.serialize());
+	return result;
 }
 
 }
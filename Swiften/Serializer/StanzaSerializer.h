@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2014 Isode Limited.
+ * Copyright (c) 2013-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,7 +14,7 @@
 
 namespace Swift {
 	class PayloadSerializerCollection;
-	class XMLElement;
+	class XMLWriter;
 
 	class StanzaSerializer : public ElementSerializer {
 		public:
@@ -22,7 +22,7 @@ namespace Swift {
 
 			virtual SafeByteArray serialize(boost::shared_ptr<ToplevelElement> element) const;
 			virtual SafeByteArray serialize(boost::shared_ptr<ToplevelElement> element, const std::string& xmlns) const;
-			virtual void setStanzaSpecificAttributes(boost::shared_ptr<ToplevelElement>, XMLElement&) const = 0;
+			virtual void setStanzaSpecificAttributes(boost::shared_ptr<ToplevelElement>, XMLWriter&) const = 0;
 
 		private:
 			std::string tag_;
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Elements/Body.h>
+#include <Swiften/Elements/Subject.h>
+#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/PayloadSerializerCollection.h>
+
+using namespace Swift;
+
+class PayloadSerializerCollectionTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(PayloadSerializerCollectionTest);
+		CPPUNIT_TEST(testGetPayloadSerializer);
+		CPPUNIT_TEST(testGetPayloadSerializer_NoMatchingSerializer);
+		CPPUNIT_TEST(testGetPayloadSerializer_Subclass);
+		CPPUNIT_TEST(testGetPayloadSerializer_FirstMatchingSerializer);
+		CPPUNIT_TEST(testGetPayloadSerializer_AfterAdd);
+		CPPUNIT_TEST(testGetPayloadSerializer_AfterRemove);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void testGetPayloadSerializer() {
+			PayloadSerializerCollection testling;
+			DummySerializer<Body> bodySerializer;
+			DummySerializer<Subject> subjectSerializer;
+			testling.addSerializer(&bodySerializer);
+			testling.addSerializer(&subjectSerializer);
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<PayloadSerializer*>(&subjectSerializer), testling.getPayloadSerializer(boost::make_shared<Subject>()));
+			CPPUNIT_ASSERT_EQUAL(static_cast<PayloadSerializer*>(&bodySerializer), testling.getPayloadSerializer(boost::make_shared<Body>()));
+			CPPUNIT_ASSERT_EQUAL(static_cast<PayloadSerializer*>(&subjectSerializer), testling.getPayloadSerializer(boost::make_shared<Subject>()));
+		}
+
+		void testGetPayloadSerializer_NoMatchingSerializer() {
+			PayloadSerializerCollection testling;
+			DummySerializer<Body> bodySerializer;
+			testling.addSerializer(&bodySerializer);
+
+			CPPUNIT_ASSERT(!testling.getPayloadSerializer(boost::make_shared<Subject>()));
+			CPPUNIT_ASSERT(!testling.getPayloadSerializer(boost::make_shared<Subject>()));
+		}
+
+		void testGetPayloadSerializer_Subclass() {
+			PayloadSerializerCollection testling;
+			DummySerializer<Body> bodySerializer;
+			testling.addSerializer(&bodySerializer);
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<PayloadSerializer*>(&bodySerializer), testling.getPayloadSerializer(boost::make_shared<SpecialBody>()));
+			CPPUNIT_ASSERT_EQUAL(static_cast<PayloadSerializer*>(&bodySerializer), testling.getPayloadSerializer(boost::make_shared<SpecialBody>()));
+		}
+
+		void testGetPayloadSerializer_FirstMatchingSerializer() {
+			PayloadSerializerCollection testling;
+			DummySerializer<Body> bodySerializer1;
+			DummySerializer<Body> bodySerializer2;
+			testling.addSerializer(&bodySerializer1);
+			testling.addSerializer(&bodySerializer2);
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<PayloadSerializer*>(&bodySerializer1), testling.getPayloadSerializer(boost::make_shared<Body>()));
+		}
+
+		void testGetPayloadSerializer_AfterAdd() {
+			PayloadSerializerCollection testling;
+			DummySerializer<Body> bodySerializer;
+			testling.getPayloadSerializer(boost::make_shared<Body>());
+
+			testling.addSerializer(&bodySerializer);
+
+			CPPUNIT_ASSERT_EQUAL(static_cast<PayloadSerializer*>(&bodySerializer), testling.getPayloadSerializer(boost::make_shared<Body>()));
+		}
+
+		void testGetPayloadSerializer_AfterRemove() {
+			PayloadSerializerCollection testling;
+			DummySerializer<Body> bodySerializer;
+			testling.addSerializer(&bodySerializer);
+			testling.getPayloadSerializer(boost::make_shared<Body>());
+
+			testling.removeSerializer(&bodySerializer);
+
+			CPPUNIT_ASSERT(!testling.getPayloadSerializer(boost::make_shared<Body>()));
+		}
+
+	private:
+		class SpecialBody : public Body {
+		};
+
+		template<typename PAYLOAD_TYPE>
+		class DummySerializer : public GenericPayloadSerializer<PAYLOAD_TYPE> {
+			public:
+				virtual std::string serializePayload(boost::shared_ptr<PAYLOAD_TYPE>) const {
+					return "";
+				}
+		};
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PayloadSerializerCollectionTest);
@@ -1,15 +1,21 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
+#include <boost/bind.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+#include <boost/thread.hpp>
 
 #include <Swiften/Serializer/XMPPSerializer.h>
 #include <Swiften/Elements/AuthChallenge.h>
+#include <Swiften/Elements/Body.h>
+#include <Swiften/Elements/Message.h>
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
 #include <Swiften/Elements/ProtocolHeader.h>
 
 using namespace Swift;
@@ -19,6 +25,8 @@ class XMPPSerializerTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST(testSerializeHeader_Client);
 		CPPUNIT_TEST(testSerializeHeader_Component);
 		CPPUNIT_TEST(testSerializeHeader_Server);
+		CPPUNIT_TEST(testSerializeElement_RawPayloads);
+		CPPUNIT_TEST(testSerializeElement_RawPayloadsParsedConcurrently);
 		CPPUNIT_TEST_SUITE_END();
 
 	public:
@@ -63,7 +71,58 @@ class XMPPSerializerTest : public CppUnit::TestFixture {
 			CPPUNIT_ASSERT_EQUAL(std::string("<?xml version=\"1.0\"?><stream:stream xmlns=\"jabber:server\" xmlns:stream=\"http://etherx.jabber.org/streams\" from=\"bla@foo.com\" to=\"foo.com\" id=\"myid\" version=\"0.99\">"), testling->serializeHeader(protocolHeader));
 		}
 
+		void testSerializeElement_RawPayloads() {
+			boost::shared_ptr<XMPPSerializer> testling(createSerializer(ClientStreamType));
+			boost::shared_ptr<Message> message = boost::make_shared<Message>();
+			message->setTo(JID("juliet@capulet.lit"));
+			message->setRawPayloads("<body xmlns=\"jabber:client\">Hi</body><foo xmlns=\"urn:example:foo\"/>", boost::make_shared<FailingPayloadsParser>());
+
+			CPPUNIT_ASSERT_EQUAL(std::string("<message to=\"juliet@capulet.lit\" type=\"chat\"><body xmlns=\"jabber:client\">Hi</body><foo xmlns=\"urn:example:foo\"/></message>"), safeByteArrayToString(testling->serializeElement(message)));
+		}
+
+		void testSerializeElement_RawPayloadsParsedConcurrently() {
+			FullPayloadSerializerCollection serializers;
+			XMPPSerializer testling(&serializers, ClientStreamType, false);
+			int failures = 0;
+
+			for (int i = 0; i < 200; ++i) {
+				boost::shared_ptr<Message> message = boost::make_shared<Message>();
+				message->setRawPayloads("<body>Hi</body>", boost::make_shared<BodyPayloadsParser>());
+
+				bool bodyFound = false;
+				boost::thread reader(boost::bind(&XMPPSerializerTest::readBody, message, &bodyFound));
+				std::string serialized = safeByteArrayToString(testling.serializeElement(message));
+				reader.join();
+
+				if (!bodyFound || serialized != "<message type=\"chat\"><body>Hi</body></message>") {
+					++failures;
+				}
+			}
+
+			CPPUNIT_ASSERT_EQUAL(0, failures);
+		}
+
 	private:
+		static void readBody(boost::shared_ptr<Message> message, bool* found) {
+			boost::shared_ptr<Body> body = message->getPayload<Body>();
+			*found = body && body->getText() == "Hi";
+		}
+
+		struct BodyPayloadsParser : public Stanza::PayloadsParser {
+			virtual std::vector< boost::shared_ptr<Payload> > parsePayloads(const std::string&) {
+				// Give the serializing thread time to run into the parse
+				boost::this_thread::yield();
+				return std::vector< boost::shared_ptr<Payload> >(1, boost::make_shared<Body>("Hi"));
+			}
+		};
+
+		struct FailingPayloadsParser : public Stanza::PayloadsParser {
+			virtual std::vector< boost::shared_ptr<Payload> > parsePayloads(const std::string&) {
+				CPPUNIT_FAIL("Payloads should not be parsed");
+				return std::vector< boost::shared_ptr<Payload> >();
+			}
+		};
+
 		XMPPSerializer* createSerializer(StreamType type) {
 			return new XMPPSerializer(payloadSerializerCollection, type, false);
 		}
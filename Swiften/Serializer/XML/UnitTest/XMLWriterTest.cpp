@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Serializer/XML/XMLElement.h>
+#include <Swiften/Serializer/XML/XMLEscaper.h>
+#include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
+using namespace Swift;
+
+class XMLWriterTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(XMLWriterTest);
+		CPPUNIT_TEST(testWrite);
+		CPPUNIT_TEST(testWrite_EmptyElement);
+		CPPUNIT_TEST(testWrite_EscapesAttributesAndText);
+		CPPUNIT_TEST(testWrite_RawXML);
+		CPPUNIT_TEST(testWrite_EmptyRawXMLStillClosesElement);
+		CPPUNIT_TEST(testWrite_SafeByteArray);
+		CPPUNIT_TEST(testWrite_XMLElement);
+		CPPUNIT_TEST(testEscapeText);
+		CPPUNIT_TEST(testEscapeAttributeValue);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void testWrite() {
+			std::string result;
+			XMLWriter testling(result);
+
+			testling.startElement("foo");
+			testling.addAttribute("xmlns", "http://example.com");
+			testling.startElement("bar");
+			testling.addText("Blo");
+			testling.endElement();
+			testling.startElement("baz");
+			testling.addAttribute("a", "b");
+			testling.endElement();
+			testling.endElement();
+
+			CPPUNIT_ASSERT_EQUAL(std::string("<foo xmlns=\"http://example.com\"><bar>Blo</bar><baz a=\"b\"/></foo>"), result);
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), testling.getDepth());
+		}
+
+		void testWrite_EmptyElement() {
+			std::string result;
+			XMLWriter testling(result);
+
+			testling.startElement("foo");
+			testling.endElement();
+
+			CPPUNIT_ASSERT_EQUAL(std::string("<foo/>"), result);
+		}
+
+		void testWrite_EscapesAttributesAndText() {
+			std::string result;
+			XMLWriter testling(result);
+
+			testling.startElement("foo");
+			testling.addAttribute("myatt", "<\"'&>");
+			testling.addText("Bli&</stream>'\"");
+			testling.endElement();
+
+			CPPUNIT_ASSERT_EQUAL(std::string("<foo myatt=\"&lt;&quot;&apos;&amp;&gt;\">Bli&amp;&lt;/stream&gt;'\"</foo>"), result);
+		}
+
+		void testWrite_RawXML() {
+			std::string result;
+			XMLWriter testling(result);
+
+			testling.startElement("foo");
+			testling.addRawXML("<bar>&amp;</bar>");
+			testling.endElement();
+
+			CPPUNIT_ASSERT_EQUAL(std::string("<foo><bar>&amp;</bar></foo>"), result);
+		}
+
+		void testWrite_EmptyRawXMLStillClosesElement() {
+			std::string result;
+			XMLWriter testling(result);
+
+			testling.startElement("foo");
+			testling.addRawXML("");
+			testling.endElement();
+
+			CPPUNIT_ASSERT_EQUAL(std::string("<foo></foo>"), result);
+		}
+
+		void testWrite_SafeByteArray() {
+			SafeByteArray result;
+			XMLWriter testling(result);
+
+			testling.startElement("message");
+			testling.addAttribute("to", "foo@bar.com");
+			testling.startElement("body");
+			testling.addText("a < b");
+			testling.endElement();
+			testling.endElement();
+
+			CPPUNIT_ASSERT_EQUAL(createSafeByteArray("<message to=\"foo@bar.com\"><body>a &lt; b</body></message>"), result);
+		}
+
+		void testWrite_XMLElement() {
+			XMLElement element("foo", "http://example.com");
+			boost::shared_ptr<XMLElement> barElement(new XMLElement("bar"));
+			barElement->addNode(boost::make_shared<XMLTextNode>("Bli&"));
+			element.addNode(barElement);
+			std::string result;
+			XMLWriter testling(result);
+
+			testling.startElement("root");
+			element.write(testling);
+			testling.endElement();
+
+			CPPUNIT_ASSERT_EQUAL(std::string("<root><foo xmlns=\"http://example.com\"><bar>Bli&amp;</bar></foo></root>"), result);
+		}
+
+		void testEscapeText() {
+			CPPUNIT_ASSERT_EQUAL(std::string("a&amp;b&lt;c&gt;d'\""), XMLEscaper::escapeText("a&b<c>d'\""));
+			CPPUNIT_ASSERT_EQUAL(std::string("abc"), XMLEscaper::escapeText("abc"));
+			CPPUNIT_ASSERT_EQUAL(std::string(""), XMLEscaper::escapeText(""));
+		}
+
+		void testEscapeAttributeValue() {
+			CPPUNIT_ASSERT_EQUAL(std::string("&amp;&lt;&gt;&apos;&quot;x"), XMLEscaper::escapeAttributeValue("&<>'\"x"));
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(XMLWriterTest);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -26,6 +26,7 @@ namespace Swift {
 			void addNode(boost::shared_ptr<XMLNode> node);
 
 			virtual std::string serialize();
+			virtual void write(XMLWriter& writer);
 
 		private:
 			std::string tag_;
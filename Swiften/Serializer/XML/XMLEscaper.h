@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <string>
+
+namespace Swift {
+	/**
+	 * Single-pass XML escaping, appending to any container that supports
+	 * insert(end(), first, last) (e.g. std::string or SafeByteArray).
+	 */
+	namespace XMLEscaper {
+		namespace Detail {
+			inline const char* getEscapeSequence(char c, bool isAttributeValue) {
+				switch (c) {
+					case '&': return "&amp;";
+					case '<': return "&lt;";
+					case '>': return "&gt;";
+					case '\'': return isAttributeValue ? "&apos;" : NULL;
+					case '"': return isAttributeValue ? "&quot;" : NULL;
+					default: return NULL;
+				}
+			}
+
+			template<typename Output>
+			void appendEscaped(const std::string& value, bool isAttributeValue, Output& output) {
+				std::string::const_iterator unescapedStart = value.begin();
+				for (std::string::const_iterator i = value.begin(); i != value.end(); ++i) {
+					const char* escapeSequence = getEscapeSequence(*i, isAttributeValue);
+					if (escapeSequence) {
+						output.insert(output.end(), unescapedStart, i);
+						output.insert(output.end(), escapeSequence, escapeSequence + std::strlen(escapeSequence));
+						unescapedStart = i + 1;
+					}
+				}
+				output.insert(output.end(), unescapedStart, value.end());
+			}
+		}
+
+		/**
+		 * Appends character data, escaping '&', '<' and '>'.
+		 */
+		template<typename Output>
+		void appendEscapedText(const std::string& text, Output& output) {
+			Detail::appendEscaped(text, false, output);
+		}
+
+		/**
+		 * Appends an attribute value, escaping '&', '<', '>', '\'' and '"'.
+		 */
+		template<typename Output>
+		void appendEscapedAttributeValue(const std::string& value, Output& output) {
+			Detail::appendEscaped(value, true, output);
+		}
+
+		inline std::string escapeText(const std::string& text) {
+			std::string result;
+			result.reserve(text.size());
+			appendEscapedText(text, result);
+			return result;
+		}
+
+		inline std::string escapeAttributeValue(const std::string& value) {
+			std::string result;
+			result.reserve(value.size());
+			appendEscapedAttributeValue(value, result);
+			return result;
+		}
+	}
+}
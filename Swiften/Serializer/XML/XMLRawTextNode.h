@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <Swiften/Serializer/XML/XMLNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 	class XMLRawTextNode : public XMLNode {
@@ -18,6 +19,10 @@ namespace Swift {
 				return text_;
 			}
 
+			void write(XMLWriter& writer) {
+				writer.addRawXML(text_);
+			}
+
 		private:
 			std::string text_;
 	};
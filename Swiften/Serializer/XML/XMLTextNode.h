@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,7 +7,8 @@
 #pragma once
 
 #include <Swiften/Serializer/XML/XMLNode.h>
-#include <Swiften/Base/String.h>
+#include <Swiften/Serializer/XML/XMLEscaper.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 	class XMLTextNode : public XMLNode {
@@ -15,13 +16,14 @@ namespace Swift {
 			typedef boost::shared_ptr<XMLTextNode> ref;
 
 			XMLTextNode(const std::string& text) : text_(text) {
-				String::replaceAll(text_, '&', "&amp;"); // Should come first
-				String::replaceAll(text_, '<', "&lt;");
-				String::replaceAll(text_, '>', "&gt;");
 			}
 
 			std::string serialize() {
-				return text_;
+				return XMLEscaper::escapeText(text_);
+			}
+
+			void write(XMLWriter& writer) {
+				writer.addText(text_);
 			}
 
 			static ref create(const std::string& text) {
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
+#include <cassert>
+#include <cstring>
+
+#include <Swiften/Serializer/XML/XMLEscaper.h>
+
+namespace Swift {
+
+XMLWriter::XMLWriter(SafeByteArray& output) : safeOutput_(&output), stringOutput_(NULL) {
+}
+
+XMLWriter::XMLWriter(std::string& output) : safeOutput_(NULL), stringOutput_(&output) {
+}
+
+void XMLWriter::startElement(const std::string& tag) {
+	startContent();
+	append("<", 1);
+	openElements_.push_back(OpenElement(getOutputSize(), tag.size()));
+	append(tag);
+}
+
+void XMLWriter::addAttribute(const std::string& name, const std::string& value) {
+	assert(!openElements_.empty() && !openElements_.back().hasContent);
+	append(" ", 1);
+	append(name);
+	append("=\"", 2);
+	appendEscaped(value, true);
+	append("\"", 1);
+}
+
+void XMLWriter::addText(const std::string& text) {
+	startContent();
+	appendEscaped(text, false);
+}
+
+void XMLWriter::addRawXML(const std::string& xml) {
+	startContent();
+	append(xml);
+}
+
+void XMLWriter::endElement() {
+	assert(!openElements_.empty());
+	OpenElement element = openElements_.back();
+	openElements_.pop_back();
+	if (element.hasContent) {
+		append("</", 2);
+		appendFromOutput(element.tagOffset, element.tagSize);
+		append(">", 1);
+	}
+	else {
+		append("/>", 2);
+	}
+}
+
+void XMLWriter::startContent() {
+	if (!openElements_.empty() && !openElements_.back().hasContent) {
+		openElements_.back().hasContent = true;
+		append(">", 1);
+	}
+}
+
+void XMLWriter::append(const char* data, size_t size) {
+	if (safeOutput_) {
+		safeOutput_->insert(safeOutput_->end(), data, data + size);
+	}
+	else {
+		stringOutput_->append(data, size);
+	}
+}
+
+void XMLWriter::append(const std::string& data) {
+	append(data.data(), data.size());
+}
+
+void XMLWriter::appendEscaped(const std::string& data, bool isAttributeValue) {
+	if (safeOutput_) {
+		if (isAttributeValue) {
+			XMLEscaper::appendEscapedAttributeValue(data, *safeOutput_);
+		}
+		else {
+			XMLEscaper::appendEscapedText(data, *safeOutput_);
+		}
+	}
+	else {
+		if (isAttributeValue) {
+			XMLEscaper::appendEscapedAttributeValue(data, *stringOutput_);
+		}
+		else {
+			XMLEscaper::appendEscapedText(data, *stringOutput_);
+		}
+	}
+}
+
+void XMLWriter::appendFromOutput(size_t offset, size_t size) {
+	if (size == 0) {
+		return;
+	}
+	size_t outputSize = getOutputSize();
+	assert(offset + size <= outputSize);
+	if (safeOutput_) {
+		safeOutput_->resize(outputSize + size);
+		std::memcpy(&(*safeOutput_)[outputSize], &(*safeOutput_)[offset], size);
+	}
+	else {
+		stringOutput_->resize(outputSize + size);
+		std::memcpy(&(*stringOutput_)[outputSize], &(*stringOutput_)[offset], size);
+	}
+}
+
+size_t XMLWriter::getOutputSize() const {
+	return safeOutput_ ? safeOutput_->size() : stringOutput_->size();
+}
+
+}
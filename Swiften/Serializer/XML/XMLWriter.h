@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/SafeByteArray.h>
+
+namespace Swift {
+	/**
+	 * Writes XML into a single growable output buffer.
+	 *
+	 * Elements are written by calling startElement(), then addAttribute()
+	 * for each attribute, then any content (child elements, text, raw XML),
+	 * and finally endElement(). Elements without content are written as
+	 * empty-element tags. Attribute values and text are escaped while
+	 * being appended, and no intermediate strings are created.
+	 */
+	class SWIFTEN_API XMLWriter {
+		public:
+			XMLWriter(SafeByteArray& output);
+			XMLWriter(std::string& output);
+
+			void startElement(const std::string& tag);
+			void addAttribute(const std::string& name, const std::string& value);
+			void addText(const std::string& text);
+
+			/**
+			 * Appends already serialized XML verbatim.
+			 */
+			void addRawXML(const std::string& xml);
+			void endElement();
+
+			/**
+			 * Returns the number of elements started but not yet ended.
+			 */
+			size_t getDepth() const {
+				return openElements_.size();
+			}
+
+		private:
+			struct OpenElement {
+				OpenElement(size_t tagOffset, size_t tagSize) : tagOffset(tagOffset), tagSize(tagSize), hasContent(false) {}
+
+				size_t tagOffset;
+				size_t tagSize;
+				bool hasContent;
+			};
+
+			void startContent();
+			void append(const char* data, size_t size);
+			void append(const std::string& data);
+			void appendEscaped(const std::string& data, bool isAttributeValue);
+			void appendFromOutput(size_t offset, size_t size);
+			size_t getOutputSize() const;
+
+		private:
+			SafeByteArray* safeOutput_;
+			std::string* stringOutput_;
+
+			// Tag names are referenced by their position in the output, so
+			// closing tags can be written without storing a copy.
+			std::vector<OpenElement> openElements_;
+	};
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -84,9 +84,9 @@ std::string XMPPSerializer::serializeHeader(const ProtocolHeader& header) const
 }
 
 SafeByteArray XMPPSerializer::serializeElement(boost::shared_ptr<ToplevelElement> element) const {
-	std::vector< boost::shared_ptr<ElementSerializer> >::const_iterator i = std::find_if(serializers_.begin(), serializers_.end(), boost::bind(&ElementSerializer::canSerialize, _1, element));
-	if (i != serializers_.end()) {
-		return (*i)->serialize(element);
+	boost::shared_ptr<ElementSerializer> serializer = getSerializer(element);
+	if (serializer) {
+		return serializer->serialize(element);
 	}
 	else {
 		std::cerr << "Could not find serializer for " << typeid(*(element.get())).name() << std::endl;
@@ -94,6 +94,21 @@ SafeByteArray XMPPSerializer::serializeElement(boost::shared_ptr<ToplevelElement
 	}
 }
 
+boost::shared_ptr<ElementSerializer> XMPPSerializer::getSerializer(boost::shared_ptr<ToplevelElement> element) const {
+	TypeIndex type(typeid(*element));
+	SerializerCache::const_iterator i = serializerCache_.find(type);
+	if (i != serializerCache_.end()) {
+		return i->second;
+	}
+	boost::shared_ptr<ElementSerializer> serializer;
+	std::vector< boost::shared_ptr<ElementSerializer> >::const_iterator j = std::find_if(serializers_.begin(), serializers_.end(), boost::bind(&ElementSerializer::canSerialize, _1, element));
+	if (j != serializers_.end()) {
+		serializer = *j;
+	}
+	serializerCache_.insert(std::make_pair(type, serializer));
+	return serializer;
+}
+
 std::string XMPPSerializer::serializeFooter() const {
 	return "</stream:stream>";
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,9 +7,11 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include <vector>
 
 #include <Swiften/Base/API.h>
+#include <Swiften/Base/TypeIndex.h>
 #include <Swiften/Elements/ToplevelElement.h>
 #include <Swiften/Elements/StreamType.h>
 #include <string>
@@ -30,9 +32,18 @@ namespace Swift {
 		
 		private:
 			std::string getDefaultNamespace() const;
+			boost::shared_ptr<ElementSerializer> getSerializer(boost::shared_ptr<ToplevelElement> element) const;
 
 		private:
+			typedef boost::unordered_map<TypeIndex, boost::shared_ptr<ElementSerializer> > SerializerCache;
+
 			StreamType type_;
 			std::vector< boost::shared_ptr<ElementSerializer> > serializers_;
+
+			/**
+			 * Serializer for each dynamic element type seen so far, filled in
+			 * lazily by a scan over serializers_.
+			 */
+			mutable SerializerCache serializerCache_;
 	};
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -114,6 +114,9 @@ void BasicSessionStream::addTLSEncryption() {
 		streamStack->addLayer(tlsLayer);
 		tlsLayer->onError.connect(boost::bind(&BasicSessionStream::handleTLSError, this, _1));
 		tlsLayer->onConnected.connect(boost::bind(&BasicSessionStream::handleTLSConnected, this));
+		if (!getTLSServerName().empty()) {
+			tlsLayer->setServerName(getTLSServerName());
+		}
 		tlsLayer->connect();
 	}
 }
@@ -1,15 +1,17 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Session/Session.h>
 
+#include <cassert>
 #include <boost/bind.hpp>
 
 #include <Swiften/StreamStack/XMPPLayer.h>
 #include <Swiften/StreamStack/StreamStack.h>
+#include <Swiften/StreamStack/TLSLayer.h>
 
 namespace Swift {
 
@@ -24,12 +26,14 @@ Session::Session(
 			xmlParserFactory(xmlParserFactory),
 			xmppLayer(NULL),
 			connectionLayer(NULL),
+			tlsLayer(NULL),
 			streamStack(0),
 			finishing(false) {
 }
 
 Session::~Session() {
 	delete streamStack;
+	delete tlsLayer;
 	delete connectionLayer;
 	delete xmppLayer;
 }
@@ -76,6 +80,18 @@ void Session::initializeStreamStack() {
 	streamStack = new StreamStack(xmppLayer, connectionLayer);
 }
 
+void Session::addServerTLSEncryption(TLSContext* context) {
+	assert(!tlsLayer);
+	tlsLayer = new TLSLayer(context);
+	tlsLayer->onError.connect(boost::bind(&Session::handleTLSError, this, _1));
+	streamStack->addLayer(tlsLayer);
+	tlsLayer->accept();
+}
+
+void Session::handleTLSError(boost::shared_ptr<Swift::TLSError>) {
+	finishSession(TLSError);
+}
+
 void Session::sendElement(boost::shared_ptr<ToplevelElement> stanza) {
 	xmppLayer->writeElement(stanza);
 }
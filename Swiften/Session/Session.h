@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -27,6 +27,9 @@ namespace Swift {
 	class PayloadSerializerCollection;
 	class XMPPLayer;
 	class XMLParserFactory;
+	class TLSContext;
+	class TLSError;
+	class TLSLayer;
 
 	class SWIFTEN_API Session : public boost::enable_shared_from_this<Session> {
 		public:
@@ -87,6 +90,16 @@ namespace Swift {
 
 			void initializeStreamStack();
 
+			/**
+			 * Adds a TLS layer in the server role to the stream, and starts
+			 * the handshake. The session takes ownership of the context.
+			 */
+			void addServerTLSEncryption(TLSContext* context);
+
+			bool isTLSEncrypted() const {
+				return tlsLayer;
+			}
+
 			XMPPLayer* getXMPPLayer() const {
 				return xmppLayer;
 			}
@@ -99,6 +112,7 @@ namespace Swift {
 
 		private:
 			void handleDisconnected(const boost::optional<Connection::Error>& error);
+			void handleTLSError(boost::shared_ptr<Swift::TLSError> error);
 
 		private:
 			JID localJID;
@@ -109,6 +123,7 @@ namespace Swift {
 			XMLParserFactory* xmlParserFactory;
 			XMPPLayer* xmppLayer;
 			ConnectionLayer* connectionLayer;
+			TLSLayer* tlsLayer;
 			StreamStack* streamStack;
 			bool finishing;
 	};
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,6 +9,7 @@
 #include <Swiften/Base/boost_bsignals.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/optional.hpp>
+#include <string>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/ProtocolHeader.h>
@@ -67,6 +68,14 @@ namespace Swift {
 				return certificate && !certificate->isNull();
 			}
 
+			/**
+			 * Sets the name of the server, used to resume earlier TLS
+			 * sessions with it.
+			 */
+			void setTLSServerName(const std::string& serverName) {
+				tlsServerName = serverName;
+			}
+
 			virtual Certificate::ref getPeerCertificate() const = 0;
 			virtual std::vector<Certificate::ref> getPeerCertificateChain() const = 0;
 			virtual boost::shared_ptr<CertificateVerificationError> getPeerCertificateVerificationError() const = 0;
@@ -85,7 +94,12 @@ namespace Swift {
 				return certificate;
 			}
 
+			const std::string& getTLSServerName() const {
+				return tlsServerName;
+			}
+
 		private:
 			CertificateWithKey::ref certificate;
+			std::string tlsServerName;
 	};
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,6 +21,14 @@ namespace Swift {
 			void handleStanzaSent(boost::shared_ptr<Stanza> stanza);
 			void handleAckReceived(unsigned int handledStanzasCount);
 
+			/**
+			 * Returns the stanzas that were sent, but not acked yet, in the
+			 * order in which they were sent.
+			 */
+			const std::deque<boost::shared_ptr<Stanza> >& getUnackedStanzas() const {
+				return unackedStanzas;
+			}
+
 		public:
 			boost::signal<void ()> onRequestAck;
 			boost::signal<void (boost::shared_ptr<Stanza>)> onStanzaAcked;
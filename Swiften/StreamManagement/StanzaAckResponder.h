@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,10 @@ namespace Swift {
 			void handleStanzaReceived();
 			void handleAckRequestReceived();
 
+			unsigned int getHandledStanzasCount() const {
+				return handledStanzasCount;
+			}
+
 		public:
 			boost::signal<void (unsigned int /* handledStanzaCount */)> onAck;
 
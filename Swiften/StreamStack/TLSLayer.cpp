@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -15,6 +15,14 @@ namespace Swift {
 
 TLSLayer::TLSLayer(TLSContextFactory* factory) {
 	context = factory->createTLSContext();
+	connectToContext();
+}
+
+TLSLayer::TLSLayer(TLSContext* context) : context(context) {
+	connectToContext();
+}
+
+void TLSLayer::connectToContext() {
 	context->onDataForNetwork.connect(boost::bind(&TLSLayer::writeDataToChildLayer, this, _1));
 	context->onDataForApplication.connect(boost::bind(&TLSLayer::writeDataToParentLayer, this, _1));
 	context->onConnected.connect(onConnected);
@@ -25,10 +33,18 @@ TLSLayer::~TLSLayer() {
 	delete context;
 }
 
+void TLSLayer::setServerName(const std::string& serverName) {
+	context->setServerName(serverName);
+}
+
 void TLSLayer::connect() {
 	context->connect();
 }
 
+void TLSLayer::accept() {
+	context->accept();
+}
+
 void TLSLayer::writeData(const SafeByteArray& data) {
 	context->handleDataFromApplication(data);
 }
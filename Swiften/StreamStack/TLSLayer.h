@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <string>
+
 #include <Swiften/Base/boost_bsignals.h>
 
 #include <Swiften/Base/SafeByteArray.h>
@@ -22,9 +24,17 @@ namespace Swift {
 	class TLSLayer : public StreamLayer {
 		public:
 			TLSLayer(TLSContextFactory*);
+
+			/**
+			 * Creates a layer using the given context (e.g. a server
+			 * context). The layer takes ownership of the context.
+			 */
+			TLSLayer(TLSContext* context);
 			~TLSLayer();
 
+			void setServerName(const std::string& serverName);
 			void connect();
+			void accept();
 			bool setClientCertificate(CertificateWithKey::ref cert);
 
 			Certificate::ref getPeerCertificate() const;
@@ -42,6 +52,9 @@ namespace Swift {
 			boost::signal<void (boost::shared_ptr<TLSError>)> onError;
 			boost::signal<void ()> onConnected;
 
+		private:
+			void connectToContext();
+
 		private:
 			TLSContext* context;
 	};
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,6 +21,7 @@ XMPPLayer::XMPPLayer(
 			payloadSerializers_(payloadSerializers),
 			xmlParserFactory_(xmlParserFactory),
 			setExplictNSonTopLevelElements_(setExplictNSonTopLevelElements),
+			rawForwarding_(false),
 			resetParserAfterParse_(false),
 			inParser_(false) {
 	xmppParser_ = new XMPPParser(this, payloadParserFactories_, xmlParserFactory);
@@ -56,10 +57,7 @@ void XMPPLayer::writeDataInternal(const SafeByteArray& data) {
 void XMPPLayer::handleDataRead(const SafeByteArray& data) {
 	onDataRead(data);
 	inParser_ = true;
-	// FIXME: Converting to unsafe string. Should be ok, since we don't take passwords
-	// from the stream in clients. If servers start using this, and require safe storage,
-	// we need to fix this.
-	if (!xmppParser_->parse(byteArrayToString(ByteArray(data.begin(), data.end())))) {
+	if (!xmppParser_->parse(vecptr(data), data.size())) {
 		inParser_ = false;
 		onError();
 		return;
@@ -73,9 +71,15 @@ void XMPPLayer::handleDataRead(const SafeByteArray& data) {
 void XMPPLayer::doResetParser() {
 	delete xmppParser_;
 	xmppParser_ = new XMPPParser(this, payloadParserFactories_, xmlParserFactory_);
+	xmppParser_->setRawForwarding(rawForwarding_);
 	resetParserAfterParse_ = false;
 }
 
+void XMPPLayer::setRawForwarding(bool enabled) {
+	rawForwarding_ = enabled;
+	xmppParser_->setRawForwarding(enabled);
+}
+
 void XMPPLayer::handleStreamStart(const ProtocolHeader& header) {
 	onStreamStart(header);
 }
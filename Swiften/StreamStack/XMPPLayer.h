@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2014 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -44,6 +44,13 @@ namespace Swift {
 
 			void resetParser();
 
+			/**
+			 * Enables raw forwarding of stanzas.
+			 *
+			 * @see XMPPParser::setRawForwarding()
+			 */
+			void setRawForwarding(bool enabled);
+
 		protected:
 			void handleDataRead(const SafeByteArray& data);
 			void writeDataInternal(const SafeByteArray& data);
@@ -69,6 +76,7 @@ namespace Swift {
 			XMLParserFactory* xmlParserFactory_;
 			XMPPSerializer* xmppSerializer_;
 			bool setExplictNSonTopLevelElements_;
+			bool rawForwarding_;
 			bool resetParserAfterParse_;
 			bool inParser_;
 	};
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,6 +21,7 @@
 
 #include <Swiften/TLS/OpenSSL/OpenSSLContext.h>
 #include <Swiften/TLS/OpenSSL/OpenSSLCertificate.h>
+#include <Swiften/TLS/OpenSSL/OpenSSLSessionCache.h>
 #include <Swiften/TLS/CertificateWithKey.h>
 #include <Swiften/TLS/PKCS12Certificate.h>
 
@@ -33,16 +34,52 @@
 namespace Swift {
 
 static const int MAX_FINISHED_SIZE = 4096;
-static const int SSL_READ_BUFFERSIZE = 8192;
+// Twice the largest read of a connection, so only unusual bursts are released
+static const size_t MAX_RETAINED_READ_BUFFER_SIZE = 131072;
 
 static void freeX509Stack(STACK_OF(X509)* stack) {
 	sk_X509_free(stack);
 }
 
-OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readBIO_(0), writeBIO_(0) {
+OpenSSLContext::OpenSSLContext(boost::shared_ptr<SSL_CTX> context, boost::shared_ptr<OpenSSLSessionCache> sessionCache) : state_(Start), context_(context), sessionCache_(sessionCache), hasClientCertificate_(false), handle_(0), readBIO_(0), writeBIO_(0) {
+	handle_ = SSL_new(context_.get());
+	SSL_set_app_data(handle_, this);
+}
+
+SSL_CTX* OpenSSLContext::createServerContext() {
+	ensureLibraryInitialized();
+	SSL_CTX* context = SSL_CTX_new(SSLv23_server_method());
+	SSL_CTX_set_options(context, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
+
+	// Clients can resume sessions both from the server-side session cache
+	// and from session tickets (enabled by default). Both are shared by
+	// all connections using this context.
+	static const unsigned char sessionIDContext[] = "Swiften";
+	SSL_CTX_set_session_id_context(context, sessionIDContext, sizeof(sessionIDContext) - 1);
+	SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER);
+	return context;
+}
+
+OpenSSLContext::~OpenSSLContext() {
+	// The underlying connection is closed without a TLS shutdown. Mark it
+	// as shut down anyway, as OpenSSL otherwise considers the session
+	// unusable for resumption.
+	if (state_ == Connected) {
+		SSL_set_shutdown(handle_, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+	}
+	SSL_free(handle_);
+}
+
+SSL_CTX* OpenSSLContext::createClientContext() {
 	ensureLibraryInitialized();
-	context_ = SSL_CTX_new(SSLv23_client_method());
-	SSL_CTX_set_options(context_, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
+	SSL_CTX* context = SSL_CTX_new(SSLv23_client_method());
+	SSL_CTX_set_options(context, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
+
+	// Sessions are kept per server in an OpenSSLSessionCache, which is
+	// filled from the callback (also for the tickets that TLS 1.3 servers
+	// send after the handshake).
+	SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(context, &OpenSSLContext::handleNewSession);
 
 	// TODO: implement CRL checking
 	// TODO: download CRL (HTTP transport)
@@ -52,7 +89,7 @@ OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readB
 	// TODO: handle OCSP stapling see https://www.rfc-editor.org/rfc/rfc4366.txt
 	// Load system certs
 #if defined(SWIFTEN_PLATFORM_WINDOWS)
-	X509_STORE* store = SSL_CTX_get_cert_store(context_);
+	X509_STORE* store = SSL_CTX_get_cert_store(context);
 	HCERTSTORE systemStore = CertOpenSystemStore(0, "ROOT");
 	if (systemStore) {
 		PCCERT_CONTEXT certContext = NULL;
@@ -68,7 +105,7 @@ OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readB
 		}
 	}
 #elif !defined(SWIFTEN_PLATFORM_MACOSX)
-	SSL_CTX_load_verify_locations(context_, NULL, "/etc/ssl/certs");
+	SSL_CTX_load_verify_locations(context, NULL, "/etc/ssl/certs");
 #elif defined(SWIFTEN_PLATFORM_MACOSX) && !defined(SWIFTEN_PLATFORM_IPHONE)
 	// On Mac OS X 10.5 (OpenSSL < 0.9.8), OpenSSL does not automatically look in the system store.
 	// On Mac OS X 10.6 (OpenSSL >= 0.9.8), OpenSSL *does* look in the system store to determine trust.
@@ -76,7 +113,7 @@ OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readB
 	// the certificates first. See 
 	//		http://opensource.apple.com/source/OpenSSL098/OpenSSL098-27/src/crypto/x509/x509_vfy_apple.c
 	// to understand why. We therefore add all certs from the system store ourselves.
-	X509_STORE* store = SSL_CTX_get_cert_store(context_);
+	X509_STORE* store = SSL_CTX_get_cert_store(context);
 	CFArrayRef anchorCertificates;
 	if (SecTrustCopyAnchorCertificates(&anchorCertificates) == 0) {
 		for (int i = 0; i < CFArrayGetCount(anchorCertificates); ++i) {
@@ -96,11 +133,7 @@ OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readB
 		CFRelease(anchorCertificates);
 	}
 #endif
-}
-
-OpenSSLContext::~OpenSSLContext() {
-	SSL_free(handle_);
-	SSL_CTX_free(context_);
+	return context;
 }
 
 void OpenSSLContext::ensureLibraryInitialized() {
@@ -119,23 +152,60 @@ void OpenSSLContext::ensureLibraryInitialized() {
 	}
 }
 
+int OpenSSLContext::handleNewSession(SSL* handle, SSL_SESSION* session) {
+	OpenSSLContext* context = static_cast<OpenSSLContext*>(SSL_get_app_data(handle));
+	if (!context || !context->sessionCache_ || context->serverName_.empty() || context->hasClientCertificate_) {
+		return 0;
+	}
+	context->sessionCache_->addSession(context->serverName_, session);
+	return 1;
+}
+
+void OpenSSLContext::setServerName(const std::string& serverName) {
+	serverName_ = serverName;
+}
+
 void OpenSSLContext::connect() {
-	handle_ = SSL_new(context_);
 	// Ownership of BIOs is ransferred
 	readBIO_ = BIO_new(BIO_s_mem());
 	writeBIO_ = BIO_new(BIO_s_mem());
 	SSL_set_bio(handle_, readBIO_, writeBIO_);
 
+	if (!serverName_.empty()) {
+		SSL_set_tlsext_host_name(handle_, const_cast<char*>(serverName_.c_str()));
+		// Sessions authenticated with a client certificate are not shared
+		// with other connections to the same server.
+		if (sessionCache_ && !hasClientCertificate_) {
+			if (boost::shared_ptr<SSL_SESSION> session = sessionCache_->getSession(serverName_)) {
+				SSL_set_session(handle_, session.get());
+			}
+		}
+	}
+
+	SSL_set_connect_state(handle_);
+	state_ = Connecting;
+	doConnect();
+}
+
+void OpenSSLContext::accept() {
+	// Ownership of BIOs is transferred
+	readBIO_ = BIO_new(BIO_s_mem());
+	writeBIO_ = BIO_new(BIO_s_mem());
+	SSL_set_bio(handle_, readBIO_, writeBIO_);
+
+	SSL_set_accept_state(handle_);
 	state_ = Connecting;
 	doConnect();
 }
 
 void OpenSSLContext::doConnect() {
-	int connectResult = SSL_connect(handle_);
+	int connectResult = SSL_do_handshake(handle_);
 	int error = SSL_get_error(handle_, connectResult);
 	switch (error) {
 		case SSL_ERROR_NONE: {
 			state_ = Connected;
+			// With TLS 1.3, the client's Finished message is only written now
+			sendPendingDataToNetwork();
 			//std::cout << x->name << std::endl;
 			//const char* comp = SSL_get_current_compression(handle_);
 			//std::cout << "Compression: " << SSL_COMP_get_name(comp) << std::endl;
@@ -147,6 +217,9 @@ void OpenSSLContext::doConnect() {
 			break;
 		default:
 			state_ = Error;
+			if (sessionCache_ && !serverName_.empty() && SSL_session_reused(handle_)) {
+				sessionCache_->removeSession(serverName_);
+			}
 			onError(boost::make_shared<TLSError>());
 	}
 }
@@ -154,10 +227,15 @@ void OpenSSLContext::doConnect() {
 void OpenSSLContext::sendPendingDataToNetwork() {
 	int size = BIO_pending(writeBIO_);
 	if (size > 0) {
+		// Reuse the buffer of the previous write. It is taken out of the
+		// context while it is being sent, in case sending causes another
+		// write.
 		SafeByteArray data;
-		data.resize(size);
+		data.swap(writeBuffer_);
+		data.resize(static_cast<size_t>(size));
 		BIO_read(writeBIO_, vecptr(data), size);
 		onDataForNetwork(data);
+		writeBuffer_.swap(data);
 	}
 }
 
@@ -186,22 +264,45 @@ void OpenSSLContext::handleDataFromApplication(const SafeByteArray& data) {
 }
 
 void OpenSSLContext::sendPendingDataToApplication() {
-	SafeByteArray data;
-	data.resize(SSL_READ_BUFFERSIZE);
-	int ret = SSL_read(handle_, vecptr(data), data.size());
-	while (ret > 0) {
-		data.resize(ret);
-		onDataForApplication(data);
-		data.resize(SSL_READ_BUFFERSIZE);
-		ret = SSL_read(handle_, vecptr(data), data.size());
+	// Decrypt all records that arrived into one buffer, so the application
+	// gets everything at once instead of a separate call per record. The
+	// buffer keeps its memory between reads, and only grows when more data
+	// is pending than fits in it. Memory of unusually large bursts is
+	// released again afterwards.
+	size_t size = 0;
+	bool error = false;
+	while (true) {
+		if (size == readBuffer_.size()) {
+			size_t pending = static_cast<size_t>(BIO_pending(readBIO_) + SSL_pending(handle_));
+			if (pending == 0) {
+				break;
+			}
+			readBuffer_.resize(size + pending);
+		}
+		int ret = SSL_read(handle_, vecptr(readBuffer_) + size, static_cast<int>(readBuffer_.size() - size));
+		if (ret <= 0) {
+			error = ret < 0 && SSL_get_error(handle_, ret) != SSL_ERROR_WANT_READ;
+			break;
+		}
+		size += static_cast<size_t>(ret);
 	}
-	if (ret < 0 && SSL_get_error(handle_, ret) != SSL_ERROR_WANT_READ) {
+	if (error) {
 		state_ = Error;
+	}
+
+	if (size > 0) {
+		readBuffer_.resize(size);
+		onDataForApplication(readBuffer_);
+	}
+	if (readBuffer_.capacity() > MAX_RETAINED_READ_BUFFER_SIZE) {
+		SafeByteArray().swap(readBuffer_);
+	}
+	if (error) {
 		onError(boost::make_shared<TLSError>());
 	}
 }
 
-bool OpenSSLContext::setClientCertificate(CertificateWithKey::ref certificate) {
+static bool parsePKCS12Certificate(CertificateWithKey::ref certificate, boost::shared_ptr<X509>& cert, boost::shared_ptr<EVP_PKEY>& privateKey, boost::shared_ptr<STACK_OF(X509)>& caCerts) {
 	boost::shared_ptr<PKCS12Certificate> pkcs12Certificate = boost::dynamic_pointer_cast<PKCS12Certificate>(certificate);
 	if (!pkcs12Certificate || pkcs12Certificate->isNull()) {
 		return false;
@@ -226,19 +327,50 @@ bool OpenSSLContext::setClientCertificate(CertificateWithKey::ref certificate) {
 	if (result != 1) { 
 		return false;
 	}
-	boost::shared_ptr<X509> cert(certPtr, X509_free);
-	boost::shared_ptr<EVP_PKEY> privateKey(privateKeyPtr, EVP_PKEY_free);
-	boost::shared_ptr<STACK_OF(X509)> caCerts(caCertsPtr, freeX509Stack);
+	cert = boost::shared_ptr<X509>(certPtr, X509_free);
+	privateKey = boost::shared_ptr<EVP_PKEY>(privateKeyPtr, EVP_PKEY_free);
+	caCerts = boost::shared_ptr<STACK_OF(X509)>(caCertsPtr, freeX509Stack);
+	return true;
+}
+
+bool OpenSSLContext::setClientCertificate(CertificateWithKey::ref certificate) {
+	boost::shared_ptr<X509> cert;
+	boost::shared_ptr<EVP_PKEY> privateKey;
+	boost::shared_ptr<STACK_OF(X509)> caCerts;
+	if (!parsePKCS12Certificate(certificate, cert, privateKey, caCerts)) {
+		return false;
+	}
+
+	// Use the key & certificates (on this connection only, as the context
+	// is shared)
+	if (SSL_use_certificate(handle_, cert.get()) != 1) {
+		return false;
+	}
+	if (SSL_use_PrivateKey(handle_, privateKey.get()) != 1) {
+		return false;
+	}
+	for (int i = 0;  i < sk_X509_num(caCerts.get()); ++i) {
+		SSL_add0_chain_cert(handle_, sk_X509_value(caCerts.get(), i));
+	}
+	hasClientCertificate_ = true;
+	return true;
+}
 
-	// Use the key & certificates
-	if (SSL_CTX_use_certificate(context_, cert.get()) != 1) {
+bool OpenSSLContext::setServerCertificate(SSL_CTX* context, CertificateWithKey::ref certificate) {
+	boost::shared_ptr<X509> cert;
+	boost::shared_ptr<EVP_PKEY> privateKey;
+	boost::shared_ptr<STACK_OF(X509)> caCerts;
+	if (!parsePKCS12Certificate(certificate, cert, privateKey, caCerts)) {
 		return false;
 	}
-	if (SSL_CTX_use_PrivateKey(context_, privateKey.get()) != 1) {
+	if (SSL_CTX_use_certificate(context, cert.get()) != 1) {
+		return false;
+	}
+	if (SSL_CTX_use_PrivateKey(context, privateKey.get()) != 1 || SSL_CTX_check_private_key(context) != 1) {
 		return false;
 	}
 	for (int i = 0;  i < sk_X509_num(caCerts.get()); ++i) {
-		SSL_CTX_add_extra_chain_cert(context_, sk_X509_value(caCerts.get(), i));
+		SSL_CTX_add_extra_chain_cert(context, sk_X509_value(caCerts.get(), i));
 	}
 	return true;
 }
@@ -273,6 +405,10 @@ ByteArray OpenSSLContext::getFinishMessage() const {
 	return data;
 }
 
+bool OpenSSLContext::isSessionReused() const {
+	return SSL_session_reused(handle_) != 0;
+}
+
 CertificateVerificationError::Type OpenSSLContext::getVerificationErrorTypeForResult(int result) {
 	assert(result != 0);
 	switch (result) {
@@ -1,27 +1,50 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <string>
 #include <openssl/ssl.h>
 #include <Swiften/Base/boost_bsignals.h>
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <Swiften/TLS/TLSContext.h>
 #include <Swiften/Base/ByteArray.h>
 #include <Swiften/TLS/CertificateWithKey.h>
 
 namespace Swift {
+	class OpenSSLSessionCache;
 
 	class OpenSSLContext : public TLSContext, boost::noncopyable {
 		public:
-			OpenSSLContext();
+			/**
+			 * Creates a connection using the given (shared) client context.
+			 * Sessions are resumed from and stored in the session cache.
+			 */
+			OpenSSLContext(boost::shared_ptr<SSL_CTX> context, boost::shared_ptr<OpenSSLSessionCache> sessionCache);
 			~OpenSSLContext();
 
+			/**
+			 * Creates a client context that trusts the system certificates,
+			 * and stores new sessions in the session cache of the contexts
+			 * using it.
+			 */
+			static SSL_CTX* createClientContext();
+
+			/**
+			 * Creates a server context. A certificate has to be set with
+			 * setServerCertificate() before it can be used.
+			 */
+			static SSL_CTX* createServerContext();
+			static bool setServerCertificate(SSL_CTX* context, CertificateWithKey::ref certificate);
+
+			void setServerName(const std::string& serverName);
 			void connect();
+			void accept();
 			bool setClientCertificate(CertificateWithKey::ref cert);
 
 			void handleDataFromNetwork(const SafeByteArray&);
@@ -32,8 +55,11 @@ namespace Swift {
 
 			virtual ByteArray getFinishMessage() const;
 
+			bool isSessionReused() const;
+
 		private:
 			static void ensureLibraryInitialized();	
+			static int handleNewSession(SSL*, SSL_SESSION*);
 
 			static CertificateVerificationError::Type getVerificationErrorTypeForResult(int);
 
@@ -45,9 +71,14 @@ namespace Swift {
 			enum State { Start, Connecting, Connected, Error };
 
 			State state_;
-			SSL_CTX* context_;
+			boost::shared_ptr<SSL_CTX> context_;
+			boost::shared_ptr<OpenSSLSessionCache> sessionCache_;
+			std::string serverName_;
+			bool hasClientCertificate_;
 			SSL* handle_;
 			BIO* readBIO_;
 			BIO* writeBIO_;
+			SafeByteArray readBuffer_;
+			SafeByteArray writeBuffer_;
 	};
 }
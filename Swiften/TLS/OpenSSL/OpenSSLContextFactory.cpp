@@ -1,21 +1,50 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/TLS/OpenSSL/OpenSSLContextFactory.h>
+
+#include <boost/smart_ptr/make_shared.hpp>
+
 #include <Swiften/TLS/OpenSSL/OpenSSLContext.h>
+#include <Swiften/TLS/OpenSSL/OpenSSLSessionCache.h>
 #include <Swiften/Base/Log.h>
 
 namespace Swift {
 
+OpenSSLContextFactory::OpenSSLContextFactory() : sessionCache(boost::make_shared<OpenSSLSessionCache>()) {
+}
+
+OpenSSLContextFactory::~OpenSSLContextFactory() {
+}
+
 bool OpenSSLContextFactory::canCreate() const {
 	return true;
 }
 
 TLSContext* OpenSSLContextFactory::createTLSContext() {
-	return new OpenSSLContext();
+	if (!context) {
+		context = boost::shared_ptr<SSL_CTX>(OpenSSLContext::createClientContext(), SSL_CTX_free);
+	}
+	return new OpenSSLContext(context, sessionCache);
+}
+
+bool OpenSSLContextFactory::setServerCertificate(CertificateWithKey::ref certificate) {
+	boost::shared_ptr<SSL_CTX> newServerContext(OpenSSLContext::createServerContext(), SSL_CTX_free);
+	if (!OpenSSLContext::setServerCertificate(newServerContext.get(), certificate)) {
+		return false;
+	}
+	serverContext = newServerContext;
+	return true;
+}
+
+TLSContext* OpenSSLContextFactory::createServerTLSContext() {
+	if (!serverContext) {
+		return NULL;
+	}
+	return new OpenSSLContext(serverContext, boost::shared_ptr<OpenSSLSessionCache>());
 }
 
 void OpenSSLContextFactory::setCheckCertificateRevocation(bool check) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,14 +9,37 @@
 #include <Swiften/TLS/TLSContextFactory.h>
 
 #include <cassert>
+#include <openssl/ssl.h>
+#include <boost/shared_ptr.hpp>
 
 namespace Swift {
+	class OpenSSLSessionCache;
+
+	/**
+	 * Creates connections that share one OpenSSL context (and thus only
+	 * load the trusted certificates once), and that resume earlier sessions
+	 * with the same server.
+	 *
+	 * Server connections share a separate context, which can be used from
+	 * multiple threads once the server certificate is set.
+	 */
 	class OpenSSLContextFactory : public TLSContextFactory {
 		public:
+			OpenSSLContextFactory();
+			~OpenSSLContextFactory();
+
 			bool canCreate() const;
 			virtual TLSContext* createTLSContext();
 
 			// Not supported
 			virtual void setCheckCertificateRevocation(bool b);
+
+			virtual bool setServerCertificate(CertificateWithKey::ref certificate);
+			virtual TLSContext* createServerTLSContext();
+
+		private:
+			boost::shared_ptr<SSL_CTX> context;
+			boost::shared_ptr<SSL_CTX> serverContext;
+			boost::shared_ptr<OpenSSLSessionCache> sessionCache;
 	};
 }
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/TLS/OpenSSL/OpenSSLSessionCache.h>
+
+#include <boost/thread/locks.hpp>
+
+namespace Swift {
+
+OpenSSLSessionCache::OpenSSLSessionCache() {
+}
+
+boost::shared_ptr<SSL_SESSION> OpenSSLSessionCache::getSession(const std::string& serverName) const {
+	boost::lock_guard<boost::mutex> lock(mutex);
+	std::map<std::string, boost::shared_ptr<SSL_SESSION> >::const_iterator i = sessions.find(serverName);
+	return i != sessions.end() ? i->second : boost::shared_ptr<SSL_SESSION>();
+}
+
+void OpenSSLSessionCache::addSession(const std::string& serverName, SSL_SESSION* session) {
+	boost::shared_ptr<SSL_SESSION> sessionPtr(session, SSL_SESSION_free);
+	boost::lock_guard<boost::mutex> lock(mutex);
+	sessions[serverName] = sessionPtr;
+}
+
+void OpenSSLSessionCache::removeSession(const std::string& serverName) {
+	boost::shared_ptr<SSL_SESSION> session;
+	boost::lock_guard<boost::mutex> lock(mutex);
+	std::map<std::string, boost::shared_ptr<SSL_SESSION> >::iterator i = sessions.find(serverName);
+	if (i != sessions.end()) {
+		session = i->second;
+		sessions.erase(i);
+	}
+}
+
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <openssl/ssl.h>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace Swift {
+	/**
+	 * Remembers the last TLS session negotiated with each server, so that
+	 * new connections to the same server can do an abbreviated handshake.
+	 */
+	class OpenSSLSessionCache : boost::noncopyable {
+		public:
+			OpenSSLSessionCache();
+
+			/**
+			 * Returns the session to resume for the given server, or a null
+			 * pointer if there is none.
+			 */
+			boost::shared_ptr<SSL_SESSION> getSession(const std::string& serverName) const;
+
+			/**
+			 * Takes over the caller's reference to the session.
+			 */
+			void addSession(const std::string& serverName, SSL_SESSION* session);
+
+			void removeSession(const std::string& serverName);
+
+		private:
+			mutable boost::mutex mutex;
+			std::map<std::string, boost::shared_ptr<SSL_SESSION> > sessions;
+	};
+}
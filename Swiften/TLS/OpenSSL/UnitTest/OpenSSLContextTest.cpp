@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <deque>
+#include <boost/bind.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/TLS/OpenSSL/OpenSSLContext.h>
+#include <Swiften/TLS/OpenSSL/OpenSSLContextFactory.h>
+#include <Swiften/TLS/OpenSSL/UnitTest/SelfSignedCertificate.h>
+#include <Swiften/TLS/PKCS12Certificate.h>
+
+using namespace Swift;
+
+namespace {
+	/**
+	 * Passes the data of a client and a server context to each other.
+	 */
+	class TLSConnection {
+		public:
+			TLSConnection(TLSContext* client, TLSContext* server) : client(client), server(server), clientReads(0), clientConnected(false), serverConnected(false), error(false) {
+				client->onDataForNetwork.connect(boost::bind(&TLSConnection::handleDataForNetwork, this, &toServer, _1));
+				server->onDataForNetwork.connect(boost::bind(&TLSConnection::handleDataForNetwork, this, &toClient, _1));
+				client->onDataForApplication.connect(boost::bind(&TLSConnection::handleDataForApplication, this, &clientData, _1));
+				client->onDataForApplication.connect(boost::bind(&TLSConnection::handleClientRead, this));
+				server->onDataForApplication.connect(boost::bind(&TLSConnection::handleDataForApplication, this, &serverData, _1));
+				client->onConnected.connect(boost::bind(&TLSConnection::handleConnected, this, &clientConnected));
+				server->onConnected.connect(boost::bind(&TLSConnection::handleConnected, this, &serverConnected));
+				client->onError.connect(boost::bind(&TLSConnection::handleError, this));
+				server->onError.connect(boost::bind(&TLSConnection::handleError, this));
+			}
+
+			void connect() {
+				server->accept();
+				client->connect();
+				flush();
+			}
+
+			void flush() {
+				while (!error && (!toServer.empty() || !toClient.empty())) {
+					if (!toServer.empty()) {
+						SafeByteArray data = toServer.front();
+						toServer.pop_front();
+						server->handleDataFromNetwork(data);
+					}
+					if (!toClient.empty()) {
+						SafeByteArray data = toClient.front();
+						toClient.pop_front();
+						client->handleDataFromNetwork(data);
+					}
+				}
+			}
+
+		private:
+			void handleDataForNetwork(std::deque<SafeByteArray>* queue, const SafeByteArray& data) {
+				queue->push_back(data);
+			}
+
+			void handleDataForApplication(SafeByteArray* buffer, const SafeByteArray& data) {
+				append(*buffer, data);
+			}
+
+			void handleClientRead() {
+				++clientReads;
+			}
+
+			void handleConnected(bool* connected) {
+				*connected = true;
+			}
+
+			void handleError() {
+				error = true;
+			}
+
+		public:
+			TLSContext* client;
+			TLSContext* server;
+			std::deque<SafeByteArray> toServer;
+			std::deque<SafeByteArray> toClient;
+			SafeByteArray clientData;
+			SafeByteArray serverData;
+			int clientReads;
+			bool clientConnected;
+			bool serverConnected;
+			bool error;
+	};
+}
+
+class OpenSSLContextTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(OpenSSLContextTest);
+		CPPUNIT_TEST(testConnect);
+		CPPUNIT_TEST(testConnect_ResumesSession);
+		CPPUNIT_TEST(testHandleDataFromNetwork_MultipleRecords);
+		CPPUNIT_TEST(testHandleDataFromNetwork_AfterLargeBurst);
+		CPPUNIT_TEST(testCreateServerTLSContext_WithoutCertificate);
+		CPPUNIT_TEST(testSetServerCertificate_InvalidCertificate);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void setUp() {
+			clientFactory = new OpenSSLContextFactory();
+			serverFactory = new OpenSSLContextFactory();
+		}
+
+		void tearDown() {
+			delete serverFactory;
+			delete clientFactory;
+		}
+
+		void testConnect() {
+			CPPUNIT_ASSERT(serverFactory->setServerCertificate(getCertificate()));
+			boost::shared_ptr<TLSContext> client(clientFactory->createTLSContext());
+			boost::shared_ptr<TLSContext> server(serverFactory->createServerTLSContext());
+			TLSConnection connection(client.get(), server.get());
+
+			connection.connect();
+			client->handleDataFromApplication(createSafeByteArray("<stream>"));
+			server->handleDataFromApplication(createSafeByteArray("<stream/>"));
+			connection.flush();
+
+			CPPUNIT_ASSERT(!connection.error);
+			CPPUNIT_ASSERT(connection.clientConnected);
+			CPPUNIT_ASSERT(connection.serverConnected);
+			CPPUNIT_ASSERT_EQUAL(std::string("<stream>"), byteArrayToString(ByteArray(connection.serverData.begin(), connection.serverData.end())));
+			CPPUNIT_ASSERT_EQUAL(std::string("<stream/>"), byteArrayToString(ByteArray(connection.clientData.begin(), connection.clientData.end())));
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), client->getPeerCertificateChain().size());
+		}
+
+		void testConnect_ResumesSession() {
+			CPPUNIT_ASSERT(serverFactory->setServerCertificate(getCertificate()));
+			for (int i = 0; i < 2; ++i) {
+				boost::shared_ptr<TLSContext> client(clientFactory->createTLSContext());
+				boost::shared_ptr<TLSContext> server(serverFactory->createServerTLSContext());
+				client->setServerName("example.com");
+				TLSConnection connection(client.get(), server.get());
+
+				connection.connect();
+				client->handleDataFromApplication(createSafeByteArray("<stream>"));
+				connection.flush();
+
+				CPPUNIT_ASSERT(connection.clientConnected);
+				CPPUNIT_ASSERT(connection.serverConnected);
+				CPPUNIT_ASSERT_EQUAL(i == 1, boost::dynamic_pointer_cast<OpenSSLContext>(client)->isSessionReused());
+			}
+		}
+
+		void testHandleDataFromNetwork_MultipleRecords() {
+			CPPUNIT_ASSERT(serverFactory->setServerCertificate(getCertificate()));
+			boost::shared_ptr<TLSContext> client(clientFactory->createTLSContext());
+			boost::shared_ptr<TLSContext> server(serverFactory->createServerTLSContext());
+			TLSConnection connection(client.get(), server.get());
+			connection.connect();
+
+			server->handleDataFromApplication(createSafeByteArray("<message>"));
+			server->handleDataFromApplication(SafeByteArray(20000, 'a'));
+			server->handleDataFromApplication(createSafeByteArray("</message>"));
+			SafeByteArray records;
+			while (!connection.toClient.empty()) {
+				append(records, connection.toClient.front());
+				connection.toClient.pop_front();
+			}
+			client->handleDataFromNetwork(records);
+
+			CPPUNIT_ASSERT(!connection.error);
+			CPPUNIT_ASSERT_EQUAL(1, connection.clientReads);
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(20019), connection.clientData.size());
+			CPPUNIT_ASSERT_EQUAL(std::string("<message>aaa"), byteArrayToString(ByteArray(connection.clientData.begin(), connection.clientData.begin() + 12)));
+			CPPUNIT_ASSERT_EQUAL(std::string("aaa</message>"), byteArrayToString(ByteArray(connection.clientData.end() - 13, connection.clientData.end())));
+		}
+
+		void testHandleDataFromNetwork_AfterLargeBurst() {
+			CPPUNIT_ASSERT(serverFactory->setServerCertificate(getCertificate()));
+			boost::shared_ptr<TLSContext> client(clientFactory->createTLSContext());
+			boost::shared_ptr<TLSContext> server(serverFactory->createServerTLSContext());
+			TLSConnection connection(client.get(), server.get());
+			connection.connect();
+
+			server->handleDataFromApplication(SafeByteArray(200000, 'a'));
+			SafeByteArray records;
+			while (!connection.toClient.empty()) {
+				append(records, connection.toClient.front());
+				connection.toClient.pop_front();
+			}
+			client->handleDataFromNetwork(records);
+			server->handleDataFromApplication(createSafeByteArray("<message/>"));
+			connection.flush();
+
+			CPPUNIT_ASSERT(!connection.error);
+			CPPUNIT_ASSERT_EQUAL(2, connection.clientReads);
+			CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(200010), connection.clientData.size());
+			CPPUNIT_ASSERT_EQUAL(std::string("aaa<message/>"), byteArrayToString(ByteArray(connection.clientData.end() - 13, connection.clientData.end())));
+		}
+
+		void testCreateServerTLSContext_WithoutCertificate() {
+			CPPUNIT_ASSERT(!serverFactory->createServerTLSContext());
+		}
+
+		void testSetServerCertificate_InvalidCertificate() {
+			boost::shared_ptr<PKCS12Certificate> certificate = boost::make_shared<PKCS12Certificate>();
+			certificate->setData(createByteArray("foo"));
+
+			CPPUNIT_ASSERT(!serverFactory->setServerCertificate(certificate));
+			CPPUNIT_ASSERT(!serverFactory->createServerTLSContext());
+		}
+
+	private:
+		/**
+		 * Returns a self-signed certificate for example.com, which is
+		 * generated once for all tests.
+		 */
+		static CertificateWithKey::ref getCertificate() {
+			static boost::shared_ptr<PKCS12Certificate> certificate;
+			if (!certificate) {
+				certificate = SelfSignedCertificate::create();
+			}
+			return certificate;
+		}
+
+	private:
+		OpenSSLContextFactory* clientFactory;
+		OpenSSLContextFactory* serverFactory;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OpenSSLContextTest);
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2015 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <openssl/evp.h>
+#include <openssl/pkcs12.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/TLS/PKCS12Certificate.h>
+
+namespace Swift {
+	namespace SelfSignedCertificate {
+		/**
+		 * Creates a self-signed certificate for example.com, with a new
+		 * 2048-bit RSA key, for tests and benchmarks that need a TLS
+		 * server. The certificate is valid for an hour, and the PKCS#12
+		 * data has an empty password.
+		 */
+		inline boost::shared_ptr<PKCS12Certificate> create() {
+			EVP_PKEY* key = NULL;
+			EVP_PKEY_CTX* keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+			EVP_PKEY_keygen_init(keyContext);
+			EVP_PKEY_CTX_set_rsa_keygen_bits(keyContext, 2048);
+			EVP_PKEY_keygen(keyContext, &key);
+			EVP_PKEY_CTX_free(keyContext);
+
+			X509* x509 = X509_new();
+			ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+			X509_gmtime_adj(X509_get_notBefore(x509), 0);
+			X509_gmtime_adj(X509_get_notAfter(x509), 3600);
+			X509_set_pubkey(x509, key);
+			X509_NAME* name = X509_get_subject_name(x509);
+			X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("example.com"), -1, -1, 0);
+			X509_set_issuer_name(x509, name);
+			X509_sign(x509, key, EVP_sha256());
+
+			PKCS12* pkcs12 = PKCS12_create(const_cast<char*>(""), NULL, key, x509, NULL, 0, 0, 0, 0, 0);
+			ByteArray data(static_cast<size_t>(i2d_PKCS12(pkcs12, NULL)));
+			unsigned char* p = vecptr(data);
+			i2d_PKCS12(pkcs12, &p);
+			PKCS12_free(pkcs12);
+			X509_free(x509);
+			EVP_PKEY_free(key);
+
+			boost::shared_ptr<PKCS12Certificate> certificate = boost::make_shared<PKCS12Certificate>();
+			certificate->setData(data);
+			return certificate;
+		}
+	}
+}
@@ -1,16 +1,25 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/TLS/TLSContext.h>
 
+#include <boost/smart_ptr/make_shared.hpp>
+
 namespace Swift {
 
 TLSContext::~TLSContext() {
 }
 
+void TLSContext::setServerName(const std::string&) {
+}
+
+void TLSContext::accept() {
+	onError(boost::make_shared<TLSError>());
+}
+
 Certificate::ref TLSContext::getPeerCertificate() const {
 	std::vector<Certificate::ref> chain = getPeerCertificateChain();
 	return chain.empty() ? Certificate::ref() : chain[0];
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,6 +8,7 @@
 
 #include <Swiften/Base/boost_bsignals.h>
 #include <boost/shared_ptr.hpp>
+#include <string>
 
 #include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/TLS/Certificate.h>
@@ -21,8 +22,21 @@ namespace Swift {
 		public:
 			virtual ~TLSContext();
 
+			/**
+			 * Sets the name of the server this context connects to. The
+			 * name is sent to the server (SNI), and is used to find a
+			 * previous session with the server to resume.
+			 */
+			virtual void setServerName(const std::string&);
+
 			virtual void connect() = 0;
 
+			/**
+			 * Starts the handshake in the server role. Only contexts created
+			 * with TLSContextFactory::createServerTLSContext() support this.
+			 */
+			virtual void accept();
+
 			virtual bool setClientCertificate(CertificateWithKey::ref cert) = 0;
 
 			virtual void handleDataFromNetwork(const SafeByteArray&) = 0;
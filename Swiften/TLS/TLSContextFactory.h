@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2015 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <Swiften/TLS/CertificateWithKey.h>
+
 namespace Swift {
 	class TLSContext;
 
@@ -17,5 +19,19 @@ namespace Swift {
 
 			virtual TLSContext* createTLSContext() = 0;
 			virtual void setCheckCertificateRevocation(bool b) = 0;
+
+			/**
+			 * Sets the certificate and key that server contexts present.
+			 *
+			 * Returns false if the certificate could not be used, or if the
+			 * factory does not support server contexts.
+			 */
+			virtual bool setServerCertificate(CertificateWithKey::ref certificate);
+
+			/**
+			 * Creates a context for the server side of a connection, or
+			 * returns NULL if no server certificate was set.
+			 */
+			virtual TLSContext* createServerTLSContext();
 	};
 }